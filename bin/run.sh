@@ -23,11 +23,14 @@ fi
 
 if [ "${MODE}" = "TEST" ]; then
     FLAGS="${FLAGS} -g -DTEST"
+elif [ "${MODE}" = "BENCH" ]; then
+    FLAGS="${FLAGS/-fsanitize=address/} -O3 -DBENCH -DLOG_LEVEL=LEVEL_INFO"
 elif [ "${MODE}" = "" ]; then
     FLAGS="${FLAGS} -O3 -DLOG_LEVEL=LEVEL_INFO"
 else
     echo "ERROR: invalid mode ${MODE} - allowed modes are"
     echo " * TEST"
+    echo " * BENCH"
     echo " * (none)"
     exit 1
 fi
@@ -54,6 +57,13 @@ if [ "${MODE}" = "TEST" ]; then
     else
         echo -e "\n\n\e[31mApplication not run.\e[0m\n\n"
     fi
+elif [ "${MODE}" = "BENCH" ]; then
+    # One result file per commit, to be diffed against the results of another commit
+    mkdir -p "${BD}/bench"
+    export JSON_BENCH_COMMIT="$(git -C "${BD}" rev-parse --short HEAD 2>/dev/null || echo unknown)"
+    export JSON_BENCH_OUT="${JSON_BENCH_OUT:-${BD}/bench/${JSON_BENCH_COMMIT}.json}"
+    export JSON_BENCH_ASSETS="${JSON_BENCH_ASSETS:-${BD}/test/assets}"
+    "${BD}/build/json_serializer"
 else
     "${BD}/build/json_serializer"
 fi
@@ -1,9 +1,63 @@
+#ifdef JSON_STATS
+// Heap calls of the library, see JsonGlobalStats. The functions are defined before the macros,
+// so that they call the allocator of the C library.
+static atomic_size_t _json_stats_num_of_allocs   = 0;
+static atomic_size_t _json_stats_num_of_reallocs = 0;
+static atomic_size_t _json_stats_num_of_frees    = 0;
+static atomic_size_t _json_stats_allocated_bytes = 0;
+
+static void* _json_stats_malloc(size_t size)
+{
+    atomic_fetch_add_explicit(&_json_stats_num_of_allocs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_json_stats_allocated_bytes, size, memory_order_relaxed);
+    return malloc(size);
+}
+
+static void* _json_stats_calloc(size_t num, size_t size)
+{
+    atomic_fetch_add_explicit(&_json_stats_num_of_allocs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&_json_stats_allocated_bytes, num * size, memory_order_relaxed);
+    return calloc(num, size);
+}
+
+static void* _json_stats_realloc(void* ptr, size_t size)
+{
+    atomic_fetch_add_explicit(
+        (ptr == NULL) ? &_json_stats_num_of_allocs : &_json_stats_num_of_reallocs,
+        1,
+        memory_order_relaxed);
+    atomic_fetch_add_explicit(&_json_stats_allocated_bytes, size, memory_order_relaxed);
+    return realloc(ptr, size);
+}
+
+static void _json_stats_free(void* ptr)
+{
+    if (ptr != NULL)
+    {
+        atomic_fetch_add_explicit(&_json_stats_num_of_frees, 1, memory_order_relaxed);
+    }
+    free(ptr);
+}
+
+void JsonStats_global(JsonGlobalStats* out_stats_p)
+{
+    out_stats_p->num_of_allocs   = atomic_load(&_json_stats_num_of_allocs);
+    out_stats_p->num_of_reallocs = atomic_load(&_json_stats_num_of_reallocs);
+    out_stats_p->num_of_frees    = atomic_load(&_json_stats_num_of_frees);
+    out_stats_p->allocated_bytes = atomic_load(&_json_stats_allocated_bytes);
+}
+
+#define malloc(size) _json_stats_malloc(size)
+#define calloc(num, size) _json_stats_calloc(num, size)
+#define realloc(ptr, size) _json_stats_realloc(ptr, size)
+#define free(ptr) _json_stats_free(ptr)
+#endif /* JSON_STATS */
+
 #if LOG_LEVEL > LEVEL_NO_LOGS
 
 FILE* log_out_file_p = NULL;
 FILE* log_err_file_p = NULL;
-pthread_mutex_t log_out_mutex;
-pthread_mutex_t log_err_mutex;
+pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER; // Writes that bypass the writer thread
 
 void wrap_free(char** var) { free(*var); }
 
@@ -37,8 +91,6 @@ void logger_init(const char* log_out_file_path_str, const char* log_err_file_pat
         return;
     }
     LOG_INFO("Initializing logger.");
-    pthread_mutex_init(&log_out_mutex, NULL);
-    pthread_mutex_init(&log_err_mutex, NULL);
     logger_initialized = true;
 
     if (log_out_file_path_str != NULL && log_err_file_path_str != NULL)
@@ -89,6 +141,345 @@ void get_date_time(char* date_time_str)
 #endif /* __linux__ */
 }
 
+// ---------- Asynchronous logging ----------
+// A log line costs its caller a clock_gettime and a vsnprintf into a ring of its own thread, with
+// no lock and no system call. A writer thread, started with the first line, drains the rings of all
+// the threads, adds the prefix and writes the lines in batches, with one fflush per batch. The date
+// is formatted once per second and the pid is read once. A thread whose ring is full waits for the
+// writer, so no line is lost; lines of different threads may be written out of order. The writer
+// sleeps on a condition variable when every ring is empty, and a line published while it sleeps
+// wakes it up. When the writer thread cannot start, or after the program exits, lines are written
+// synchronously.
+
+#define LOGGER_IDLE 0
+#define LOGGER_STARTING 1
+#define LOGGER_RUNNING 2
+#define LOGGER_STOPPING 3
+#define LOGGER_SYNC 4
+#define LOGGER_IDLE_PASSES 256 // Empty passes of the writer thread before it sleeps
+
+static atomic_int _logger_state          = LOGGER_IDLE;
+static atomic_bool _logger_stop_flag     = false;
+static atomic_bool _logger_sleeping      = false; // Set by the writer while it waits for lines
+static pthread_mutex_t _logger_wake_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _logger_wake_cond   = PTHREAD_COND_INITIALIZER;
+static _Atomic(LogRing*) _logger_rings_p = NULL; // Rings of all the threads, newest first
+static pthread_t _logger_writer;
+static pthread_key_t _logger_ring_key;
+static pthread_once_t _logger_once = PTHREAD_ONCE_INIT;
+static pid_t _logger_pid;
+static _Thread_local LogRing* _log_ring_p = NULL;
+
+static void _logger_format_time(const struct timespec* time_p, char* date_time_str,
+                                time_t* cached_sec_p)
+{
+    if (time_p->tv_sec != *cached_sec_p)
+    {
+        struct tm result;
+        localtime_r(&time_p->tv_sec, &result);
+        strftime(date_time_str, 26, "%a %b %d %Y %H:%M:%S.", &result);
+        *cached_sec_p = time_p->tv_sec;
+    }
+    long usec = time_p->tv_nsec / 1000;
+    for (size_t i = 30; i >= 25; i--)
+    {
+        date_time_str[i] = (char)('0' + usec % 10);
+        usec /= 10;
+    }
+    date_time_str[31] = '\0';
+}
+
+static void _logger_write(const LogRecord* record_p, const char* date_time_str)
+{
+    if (record_p->type == NULL)
+    {
+        fprintf(record_p->file_p, "------- <%d> %s -------\n", _logger_pid, date_time_str);
+    }
+    else
+    {
+        fprintf(
+            record_p->file_p,
+            "[%5s] <%d> %s %s:%d | %s\n",
+            record_p->type,
+            _logger_pid,
+            date_time_str,
+            record_p->filename,
+            record_p->line,
+            record_p->message);
+    }
+}
+
+// Write a record right away, as the logger did before the writer thread existed.
+static void _logger_write_now(const LogRecord* record_p)
+{
+    char date_time_str[DATE_TIME_STR_LEN];
+    time_t cached_sec = -1;
+    _logger_format_time(&record_p->time, date_time_str, &cached_sec);
+    pthread_mutex_lock(&log_mutex);
+    _logger_write(record_p, date_time_str);
+    fflush(record_p->file_p);
+    pthread_mutex_unlock(&log_mutex);
+}
+
+// Whether every line published has been drained.
+static bool _logger_is_drained(void)
+{
+    for (LogRing* ring_p = atomic_load(&_logger_rings_p); ring_p != NULL; ring_p = ring_p->next_p)
+    {
+        if (atomic_load(&ring_p->head) != ring_p->drained)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Wait until a line is published or the logger is stopped. `_logger_sleeping` is set before the
+// rings are checked again and a thread reads it after publishing, both sequentially consistent, so
+// either the writer sees the line or the thread sees the writer asleep and signals it.
+static void _logger_wait(void)
+{
+    pthread_mutex_lock(&_logger_wake_mutex);
+    atomic_store(&_logger_sleeping, true);
+    while (_logger_is_drained() && !atomic_load(&_logger_stop_flag))
+    {
+        pthread_cond_wait(&_logger_wake_cond, &_logger_wake_mutex);
+    }
+    atomic_store(&_logger_sleeping, false);
+    pthread_mutex_unlock(&_logger_wake_mutex);
+}
+
+static void _logger_wake(void)
+{
+    pthread_mutex_lock(&_logger_wake_mutex);
+    pthread_cond_signal(&_logger_wake_cond);
+    pthread_mutex_unlock(&_logger_wake_mutex);
+}
+
+static void* _logger_run(void* unused_p)
+{
+    (void)unused_p;
+    char date_time_str[DATE_TIME_STR_LEN];
+    time_t cached_sec          = -1;
+    size_t num_of_empty_passes = 0;
+    while (true)
+    {
+        // Read before draining, so that the last pass sees every line logged before the stop.
+        const bool stopping = atomic_load_explicit(&_logger_stop_flag, memory_order_acquire);
+        LogRing* rings_p    = atomic_load_explicit(&_logger_rings_p, memory_order_acquire);
+        size_t num_of_lines = 0;
+        for (LogRing* ring_p = rings_p; ring_p != NULL; ring_p = ring_p->next_p)
+        {
+            // Sequentially consistent, see log_enqueue.
+            const size_t head = atomic_load(&ring_p->head);
+            for (ring_p->drained = atomic_load_explicit(&ring_p->tail, memory_order_relaxed);
+                 ring_p->drained != head;
+                 ring_p->drained++)
+            {
+                const LogRecord* record_p = &ring_p->records[ring_p->drained % LOG_RING_LEN];
+                _logger_format_time(&record_p->time, date_time_str, &cached_sec);
+                _logger_write(record_p, date_time_str);
+                num_of_lines++;
+            }
+        }
+        if (num_of_lines == 0)
+        {
+            if (stopping)
+            {
+                return NULL;
+            }
+            // Yield for a while before sleeping, so that bursts of lines do not pay for a wake-up.
+            if (++num_of_empty_passes < LOGGER_IDLE_PASSES)
+            {
+                sched_yield();
+            }
+            else
+            {
+                _logger_wait();
+                num_of_empty_passes = 0;
+            }
+            continue;
+        }
+        num_of_empty_passes = 0;
+        fflush(NULL);
+        // Slots are released only once flushed, so that logger_flush can wait on `tail` alone.
+        for (LogRing* ring_p = rings_p; ring_p != NULL; ring_p = ring_p->next_p)
+        {
+            atomic_store_explicit(&ring_p->tail, ring_p->drained, memory_order_release);
+        }
+    }
+}
+
+static void _LogRing_release(void* ring_p)
+{
+    atomic_store_explicit(&((LogRing*)ring_p)->in_use, false, memory_order_release);
+}
+
+// Take the ring of a thread that has exited, or add a new one.
+static LogRing* _LogRing_acquire(void)
+{
+    for (LogRing* ring_p = atomic_load(&_logger_rings_p); ring_p != NULL; ring_p = ring_p->next_p)
+    {
+        bool expected = false;
+        if (atomic_compare_exchange_strong(&ring_p->in_use, &expected, true))
+        {
+            return ring_p;
+        }
+    }
+    LogRing* ring_p = aligned_alloc(_Alignof(LogRing), sizeof(LogRing));
+    if (ring_p == NULL)
+    {
+        return NULL;
+    }
+    atomic_init(&ring_p->head, 0);
+    atomic_init(&ring_p->tail, 0);
+    atomic_init(&ring_p->in_use, true);
+    ring_p->drained = 0;
+    ring_p->next_p  = atomic_load(&_logger_rings_p);
+    while (!atomic_compare_exchange_weak(&_logger_rings_p, &ring_p->next_p, ring_p))
+    {
+    }
+    return ring_p;
+}
+
+// Write what is left and fall back to synchronous writes, registered with atexit.
+static void _logger_stop(void)
+{
+    int expected = LOGGER_RUNNING;
+    if (atomic_compare_exchange_strong(&_logger_state, &expected, LOGGER_STOPPING))
+    {
+        atomic_store(&_logger_stop_flag, true);
+        _logger_wake();
+        pthread_join(_logger_writer, NULL);
+        atomic_store(&_logger_state, LOGGER_SYNC);
+    }
+}
+
+// The writer thread is not duplicated by fork: the child drops the rings and starts its own.
+static void _logger_after_fork(void)
+{
+    atomic_store(&_logger_rings_p, NULL);
+    atomic_store(&_logger_state, LOGGER_IDLE);
+    _log_ring_p = NULL;
+}
+
+static void _logger_init_once(void)
+{
+    pthread_key_create(&_logger_ring_key, _LogRing_release);
+    pthread_atfork(NULL, NULL, _logger_after_fork);
+    atexit(_logger_stop);
+}
+
+static void _logger_start(void)
+{
+    int expected = LOGGER_IDLE;
+    if (atomic_compare_exchange_strong(&_logger_state, &expected, LOGGER_STARTING))
+    {
+        pthread_once(&_logger_once, _logger_init_once);
+        _logger_pid = getpid();
+        atomic_store(&_logger_stop_flag, false);
+        atomic_store(
+            &_logger_state,
+            (pthread_create(&_logger_writer, NULL, _logger_run, NULL) == 0) ? LOGGER_RUNNING
+                                                                            : LOGGER_SYNC);
+        return;
+    }
+    while (atomic_load(&_logger_state) == LOGGER_STARTING)
+    {
+        sched_yield();
+    }
+}
+
+void log_enqueue(FILE* file_p, const char* type, const char* filename, int line, const char* fmt,
+                 ...)
+{
+    if (atomic_load_explicit(&_logger_state, memory_order_acquire) != LOGGER_RUNNING)
+    {
+        _logger_start();
+    }
+    LogRecord sync_record;
+    LogRecord* record_p = &sync_record;
+    LogRing* ring_p     = _log_ring_p;
+    size_t head         = 0;
+    if ((ring_p == NULL) && (atomic_load(&_logger_state) == LOGGER_RUNNING))
+    {
+        ring_p      = _LogRing_acquire();
+        _log_ring_p = ring_p;
+        pthread_setspecific(_logger_ring_key, ring_p);
+    }
+    if (ring_p != NULL)
+    {
+        head = atomic_load_explicit(&ring_p->head, memory_order_relaxed);
+        while (head - atomic_load_explicit(&ring_p->tail, memory_order_acquire) == LOG_RING_LEN)
+        {
+            if (atomic_load(&_logger_state) != LOGGER_RUNNING)
+            {
+                break;
+            }
+            sched_yield();
+        }
+        if (atomic_load(&_logger_state) == LOGGER_RUNNING)
+        {
+            record_p = &ring_p->records[head % LOG_RING_LEN];
+        }
+    }
+    clock_gettime(CLOCK_REALTIME, &record_p->time);
+    record_p->file_p   = file_p;
+    record_p->type     = type;
+    record_p->filename = filename;
+    record_p->line     = line;
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(record_p->message, LOG_MESSAGE_LEN, fmt, args);
+    va_end(args);
+    if (record_p == &sync_record)
+    {
+        _logger_write_now(record_p);
+        return;
+    }
+    // Sequentially consistent with the loads of `head` and `_logger_state` by the writer thread
+    // and the stores of `_logger_sleeping` and `_logger_state`, see _logger_wait and _logger_stop.
+    atomic_store(&ring_p->head, head + 1);
+    if (atomic_load(&_logger_state) != LOGGER_RUNNING)
+    {
+        // The logger was stopped after the slot was taken and its last pass may have missed the
+        // line. Once the writer has been joined, `tail` tells whether it was written.
+        while (atomic_load(&_logger_state) == LOGGER_STOPPING)
+        {
+            sched_yield();
+        }
+        if (atomic_load_explicit(&ring_p->tail, memory_order_acquire) <= head)
+        {
+            _logger_write_now(record_p);
+            atomic_store_explicit(&ring_p->tail, head + 1, memory_order_release);
+        }
+        return;
+    }
+    if (atomic_load(&_logger_sleeping))
+    {
+        _logger_wake();
+    }
+}
+
+// Wait until every line logged so far has been written and flushed.
+void logger_flush(void)
+{
+    if (atomic_load(&_logger_state) != LOGGER_RUNNING)
+    {
+        fflush(NULL);
+        return;
+    }
+    for (LogRing* ring_p = atomic_load(&_logger_rings_p); ring_p != NULL; ring_p = ring_p->next_p)
+    {
+        const size_t head = atomic_load_explicit(&ring_p->head, memory_order_acquire);
+        while ((atomic_load_explicit(&ring_p->tail, memory_order_acquire) < head) &&
+               (atomic_load(&_logger_state) == LOGGER_RUNNING))
+        {
+            sched_yield();
+        }
+    }
+}
+
 #endif /* LOG_LEVEL > LEVEL_NO_LOGS */
 
 void ASSERT_(bool value, const char* message, const char* filename, int line_number)
@@ -304,29 +695,98 @@ void ASSERT_NE_llu(
     }
 }
 
-#define MAX_NUM_LEN (30)
-
-// Used only for returning data in a convenient way. Not used for storage.
+// Built when an array is closed, so that its elements are reached by index in O(1). The elements
+// stay linked through `next_sibling` as well.
 typedef struct JsonArray
 {
-    struct JsonItem* element;
+    size_t len;
+    struct JsonItem* elements[];
 } JsonArray;
 
-typedef enum
+#define JSON_ARENA_MIN_CHUNK_SIZE (4096)
+
+typedef struct JsonArenaChunk
+{
+    struct JsonArenaChunk* next_p;
+    size_t capacity;
+    size_t used;
+    max_align_t data[];
+} JsonArenaChunk;
+
+static void* _JsonArena_alloc(JsonArena* arena_p, size_t size)
+{
+    size = (size + sizeof(max_align_t) - 1) / sizeof(max_align_t) * sizeof(max_align_t);
+    JsonArenaChunk* chunk_p = arena_p->curr_chunk_p;
+    // Move on to the chunks kept by `JsonObj_reset` before allocating new ones.
+    while ((chunk_p != NULL) && (chunk_p->used + size > chunk_p->capacity)
+           && (chunk_p->next_p != NULL))
+    {
+        chunk_p       = chunk_p->next_p;
+        chunk_p->used = 0;
+    }
+    if ((chunk_p == NULL) || (chunk_p->used + size > chunk_p->capacity))
+    {
+        size_t capacity = (chunk_p == NULL) ? JSON_ARENA_MIN_CHUNK_SIZE : 2 * chunk_p->capacity;
+        if (capacity < size)
+        {
+            capacity = size;
+        }
+        JsonArenaChunk* new_chunk_p = malloc(sizeof(JsonArenaChunk) + capacity);
+        if (new_chunk_p == NULL)
+        {
+            LOG_PERROR("Out of memory");
+            return NULL;
+        }
+        new_chunk_p->next_p   = NULL;
+        new_chunk_p->capacity = capacity;
+        new_chunk_p->used     = 0;
+        if (chunk_p == NULL)
+        {
+            arena_p->first_chunk_p = new_chunk_p;
+        }
+        else
+        {
+            chunk_p->next_p = new_chunk_p;
+        }
+        chunk_p = new_chunk_p;
+    }
+    arena_p->curr_chunk_p = chunk_p;
+    void* ret_p           = (char*)chunk_p->data + chunk_p->used;
+    chunk_p->used += size;
+    return ret_p;
+}
+
+static void _JsonArena_rewind(JsonArena* arena_p)
+{
+    if (arena_p->first_chunk_p != NULL)
+    {
+        arena_p->first_chunk_p->used = 0;
+    }
+    arena_p->curr_chunk_p = arena_p->first_chunk_p;
+}
+
+static void _JsonArena_destroy(JsonArena* arena_p)
 {
-    EMPTY,
-    NUMBER,
-    STRING,
-    KEY,
-    BOOLEAN_TRUE,
-    BOOLEAN_FALSE,
-    INVALID,
-} ElementType;
+    JsonArenaChunk* chunk_p = arena_p->first_chunk_p;
+    while (chunk_p != NULL)
+    {
+        JsonArenaChunk* next_chunk_p = chunk_p->next_p;
+        free(chunk_p);
+        chunk_p = next_chunk_p;
+    }
+    arena_p->first_chunk_p = NULL;
+    arena_p->curr_chunk_p  = NULL;
+}
 
-static JsonItem* JsonItem_new(void)
+static JsonItem* JsonItem_new(JsonArena* arena_p)
 {
-    JsonItem* new_item         = (JsonItem*)malloc(sizeof(JsonItem));
+    JsonItem* new_item = (JsonItem*)_JsonArena_alloc(arena_p, sizeof(JsonItem));
+    if (new_item == NULL)
+    {
+        return NULL;
+    }
     new_item->key_p            = NULL;
+    new_item->key_len          = 0;
     new_item->index            = 0;
     new_item->value.value_type = VALUE_UNDEFINED;
     new_item->parent           = NULL;
@@ -334,1073 +794,11349 @@ static JsonItem* JsonItem_new(void)
     return new_item;
 }
 
-static bool _is_token(const char c)
+static Error _JsonItemStack_push(JsonItemStack* stack_p, JsonItem* item_p)
 {
-    char* token_list = "{}[],:\"";
-    for (size_t i = 0; i < strlen(token_list); i++)
+    if (stack_p->count == stack_p->capacity)
     {
-        if (c == token_list[i])
-            return true;
+        const size_t capacity = (stack_p->capacity == 0) ? 1024 : 2 * stack_p->capacity;
+        JsonItem** items      = realloc(stack_p->items, capacity * sizeof(JsonItem*));
+        if (items == NULL)
+        {
+            LOG_PERROR("Out of memory");
+            return ERR_FATAL;
+        }
+        stack_p->items    = items;
+        stack_p->capacity = capacity;
     }
-    return false;
+    stack_p->items[stack_p->count++] = item_p;
+    return ERR_ALL_GOOD;
 }
 
-static ElementType _get_value_type(char* initial_char_p)
+// Move the last `len` items of the stack, which are the elements of `array_item_p`, to its
+// JsonArray. Collecting them while parsing saves walking the elements again, which would miss the
+// cache when they are large.
+static Error _JsonArray_build(
+    JsonArena* arena_p,
+    JsonItem* array_item_p,
+    JsonItemStack* stack_p,
+    size_t len)
 {
-    if (strncmp(initial_char_p, "{\"", 2) == 0 || strncmp(initial_char_p, ",\"", 2) == 0)
-    {
-        return KEY;
-    }
-    else if (strncmp(initial_char_p, "{}", 2) == 0)
+    JsonArray* array_p = _JsonArena_alloc(arena_p, sizeof(JsonArray) + len * sizeof(JsonItem*));
+    if (array_p == NULL)
     {
-        return EMPTY;
+        return ERR_FATAL;
     }
-    else if (initial_char_p[0] == '"')
+    array_p->len = len;
+    if (len > 0) // The stack is still NULL if no array has had elements yet.
     {
-        return STRING;
+        stack_p->count -= len;
+        memcpy(array_p->elements, &stack_p->items[stack_p->count], len * sizeof(JsonItem*));
     }
-    else if (strncmp(initial_char_p, "true", 4) == 0)
+    array_item_p->value.value_array_p = array_p;
+    return ERR_ALL_GOOD;
+}
+
+// ---------- Key table ----------
+// Objects with at least JSON_KEY_TABLE_MIN_ITEMS members get an open-addressing table from key
+// hash to item, allocated in the arena and hung from the first member. The getters probe it
+// instead of walking the siblings. Smaller objects are cheaper to scan.
+
+#define JSON_KEY_TABLE_MIN_ITEMS (16)
+
+typedef struct
+{
+    uint64_t hash;
+    const JsonItem* item_p; // NULL for an empty slot
+} JsonKeySlot;
+
+typedef struct JsonKeyTable
+{
+    size_t mask; // Number of slots - 1, the number of slots being a power of 2
+    JsonKeySlot slots[];
+} JsonKeyTable;
+
+// 64-bit FNV-1a
+static inline uint64_t _hash_key(const char* key_p, size_t len)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++)
     {
-        return BOOLEAN_TRUE;
+        hash = (hash ^ (unsigned char)key_p[i]) * 0x100000001b3ULL;
     }
-    else if (strncmp(initial_char_p, "false", 5) == 0)
+    return hash;
+}
+
+// Keys of different lengths are told apart without reading them, and most keys of the same
+// length differ in their first 8 bytes, which are compared as one word.
+static inline bool _keys_equal(const char* key_1_p, size_t len_1, const char* key_2_p, size_t len_2)
+{
+    if (len_1 != len_2)
     {
-        return BOOLEAN_FALSE;
+        return false;
     }
-    else
+    if (len_1 < sizeof(uint64_t))
     {
-        return NUMBER;
+        return memcmp(key_1_p, key_2_p, len_1) == 0;
     }
+    uint64_t word_1;
+    uint64_t word_2;
+    memcpy(&word_1, key_1_p, sizeof(uint64_t));
+    memcpy(&word_2, key_2_p, sizeof(uint64_t));
+    const size_t num_of_bytes = sizeof(uint64_t);
+    return (word_1 == word_2)
+           && (memcmp(&key_1_p[num_of_bytes], &key_2_p[num_of_bytes], len_1 - num_of_bytes) == 0);
 }
 
-static char* _strip_whitespace_malloc(const char* json_string_p)
+// Index the `num_of_items` members starting at `first_item_p`. The table is at most half full, so
+// linear probing stays short. When a key is repeated, the first occurrence wins, as it does when
+// walking the siblings.
+static Error _JsonKeyTable_build(JsonArena* arena_p, JsonItem* first_item_p, size_t num_of_items)
 {
-    // The returned string cannot be longer than the input string (plus an termination char).
-    char* ret_str;
-    const size_t str_len = strlen(json_string_p);
-    ret_str              = malloc(str_len + 1);
-
-    size_t pos_out     = 0;
-    bool inside_string = false;
-    for (size_t pos_in = 0; pos_in < str_len; pos_in++)
+    size_t num_of_slots = 2 * JSON_KEY_TABLE_MIN_ITEMS;
+    while (num_of_slots < 2 * num_of_items)
     {
-        char curr_char = json_string_p[pos_in];
-        // "Open/Close" a string.
-        if (curr_char == '\"')
-        { // TODO: check how it works if the value contains an escaped '\"'
-            inside_string = !inside_string;
-        }
-        // Ignore everything outside a string that is not printable or is a space (ascii 32).
-        if (inside_string || (curr_char > 32))
-        {
-            ret_str[pos_out++] = json_string_p[pos_in];
-        }
+        num_of_slots *= 2;
     }
-    ret_str[pos_out] = '\0';
-    return ret_str;
-}
-
-static char* _terminate_str(char* char_p)
-{
-    while ((char_p != NULL) && (char_p + 1 != NULL))
+    JsonKeyTable* table_p
+        = _JsonArena_alloc(arena_p, sizeof(JsonKeyTable) + num_of_slots * sizeof(JsonKeySlot));
+    if (table_p == NULL)
+    {
+        return ERR_FATAL;
+    }
+    table_p->mask = num_of_slots - 1;
+    memset(table_p->slots, 0, num_of_slots * sizeof(JsonKeySlot));
+    for (const JsonItem* item_p = first_item_p; item_p != NULL; item_p = item_p->next_sibling)
     {
-        if (*char_p == '"')
+        const uint64_t hash = _hash_key(item_p->key_p, item_p->key_len);
+        size_t slot         = hash & table_p->mask;
+        while (table_p->slots[slot].item_p != NULL)
         {
-            char_p++;
-            if ((*char_p == ',') || (*char_p == '}') || (*char_p == ']') || (*char_p == ':'))
+            const JsonItem* slot_item_p = table_p->slots[slot].item_p;
+            if ((table_p->slots[slot].hash == hash)
+                && _keys_equal(
+                    slot_item_p->key_p, slot_item_p->key_len, item_p->key_p, item_p->key_len))
             {
-                *(char_p - 1) = '\0';
-                // return the position following the str termination
-                return char_p;
+                break;
             }
+            slot = (slot + 1) & table_p->mask;
         }
-        else
+        if (table_p->slots[slot].item_p == NULL)
         {
-            char_p++;
+            table_p->slots[slot].hash   = hash;
+            table_p->slots[slot].item_p = item_p;
         }
     }
-    return NULL;
+    first_item_p->key_table_p = table_p;
+    return ERR_ALL_GOOD;
 }
 
-static char* _generate_tokens_malloc(char* json_string_p)
+static const JsonItem* _JsonKeyTable_find_hashed(
+    const JsonKeyTable* table_p,
+    const char* key,
+    size_t key_len,
+    uint64_t hash)
 {
-    char* ret_str;
-    size_t str_len     = strlen(json_string_p);
-    ret_str            = malloc(str_len + 1);
-    size_t pos_out     = 0;
-    bool inside_string = false;
-    for (size_t pos_in = 0; pos_in < str_len; pos_in++)
+    for (size_t slot = hash & table_p->mask; table_p->slots[slot].item_p != NULL;
+         slot        = (slot + 1) & table_p->mask)
     {
-        char curr_char = json_string_p[pos_in];
-        // "Open/Close" a string.
-        if (curr_char == '\"')
+        const JsonItem* item_p = table_p->slots[slot].item_p;
+        if ((table_p->slots[slot].hash == hash)
+            && _keys_equal(item_p->key_p, item_p->key_len, key, key_len))
         {
-            inside_string = !inside_string;
-        }
-        // Ignore tokens found inside a string unless it's the '\"", hence end of the string.
-        if ((_is_token(curr_char) && !inside_string) || curr_char == '"')
-        {
-            ret_str[pos_out++] = json_string_p[pos_in];
+            return item_p;
         }
     }
-    ret_str[pos_out] = '\0';
-    return ret_str;
+    return NULL;
 }
 
-static Error _validate_tokens(char* json_char_p)
+static inline const JsonItem* _JsonKeyTable_find(
+    const JsonKeyTable* table_p,
+    const char* key,
+    size_t key_len)
+{
+    return _JsonKeyTable_find_hashed(table_p, key, key_len, _hash_key(key, key_len));
+}
+
+// ---------- Structural index (stage 1) ----------
+// The input is scanned 64 bytes at a time. A kernel chosen at runtime reduces each block to one
+// bitmask per character class, then plain 64-bit arithmetic finds the structural characters that
+// are outside strings: `{}[],:`, every unescaped quote (opening and closing) and the first
+// character of every scalar. Their offsets are appended to a JsonIndex, which `_deserialize`
+// walks instead of the raw bytes.
+
+#define JSON_BLOCK_SIZE (64)
+#define JSON_INDEX_BATCH_BLOCKS (1024)
+
+typedef struct
+{
+    uint64_t backslash;
+    uint64_t quote;
+    uint64_t op;         // {}[],:
+    uint64_t whitespace; // anything up to ' '
+} JsonBlockMasks;
+
+// Carried from one block to the next.
+typedef struct
+{
+    uint64_t prev_escaped;   // 1 if the first byte of the next block is escaped
+    uint64_t prev_in_string; // all ones if the next block starts inside a string
+    uint64_t prev_scalar;    // 1 if the last byte of the previous block belongs to a scalar
+} JsonScanState;
+
+typedef size_t (*JsonIndexBlocksFn)(const char*, size_t, uint32_t, JsonScanState*, uint32_t*);
+
+static inline void _classify_block_scalar(const char* block_p, JsonBlockMasks* masks_p)
 {
-    Error ret_res                  = ERR_ALL_GOOD;
-    unsigned long long obj_counter = 0;
-    unsigned long long arr_counter = 0;
-    char curr_char;
-    for (size_t index = 0; json_char_p[index] != 0; index++)
+    JsonBlockMasks masks = {0, 0, 0, 0};
+    for (size_t i = 0; i < JSON_BLOCK_SIZE; i++)
     {
-        curr_char = json_char_p[index];
-        if (curr_char == '[')
-        {
-            arr_counter++;
-        }
-        else if (curr_char == ']')
-        {
-            if (arr_counter > 0)
-            {
-                arr_counter--;
-            }
-            else
-            {
-                LOG_ERROR("Extra `]` detected");
-                return ERR_JSON_INVALID;
-            }
-        }
-        if (curr_char == '{')
+        const uint64_t bit = 1ULL << i;
+        switch (block_p[i])
         {
-            obj_counter++;
-        }
-        else if (curr_char == '}')
-        {
-            if (obj_counter > 0)
-            {
-                obj_counter--;
-            }
-            else
+        case '"':
+            masks.quote |= bit;
+            break;
+        case '\\':
+            masks.backslash |= bit;
+            break;
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case ',':
+        case ':':
+            masks.op |= bit;
+            break;
+        default:
+            if ((unsigned char)block_p[i] <= ' ')
             {
-                LOG_ERROR("Extra `}` detected");
-                return ERR_JSON_INVALID;
+                masks.whitespace |= bit;
             }
+            break;
         }
     }
-    if (arr_counter)
-    {
-        LOG_ERROR("Missing `]` detected");
-        return ERR_JSON_INVALID;
-    }
-    if (obj_counter)
-    {
-        LOG_ERROR("Missing `}` detected");
-        return ERR_JSON_INVALID;
-    }
-    return ret_res;
+    *masks_p = masks;
 }
 
-static Error
-_deserialize(JsonItem* curr_item_p, char** start_pos_p)
+static inline uint64_t _prefix_xor_scalar(uint64_t bits)
 {
-    char* curr_pos_p = *start_pos_p;
-    bool parent_set  = false;
-    Error ret_result = ERR_ALL_GOOD;
-    while ((curr_pos_p[0] != '\0') && (curr_pos_p[1] != '\0'))
-    {
-        if ((curr_pos_p[0] == '}') || (curr_pos_p[0] == ']'))
-        {
-            // Use continue to make sure the next 2 chars are checked.
-            curr_pos_p++;
-            curr_item_p = curr_item_p->parent;
-            continue;
-        }
-        if (curr_pos_p[0] == '[')
-        {
-            LOG_TRACE("Found beginning of array.");
-            JsonItem* new_item               = JsonItem_new();
-            new_item->parent                 = curr_item_p;
-            curr_item_p->value.value_type    = VALUE_ARRAY;
-            curr_item_p->value.value_child_p = new_item;
-            curr_pos_p++;
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
 
-            curr_item_p = new_item;
-            continue;
+#if defined(__x86_64__)
+__attribute__((target("sse4.2,pclmul"))) static inline void
+_classify_block_sse42(const char* block_p, JsonBlockMasks* masks_p)
+{
+    const __m128i op_set = _mm_setr_epi8('{', '}', '[', ']', ',', ':', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    JsonBlockMasks masks = {0, 0, 0, 0};
+    for (size_t i = 0; i < JSON_BLOCK_SIZE; i += 16)
+    {
+        const __m128i chunk = _mm_loadu_si128((const __m128i*)&block_p[i]);
+        const __m128i op    = _mm_cmpestrm(
+            op_set, 6, chunk, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK);
+        masks.op |= (uint64_t)(uint16_t)_mm_cvtsi128_si32(op) << i;
+        masks.quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                           _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')))
+                       << i;
+        masks.backslash |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                               _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\')))
+                           << i;
+        // c <= ' ' if and only if max(c, ' ') == ' '
+        const __m128i space = _mm_set1_epi8(' ');
+        masks.whitespace |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                                _mm_cmpeq_epi8(_mm_max_epu8(chunk, space), space))
+                            << i;
+    }
+    *masks_p = masks;
+}
+
+__attribute__((target("avx2,pclmul"))) static inline void
+_classify_block_avx2(const char* block_p, JsonBlockMasks* masks_p)
+{
+    JsonBlockMasks masks = {0, 0, 0, 0};
+    for (size_t i = 0; i < JSON_BLOCK_SIZE; i += 32)
+    {
+        const __m256i chunk = _mm256_loadu_si256((const __m256i*)&block_p[i]);
+        // '[' | 0x20 == '{' and ']' | 0x20 == '}', no other byte maps onto them.
+        const __m256i lower   = _mm256_or_si256(chunk, _mm256_set1_epi8(0x20));
+        const __m256i op      = _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('{')),
+                _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('}'))),
+            _mm256_or_si256(
+                _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(',')),
+                _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(':'))));
+        const __m256i space   = _mm256_set1_epi8(' ');
+        const __m256i ws      = _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, space), space);
+        const __m256i quote   = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"'));
+        const __m256i bslash  = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\'));
+        masks.op |= (uint64_t)(uint32_t)_mm256_movemask_epi8(op) << i;
+        masks.whitespace |= (uint64_t)(uint32_t)_mm256_movemask_epi8(ws) << i;
+        masks.quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(quote) << i;
+        masks.backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(bslash) << i;
+    }
+    *masks_p = masks;
+}
+
+// Carry-less multiplication by all ones computes the prefix xor in one instruction.
+__attribute__((target("pclmul"))) static inline uint64_t _prefix_xor_clmul(uint64_t bits)
+{
+    const __m128i result = _mm_clmulepi64_si128(
+        _mm_set_epi64x(0, (long long)bits), _mm_set1_epi8((char)0xFF), 0);
+    return (uint64_t)_mm_cvtsi128_si64(result);
+}
+#endif /* __x86_64__ */
+
+// Return the bytes escaped by a backslash, i.e. those following an odd-length run of backslashes.
+static inline uint64_t _escaped_bits(uint64_t backslash, uint64_t* prev_escaped_p)
+{
+    const uint64_t even_bits = 0x5555555555555555ULL;
+    // A backslash escaped by the previous block does not start a run.
+    backslash &= ~*prev_escaped_p;
+    const uint64_t follows_escape      = (backslash << 1) | *prev_escaped_p;
+    const uint64_t odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+    // Adding the starts clears the runs beginning on odd bits; the carry out tells whether a run
+    // spills over into the next block.
+    const uint64_t sequences_starting_on_even_bits = odd_sequence_starts + backslash;
+    *prev_escaped_p = (sequences_starting_on_even_bits < backslash) ? 1 : 0;
+    const uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+    return (even_bits ^ invert_mask) & follows_escape;
+}
+
+static inline size_t _flatten_bits(uint64_t bits, uint32_t offset, uint32_t* out_p)
+{
+    size_t count = 0;
+    while (bits != 0)
+    {
+        out_p[count++] = offset + (uint32_t)__builtin_ctzll(bits);
+        bits &= bits - 1;
+    }
+    return count;
+}
+
+// Generate `_index_blocks_<isa>`, which indexes `num_of_blocks` full blocks and returns the number of
+// positions written to `out_p`.
+#define INDEX_BLOCKS_c(isa, ATTRIBUTES, PREFIX_XOR)                                             \
+    ATTRIBUTES static size_t _index_blocks_##isa(                                               \
+        const char* block_p,                                                                    \
+        size_t num_of_blocks,                                                                   \
+        uint32_t offset,                                                                        \
+        JsonScanState* state_p,                                                                 \
+        uint32_t* out_p)                                                                        \
+    {                                                                                           \
+        size_t count = 0;                                                                       \
+        for (size_t i = 0; i < num_of_blocks; i++)                                              \
+        {                                                                                       \
+            JsonBlockMasks masks;                                                               \
+            _classify_block_##isa(block_p, &masks);                                             \
+            const uint64_t escaped   = _escaped_bits(masks.backslash, &state_p->prev_escaped);  \
+            const uint64_t quote     = masks.quote & ~escaped;                                  \
+            const uint64_t in_string = PREFIX_XOR(quote) ^ state_p->prev_in_string;             \
+            state_p->prev_in_string  = 0ULL - (in_string >> 63);                                \
+            const uint64_t scalar    = ~(masks.op | masks.whitespace | quote);                  \
+            const uint64_t follows   = (scalar << 1) | state_p->prev_scalar;                    \
+            state_p->prev_scalar     = scalar >> 63;                                            \
+            /* The closing quote is outside `in_string`, the opening one is added back. */      \
+            const uint64_t structurals                                                          \
+                = ((masks.op | (scalar & ~follows)) & ~in_string) | quote;                      \
+            count += _flatten_bits(structurals, offset, &out_p[count]);                         \
+            block_p += JSON_BLOCK_SIZE;                                                         \
+            offset += JSON_BLOCK_SIZE;                                                          \
+        }                                                                                       \
+        return count;                                                                           \
+    }
+
+// clang-format off
+INDEX_BLOCKS_c(scalar, , _prefix_xor_scalar)
+#if defined(__x86_64__)
+INDEX_BLOCKS_c(sse42, __attribute__((target("sse4.2,pclmul"))), _prefix_xor_clmul)
+INDEX_BLOCKS_c(avx2, __attribute__((target("avx2,pclmul"))), _prefix_xor_clmul)
+#endif /* __x86_64__ */
+// clang-format on
+
+static JsonIndexBlocksFn _select_index_kernel(void)
+{
+#if defined(__x86_64__)
+    // Query CPUID for the widest kernel available.
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("pclmul"))
+    {
+        return _index_blocks_avx2;
+    }
+    if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul"))
+    {
+        return _index_blocks_sse42;
+    }
+#endif /* __x86_64__ */
+    return _index_blocks_scalar;
+}
+
+static Error _JsonIndex_reserve(JsonIndex* index_p, size_t capacity)
+{
+    if (index_p->capacity >= capacity)
+    {
+        return ERR_ALL_GOOD;
+    }
+    if (capacity < 2 * index_p->capacity)
+    {
+        capacity = 2 * index_p->capacity;
+    }
+    uint32_t* positions = realloc(index_p->positions, capacity * sizeof(uint32_t));
+    if (positions == NULL)
+    {
+        LOG_PERROR("Out of memory");
+        return ERR_FATAL;
+    }
+    index_p->positions = positions;
+    index_p->capacity  = capacity;
+    return ERR_ALL_GOOD;
+}
+
+// Append the structural characters found between `start` and `len` to `index_p`. `state_p` holds
+// the state of the scan at `start` on entry, and at `len` on return.
+static Error _index_range(
+    JsonIndexBlocksFn index_blocks,
+    const char* json_string,
+    size_t start,
+    size_t len,
+    JsonIndex* index_p,
+    JsonScanState* state_p)
+{
+    size_t offset = start;
+    while (offset < len)
+    {
+        size_t num_of_blocks = (len - offset) / JSON_BLOCK_SIZE;
+        if (num_of_blocks > JSON_INDEX_BATCH_BLOCKS)
+        {
+            num_of_blocks = JSON_INDEX_BATCH_BLOCKS;
         }
-        if ((curr_item_p->parent->value.value_type == VALUE_ARRAY) && (*curr_pos_p == ','))
+        const size_t max_count = index_p->count + (num_of_blocks + 1) * JSON_BLOCK_SIZE;
+        return_on_err(_JsonIndex_reserve(index_p, max_count));
+        if (num_of_blocks == 0)
         {
-            // This is a sibling of an array.
-            LOG_TRACE("Found sibling in array.");
-            JsonItem* new_item        = JsonItem_new();
-            new_item->index           = curr_item_p->index + 1;
-            new_item->parent          = curr_item_p->parent;
-            curr_item_p->next_sibling = new_item;
-            curr_pos_p++;
-            curr_item_p = new_item;
-            continue;
+            // Pad the last partial block with whitespace.
+            char last_block[JSON_BLOCK_SIZE];
+            memset(last_block, ' ', JSON_BLOCK_SIZE);
+            memcpy(last_block, &json_string[offset], len - offset);
+            index_p->count += index_blocks(
+                last_block, 1, (uint32_t)offset, state_p, &index_p->positions[index_p->count]);
+            break;
         }
-        // If we are here, it's an item. If its parent is of type VALUE_ARRAY, we need to increment
-        // the index, somehow.
-        switch (_get_value_type(curr_pos_p))
+        index_p->count += index_blocks(
+            &json_string[offset],
+            num_of_blocks,
+            (uint32_t)offset,
+            state_p,
+            &index_p->positions[index_p->count]);
+        offset += num_of_blocks * JSON_BLOCK_SIZE;
+    }
+    return ERR_ALL_GOOD;
+}
+
+static Error _index_structurals(
+    JsonIndexBlocksFn index_blocks,
+    const char* json_string,
+    size_t len,
+    JsonIndex* index_p)
+{
+    if (len >= UINT32_MAX)
+    {
+        LOG_ERROR("JSON string too large to be indexed");
+        return ERR_INVALID;
+    }
+    JsonScanState state = {0, 0, 0};
+    index_p->count      = 0;
+    return_on_err(_index_range(index_blocks, json_string, 0, len, index_p, &state));
+    if (state.prev_in_string)
+    {
+        LOG_ERROR("Unterminated string");
+        return ERR_JSON_INVALID;
+    }
+    return ERR_ALL_GOOD;
+}
+
+// ---------- Tree builder (stage 2) ----------
+
+// Scalars are not delimited in the index, so make sure that a literal or a number is not followed
+// by unexpected characters.
+static inline bool _is_scalar_end(const char* char_p, const char* end_p)
+{
+    return (char_p == end_p) || ((unsigned char)*char_p <= ' ') || (*char_p == ',')
+           || (*char_p == '}') || (*char_p == ']') || (*char_p == ':') || (*char_p == '{')
+           || (*char_p == '[') || (*char_p == '"');
+}
+
+// ---------- Strings ----------
+// A string is decoded in place, between its quotes: no escape decodes to more bytes than it takes,
+// so the decoded string is written over the escaped one and null-terminated. `_str_scan` looks for
+// the first backslash or non-ASCII byte 32 bytes at a time, so a plain ASCII string is read once
+// and never copied. The rest of any other string is validated as UTF-8 by a kernel chosen at
+// runtime, then `_unescape` moves it down 32 bytes at a time between two escapes.
+
+#define JSON_STR_BLOCK_SIZE (32)
+
+static const uint64_t _swar_ones = 0x0101010101010101ULL;
+static const uint64_t _swar_high = 0x8080808080808080ULL;
+
+// Offset of the first backslash or non-ASCII byte of the `len` bytes at `str_p`, or `len` if there
+// is none.
+static inline size_t _str_scan(const char* str_p, size_t len)
+{
+    size_t offset = 0;
+#if defined(__x86_64__)
+    // SSE2 is part of x86-64, so this loop needs no kernel selection.
+    const __m128i backslash = _mm_set1_epi8('\\');
+    for (; len - offset >= JSON_STR_BLOCK_SIZE; offset += JSON_STR_BLOCK_SIZE)
+    {
+        const __m128i lo = _mm_loadu_si128((const __m128i*)&str_p[offset]);
+        const __m128i hi = _mm_loadu_si128((const __m128i*)&str_p[offset + 16]);
+        // The sign bit is set in non-ASCII bytes and in the bytes equal to a backslash.
+        const uint32_t mask
+            = (uint32_t)_mm_movemask_epi8(_mm_or_si128(lo, _mm_cmpeq_epi8(lo, backslash)))
+            | ((uint32_t)_mm_movemask_epi8(_mm_or_si128(hi, _mm_cmpeq_epi8(hi, backslash))) << 16);
+        if (mask != 0)
         {
-        case NUMBER:
+            return offset + (size_t)__builtin_ctz(mask);
+        }
+    }
+#endif /* __x86_64__ */
+    for (; len - offset >= sizeof(uint64_t); offset += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, &str_p[offset], sizeof(uint64_t));
+        // A zero byte of `word ^ '\\'` sets the sign bit of the difference.
+        const uint64_t backslashes = word ^ (_swar_ones * '\\');
+        if (((word | ((backslashes - _swar_ones) & ~backslashes)) & _swar_high) != 0)
         {
-            // 23 digits should be sufficient.
-            char num_buff[MAX_NUM_LEN];
-            // Try to convert into an integer or a double, depending on the presence of a dot ('.').
-            bool dot_found = false;
-            size_t i       = 0;
-            // Create a substring containing the number.
-            for (; (i < MAX_NUM_LEN - 1) && (*curr_pos_p != ',') && (*curr_pos_p != '}')
-                   && (*curr_pos_p != ']');
-                 i++)
-            {
-
-                if (*curr_pos_p == '.')
-                {
-                    dot_found = true;
-                }
-                num_buff[i] = *curr_pos_p;
-                curr_pos_p++;
-            }
-            // Null terminate the string.
-            num_buff[i] = '\0';
-            if (dot_found)
-            {
-                json_decimal_t parsed_double = 0.0f;
-                if (sscanf(num_buff, "%lf", &parsed_double) != 1)
-                {
-                    LOG_ERROR("Failed to parse double");
-                    ret_result = ERR_PARSE_STRING_TO_DOUBLE;
-                }
-                if (is_ok(ret_result))
-                {
-                    curr_item_p->value.value_type   = VALUE_DOUBLE;
-                    curr_item_p->value.value_double = parsed_double;
-                    LOG_TRACE("Found value %lf", curr_item_p->value.value_double);
-                }
-            }
-            else if (num_buff[0] == '-')
-            { // Convert into an integer if it is negative.
-                json_int_t parsed_int = 0;
-                if (sscanf(num_buff, "%lld", &parsed_int) != 1)
-                {
-                    LOG_ERROR("Failed to parse int");
-                    ret_result = ERR_PARSE_STRING_TO_INT;
-                }
-                if (is_ok(ret_result))
-                {
-                    curr_item_p->value.value_type = VALUE_INT;
-                    curr_item_p->value.value_int  = parsed_int;
-                    LOG_TRACE("Found value %lld", curr_item_p->value.value_int);
-                }
-            }
-            else
-            {
-                // Convert any positive value into a size_t.
-                json_uint_t parsed_llu = 0;
-                if (sscanf(num_buff, "%llu", &parsed_llu) != 1)
-                {
-                    LOG_ERROR("Failed to parse json_uint_t");
-                    ret_result = ERR_PARSE_STRING_TO_LLU;
-                }
-                if (is_ok(ret_result))
-                {
-                    char tmp[MAX_NUM_LEN];
-                    snprintf(tmp, MAX_NUM_LEN, "+%llu", parsed_llu);
-                    if ((strncmp(tmp, num_buff, MAX_NUM_LEN) != 0) && (strncmp(&tmp[1], num_buff, MAX_NUM_LEN) != 0))
-                    {
-                        LOG_ERROR("LLU overflow %s", tmp);
-                        return ERR_PARSE_STRING_TO_LLU;
-                    }
-                    curr_item_p->value.value_type = VALUE_LLU;
-                    curr_item_p->value.value_llu  = parsed_llu;
-                    LOG_TRACE("Found LLU value %llu", curr_item_p->value.value_llu);
-                }
-            }
             break;
         }
-        case STRING:
+    }
+    for (; offset < len; offset++)
+    {
+        if ((str_p[offset] == '\\') || ((unsigned char)str_p[offset] >= 0x80))
         {
-            curr_item_p->value.value_type   = VALUE_STR;
-            curr_item_p->value.value_char_p = curr_pos_p + 1; // Point after the quote
-            curr_pos_p                      = _terminate_str(curr_pos_p);
-            LOG_TRACE("Found value \"%s\"", curr_item_p->value.value_char_p);
             break;
         }
-        case KEY:
+    }
+    return offset;
+}
+
+typedef bool (*JsonUtf8Fn)(const char*, size_t);
+
+static bool _validate_utf8_scalar(const char* str_p, size_t len)
+{
+    const unsigned char* bytes = (const unsigned char*)str_p;
+    size_t i                   = 0;
+    while (i < len)
+    {
+        const unsigned char lead = bytes[i];
+        if (lead < 0x80)
         {
-            if (*curr_pos_p == '{')
-            {
-                if (parent_set)
-                {
-                    // It's a child
-                    LOG_TRACE("Found new object");
-                    JsonItem* new_item               = JsonItem_new();
-                    new_item->parent                 = curr_item_p;
-                    curr_item_p->value.value_type    = VALUE_ITEM;
-                    curr_item_p->value.value_child_p = new_item;
-                    curr_item_p                      = new_item;
-                }
-                else
-                {
-                    parent_set = true;
-                }
-            }
-            else if (*curr_pos_p == ',')
-            {
-                // It's a sibling - the parent must be in common.
-                JsonItem* new_item        = JsonItem_new();
-                curr_item_p->next_sibling = new_item;
-                new_item->parent          = curr_item_p->parent;
-                curr_item_p               = new_item;
-            }
-            // Extract the key for the new item.
-            curr_pos_p         = curr_pos_p + 2; // That's where the key starts
-            curr_item_p->key_p = curr_pos_p;
-            curr_pos_p         = _terminate_str(curr_pos_p); // We should be at ':' now.
-            LOG_TRACE("Found key: \"%s\"", curr_item_p->key_p);
-            if (*curr_pos_p != ':')
-            {
-                printf("something bad happened\n");
-                exit(ERR_FATAL);
-            }
-            curr_pos_p++; // Skip the ':'.
-            break;
+            i++;
+            continue;
         }
-        case BOOLEAN_TRUE:
+        size_t num_of_conts;
+        uint32_t code_point;
+        uint32_t min_code_point;
+        if ((lead & 0xE0) == 0xC0)
         {
-            curr_pos_p += 4;
-            // Null terminate the string.
-            curr_item_p->value.value_type = VALUE_BOOL;
-            curr_item_p->value.value_bool = true;
-            LOG_TRACE("Found value TRUE");
-            break;
+            num_of_conts   = 1;
+            code_point     = lead & 0x1F;
+            min_code_point = 0x80;
         }
-        case BOOLEAN_FALSE:
+        else if ((lead & 0xF0) == 0xE0)
         {
-            curr_pos_p += 5;
-            // Null terminate the string.
-            curr_item_p->value.value_type = VALUE_BOOL;
-            curr_item_p->value.value_bool = false;
-            LOG_TRACE("Found value FALSE");
-            break;
+            num_of_conts   = 2;
+            code_point     = lead & 0x0F;
+            min_code_point = 0x800;
         }
-        case EMPTY:
+        else if ((lead & 0xF8) == 0xF0)
         {
-            LOG_TRACE("Found empty object - skipping");
-            curr_pos_p += 2;
-            break;
+            num_of_conts   = 3;
+            code_point     = lead & 0x07;
+            min_code_point = 0x10000;
         }
-        case INVALID:
+        else
         {
-            printf("To be handled\n");
-            exit(3);
+            return false;
         }
-
-        default:
-            break;
+        if (len - i <= num_of_conts)
+        {
+            return false;
         }
-        if (is_err(ret_result))
+        for (size_t j = 1; j <= num_of_conts; j++)
         {
-            return ERR_JSON_INVALID;
+            if ((bytes[i + j] & 0xC0) != 0x80)
+            {
+                return false;
+            }
+            code_point = (code_point << 6) | (bytes[i + j] & 0x3F);
         }
+        // Overlong encodings, surrogates and code points past U+10FFFF are not UTF-8.
+        if ((code_point < min_code_point) || (code_point > 0x10FFFF)
+            || ((code_point >= 0xD800) && (code_point <= 0xDFFF)))
+        {
+            return false;
+        }
+        i += num_of_conts + 1;
     }
-    return ERR_ALL_GOOD;
+    return true;
 }
 
-Error JsonObj_new(
-    const char* json_string_p,
-    JsonObj* out_json_obj_p)
-{
-    if (strlen(json_string_p) == 0)
-    {
-        LOG_ERROR("Empty JSON string detected");
-        return ERR_EMPTY_STRING;
+#if defined(__x86_64__)
+// Lookup algorithm of Keiser and Lemire: each byte and the one before it are classified by three
+// 16-entry tables, indexed by the high and low nibbles of the previous byte and the high nibble of
+// the byte. Each bit is one kind of error, and the byte is invalid if a bit is set in all three.
+// Continuations of 3- and 4-byte sequences are checked separately against the bytes 2 and 3
+// positions back.
+#define UTF8_TOO_SHORT (1 << 0)      // 11______ 0_______ or 11______ 11______
+#define UTF8_TOO_LONG (1 << 1)       // 0_______ 10______
+#define UTF8_OVERLONG_3 (1 << 2)     // 11100000 100_____
+#define UTF8_TOO_LARGE (1 << 3)      // 11110100 1001____ and above
+#define UTF8_SURROGATE (1 << 4)      // 11101101 101_____
+#define UTF8_OVERLONG_2 (1 << 5)     // 1100000_ 10______
+#define UTF8_TOO_LARGE_1000 (1 << 6) // 11110101 1000____ and above
+#define UTF8_OVERLONG_4 (1 << 6)     // 11110000 1000____
+#define UTF8_TWO_CONTS (1 << 7)      // 10______ 10______
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+// clang-format off
+static const uint8_t _utf8_byte_1_high[16] = {
+    // 0_______: ASCII
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    // 10______: continuation
+    UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+    // 110_____: 2-byte lead
+    UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+    UTF8_TOO_SHORT,
+    // 1110____: 3-byte lead
+    UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+    // 1111____: 4-byte lead
+    UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+};
+static const uint8_t _utf8_byte_1_low[16] = {
+    UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4, // ____0000
+    UTF8_CARRY | UTF8_OVERLONG_2,                                     // ____0001
+    UTF8_CARRY,
+    UTF8_CARRY,
+    UTF8_CARRY | UTF8_TOO_LARGE,                                      // ____0100
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE, // ____1101
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+};
+static const uint8_t _utf8_byte_2_high[16] = {
+    // ________ 0_______: ASCII
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    // ________ 1000____
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000
+        | UTF8_OVERLONG_4,
+    // ________ 1001____
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+    // ________ 101_____
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+    // ________ 11______
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+};
+// A block is incomplete if one of its last three bytes starts a sequence longer than what is left.
+static const uint8_t _utf8_max_last[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xF0 - 1, 0xE0 - 1, 0xC0 - 1,
+};
+// clang-format on
+
+// Generate `_validate_utf8_<isa>` for a vector of `width` bytes. `ALIGNR(input, prev_input, n)`
+// returns the bytes of `input` shifted by `n` bytes, the first ones taken from `prev_input`.
+#define VALIDATE_UTF8_c(isa, ATTRIBUTES, vec, width, SUFFIX, BROADCAST, ALIGNR)                 \
+    ATTRIBUTES static bool _validate_utf8_##isa(const char* str_p, size_t len)                  \
+    {                                                                                           \
+        const vec byte_1_high = BROADCAST(_mm_loadu_si128((const __m128i*)_utf8_byte_1_high));  \
+        const vec byte_1_low  = BROADCAST(_mm_loadu_si128((const __m128i*)_utf8_byte_1_low));   \
+        const vec byte_2_high = BROADCAST(_mm_loadu_si128((const __m128i*)_utf8_byte_2_high));  \
+        const vec max_last    = _mm##SUFFIX##_loadu_si##width(                                  \
+            (const vec*)&_utf8_max_last[sizeof(_utf8_max_last) - sizeof(vec)]);                 \
+        const vec nibble      = _mm##SUFFIX##_set1_epi8(0x0F);                                  \
+        const vec third_lead  = _mm##SUFFIX##_set1_epi8((char)(0xE0 - 0x80));                   \
+        const vec fourth_lead = _mm##SUFFIX##_set1_epi8((char)(0xF0 - 0x80));                   \
+        const vec sign        = _mm##SUFFIX##_set1_epi8((char)0x80);                            \
+        vec error             = _mm##SUFFIX##_setzero_si##width();                              \
+        vec prev_input        = _mm##SUFFIX##_setzero_si##width();                              \
+        vec prev_incomplete   = _mm##SUFFIX##_setzero_si##width();                              \
+        for (size_t offset = 0; offset < len; offset += sizeof(vec))                            \
+        {                                                                                       \
+            vec input;                                                                          \
+            if (len - offset >= sizeof(vec))                                                    \
+            {                                                                                   \
+                input = _mm##SUFFIX##_loadu_si##width((const vec*)&str_p[offset]);              \
+            }                                                                                   \
+            else                                                                                \
+            {                                                                                   \
+                /* Pad the last partial block with ASCII. */                                    \
+                char last_block[sizeof(vec)] = {0};                                             \
+                memcpy(last_block, &str_p[offset], len - offset);                               \
+                input = _mm##SUFFIX##_loadu_si##width((const vec*)last_block);                  \
+            }                                                                                   \
+            if (_mm##SUFFIX##_movemask_epi8(input) == 0)                                        \
+            {                                                                                   \
+                /* ASCII fails only if the previous block ends in the middle of a sequence. */  \
+                error = _mm##SUFFIX##_or_si##width(error, prev_incomplete);                     \
+                prev_input = input;                                                             \
+                continue;                                                                       \
+            }                                                                                   \
+            const vec prev1   = ALIGNR(input, prev_input, 15);                                  \
+            const vec special = _mm##SUFFIX##_and_si##width(                                    \
+                _mm##SUFFIX##_and_si##width(                                                    \
+                    _mm##SUFFIX##_shuffle_epi8(                                                 \
+                        byte_1_high,                                                            \
+                        _mm##SUFFIX##_and_si##width(_mm##SUFFIX##_srli_epi16(prev1, 4), nibble)), \
+                    _mm##SUFFIX##_shuffle_epi8(                                                 \
+                        byte_1_low, _mm##SUFFIX##_and_si##width(prev1, nibble))),               \
+                _mm##SUFFIX##_shuffle_epi8(                                                     \
+                    byte_2_high,                                                                \
+                    _mm##SUFFIX##_and_si##width(_mm##SUFFIX##_srli_epi16(input, 4), nibble)));  \
+            /* The 3rd byte of a sequence follows a byte of 0xE0 or above by 2 bytes, and the   \
+               4th byte a byte of 0xF0 or above by 3 bytes: both must be continuations. */      \
+            const vec must23 = _mm##SUFFIX##_or_si##width(                                      \
+                _mm##SUFFIX##_subs_epu8(ALIGNR(input, prev_input, 14), third_lead),             \
+                _mm##SUFFIX##_subs_epu8(ALIGNR(input, prev_input, 13), fourth_lead));           \
+            error = _mm##SUFFIX##_or_si##width(                                                 \
+                error,                                                                          \
+                _mm##SUFFIX##_xor_si##width(                                                    \
+                    _mm##SUFFIX##_and_si##width(must23, sign), special));                       \
+            prev_incomplete = _mm##SUFFIX##_subs_epu8(input, max_last);                         \
+            prev_input      = input;                                                            \
+        }                                                                                       \
+        error = _mm##SUFFIX##_or_si##width(error, prev_incomplete);                             \
+        return _mm##SUFFIX##_testz_si##width(error, error);                                     \
     }
-    char* trimmed_json_string = _strip_whitespace_malloc(json_string_p);
-    if ((trimmed_json_string[0] != '{') /*&& (*out_json_obj_pp->json_string.str[0] != '[')*/)
+
+#define UTF8_BROADCAST_128(table) (table)
+#define UTF8_ALIGNR_128(input, prev_input, n) _mm_alignr_epi8(input, prev_input, n)
+#define UTF8_ALIGNR_256(input, prev_input, n) \
+    _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev_input, input, 0x21), n)
+
+// `alignr` shifts each 128-bit lane on its own, so with AVX2 the lane before the first one of
+// `input` is taken from `prev_input` first.
+// clang-format off
+VALIDATE_UTF8_c(sse42, __attribute__((target("sse4.2"))), __m128i, 128, , UTF8_BROADCAST_128,
+                UTF8_ALIGNR_128)
+VALIDATE_UTF8_c(avx2, __attribute__((target("avx2"))), __m256i, 256, 256,
+                _mm256_broadcastsi128_si256, UTF8_ALIGNR_256)
+// clang-format on
+#endif /* __x86_64__ */
+
+static JsonUtf8Fn _select_utf8_kernel(void)
+{
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
     {
-        // TODO: Handle case in which the JSON string starts with [{ (array of objects).
-        LOG_ERROR("Invalid JSON string.");
-        free(trimmed_json_string);
-        return ERR_JSON_INVALID;
+        return _validate_utf8_avx2;
     }
-    char* tokens_string __attribute__((cleanup(wrap_free))) = _generate_tokens_malloc(trimmed_json_string);
-    Error valid_json_res                                    = _validate_tokens(tokens_string);
-    if (is_err(valid_json_res))
+    if (__builtin_cpu_supports("sse4.2"))
     {
-        free(trimmed_json_string);
-        LOG_ERROR("Invalid JSON string detected.");
-        return valid_json_res;
+        return _validate_utf8_sse42;
     }
-    out_json_obj_p->json_string = trimmed_json_string;
+#endif /* __x86_64__ */
+    return _validate_utf8_scalar;
+}
 
-    char* curr_pos_p = out_json_obj_p->json_string; // position analyzed (iterator)
-    // Create a dummy root item as the entry point of the JSON object. The first actual item is the
-    // first sibling of root. This prevents root's value type from being overwritten, hence causing
-    // errors.
-    out_json_obj_p->root.value.value_type = VALUE_ROOT;
-    out_json_obj_p->root.parent
-        = &out_json_obj_p->root; // Set the parent to itself to recognize 'root'.
-    JsonItem* new_item                = JsonItem_new();
-    out_json_obj_p->root.next_sibling = new_item;
-    new_item->parent                  = out_json_obj_p->root.parent;
+// Kernel of _select_utf8_kernel, resolved once on the first string that needs it rather than on
+// every one. Threads racing on the first call store the same kernel.
+static _Atomic(JsonUtf8Fn) _utf8_kernel = NULL;
 
-    LOG_DEBUG("JSON deserialization started.");
-    if (is_err(_deserialize(out_json_obj_p->root.next_sibling, &curr_pos_p)))
+static inline JsonUtf8Fn _get_utf8_kernel(void)
+{
+    JsonUtf8Fn kernel = atomic_load_explicit(&_utf8_kernel, memory_order_relaxed);
+    if (kernel == NULL)
     {
-        JsonObj_destroy(out_json_obj_p);
-        LOG_ERROR("Failed to deserialize JSON");
-        return ERR_JSON_INVALID;
+        kernel = _select_utf8_kernel();
+        atomic_store_explicit(&_utf8_kernel, kernel, memory_order_relaxed);
     }
-    LOG_DEBUG("JSON deserialization ended successfully.")
-
-    return ERR_ALL_GOOD;
+    return kernel;
 }
 
-static void _JsonItem_destroy(JsonItem* json_item)
+// Characters that `\x` stands for, 0 if `x` does not start an escape. `\u` is decoded apart.
+static const char _escaped_char[256] = {
+    ['"'] = '"',
+    ['\\'] = '\\',
+    ['/'] = '/',
+    ['b'] = '\b',
+    ['f'] = '\f',
+    ['n'] = '\n',
+    ['r'] = '\r',
+    ['t'] = '\t',
+};
+
+static inline bool _read_hex4(const char* char_p, uint32_t* out_value_p)
 {
-    if (json_item == NULL)
-    {
-        return;
-    }
-    if (json_item->value.value_type != VALUE_UNDEFINED)
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; i++)
     {
-        if (json_item->value.value_type == VALUE_ITEM)
+        const unsigned char lower = (unsigned char)char_p[i] | 0x20;
+        uint32_t digit;
+        if ((char_p[i] >= '0') && (char_p[i] <= '9'))
+        {
+            digit = (uint32_t)(char_p[i] - '0');
+        }
+        else if ((lower >= 'a') && (lower <= 'f'))
         {
-            _JsonItem_destroy(json_item->value.value_child_p);
+            digit = (uint32_t)(lower - 'a' + 10);
         }
-        if (json_item->value.value_type == VALUE_ARRAY)
+        else
         {
-            _JsonItem_destroy(json_item->value.value_child_p);
+            return false;
         }
+        value = (value << 4) | digit;
+    }
+    *out_value_p = value;
+    return true;
+}
+
+static inline char* _write_utf8(uint32_t code_point, char* dst_p)
+{
+    if (code_point < 0x80)
+    {
+        *dst_p++ = (char)code_point;
+    }
+    else if (code_point < 0x800)
+    {
+        *dst_p++ = (char)(0xC0 | (code_point >> 6));
+        *dst_p++ = (char)(0x80 | (code_point & 0x3F));
     }
-    if (json_item->next_sibling != NULL)
+    else if (code_point < 0x10000)
     {
-        _JsonItem_destroy(json_item->next_sibling);
+        *dst_p++ = (char)(0xE0 | (code_point >> 12));
+        *dst_p++ = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        *dst_p++ = (char)(0x80 | (code_point & 0x3F));
     }
-    json_item->value.value_type = VALUE_UNDEFINED;
-    if (json_item != json_item->parent)
+    else
     {
-        free(json_item);
+        *dst_p++ = (char)(0xF0 | (code_point >> 18));
+        *dst_p++ = (char)(0x80 | ((code_point >> 12) & 0x3F));
+        *dst_p++ = (char)(0x80 | ((code_point >> 6) & 0x3F));
+        *dst_p++ = (char)(0x80 | (code_point & 0x3F));
     }
-    json_item = NULL;
+    return dst_p;
 }
 
-void JsonObj_destroy(JsonObj* json_obj_p)
+// Decode the escape at `*src_pp`, which is never the last byte of the string ending at `end_p`,
+// into `*dst_pp`, and move both past it. A `\u` escape of a surrogate must be a high surrogate
+// followed by the `\u` escape of a low one, which together stand for one code point.
+static inline Error _decode_escape(const char** src_pp, const char* end_p, char** dst_pp)
 {
-    if (json_obj_p == NULL)
+    const char* src_p = *src_pp;
+    if (src_p[1] != 'u')
     {
-        return;
+        const char decoded = _escaped_char[(unsigned char)src_p[1]];
+        if (decoded == 0)
+        {
+            LOG_ERROR("Invalid escape `\\%c`", src_p[1]);
+            return ERR_JSON_INVALID;
+        }
+        *(*dst_pp)++ = decoded;
+        *src_pp      = src_p + 2;
+        return ERR_ALL_GOOD;
+    }
+    uint32_t code_point;
+    if ((end_p - src_p < 6) || !_read_hex4(&src_p[2], &code_point))
+    {
+        LOG_ERROR("Invalid `\\u` escape");
+        return ERR_JSON_INVALID;
     }
-    if (json_obj_p->root.value.value_type != VALUE_UNDEFINED)
+    src_p += 6;
+    if ((code_point >= 0xD800) && (code_point <= 0xDFFF))
     {
-        _JsonItem_destroy(&json_obj_p->root);
+        uint32_t low;
+        if ((code_point >= 0xDC00) || (end_p - src_p < 6) || (src_p[0] != '\\')
+            || (src_p[1] != 'u') || !_read_hex4(&src_p[2], &low) || (low < 0xDC00)
+            || (low > 0xDFFF))
+        {
+            LOG_ERROR("Unpaired surrogate `\\u%04X`", code_point);
+            return ERR_JSON_INVALID;
+        }
+        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+        src_p += 6;
     }
-    free(json_obj_p->json_string);
-    json_obj_p->json_string = NULL;
-    json_obj_p              = NULL;
+    *dst_pp = _write_utf8(code_point, *dst_pp);
+    *src_pp = src_p;
+    return ERR_ALL_GOOD;
 }
 
-#define OBJ_GET_VALUE_c(suffix, value_token, out_type, ACTION)                      \
-    Error obj_get_##suffix(const JsonObj* obj, const char* key, out_type out_value) \
-    {                                                                               \
-        if (obj)                                                                    \
-        {                                                                           \
-            return get_##suffix(obj->root.next_sibling, key, out_value);            \
-        }                                                                           \
-        else                                                                        \
-        {                                                                           \
-            return ERR_NULL;                                                        \
-        }                                                                           \
+// Decode the escapes of the `len` bytes at `str_p`, the first of them being at `offset`.
+static Error _unescape(char* str_p, size_t offset, size_t len, size_t* out_len_p)
+{
+    const char* src_p = &str_p[offset];
+    const char* end_p = &str_p[len];
+    char* dst_p       = &str_p[offset];
+    while (src_p != end_p)
+    {
+        return_on_err(_decode_escape(&src_p, end_p, &dst_p));
+        // Move the bytes up to the next backslash down, 32 then 8 at a time. A block is stored only
+        // if it holds no backslash: the store may reach bytes of the source that are not read yet.
+#if defined(__x86_64__)
+        const __m128i backslash = _mm_set1_epi8('\\');
+        while (end_p - src_p >= JSON_STR_BLOCK_SIZE)
+        {
+            const __m128i lo = _mm_loadu_si128((const __m128i*)src_p);
+            const __m128i hi = _mm_loadu_si128((const __m128i*)(src_p + 16));
+            if (_mm_movemask_epi8(
+                    _mm_or_si128(_mm_cmpeq_epi8(lo, backslash), _mm_cmpeq_epi8(hi, backslash)))
+                != 0)
+            {
+                break;
+            }
+            _mm_storeu_si128((__m128i*)dst_p, lo);
+            _mm_storeu_si128((__m128i*)(dst_p + 16), hi);
+            src_p += JSON_STR_BLOCK_SIZE;
+            dst_p += JSON_STR_BLOCK_SIZE;
+        }
+#endif /* __x86_64__ */
+        while (end_p - src_p >= (ptrdiff_t)sizeof(uint64_t))
+        {
+            uint64_t word;
+            memcpy(&word, src_p, sizeof(uint64_t));
+            const uint64_t backslashes = word ^ (_swar_ones * '\\');
+            if ((((backslashes - _swar_ones) & ~backslashes) & _swar_high) != 0)
+            {
+                break;
+            }
+            memcpy(dst_p, &word, sizeof(uint64_t));
+            src_p += sizeof(uint64_t);
+            dst_p += sizeof(uint64_t);
+        }
+        while ((src_p != end_p) && (*src_p != '\\'))
+        {
+            *dst_p++ = *src_p++;
+        }
     }
+    *dst_p     = '\0';
+    *out_len_p = (size_t)(dst_p - str_p);
+    return ERR_ALL_GOOD;
+}
 
-#define GET_VALUE_c(suffix, value_token, out_type, ACTION)                           \
-    Error get_##suffix(const JsonItem* item, const char* key, out_type out_value)    \
-    {                                                                                \
-        if (item == NULL)                                                            \
-        {                                                                            \
-            *out_value = NULL;                                                       \
-            LOG_ERROR("Input item is NULL - key `%s`.", key);                        \
-            return ERR_JSON_MISSING_ENTRY;                                           \
-        }                                                                            \
-        if (!item->key_p)                                                            \
-        {                                                                            \
-            return ERR_NULL;                                                         \
-        }                                                                            \
-        if (!strcmp(item->key_p, key))                                               \
-        {                                                                            \
-            if (item->value.value_type == value_token)                               \
-            {                                                                        \
-                *out_value = item->value.suffix;                                     \
-                ACTION;                                                              \
-                return ERR_ALL_GOOD;                                                 \
-            }                                                                        \
-            else                                                                     \
-            {                                                                        \
-                LOG_ERROR("Requested " #value_token " for a different value type."); \
-                return ERR_TYPE_MISMATCH;                                            \
-            }                                                                        \
-        }                                                                            \
-        else                                                                         \
-        {                                                                            \
-            return get_##suffix(item->next_sibling, key, out_value);                 \
-        }                                                                            \
+// Decode the `len` bytes at `str_p`, found between two quotes, in place and null-terminate them.
+// Fails on an invalid escape or invalid UTF-8.
+static Error _decode_str(char* str_p, size_t len, size_t* out_len_p)
+{
+    const size_t offset = _str_scan(str_p, len);
+    if (offset != len)
+    {
+        // Everything before `offset` is ASCII, so validation starts on a character.
+        if (!_get_utf8_kernel()(&str_p[offset], len - offset))
+        {
+            LOG_ERROR("Invalid UTF-8 in string");
+            return ERR_JSON_INVALID;
+        }
+        const char* backslash_p = memchr(&str_p[offset], '\\', len - offset);
+        if (backslash_p != NULL)
+        {
+            return _unescape(str_p, (size_t)(backslash_p - str_p), len, out_len_p);
+        }
     }
+    str_p[len] = '\0';
+    *out_len_p = len;
+    return ERR_ALL_GOOD;
+}
 
-#define OBJ_GET_NUMBER_c(suffix, value_token, out_type, ACTION)                     \
-    Error obj_get_##suffix(const JsonObj* obj, const char* key, out_type out_value) \
-    {                                                                               \
-        return get_##suffix(obj->root.next_sibling, key, out_value);                \
-    }
+// `quote_pos_p` points to the opening quote in the index, which is always followed by the closing
+// one. The string between them is decoded in place and returned with its decoded length.
+static inline Error _terminate_str(
+    char* json_string,
+    const uint32_t* quote_pos_p,
+    const char** out_str_pp,
+    uint32_t* out_len_p)
+{
+    char* str_p = &json_string[quote_pos_p[0] + 1];
+    size_t len;
+    return_on_err(_decode_str(str_p, quote_pos_p[1] - quote_pos_p[0] - 1, &len));
+    *out_str_pp = str_p;
+    *out_len_p  = (uint32_t)len;
+    return ERR_ALL_GOOD;
+}
 
-#define GET_NUMBER_c(suffix, value_token, out_type, ACTION)                                   \
-    Error get_##suffix(const JsonItem* item, const char* key, out_type out_value)             \
-    {                                                                                         \
-        if (item == NULL)                                                                     \
-        {                                                                                     \
-            LOG_ERROR("Input item is NULL - key: `%s`.", key);                                \
-            return ERR_NULL;                                                                  \
-        }                                                                                     \
-        if (!item->key_p)                                                                     \
-        {                                                                                     \
-            return ERR_NULL;                                                                  \
-        }                                                                                     \
-        if (!strcmp(item->key_p, key))                                                        \
-        {                                                                                     \
-            if (item->value.value_type == value_token)                                        \
-            {                                                                                 \
-                *out_value = item->value.suffix;                                              \
-                ACTION;                                                                       \
-                return ERR_ALL_GOOD;                                                          \
-            }                                                                                 \
-            else if ((item->value.value_type == VALUE_INT) && (value_token == VALUE_DOUBLE))  \
-            {                                                                                 \
-                LOG_WARNING("Converting int to double");                                      \
-                *out_value = (double)(1.0 * item->value.value_int);                           \
-                ACTION;                                                                       \
-                return ERR_ALL_GOOD;                                                          \
-            }                                                                                 \
-            else if ((item->value.value_type == VALUE_LLU) && (value_token == VALUE_DOUBLE))  \
-            {                                                                                 \
-                LOG_WARNING("Converting size_t to double");                                   \
-                *out_value = (double)(1.0 * item->value.value_llu);                           \
-                ACTION;                                                                       \
-                return ERR_ALL_GOOD;                                                          \
-            }                                                                                 \
-            else if ((item->value.value_type == VALUE_INT) && (value_token == VALUE_LLU))     \
-            {                                                                                 \
-                LOG_WARNING("Converting int to size_t");                                      \
-                if (item->value.value_int < 0)                                                \
-                {                                                                             \
-                    LOG_ERROR(                                                                \
-                        "Impossible to convert negative int %lld into size_t",                \
-                        item->value.value_int);                                               \
-                    LOG_ERROR("Failed to convert from INT to LLU");                           \
-                    return ERR_INVALID;                                                       \
-                };                                                                            \
-                *out_value = (json_uint_t)item->value.value_int;                              \
-                ACTION;                                                                       \
-                return ERR_ALL_GOOD;                                                          \
-            }                                                                                 \
-            else if ((item->value.value_type == VALUE_LLU) && (value_token == VALUE_INT))     \
-            {                                                                                 \
-                LOG_WARNING("Converting size_t to int");                                      \
-                *out_value = (json_int_t)item->value.value_llu;                               \
-                /* check for overflow */                                                      \
-                if (*out_value < 0)                                                           \
-                {                                                                             \
-                    LOG_ERROR(                                                                \
-                        "Overflow while converting %llu into an lld", item->value.value_llu); \
-                    return ERR_INVALID;                                                       \
-                };                                                                            \
-                ACTION;                                                                       \
-                return ERR_ALL_GOOD;                                                          \
-            }                                                                                 \
-            else                                                                              \
-            {                                                                                 \
-                LOG_ERROR("Requested " #value_token " for a different value type.")           \
-                return ERR_TYPE_MISMATCH;                                                     \
-            }                                                                                 \
-        }                                                                                     \
-        else                                                                                  \
-        {                                                                                     \
-            return get_##suffix(item->next_sibling, key, out_value);                          \
-        }                                                                                     \
-    }
+// ---------- Numbers ----------
+// Integers are accumulated eight digits at a time (SWAR) with checked overflow. Decimals take the
+// Clinger fast path when both the significand and the power of ten are exact doubles, then the
+// Eisel-Lemire algorithm, which is correctly rounded but gives up on rare ambiguous inputs: these
+// fall back to `strtod`.
 
-#define GET_ARRAY_VALUE_c(suffix, value_token, out_type)                                    \
-    Error get_array_##suffix(const JsonArray* json_array, size_t index, out_type out_value) \
-    {                                                                                       \
-        if (json_array == NULL)                                                             \
-        {                                                                                   \
-            LOG_ERROR("Input item is NULL");                                                \
-            return ERR_JSON_MISSING_ENTRY;                                                  \
-        }                                                                                   \
-        JsonItem* json_item = json_array->element;                                          \
-        while (true)                                                                        \
-        {                                                                                   \
-            if (json_item->index == index)                                                  \
-            {                                                                               \
-                break;                                                                      \
-            }                                                                               \
-            else if (json_item->next_sibling == NULL)                                       \
-            {                                                                               \
-                LOG_WARNING("Index %lu out of boundaries.", index);                         \
-                return ERR_NULL;                                                            \
-            }                                                                               \
-            json_item = json_item->next_sibling;                                            \
-        }                                                                                   \
-        if (json_item->value.value_type != value_token)                                     \
-        {                                                                                   \
-            LOG_ERROR(                                                                      \
-                "Incompatible data type - found %d, requested %d",                          \
-                json_item->value.value_type,                                                \
-                value_token);                                                               \
-            return ERR_TYPE_MISMATCH;                                                       \
-        }                                                                                   \
-        *out_value = json_item->value.suffix;                                               \
-        return ERR_ALL_GOOD;                                                                \
-    }
+#define JSON_MAX_EXACT_DIGITS (19)
+#define JSON_SMALLEST_POWER_OF_TEN (-342)
+#define JSON_LARGEST_POWER_OF_TEN (308)
+#define JSON_MANTISSA_BITS (52)
 
-// clang-format off
-OBJ_GET_VALUE_c(value_char_p, VALUE_STR, const char**, )
-OBJ_GET_VALUE_c(value_child_p, VALUE_ITEM, JsonItem**, )
-OBJ_GET_VALUE_c(
-    value_array_p,
-    VALUE_ARRAY,
-    JsonArray**,
-    (*out_value)->element = item->value.value_child_p)
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 json_uint128_t;
+#endif /* __SIZEOF_INT128__ */
 
-OBJ_GET_NUMBER_c(value_int, VALUE_INT, json_int_t*, )
-OBJ_GET_NUMBER_c(value_llu, VALUE_LLU, json_uint_t*, )
-OBJ_GET_NUMBER_c(value_double, VALUE_DOUBLE, json_decimal_t*, )
-OBJ_GET_NUMBER_c(value_bool, VALUE_BOOL, json_bool_t*, )
+typedef struct
+{
+    uint64_t low;
+    uint64_t high;
+} JsonUint128;
 
-GET_VALUE_c(value_char_p, VALUE_STR, const char**, )
-GET_VALUE_c(value_child_p, VALUE_ITEM, JsonItem**, )
-GET_VALUE_c(
-    value_array_p,
-    VALUE_ARRAY,
-    JsonArray**,
-    (*out_value)->element = item->value.value_child_p)
+// 128-bit truncated (rounded up for negative exponents) significands of 5^q, with q from
+// JSON_SMALLEST_POWER_OF_TEN to JSON_LARGEST_POWER_OF_TEN, most significant word first.
+static const uint64_t _power_of_five_128[] = {
+    0xeef453d6923bd65aULL, 0x113faa2906a13b3fULL,
+    0x9558b4661b6565f8ULL, 0x4ac7ca59a424c507ULL,
+    0xbaaee17fa23ebf76ULL, 0x5d79bcf00d2df649ULL,
+    0xe95a99df8ace6f53ULL, 0xf4d82c2c107973dcULL,
+    0x91d8a02bb6c10594ULL, 0x79071b9b8a4be869ULL,
+    0xb64ec836a47146f9ULL, 0x9748e2826cdee284ULL,
+    0xe3e27a444d8d98b7ULL, 0xfd1b1b2308169b25ULL,
+    0x8e6d8c6ab0787f72ULL, 0xfe30f0f5e50e20f7ULL,
+    0xb208ef855c969f4fULL, 0xbdbd2d335e51a935ULL,
+    0xde8b2b66b3bc4723ULL, 0xad2c788035e61382ULL,
+    0x8b16fb203055ac76ULL, 0x4c3bcb5021afcc31ULL,
+    0xaddcb9e83c6b1793ULL, 0xdf4abe242a1bbf3dULL,
+    0xd953e8624b85dd78ULL, 0xd71d6dad34a2af0dULL,
+    0x87d4713d6f33aa6bULL, 0x8672648c40e5ad68ULL,
+    0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL,
+    0xd43bf0effdc0ba48ULL, 0x0212bd1b2566def2ULL,
+    0x84a57695fe98746dULL, 0x014bb630f7604b57ULL,
+    0xa5ced43b7e3e9188ULL, 0x419ea3bd35385e2dULL,
+    0xcf42894a5dce35eaULL, 0x52064cac828675b9ULL,
+    0x818995ce7aa0e1b2ULL, 0x7343efebd1940993ULL,
+    0xa1ebfb4219491a1fULL, 0x1014ebe6c5f90bf8ULL,
+    0xca66fa129f9b60a6ULL, 0xd41a26e077774ef6ULL,
+    0xfd00b897478238d0ULL, 0x8920b098955522b4ULL,
+    0x9e20735e8cb16382ULL, 0x55b46e5f5d5535b0ULL,
+    0xc5a890362fddbc62ULL, 0xeb2189f734aa831dULL,
+    0xf712b443bbd52b7bULL, 0xa5e9ec7501d523e4ULL,
+    0x9a6bb0aa55653b2dULL, 0x47b233c92125366eULL,
+    0xc1069cd4eabe89f8ULL, 0x999ec0bb696e840aULL,
+    0xf148440a256e2c76ULL, 0xc00670ea43ca250dULL,
+    0x96cd2a865764dbcaULL, 0x380406926a5e5728ULL,
+    0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL,
+    0xeba09271e88d976bULL, 0xf7864a44c633682eULL,
+    0x93445b8731587ea3ULL, 0x7ab3ee6afbe0211dULL,
+    0xb8157268fdae9e4cULL, 0x5960ea05bad82964ULL,
+    0xe61acf033d1a45dfULL, 0x6fb92487298e33bdULL,
+    0x8fd0c16206306babULL, 0xa5d3b6d479f8e056ULL,
+    0xb3c4f1ba87bc8696ULL, 0x8f48a4899877186cULL,
+    0xe0b62e2929aba83cULL, 0x331acdabfe94de87ULL,
+    0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b14ULL,
+    0xaf8e5410288e1b6fULL, 0x07ecf0ae5ee44dd9ULL,
+    0xdb71e91432b1a24aULL, 0xc9e82cd9f69d6150ULL,
+    0x892731ac9faf056eULL, 0xbe311c083a225cd2ULL,
+    0xab70fe17c79ac6caULL, 0x6dbd630a48aaf406ULL,
+    0xd64d3d9db981787dULL, 0x092cbbccdad5b108ULL,
+    0x85f0468293f0eb4eULL, 0x25bbf56008c58ea5ULL,
+    0xa76c582338ed2621ULL, 0xaf2af2b80af6f24eULL,
+    0xd1476e2c07286faaULL, 0x1af5af660db4aee1ULL,
+    0x82cca4db847945caULL, 0x50d98d9fc890ed4dULL,
+    0xa37fce126597973cULL, 0xe50ff107bab528a0ULL,
+    0xcc5fc196fefd7d0cULL, 0x1e53ed49a96272c8ULL,
+    0xff77b1fcbebcdc4fULL, 0x25e8e89c13bb0f7aULL,
+    0x9faacf3df73609b1ULL, 0x77b191618c54e9acULL,
+    0xc795830d75038c1dULL, 0xd59df5b9ef6a2417ULL,
+    0xf97ae3d0d2446f25ULL, 0x4b0573286b44ad1dULL,
+    0x9becce62836ac577ULL, 0x4ee367f9430aec32ULL,
+    0xc2e801fb244576d5ULL, 0x229c41f793cda73fULL,
+    0xf3a20279ed56d48aULL, 0x6b43527578c1110fULL,
+    0x9845418c345644d6ULL, 0x830a13896b78aaa9ULL,
+    0xbe5691ef416bd60cULL, 0x23cc986bc656d553ULL,
+    0xedec366b11c6cb8fULL, 0x2cbfbe86b7ec8aa8ULL,
+    0x94b3a202eb1c3f39ULL, 0x7bf7d71432f3d6a9ULL,
+    0xb9e08a83a5e34f07ULL, 0xdaf5ccd93fb0cc53ULL,
+    0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff68ULL,
+    0x91376c36d99995beULL, 0x23100809b9c21fa1ULL,
+    0xb58547448ffffb2dULL, 0xabd40a0c2832a78aULL,
+    0xe2e69915b3fff9f9ULL, 0x16c90c8f323f516cULL,
+    0x8dd01fad907ffc3bULL, 0xae3da7d97f6792e3ULL,
+    0xb1442798f49ffb4aULL, 0x99cd11cfdf41779cULL,
+    0xdd95317f31c7fa1dULL, 0x40405643d711d583ULL,
+    0x8a7d3eef7f1cfc52ULL, 0x482835ea666b2572ULL,
+    0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL,
+    0xd863b256369d4a40ULL, 0x90bed43e40076a82ULL,
+    0x873e4f75e2224e68ULL, 0x5a7744a6e804a291ULL,
+    0xa90de3535aaae202ULL, 0x711515d0a205cb36ULL,
+    0xd3515c2831559a83ULL, 0x0d5a5b44ca873e03ULL,
+    0x8412d9991ed58091ULL, 0xe858790afe9486c2ULL,
+    0xa5178fff668ae0b6ULL, 0x626e974dbe39a872ULL,
+    0xce5d73ff402d98e3ULL, 0xfb0a3d212dc8128fULL,
+    0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b99ULL,
+    0xa139029f6a239f72ULL, 0x1c1fffc1ebc44e80ULL,
+    0xc987434744ac874eULL, 0xa327ffb266b56220ULL,
+    0xfbe9141915d7a922ULL, 0x4bf1ff9f0062baa8ULL,
+    0x9d71ac8fada6c9b5ULL, 0x6f773fc3603db4a9ULL,
+    0xc4ce17b399107c22ULL, 0xcb550fb4384d21d3ULL,
+    0xf6019da07f549b2bULL, 0x7e2a53a146606a48ULL,
+    0x99c102844f94e0fbULL, 0x2eda7444cbfc426dULL,
+    0xc0314325637a1939ULL, 0xfa911155fefb5308ULL,
+    0xf03d93eebc589f88ULL, 0x793555ab7eba27caULL,
+    0x96267c7535b763b5ULL, 0x4bc1558b2f3458deULL,
+    0xbbb01b9283253ca2ULL, 0x9eb1aaedfb016f16ULL,
+    0xea9c227723ee8bcbULL, 0x465e15a979c1cadcULL,
+    0x92a1958a7675175fULL, 0x0bfacd89ec191ec9ULL,
+    0xb749faed14125d36ULL, 0xcef980ec671f667bULL,
+    0xe51c79a85916f484ULL, 0x82b7e12780e7401aULL,
+    0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908810ULL,
+    0xb2fe3f0b8599ef07ULL, 0x861fa7e6dcb4aa15ULL,
+    0xdfbdcece67006ac9ULL, 0x67a791e093e1d49aULL,
+    0x8bd6a141006042bdULL, 0xe0c8bb2c5c6d24e0ULL,
+    0xaecc49914078536dULL, 0x58fae9f773886e18ULL,
+    0xda7f5bf590966848ULL, 0xaf39a475506a899eULL,
+    0x888f99797a5e012dULL, 0x6d8406c952429603ULL,
+    0xaab37fd7d8f58178ULL, 0xc8e5087ba6d33b83ULL,
+    0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a64ULL,
+    0x855c3be0a17fcd26ULL, 0x5cf2eea09a55067fULL,
+    0xa6b34ad8c9dfc06fULL, 0xf42faa48c0ea481eULL,
+    0xd0601d8efc57b08bULL, 0xf13b94daf124da26ULL,
+    0x823c12795db6ce57ULL, 0x76c53d08d6b70858ULL,
+    0xa2cb1717b52481edULL, 0x54768c4b0c64ca6eULL,
+    0xcb7ddcdda26da268ULL, 0xa9942f5dcf7dfd09ULL,
+    0xfe5d54150b090b02ULL, 0xd3f93b35435d7c4cULL,
+    0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6dafULL,
+    0xc6b8e9b0709f109aULL, 0x359ab6419ca1091bULL,
+    0xf867241c8cc6d4c0ULL, 0xc30163d203c94b62ULL,
+    0x9b407691d7fc44f8ULL, 0x79e0de63425dcf1dULL,
+    0xc21094364dfb5636ULL, 0x985915fc12f542e4ULL,
+    0xf294b943e17a2bc4ULL, 0x3e6f5b7b17b2939dULL,
+    0x979cf3ca6cec5b5aULL, 0xa705992ceecf9c42ULL,
+    0xbd8430bd08277231ULL, 0x50c6ff782a838353ULL,
+    0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL,
+    0x940f4613ae5ed136ULL, 0x871b7795e136be99ULL,
+    0xb913179899f68584ULL, 0x28e2557b59846e3fULL,
+    0xe757dd7ec07426e5ULL, 0x331aeada2fe589cfULL,
+    0x9096ea6f3848984fULL, 0x3ff0d2c85def7621ULL,
+    0xb4bca50b065abe63ULL, 0x0fed077a756b53a9ULL,
+    0xe1ebce4dc7f16dfbULL, 0xd3e8495912c62894ULL,
+    0x8d3360f09cf6e4bdULL, 0x64712dd7abbbd95cULL,
+    0xb080392cc4349decULL, 0xbd8d794d96aacfb3ULL,
+    0xdca04777f541c567ULL, 0xecf0d7a0fc5583a0ULL,
+    0x89e42caaf9491b60ULL, 0xf41686c49db57244ULL,
+    0xac5d37d5b79b6239ULL, 0x311c2875c522ced5ULL,
+    0xd77485cb25823ac7ULL, 0x7d633293366b828bULL,
+    0x86a8d39ef77164bcULL, 0xae5dff9c02033197ULL,
+    0xa8530886b54dbdebULL, 0xd9f57f830283fdfcULL,
+    0xd267caa862a12d66ULL, 0xd072df63c324fd7bULL,
+    0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL,
+    0xa46116538d0deb78ULL, 0x52d9be85f074e608ULL,
+    0xcd795be870516656ULL, 0x67902e276c921f8bULL,
+    0x806bd9714632dff6ULL, 0x00ba1cd8a3db53b6ULL,
+    0xa086cfcd97bf97f3ULL, 0x80e8a40eccd228a4ULL,
+    0xc8a883c0fdaf7df0ULL, 0x6122cd128006b2cdULL,
+    0xfad2a4b13d1b5d6cULL, 0x796b805720085f81ULL,
+    0x9cc3a6eec6311a63ULL, 0xcbe3303674053bb0ULL,
+    0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9cULL,
+    0xf4f1b4d515acb93bULL, 0xee92fb5515482d44ULL,
+    0x991711052d8bf3c5ULL, 0x751bdd152d4d1c4aULL,
+    0xbf5cd54678eef0b6ULL, 0xd262d45a78a0635dULL,
+    0xef340a98172aace4ULL, 0x86fb897116c87c34ULL,
+    0x9580869f0e7aac0eULL, 0xd45d35e6ae3d4da0ULL,
+    0xbae0a846d2195712ULL, 0x8974836059cca109ULL,
+    0xe998d258869facd7ULL, 0x2bd1a438703fc94bULL,
+    0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL,
+    0xb67f6455292cbf08ULL, 0x1a3bc84c17b1d542ULL,
+    0xe41f3d6a7377eecaULL, 0x20caba5f1d9e4a93ULL,
+    0x8e938662882af53eULL, 0x547eb47b7282ee9cULL,
+    0xb23867fb2a35b28dULL, 0xe99e619a4f23aa43ULL,
+    0xdec681f9f4c31f31ULL, 0x6405fa00e2ec94d4ULL,
+    0x8b3c113c38f9f37eULL, 0xde83bc408dd3dd04ULL,
+    0xae0b158b4738705eULL, 0x9624ab50b148d445ULL,
+    0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL,
+    0x87f8a8d4cfa417c9ULL, 0xe54ca5d70a80e5d6ULL,
+    0xa9f6d30a038d1dbcULL, 0x5e9fcf4ccd211f4cULL,
+    0xd47487cc8470652bULL, 0x7647c3200069671fULL,
+    0x84c8d4dfd2c63f3bULL, 0x29ecd9f40041e073ULL,
+    0xa5fb0a17c777cf09ULL, 0xf468107100525890ULL,
+    0xcf79cc9db955c2ccULL, 0x7182148d4066eeb4ULL,
+    0x81ac1fe293d599bfULL, 0xc6f14cd848405530ULL,
+    0xa21727db38cb002fULL, 0xb8ada00e5a506a7cULL,
+    0xca9cf1d206fdc03bULL, 0xa6d90811f0e4851cULL,
+    0xfd442e4688bd304aULL, 0x908f4a166d1da663ULL,
+    0x9e4a9cec15763e2eULL, 0x9a598e4e043287feULL,
+    0xc5dd44271ad3cdbaULL, 0x40eff1e1853f29fdULL,
+    0xf7549530e188c128ULL, 0xd12bee59e68ef47cULL,
+    0x9a94dd3e8cf578b9ULL, 0x82bb74f8301958ceULL,
+    0xc13a148e3032d6e7ULL, 0xe36a52363c1faf01ULL,
+    0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac1ULL,
+    0x96f5600f15a7b7e5ULL, 0x29ab103a5ef8c0b9ULL,
+    0xbcb2b812db11a5deULL, 0x7415d448f6b6f0e7ULL,
+    0xebdf661791d60f56ULL, 0x111b495b3464ad21ULL,
+    0x936b9fcebb25c995ULL, 0xcab10dd900beec34ULL,
+    0xb84687c269ef3bfbULL, 0x3d5d514f40eea742ULL,
+    0xe65829b3046b0afaULL, 0x0cb4a5a3112a5112ULL,
+    0x8ff71a0fe2c2e6dcULL, 0x47f0e785eaba72abULL,
+    0xb3f4e093db73a093ULL, 0x59ed216765690f56ULL,
+    0xe0f218b8d25088b8ULL, 0x306869c13ec3532cULL,
+    0x8c974f7383725573ULL, 0x1e414218c73a13fbULL,
+    0xafbd2350644eeacfULL, 0xe5d1929ef90898faULL,
+    0xdbac6c247d62a583ULL, 0xdf45f746b74abf39ULL,
+    0x894bc396ce5da772ULL, 0x6b8bba8c328eb783ULL,
+    0xab9eb47c81f5114fULL, 0x066ea92f3f326564ULL,
+    0xd686619ba27255a2ULL, 0xc80a537b0efefebdULL,
+    0x8613fd0145877585ULL, 0xbd06742ce95f5f36ULL,
+    0xa798fc4196e952e7ULL, 0x2c48113823b73704ULL,
+    0xd17f3b51fca3a7a0ULL, 0xf75a15862ca504c5ULL,
+    0x82ef85133de648c4ULL, 0x9a984d73dbe722fbULL,
+    0xa3ab66580d5fdaf5ULL, 0xc13e60d0d2e0ebbaULL,
+    0xcc963fee10b7d1b3ULL, 0x318df905079926a8ULL,
+    0xffbbcfe994e5c61fULL, 0xfdf17746497f7052ULL,
+    0x9fd561f1fd0f9bd3ULL, 0xfeb6ea8bedefa633ULL,
+    0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc0ULL,
+    0xf9bd690a1b68637bULL, 0x3dfdce7aa3c673b0ULL,
+    0x9c1661a651213e2dULL, 0x06bea10ca65c084eULL,
+    0xc31bfa0fe5698db8ULL, 0x486e494fcff30a62ULL,
+    0xf3e2f893dec3f126ULL, 0x5a89dba3c3efccfaULL,
+    0x986ddb5c6b3a76b7ULL, 0xf89629465a75e01cULL,
+    0xbe89523386091465ULL, 0xf6bbb397f1135823ULL,
+    0xee2ba6c0678b597fULL, 0x746aa07ded582e2cULL,
+    0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL,
+    0xba121a4650e4ddebULL, 0x92f34d62616ce413ULL,
+    0xe896a0d7e51e1566ULL, 0x77b020baf9c81d17ULL,
+    0x915e2486ef32cd60ULL, 0x0ace1474dc1d122eULL,
+    0xb5b5ada8aaff80b8ULL, 0x0d819992132456baULL,
+    0xe3231912d5bf60e6ULL, 0x10e1fff697ed6c69ULL,
+    0x8df5efabc5979c8fULL, 0xca8d3ffa1ef463c1ULL,
+    0xb1736b96b6fd83b3ULL, 0xbd308ff8a6b17cb2ULL,
+    0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdeULL,
+    0x8aa22c0dbef60ee4ULL, 0x6bcdf07a423aa96bULL,
+    0xad4ab7112eb3929dULL, 0x86c16c98d2c953c6ULL,
+    0xd89d64d57a607744ULL, 0xe871c7bf077ba8b7ULL,
+    0x87625f056c7c4a8bULL, 0x11471cd764ad4972ULL,
+    0xa93af6c6c79b5d2dULL, 0xd598e40d3dd89bcfULL,
+    0xd389b47879823479ULL, 0x4aff1d108d4ec2c3ULL,
+    0x843610cb4bf160cbULL, 0xcedf722a585139baULL,
+    0xa54394fe1eedb8feULL, 0xc2974eb4ee658828ULL,
+    0xce947a3da6a9273eULL, 0x733d226229feea32ULL,
+    0x811ccc668829b887ULL, 0x0806357d5a3f525fULL,
+    0xa163ff802a3426a8ULL, 0xca07c2dcb0cf26f7ULL,
+    0xc9bcff6034c13052ULL, 0xfc89b393dd02f0b5ULL,
+    0xfc2c3f3841f17c67ULL, 0xbbac2078d443ace2ULL,
+    0x9d9ba7832936edc0ULL, 0xd54b944b84aa4c0dULL,
+    0xc5029163f384a931ULL, 0x0a9e795e65d4df11ULL,
+    0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d5ULL,
+    0x99ea0196163fa42eULL, 0x504bced1bf8e4e45ULL,
+    0xc06481fb9bcf8d39ULL, 0xe45ec2862f71e1d6ULL,
+    0xf07da27a82c37088ULL, 0x5d767327bb4e5a4cULL,
+    0x964e858c91ba2655ULL, 0x3a6a07f8d510f86fULL,
+    0xbbe226efb628afeaULL, 0x890489f70a55368bULL,
+    0xeadab0aba3b2dbe5ULL, 0x2b45ac74ccea842eULL,
+    0x92c8ae6b464fc96fULL, 0x3b0b8bc90012929dULL,
+    0xb77ada0617e3bbcbULL, 0x09ce6ebb40173744ULL,
+    0xe55990879ddcaabdULL, 0xcc420a6a101d0515ULL,
+    0x8f57fa54c2a9eab6ULL, 0x9fa946824a12232dULL,
+    0xb32df8e9f3546564ULL, 0x47939822dc96abf9ULL,
+    0xdff9772470297ebdULL, 0x59787e2b93bc56f7ULL,
+    0x8bfbea76c619ef36ULL, 0x57eb4edb3c55b65aULL,
+    0xaefae51477a06b03ULL, 0xede622920b6b23f1ULL,
+    0xdab99e59958885c4ULL, 0xe95fab368e45ecedULL,
+    0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL,
+    0xaae103b5fcd2a881ULL, 0xd652bdc29f26a119ULL,
+    0xd59944a37c0752a2ULL, 0x4be76d3346f0495fULL,
+    0x857fcae62d8493a5ULL, 0x6f70a4400c562ddbULL,
+    0xa6dfbd9fb8e5b88eULL, 0xcb4ccd500f6bb952ULL,
+    0xd097ad07a71f26b2ULL, 0x7e2000a41346a7a7ULL,
+    0x825ecc24c873782fULL, 0x8ed400668c0c28c8ULL,
+    0xa2f67f2dfa90563bULL, 0x728900802f0f32faULL,
+    0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffb9ULL,
+    0xfea126b7d78186bcULL, 0xe2f610c84987bfa8ULL,
+    0x9f24b832e6b0f436ULL, 0x0dd9ca7d2df4d7c9ULL,
+    0xc6ede63fa05d3143ULL, 0x91503d1c79720dbbULL,
+    0xf8a95fcf88747d94ULL, 0x75a44c6397ce912aULL,
+    0x9b69dbe1b548ce7cULL, 0xc986afbe3ee11abaULL,
+    0xc24452da229b021bULL, 0xfbe85badce996168ULL,
+    0xf2d56790ab41c2a2ULL, 0xfae27299423fb9c3ULL,
+    0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL,
+    0xbdb6b8e905cb600fULL, 0x5400e987bbc1c920ULL,
+    0xed246723473e3813ULL, 0x290123e9aab23b68ULL,
+    0x9436c0760c86e30bULL, 0xf9a0b6720aaf6521ULL,
+    0xb94470938fa89bceULL, 0xf808e40e8d5b3e69ULL,
+    0xe7958cb87392c2c2ULL, 0xb60b1d1230b20e04ULL,
+    0x90bd77f3483bb9b9ULL, 0xb1c6f22b5e6f48c2ULL,
+    0xb4ecd5f01a4aa828ULL, 0x1e38aeb6360b1af3ULL,
+    0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL,
+    0x8d590723948a535fULL, 0x579c487e5a38ad0eULL,
+    0xb0af48ec79ace837ULL, 0x2d835a9df0c6d851ULL,
+    0xdcdb1b2798182244ULL, 0xf8e431456cf88e65ULL,
+    0x8a08f0f8bf0f156bULL, 0x1b8e9ecb641b58ffULL,
+    0xac8b2d36eed2dac5ULL, 0xe272467e3d222f3fULL,
+    0xd7adf884aa879177ULL, 0x5b0ed81dcc6abb0fULL,
+    0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL,
+    0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL,
+    0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL,
+    0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL,
+    0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL,
+    0xcdb02555653131b6ULL, 0x3792f412cb06794dULL,
+    0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL,
+    0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL,
+    0xc8de047564d20a8bULL, 0xf245825a5a445275ULL,
+    0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL,
+    0x9ced737bb6c4183dULL, 0x55464dd69685606bULL,
+    0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL,
+    0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL,
+    0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL,
+    0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL,
+    0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL,
+    0x95a8637627989aadULL, 0xdde7001379a44aa8ULL,
+    0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL,
+    0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL,
+    0x9226712162ab070dULL, 0xcab3961304ca70e8ULL,
+    0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL,
+    0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL,
+    0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL,
+    0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL,
+    0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL,
+    0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL,
+    0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL,
+    0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL,
+    0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL,
+    0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL,
+    0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL,
+    0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL,
+    0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL,
+    0xcfb11ead453994baULL, 0x67de18eda5814af2ULL,
+    0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL,
+    0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL,
+    0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL,
+    0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL,
+    0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL,
+    0xc612062576589ddaULL, 0x95364afe032a819eULL,
+    0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL,
+    0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL,
+    0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL,
+    0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL,
+    0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL,
+    0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL,
+    0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL,
+    0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL,
+    0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL,
+    0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL,
+    0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL,
+    0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL,
+    0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL,
+    0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL,
+    0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL,
+    0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL,
+    0x89705f4136b4a597ULL, 0x31680a88f8953031ULL,
+    0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL,
+    0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL,
+    0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL,
+    0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL,
+    0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL,
+    0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL,
+    0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL,
+    0xccccccccccccccccULL, 0xcccccccccccccccdULL,
+    0x8000000000000000ULL, 0x0000000000000000ULL,
+    0xa000000000000000ULL, 0x0000000000000000ULL,
+    0xc800000000000000ULL, 0x0000000000000000ULL,
+    0xfa00000000000000ULL, 0x0000000000000000ULL,
+    0x9c40000000000000ULL, 0x0000000000000000ULL,
+    0xc350000000000000ULL, 0x0000000000000000ULL,
+    0xf424000000000000ULL, 0x0000000000000000ULL,
+    0x9896800000000000ULL, 0x0000000000000000ULL,
+    0xbebc200000000000ULL, 0x0000000000000000ULL,
+    0xee6b280000000000ULL, 0x0000000000000000ULL,
+    0x9502f90000000000ULL, 0x0000000000000000ULL,
+    0xba43b74000000000ULL, 0x0000000000000000ULL,
+    0xe8d4a51000000000ULL, 0x0000000000000000ULL,
+    0x9184e72a00000000ULL, 0x0000000000000000ULL,
+    0xb5e620f480000000ULL, 0x0000000000000000ULL,
+    0xe35fa931a0000000ULL, 0x0000000000000000ULL,
+    0x8e1bc9bf04000000ULL, 0x0000000000000000ULL,
+    0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL,
+    0xde0b6b3a76400000ULL, 0x0000000000000000ULL,
+    0x8ac7230489e80000ULL, 0x0000000000000000ULL,
+    0xad78ebc5ac620000ULL, 0x0000000000000000ULL,
+    0xd8d726b7177a8000ULL, 0x0000000000000000ULL,
+    0x878678326eac9000ULL, 0x0000000000000000ULL,
+    0xa968163f0a57b400ULL, 0x0000000000000000ULL,
+    0xd3c21bcecceda100ULL, 0x0000000000000000ULL,
+    0x84595161401484a0ULL, 0x0000000000000000ULL,
+    0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL,
+    0xcecb8f27f4200f3aULL, 0x0000000000000000ULL,
+    0x813f3978f8940984ULL, 0x4000000000000000ULL,
+    0xa18f07d736b90be5ULL, 0x5000000000000000ULL,
+    0xc9f2c9cd04674edeULL, 0xa400000000000000ULL,
+    0xfc6f7c4045812296ULL, 0x4d00000000000000ULL,
+    0x9dc5ada82b70b59dULL, 0xf020000000000000ULL,
+    0xc5371912364ce305ULL, 0x6c28000000000000ULL,
+    0xf684df56c3e01bc6ULL, 0xc732000000000000ULL,
+    0x9a130b963a6c115cULL, 0x3c7f400000000000ULL,
+    0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL,
+    0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL,
+    0x96769950b50d88f4ULL, 0x1314448000000000ULL,
+    0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL,
+    0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL,
+    0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL,
+    0xb7abc627050305adULL, 0xf14a3d9e40000000ULL,
+    0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL,
+    0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL,
+    0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL,
+    0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL,
+    0x8c213d9da502de45ULL, 0x4526f422cc340000ULL,
+    0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL,
+    0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL,
+    0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL,
+    0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL,
+    0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL,
+    0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL,
+    0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL,
+    0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL,
+    0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL,
+    0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL,
+    0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL,
+    0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL,
+    0x9f4f2726179a2245ULL, 0x01d762422c946590ULL,
+    0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL,
+    0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL,
+    0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL,
+    0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL,
+    0xf316271c7fc3908aULL, 0x8bef464e3945ef7aULL,
+    0x97edd871cfda3a56ULL, 0x97758bf0e3cbb5acULL,
+    0xbde94e8e43d0c8ecULL, 0x3d52eeed1cbea317ULL,
+    0xed63a231d4c4fb27ULL, 0x4ca7aaa863ee4bddULL,
+    0x945e455f24fb1cf8ULL, 0x8fe8caa93e74ef6aULL,
+    0xb975d6b6ee39e436ULL, 0xb3e2fd538e122b44ULL,
+    0xe7d34c64a9c85d44ULL, 0x60dbbca87196b616ULL,
+    0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31cdULL,
+    0xb51d13aea4a488ddULL, 0x6babab6398bdbe41ULL,
+    0xe264589a4dcdab14ULL, 0xc696963c7eed2dd1ULL,
+    0x8d7eb76070a08aecULL, 0xfc1e1de5cf543ca2ULL,
+    0xb0de65388cc8ada8ULL, 0x3b25a55f43294bcbULL,
+    0xdd15fe86affad912ULL, 0x49ef0eb713f39ebeULL,
+    0x8a2dbf142dfcc7abULL, 0x6e3569326c784337ULL,
+    0xacb92ed9397bf996ULL, 0x49c2c37f07965404ULL,
+    0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL,
+    0x86f0ac99b4e8dafdULL, 0x69a028bb3ded71a3ULL,
+    0xa8acd7c0222311bcULL, 0xc40832ea0d68ce0cULL,
+    0xd2d80db02aabd62bULL, 0xf50a3fa490c30190ULL,
+    0x83c7088e1aab65dbULL, 0x792667c6da79e0faULL,
+    0xa4b8cab1a1563f52ULL, 0x577001b891185938ULL,
+    0xcde6fd5e09abcf26ULL, 0xed4c0226b55e6f86ULL,
+    0x80b05e5ac60b6178ULL, 0x544f8158315b05b4ULL,
+    0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL,
+    0xc913936dd571c84cULL, 0x03bc3a19cd1e38e9ULL,
+    0xfb5878494ace3a5fULL, 0x04ab48a04065c723ULL,
+    0x9d174b2dcec0e47bULL, 0x62eb0d64283f9c76ULL,
+    0xc45d1df942711d9aULL, 0x3ba5d0bd324f8394ULL,
+    0xf5746577930d6500ULL, 0xca8f44ec7ee36479ULL,
+    0x9968bf6abbe85f20ULL, 0x7e998b13cf4e1ecbULL,
+    0xbfc2ef456ae276e8ULL, 0x9e3fedd8c321a67eULL,
+    0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL,
+    0x95d04aee3b80ece5ULL, 0xbba1f1d158724a12ULL,
+    0xbb445da9ca61281fULL, 0x2a8a6e45ae8edc97ULL,
+    0xea1575143cf97226ULL, 0xf52d09d71a3293bdULL,
+    0x924d692ca61be758ULL, 0x593c2626705f9c56ULL,
+    0xb6e0c377cfa2e12eULL, 0x6f8b2fb00c77836cULL,
+    0xe498f455c38b997aULL, 0x0b6dfb9c0f956447ULL,
+    0x8edf98b59a373fecULL, 0x4724bd4189bd5eacULL,
+    0xb2977ee300c50fe7ULL, 0x58edec91ec2cb657ULL,
+    0xdf3d5e9bc0f653e1ULL, 0x2f2967b66737e3edULL,
+    0x8b865b215899f46cULL, 0xbd79e0d20082ee74ULL,
+    0xae67f1e9aec07187ULL, 0xecd8590680a3aa11ULL,
+    0xda01ee641a708de9ULL, 0xe80e6f4820cc9495ULL,
+    0x884134fe908658b2ULL, 0x3109058d147fdcddULL,
+    0xaa51823e34a7eedeULL, 0xbd4b46f0599fd415ULL,
+    0xd4e5e2cdc1d1ea96ULL, 0x6c9e18ac7007c91aULL,
+    0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL,
+    0xa6539930bf6bff45ULL, 0x84db8346b786151cULL,
+    0xcfe87f7cef46ff16ULL, 0xe612641865679a63ULL,
+    0x81f14fae158c5f6eULL, 0x4fcb7e8f3f60c07eULL,
+    0xa26da3999aef7749ULL, 0xe3be5e330f38f09dULL,
+    0xcb090c8001ab551cULL, 0x5cadf5bfd3072cc5ULL,
+    0xfdcb4fa002162a63ULL, 0x73d9732fc7c8f7f6ULL,
+    0x9e9f11c4014dda7eULL, 0x2867e7fddcdd9afaULL,
+    0xc646d63501a1511dULL, 0xb281e1fd541501b8ULL,
+    0xf7d88bc24209a565ULL, 0x1f225a7ca91a4226ULL,
+    0x9ae757596946075fULL, 0x3375788de9b06958ULL,
+    0xc1a12d2fc3978937ULL, 0x0052d6b1641c83aeULL,
+    0xf209787bb47d6b84ULL, 0xc0678c5dbd23a49aULL,
+    0x9745eb4d50ce6332ULL, 0xf840b7ba963646e0ULL,
+    0xbd176620a501fbffULL, 0xb650e5a93bc3d898ULL,
+    0xec5d3fa8ce427affULL, 0xa3e51f138ab4cebeULL,
+    0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL,
+    0xb8a8d9bbe123f017ULL, 0xb80b0047445d4184ULL,
+    0xe6d3102ad96cec1dULL, 0xa60dc059157491e5ULL,
+    0x9043ea1ac7e41392ULL, 0x87c89837ad68db2fULL,
+    0xb454e4a179dd1877ULL, 0x29babe4598c311fbULL,
+    0xe16a1dc9d8545e94ULL, 0xf4296dd6fef3d67aULL,
+    0x8ce2529e2734bb1dULL, 0x1899e4a65f58660cULL,
+    0xb01ae745b101e9e4ULL, 0x5ec05dcff72e7f8fULL,
+    0xdc21a1171d42645dULL, 0x76707543f4fa1f73ULL,
+    0x899504ae72497ebaULL, 0x6a06494a791c53a8ULL,
+    0xabfa45da0edbde69ULL, 0x0487db9d17636892ULL,
+    0xd6f8d7509292d603ULL, 0x45a9d2845d3c42b6ULL,
+    0x865b86925b9bc5c2ULL, 0x0b8a2392ba45a9b2ULL,
+    0xa7f26836f282b732ULL, 0x8e6cac7768d7141eULL,
+    0xd1ef0244af2364ffULL, 0x3207d795430cd926ULL,
+    0x8335616aed761f1fULL, 0x7f44e6bd49e807b8ULL,
+    0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL,
+    0xcd036837130890a1ULL, 0x36dba887c37a8c0fULL,
+    0x802221226be55a64ULL, 0xc2494954da2c9789ULL,
+    0xa02aa96b06deb0fdULL, 0xf2db9baa10b7bd6cULL,
+    0xc83553c5c8965d3dULL, 0x6f92829494e5acc7ULL,
+    0xfa42a8b73abbf48cULL, 0xcb772339ba1f17f9ULL,
+    0x9c69a97284b578d7ULL, 0xff2a760414536efbULL,
+    0xc38413cf25e2d70dULL, 0xfef5138519684abaULL,
+    0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL,
+    0x98bf2f79d5993802ULL, 0xef2f773ffbd97a61ULL,
+    0xbeeefb584aff8603ULL, 0xaafb550ffacfd8faULL,
+    0xeeaaba2e5dbf6784ULL, 0x95ba2a53f983cf38ULL,
+    0x952ab45cfa97a0b2ULL, 0xdd945a747bf26183ULL,
+    0xba756174393d88dfULL, 0x94f971119aeef9e4ULL,
+    0xe912b9d1478ceb17ULL, 0x7a37cd5601aab85dULL,
+    0x91abb422ccb812eeULL, 0xac62e055c10ab33aULL,
+    0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL,
+    0xe39c49765fdf9d94ULL, 0xed5a7e85fda0b80bULL,
+    0x8e41ade9fbebc27dULL, 0x14588f13be847307ULL,
+    0xb1d219647ae6b31cULL, 0x596eb2d8ae258fc8ULL,
+    0xde469fbd99a05fe3ULL, 0x6fca5f8ed9aef3bbULL,
+    0x8aec23d680043beeULL, 0x25de7bb9480d5854ULL,
+    0xada72ccc20054ae9ULL, 0xaf561aa79a10ae6aULL,
+    0xd910f7ff28069da4ULL, 0x1b2ba1518094da04ULL,
+    0x87aa9aff79042286ULL, 0x90fb44d2f05d0842ULL,
+    0xa99541bf57452b28ULL, 0x353a1607ac744a53ULL,
+    0xd3fa922f2d1675f2ULL, 0x42889b8997915ce8ULL,
+    0x847c9b5d7c2e09b7ULL, 0x69956135febada11ULL,
+    0xa59bc234db398c25ULL, 0x43fab9837e699095ULL,
+    0xcf02b2c21207ef2eULL, 0x94f967e45e03f4bbULL,
+    0x8161afb94b44f57dULL, 0x1d1be0eebac278f5ULL,
+    0xa1ba1ba79e1632dcULL, 0x6462d92a69731732ULL,
+    0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcfeULL,
+    0xfcb2cb35e702af78ULL, 0x5cda735244c3d43eULL,
+    0x9defbf01b061adabULL, 0x3a0888136afa64a7ULL,
+    0xc56baec21c7a1916ULL, 0x088aaa1845b8fdd0ULL,
+    0xf6c69a72a3989f5bULL, 0x8aad549e57273d45ULL,
+    0x9a3c2087a63f6399ULL, 0x36ac54e2f678864bULL,
+    0xc0cb28a98fcf3c7fULL, 0x84576a1bb416a7ddULL,
+    0xf0fdf2d3f3c30b9fULL, 0x656d44a2a11c51d5ULL,
+    0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL,
+    0xbc4665b596706114ULL, 0x873d5d9f0dde1feeULL,
+    0xeb57ff22fc0c7959ULL, 0xa90cb506d155a7eaULL,
+    0x9316ff75dd87cbd8ULL, 0x09a7f12442d588f2ULL,
+    0xb7dcbf5354e9beceULL, 0x0c11ed6d538aeb2fULL,
+    0xe5d3ef282a242e81ULL, 0x8f1668c8a86da5faULL,
+    0x8fa475791a569d10ULL, 0xf96e017d694487bcULL,
+    0xb38d92d760ec4455ULL, 0x37c981dcc395a9acULL,
+    0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL,
+    0x8c469ab843b89562ULL, 0x93956d7478ccec8eULL,
+    0xaf58416654a6babbULL, 0x387ac8d1970027b2ULL,
+    0xdb2e51bfe9d0696aULL, 0x06997b05fcc0319eULL,
+    0x88fcf317f22241e2ULL, 0x441fece3bdf81f03ULL,
+    0xab3c2fddeeaad25aULL, 0xd527e81cad7626c3ULL,
+    0xd60b3bd56a5586f1ULL, 0x8a71e223d8d3b074ULL,
+    0x85c7056562757456ULL, 0xf6872d5667844e49ULL,
+    0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL,
+    0xd106f86e69d785c7ULL, 0xe13336d701beba52ULL,
+    0x82a45b450226b39cULL, 0xecc0024661173473ULL,
+    0xa34d721642b06084ULL, 0x27f002d7f95d0190ULL,
+    0xcc20ce9bd35c78a5ULL, 0x31ec038df7b441f4ULL,
+    0xff290242c83396ceULL, 0x7e67047175a15271ULL,
+    0x9f79a169bd203e41ULL, 0x0f0062c6e984d386ULL,
+    0xc75809c42c684dd1ULL, 0x52c07b78a3e60868ULL,
+    0xf92e0c3537826145ULL, 0xa7709a56ccdf8a82ULL,
+    0x9bbcc7a142b17ccbULL, 0x88a66076400bb691ULL,
+    0xc2abf989935ddbfeULL, 0x6acff893d00ea435ULL,
+    0xf356f7ebf83552feULL, 0x0583f6b8c4124d43ULL,
+    0x98165af37b2153deULL, 0xc3727a337a8b704aULL,
+    0xbe1bf1b059e9a8d6ULL, 0x744f18c0592e4c5cULL,
+    0xeda2ee1c7064130cULL, 0x1162def06f79df73ULL,
+    0x9485d4d1c63e8be7ULL, 0x8addcb5645ac2ba8ULL,
+    0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173692ULL,
+    0xe8111c87c5c1ba99ULL, 0xc8fa8db6ccdd0437ULL,
+    0x910ab1d4db9914a0ULL, 0x1d9c9892400a22a2ULL,
+    0xb54d5e4a127f59c8ULL, 0x2503beb6d00cab4bULL,
+    0xe2a0b5dc971f303aULL, 0x2e44ae64840fd61dULL,
+    0x8da471a9de737e24ULL, 0x5ceaecfed289e5d2ULL,
+    0xb10d8e1456105dadULL, 0x7425a83e872c5f47ULL,
+    0xdd50f1996b947518ULL, 0xd12f124e28f77719ULL,
+    0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa6fULL,
+    0xace73cbfdc0bfb7bULL, 0x636cc64d1001550bULL,
+    0xd8210befd30efa5aULL, 0x3c47f7e05401aa4eULL,
+    0x8714a775e3e95c78ULL, 0x65acfaec34810a71ULL,
+    0xa8d9d1535ce3b396ULL, 0x7f1839a741a14d0dULL,
+    0xd31045a8341ca07cULL, 0x1ede48111209a050ULL,
+    0x83ea2b892091e44dULL, 0x934aed0aab460432ULL,
+    0xa4e4b66b68b65d60ULL, 0xf81da84d5617853fULL,
+    0xce1de40642e3f4b9ULL, 0x36251260ab9d668eULL,
+    0x80d2ae83e9ce78f3ULL, 0xc1d72b7c6b426019ULL,
+    0xa1075a24e4421730ULL, 0xb24cf65b8612f81fULL,
+    0xc94930ae1d529cfcULL, 0xdee033f26797b627ULL,
+    0xfb9b7cd9a4a7443cULL, 0x169840ef017da3b1ULL,
+    0x9d412e0806e88aa5ULL, 0x8e1f289560ee864eULL,
+    0xc491798a08a2ad4eULL, 0xf1a6f2bab92a27e2ULL,
+    0xf5b5d7ec8acb58a2ULL, 0xae10af696774b1dbULL,
+    0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL,
+    0xbff610b0cc6edd3fULL, 0x17fd090a58d32af3ULL,
+    0xeff394dcff8a948eULL, 0xddfc4b4cef07f5b0ULL,
+    0x95f83d0a1fb69cd9ULL, 0x4abdaf101564f98eULL,
+    0xbb764c4ca7a4440fULL, 0x9d6d1ad41abe37f1ULL,
+    0xea53df5fd18d5513ULL, 0x84c86189216dc5edULL,
+    0x92746b9be2f8552cULL, 0x32fd3cf5b4e49bb4ULL,
+    0xb7118682dbb66a77ULL, 0x3fbc8c33221dc2a1ULL,
+    0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL,
+    0x8f05b1163ba6832dULL, 0x29cb4d87f2a7400eULL,
+    0xb2c71d5bca9023f8ULL, 0x743e20e9ef511012ULL,
+    0xdf78e4b2bd342cf6ULL, 0x914da9246b255416ULL,
+    0x8bab8eefb6409c1aULL, 0x1ad089b6c2f7548eULL,
+    0xae9672aba3d0c320ULL, 0xa184ac2473b529b1ULL,
+    0xda3c0f568cc4f3e8ULL, 0xc9e5d72d90a2741eULL,
+    0x8865899617fb1871ULL, 0x7e2fa67c7a658892ULL,
+    0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab7ULL,
+    0xd51ea6fa85785631ULL, 0x552a74227f3ea565ULL,
+    0x8533285c936b35deULL, 0xd53a88958f87275fULL,
+    0xa67ff273b8460356ULL, 0x8a892abaf368f137ULL,
+    0xd01fef10a657842cULL, 0x2d2b7569b0432d85ULL,
+    0x8213f56a67f6b29bULL, 0x9c3b29620e29fc73ULL,
+    0xa298f2c501f45f42ULL, 0x8349f3ba91b47b8fULL,
+    0xcb3f2f7642717713ULL, 0x241c70a936219a73ULL,
+    0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0110ULL,
+    0x9ec95d1463e8a506ULL, 0xf4363804324a40aaULL,
+    0xc67bb4597ce2ce48ULL, 0xb143c6053edcd0d5ULL,
+    0xf81aa16fdc1b81daULL, 0xdd94b7868e94050aULL,
+    0x9b10a4e5e9913128ULL, 0xca7cf2b4191c8326ULL,
+    0xc1d4ce1f63f57d72ULL, 0xfd1c2f611f63a3f0ULL,
+    0xf24a01a73cf2dccfULL, 0xbc633b39673c8cecULL,
+    0x976e41088617ca01ULL, 0xd5be0503e085d813ULL,
+    0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e18ULL,
+    0xec9c459d51852ba2ULL, 0xddf8e7d60ed1219eULL,
+    0x93e1ab8252f33b45ULL, 0xcabb90e5c942b503ULL,
+    0xb8da1662e7b00a17ULL, 0x3d6a751f3b936243ULL,
+    0xe7109bfba19c0c9dULL, 0x0cc512670a783ad4ULL,
+    0x906a617d450187e2ULL, 0x27fb2b80668b24c5ULL,
+    0xb484f9dc9641e9daULL, 0xb1f9f660802dedf6ULL,
+    0xe1a63853bbd26451ULL, 0x5e7873f8a0396973ULL,
+    0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL,
+    0xb049dc016abc5e5fULL, 0x91ce1a9a3d2cda62ULL,
+    0xdc5c5301c56b75f7ULL, 0x7641a140cc7810fbULL,
+    0x89b9b3e11b6329baULL, 0xa9e904c87fcb0a9dULL,
+    0xac2820d9623bf429ULL, 0x546345fa9fbdcd44ULL,
+    0xd732290fbacaf133ULL, 0xa97c177947ad4095ULL,
+    0x867f59a9d4bed6c0ULL, 0x49ed8eabcccc485dULL,
+    0xa81f301449ee8c70ULL, 0x5c68f256bfff5a74ULL,
+    0xd226fc195c6a2f8cULL, 0x73832eec6fff3111ULL,
+    0x83585d8fd9c25db7ULL, 0xc831fd53c5ff7eabULL,
+    0xa42e74f3d032f525ULL, 0xba3e7ca8b77f5e55ULL,
+    0xcd3a1230c43fb26fULL, 0x28ce1bd2e55f35ebULL,
+    0x80444b5e7aa7cf85ULL, 0x7980d163cf5b81b3ULL,
+    0xa0555e361951c366ULL, 0xd7e105bcc332621fULL,
+    0xc86ab5c39fa63440ULL, 0x8dd9472bf3fefaa7ULL,
+    0xfa856334878fc150ULL, 0xb14f98f6f0feb951ULL,
+    0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL,
+    0xc3b8358109e84f07ULL, 0x0a862f80ec4700c8ULL,
+    0xf4a642e14c6262c8ULL, 0xcd27bb612758c0faULL,
+    0x98e7e9cccfbd7dbdULL, 0x8038d51cb897789cULL,
+    0xbf21e44003acdd2cULL, 0xe0470a63e6bd56c3ULL,
+    0xeeea5d5004981478ULL, 0x1858ccfce06cac74ULL,
+    0x95527a5202df0ccbULL, 0x0f37801e0c43ebc8ULL,
+    0xbaa718e68396cffdULL, 0xd30560258f54e6baULL,
+    0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL,
+    0x91d28b7416cdd27eULL, 0x4cdc331d57fa5441ULL,
+    0xb6472e511c81471dULL, 0xe0133fe4adf8e952ULL,
+    0xe3d8f9e563a198e5ULL, 0x58180fddd97723a6ULL,
+    0x8e679c2f5e44ff8fULL, 0x570f09eaa7ea7648ULL,
+};
 
-GET_NUMBER_c(value_int, VALUE_INT, json_int_t*, )
-GET_NUMBER_c(value_llu, VALUE_LLU, json_uint_t *, )
-GET_NUMBER_c(value_double, VALUE_DOUBLE, double*, )
-GET_NUMBER_c(value_bool, VALUE_BOOL, bool*, )
+static const double _exact_powers_of_ten[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                              1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                              1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
 
-GET_ARRAY_VALUE_c(value_char_p, VALUE_STR, const char**)
-GET_ARRAY_VALUE_c(value_int, VALUE_INT, json_int_t*)
-GET_ARRAY_VALUE_c(value_llu, VALUE_LLU, json_uint_t*)
-GET_ARRAY_VALUE_c(value_double, VALUE_DOUBLE, double*)
-GET_ARRAY_VALUE_c(value_bool, VALUE_BOOL, bool*)
-GET_ARRAY_VALUE_c(value_child_p, VALUE_ITEM, JsonItem**)
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wextra-semi"
-; // ensure clang-format works when turned on again
-#pragma clang diagnostic pop
-                                                                                  // clang-format on
+static inline bool _is_digit(const char c) { return (c >= '0') && (c <= '9'); }
 
-#ifdef TEST
-void test_logger(void)
+static inline uint64_t _load_eight_chars(const char* char_p)
 {
-    PRINT_BANNER()
-    PRINT_TEST_TITLE("Logging all levels");
-    PRINT_SEPARATOR();
-    LOG_TRACE("Log trace.");
-    LOG_DEBUG("Log debug.");
-    LOG_INFO("Log info.");
-    LOG_WARNING("Log warning.");
-    LOG_ERROR("Log error.");
+    uint64_t val;
+    memcpy(&val, char_p, sizeof(val));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    val = __builtin_bswap64(val);
+#endif
+    return val;
 }
 
-static char* load_file_alloc(char* filename)
+static inline bool _is_eight_digits(uint64_t val)
 {
-    FILE* json_file = fopen(filename, "r");
-    if (json_file == NULL)
+    return (((val & 0xF0F0F0F0F0F0F0F0ULL)
+              | (((val + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4))
+             == 0x3333333333333333ULL);
+}
+
+static inline uint64_t _parse_eight_digits(uint64_t val)
+{
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 0x000F424000000064ULL; // 100 + (1000000 << 32)
+    const uint64_t mul2 = 0x0000271000000001ULL; // 1 + (10000 << 32)
+    val -= 0x3030303030303030ULL;
+    val = (val * 10) + (val >> 8);
+    val = (((val & mask) * mul1) + (((val >> 16) & mask) * mul2)) >> 32;
+    return val & 0xFFFFFFFFULL;
+}
+
+// Accumulate the digits starting at `*char_pp` into `*value_p`, which wraps around on overflow.
+static inline void _parse_digits(const char** char_pp, const char* end_p, uint64_t* value_p)
+{
+    const char* char_p = *char_pp;
+    uint64_t value     = *value_p;
+    while ((end_p - char_p >= 8) && _is_eight_digits(_load_eight_chars(char_p)))
     {
-        LOG_PERROR("Could not read file");
+        value = value * 100000000ULL + _parse_eight_digits(_load_eight_chars(char_p));
+        char_p += 8;
     }
-    int c;
-    size_t chars_read = 0;
-    size_t size       = 4096;
-    char* ret_str     = malloc(size);
-    if (ret_str == NULL)
+    while ((char_p < end_p) && _is_digit(*char_p))
     {
-        LOG_PERROR("out of memory");
-        exit(1);
+        value = value * 10 + (uint64_t)(*char_p - '0');
+        char_p++;
     }
-    while ((c = fgetc(json_file)) != EOF)
+    *char_pp = char_p;
+    *value_p = value;
+}
+
+static inline JsonUint128 _full_multiplication(uint64_t a, uint64_t b)
+{
+    JsonUint128 result;
+#if defined(__SIZEOF_INT128__)
+    const json_uint128_t product = (json_uint128_t)a * b;
+    result.low                   = (uint64_t)product;
+    result.high                  = (uint64_t)(product >> 64);
+#else
+    const uint64_t a_lo = (uint32_t)a, a_hi = a >> 32, b_lo = (uint32_t)b, b_hi = b >> 32;
+    const uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi;
+    const uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+    result.high          = a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+    result.low           = (cross << 32) | (uint32_t)lo_lo;
+#endif /* __SIZEOF_INT128__ */
+    return result;
+}
+
+// Eisel-Lemire: compute w * 10^q correctly rounded, for w != 0. Return false when the 128-bit
+// approximation of 5^q is not accurate enough to decide the rounding.
+static bool _compute_double(int64_t q, uint64_t w, uint64_t* bits_p)
+{
+    if (q < JSON_SMALLEST_POWER_OF_TEN)
     {
-        if (chars_read >= size - 1)
+        *bits_p = 0;
+        return true;
+    }
+    if (q > JSON_LARGEST_POWER_OF_TEN)
+    {
+        *bits_p = 0x7FFULL << JSON_MANTISSA_BITS;
+        return true;
+    }
+    const int lz = __builtin_clzll(w);
+    w <<= lz;
+    const size_t index    = 2 * (size_t)(q - JSON_SMALLEST_POWER_OF_TEN);
+    JsonUint128 product   = _full_multiplication(w, _power_of_five_128[index]);
+    const uint64_t precision_mask = 0xFFFFFFFFFFFFFFFFULL >> (JSON_MANTISSA_BITS + 3);
+    if ((product.high & precision_mask) == precision_mask)
+    {
+        // Not enough bits yet: add the contribution of the lower half of 5^q.
+        const JsonUint128 second = _full_multiplication(w, _power_of_five_128[index + 1]);
+        product.low += second.high;
+        if (second.high > product.low)
         {
-            /* time to make it bigger */
-            size    = (size_t)(size * 1.5);
-            ret_str = realloc(ret_str, size);
-            if (ret_str == NULL)
-            {
-                LOG_PERROR("out of memory");
-                exit(1);
-            }
+            product.high++;
+        }
+        // Only when 5^q fits in 128 bits (or its reciprocal is exact) is this always accurate.
+        if ((product.low == 0xFFFFFFFFFFFFFFFFULL) && ((q < -27) || (q > 55)))
+        {
+            return false;
         }
-        ret_str[chars_read++] = c;
     }
-    ret_str[chars_read++] = '\0';
-    fclose(json_file);
-    return ret_str;
+    const int upperbit = (int)(product.high >> 63);
+    const int shift    = upperbit + 64 - JSON_MANTISSA_BITS - 3;
+    uint64_t mantissa  = product.high >> shift;
+    // floor(q * log2(10)) + 63, then biased with the minimum exponent (-1023).
+    int64_t power2 = ((((152170 + 65536) * q) >> 16) + 63) + upperbit - lz + 1023;
+    if (power2 <= 0)
+    {
+        // Subnormal.
+        if (-power2 + 1 >= 64)
+        {
+            *bits_p = 0;
+            return true;
+        }
+        mantissa >>= -power2 + 1;
+        mantissa += (mantissa & 1);
+        mantissa >>= 1;
+        power2  = (mantissa < (1ULL << JSON_MANTISSA_BITS)) ? 0 : 1;
+        *bits_p = (mantissa & ((1ULL << JSON_MANTISSA_BITS) - 1))
+                  | ((uint64_t)power2 << JSON_MANTISSA_BITS);
+        return true;
+    }
+    // Halfway between two doubles: round to even instead of up.
+    if ((product.low <= 1) && (q >= -4) && (q <= 23) && ((mantissa & 3) == 1)
+        && ((mantissa << shift) == product.high))
+    {
+        mantissa &= ~1ULL;
+    }
+    mantissa += (mantissa & 1);
+    mantissa >>= 1;
+    if (mantissa >= (2ULL << JSON_MANTISSA_BITS))
+    {
+        mantissa = 1ULL << JSON_MANTISSA_BITS;
+        power2++;
+    }
+    mantissa &= ~(1ULL << JSON_MANTISSA_BITS);
+    if (power2 >= 0x7FF)
+    {
+        *bits_p = 0x7FFULL << JSON_MANTISSA_BITS;
+        return true;
+    }
+    *bits_p = mantissa | ((uint64_t)power2 << JSON_MANTISSA_BITS);
+    return true;
 }
 
-void test_json_deserializer(void)
+// Slow path: hand the number to `strtod`, which needs a null-terminated copy.
+static Error _strtod_fallback(const char* start_p, size_t len, json_decimal_t* out_p)
 {
-    PRINT_BANNER();
-    PRINT_TEST_TITLE("Validate tokens")
+    char stack_buff[128];
+    char* buff = (len < sizeof(stack_buff)) ? stack_buff : malloc(len + 1);
+    if (buff == NULL)
     {
-        { // TODO: this should fail
-            char json_char_p[] = "{[}]";
-            ASSERT_OK(_validate_tokens(json_char_p), "Valid JSON");
+        LOG_PERROR("Out of memory");
+        return ERR_FATAL;
+    }
+    memcpy(buff, start_p, len);
+    buff[len]    = '\0';
+    char* end_p  = NULL;
+    *out_p       = strtod(buff, &end_p);
+    Error result = ((size_t)(end_p - buff) == len) ? ERR_ALL_GOOD : ERR_PARSE_STRING_TO_DOUBLE;
+    if (buff != stack_buff)
+    {
+        free(buff);
+    }
+    return result;
+}
+
+// Parse the number starting at `*curr_pos_pp` and leave `*curr_pos_pp` right after it. Integers
+// become VALUE_LLU, or VALUE_INT when negative, and anything with a fraction or an exponent becomes
+// VALUE_DOUBLE.
+static Error _deserialize_number(const char** curr_pos_pp, const char* end_p, JsonValue* value_p)
+{
+    const char* start_p = *curr_pos_pp;
+    const char* char_p  = start_p;
+    const bool negative = (char_p < end_p) && (*char_p == '-');
+    if ((char_p < end_p) && ((*char_p == '-') || (*char_p == '+')))
+    {
+        char_p++;
+    }
+    const char* int_start_p = char_p;
+    uint64_t w              = 0;
+    _parse_digits(&char_p, end_p, &w);
+    const char* int_end_p = char_p;
+    if (int_end_p == int_start_p)
+    {
+        LOG_ERROR("Unexpected character `%c`", *start_p);
+        return ERR_JSON_INVALID;
+    }
+    int64_t exponent           = 0;
+    const char* frac_start_p   = NULL;
+    bool is_decimal            = false;
+    if ((char_p < end_p) && (*char_p == '.'))
+    {
+        is_decimal   = true;
+        frac_start_p = ++char_p;
+        _parse_digits(&char_p, end_p, &w);
+        exponent = frac_start_p - char_p;
+        if (char_p == frac_start_p)
+        {
+            LOG_ERROR("Missing digits after the decimal point");
+            return ERR_PARSE_STRING_TO_DOUBLE;
         }
+    }
+    const char* digits_end_p = char_p;
+    int64_t exp_number       = 0;
+    if ((char_p < end_p) && ((*char_p == 'e') || (*char_p == 'E')))
+    {
+        is_decimal         = true;
+        bool exp_negative  = false;
+        char_p++;
+        if ((char_p < end_p) && ((*char_p == '-') || (*char_p == '+')))
         {
-            char json_char_p[] = "{[][[]]{}{{}}}";
-            ASSERT_OK(_validate_tokens(json_char_p), "Valid JSON");
+            exp_negative = (*char_p == '-');
+            char_p++;
         }
+        const char* exp_start_p = char_p;
+        while ((char_p < end_p) && _is_digit(*char_p))
         {
-            char json_char_p[] = "{";
-            ASSERT_ERR(_validate_tokens(json_char_p), "Missing }.");
+            // Saturate: anything this large is 0 or infinity anyway.
+            if (exp_number < 0x10000000)
+            {
+                exp_number = 10 * exp_number + (*char_p - '0');
+            }
+            char_p++;
         }
+        if (char_p == exp_start_p)
         {
-            char json_char_p[] = "}";
-            ASSERT_ERR(_validate_tokens(json_char_p), "Extra }.");
+            LOG_ERROR("Missing digits in the exponent");
+            return ERR_PARSE_STRING_TO_DOUBLE;
         }
+        exp_number = exp_negative ? -exp_number : exp_number;
+        exponent += exp_number;
+    }
+    *curr_pos_pp = char_p;
+
+    // Count the significant digits, ignoring leading zeros.
+    size_t digit_count       = (size_t)(int_end_p - int_start_p);
+    const char* first_digit_p = int_start_p;
+    while ((first_digit_p < int_end_p) && (*first_digit_p == '0'))
+    {
+        first_digit_p++;
+        digit_count--;
+    }
+    if (frac_start_p != NULL)
+    {
+        digit_count += (size_t)(digits_end_p - frac_start_p);
+        if (first_digit_p == int_end_p)
         {
-            char json_char_p[] = "[}";
-            ASSERT_ERR(_validate_tokens(json_char_p), "Extra }.");
+            first_digit_p = frac_start_p;
+            while ((first_digit_p < digits_end_p) && (*first_digit_p == '0'))
+            {
+                first_digit_p++;
+                digit_count--;
+            }
         }
+    }
+
+    if (!is_decimal)
+    {
+        uint64_t magnitude      = w;
+        const size_t max_digits = JSON_MAX_EXACT_DIGITS + 1;
+        if (digit_count == max_digits)
         {
-            char json_char_p[] = "[";
-            ASSERT_ERR(_validate_tokens(json_char_p), "Missing ].");
+            // 20 digits: recompute the first 19 safely and check the last step.
+            magnitude = 0;
+            const char* digit_p = first_digit_p;
+            _parse_digits(&digit_p, int_end_p - 1, &magnitude);
+            if (__builtin_mul_overflow(magnitude, 10, &magnitude)
+                || __builtin_add_overflow(magnitude, (uint64_t)(*digit_p - '0'), &magnitude))
+            {
+                digit_count = max_digits + 1;
+            }
         }
+        if (negative)
         {
-            char json_char_p[] = "]";
-            ASSERT_ERR(_validate_tokens(json_char_p), "Extra ].");
+            if ((digit_count > max_digits) || (magnitude > (uint64_t)INT64_MAX + 1))
+            {
+                LOG_ERROR("Integer overflow");
+                return ERR_PARSE_STRING_TO_INT;
+            }
+            value_p->value_type = VALUE_INT;
+            value_p->value_int  = (json_int_t)(0 - magnitude);
+            LOG_TRACE("Found value %lld", value_p->value_int);
         }
+        else
         {
-            char json_char_p[] = "{]";
-            ASSERT_ERR(_validate_tokens(json_char_p), "Extra ].");
+            if (digit_count > max_digits)
+            {
+                LOG_ERROR("LLU overflow");
+                return ERR_PARSE_STRING_TO_LLU;
+            }
+            value_p->value_type = VALUE_LLU;
+            value_p->value_llu  = magnitude;
+            LOG_TRACE("Found LLU value %llu", value_p->value_llu);
         }
+        return ERR_ALL_GOOD;
     }
-    PRINT_TEST_TITLE("Empty object")
+
+    bool truncated = false;
+    if (digit_count > JSON_MAX_EXACT_DIGITS)
     {
-        JsonObj json_obj;
-        JsonItem* json_item_p;
-        const char* json_char_p = "{}";
-        json_int_t a;
-        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Empty JSON created");
-        ASSERT_ERR(Json_get(&json_obj, "missing key", &json_item_p), "Fix NULL on key");
-        ASSERT_ERR(Json_get(&json_obj, "missing key", &a), "Fix NULL on key");
-        JsonObj_destroy(&json_obj);
+        // Keep the first 19 significant digits and move the rest into the exponent.
+        truncated              = true;
+        w                      = 0;
+        const char* digit_p    = first_digit_p;
+        const uint64_t min_w   = 1000000000000000000ULL;
+        while ((w < min_w) && (digit_p < int_end_p))
+        {
+            w = 10 * w + (uint64_t)(*digit_p++ - '0');
+        }
+        if (w >= min_w)
+        {
+            exponent = (int_end_p - digit_p) + exp_number;
+        }
+        else
+        {
+            digit_p = (digit_p < frac_start_p) ? frac_start_p : digit_p;
+            while ((w < min_w) && (digit_p < digits_end_p))
+            {
+                w = 10 * w + (uint64_t)(*digit_p++ - '0');
+            }
+            exponent = (frac_start_p - digit_p) + exp_number;
+        }
     }
-    PRINT_TEST_TITLE("Wrong object")
+
+    json_decimal_t parsed_double = 0.0;
+    if (w != 0)
     {
-        JsonObj json_obj;
-        const char* json_char_p = "{:}";
-        ASSERT_ERR(JsonObj_new(json_char_p, &json_obj), "Invalid JSON");
+        uint64_t bits    = 0;
+        uint64_t bits_up = 0;
+        if (!truncated && (exponent >= -22) && (exponent <= 22) && (w <= (1ULL << 53)))
+        {
+            // Clinger: both operands are exact, so is the correctly rounded result.
+            parsed_double = (json_decimal_t)w;
+            parsed_double = (exponent < 0) ? parsed_double / _exact_powers_of_ten[-exponent]
+                                           : parsed_double * _exact_powers_of_ten[exponent];
+        }
+        else if (
+            _compute_double(exponent, w, &bits)
+            && (!truncated
+                || (_compute_double(exponent, w + 1, &bits_up) && (bits_up == bits))))
+        {
+            // When digits were dropped, both bounds must round to the same double.
+            memcpy(&parsed_double, &bits, sizeof(bits));
+        }
+        else
+        {
+            return_on_err(_strtod_fallback(
+                int_start_p, (size_t)(char_p - int_start_p), &parsed_double));
+        }
     }
-    PRINT_TEST_TITLE("Empty nested object")
+    value_p->value_type   = VALUE_DOUBLE;
+    value_p->value_double = negative ? -parsed_double : parsed_double;
+    LOG_TRACE("Found value %lf", value_p->value_double);
+    return ERR_ALL_GOOD;
+}
+
+// Read the literal or number starting at `curr_pos_p` into `value_p`.
+static inline Error _deserialize_scalar(
+    const char* curr_pos_p,
+    const char* end_p,
+    JsonValue* value_p)
+{
+    switch (*curr_pos_p)
     {
-        JsonObj json_obj;
-        const char* value_str;
-        const char* json_char_p = "{\"key\":{}}";
-        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Empty nested JSON");
-        ASSERT_ERR(Json_get(&json_obj, "key", &value_str), "Key found but value cannot be retrieved");
-        JsonObj_destroy(&json_obj);
-    }
-    PRINT_TEST_TITLE("Key-value pair");
+    case 't':
     {
-        JsonObj json_obj;
-        const char* value_str;
-        const char* json_char_p = " {\"key\": \"value string\"}";
-        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
-        Json_get(&json_obj, "key", &value_str);
-        ASSERT_EQ("value string", value_str, "Key for root found with correct value STRING");
-        ASSERT_ERR(Json_get(&json_obj, "missing key", &value_str), "Missing key detected.");
-        ASSERT_EQ(value_str == NULL, true, "Returned null due to missing key.");
-        JsonObj_destroy(&json_obj);
+        if ((end_p - curr_pos_p < 4) || (strncmp(curr_pos_p, "true", 4) != 0)
+            || !_is_scalar_end(curr_pos_p + 4, end_p))
+        {
+            LOG_ERROR("Invalid literal");
+            return ERR_JSON_INVALID;
+        }
+        value_p->value_type = VALUE_BOOL;
+        value_p->value_bool = true;
+        LOG_TRACE("Found value TRUE");
+        return ERR_ALL_GOOD;
     }
-    PRINT_TEST_TITLE("Sibling key-value pair");
+    case 'f':
     {
-        JsonObj json_obj;
-        const char* value_str;
-        json_uint_t value_llu;
-        const char* json_char_p = " {\"key\": \"value string\", \"sibling\": 56}";
-        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
-        Json_get(&json_obj, "key", &value_str);
-        Json_get(&json_obj, "sibling", &value_llu);
-        ASSERT_EQ("value string", value_str, "Key for root value STRING");
-        ASSERT_EQ(56, value_llu, "Key for root found with correct value INT");
-        JsonObj_destroy(&json_obj);
+        if ((end_p - curr_pos_p < 5) || (strncmp(curr_pos_p, "false", 5) != 0)
+            || !_is_scalar_end(curr_pos_p + 5, end_p))
+        {
+            LOG_ERROR("Invalid literal");
+            return ERR_JSON_INVALID;
+        }
+        value_p->value_type = VALUE_BOOL;
+        value_p->value_bool = false;
+        LOG_TRACE("Found value FALSE");
+        return ERR_ALL_GOOD;
     }
-    PRINT_TEST_TITLE("Simple array");
+    default:
     {
-        JsonObj json_obj;
-        const char* value_str;
-        json_uint_t value_llu;
-        JsonArray* json_array;
-        const char* json_char_p = " {\"key\": [\"array value\", 56]}";
-        printf("\n%s\n", json_char_p);
-        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
-        Json_get(&json_obj, "key", &json_array);
-        Json_get(json_array, 0, &value_str);
-        ASSERT_EQ("array value", value_str, "Array STRING element retrieved.");
-        Json_get(json_array, 1, &value_llu);
-        ASSERT_EQ(56, value_llu, "Array LLU element retrieved.");
-        JsonObj_destroy(&json_obj);
+        return_on_err(_deserialize_number(&curr_pos_p, end_p, value_p));
+        if (!_is_scalar_end(curr_pos_p, end_p))
+        {
+            LOG_ERROR("Unexpected character `%c` after number", *curr_pos_p);
+            return ERR_JSON_INVALID;
+        }
+        return ERR_ALL_GOOD;
     }
-    PRINT_TEST_TITLE("Array of objects");
-    {
-        JsonObj json_obj;
-        JsonItem* json_item;
-        json_uint_t value_llu;
-        JsonArray* json_array;
-        const char* json_char_p = " {\"key\": [ {\"array key\": 56}]}";
-        printf("\n%s\n", json_char_p);
-        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
-        Json_get(&json_obj, "key", &json_array);
-        Json_get(json_array, 0, &json_item);
-        ASSERT_EQ(json_item->key_p, "array key", "Array STRING element retrieved.");
-        printf("%d\n", json_item->value.value_type);
-        Json_get(json_item, "array key", &value_llu);
-        ASSERT_EQ(value_llu, 56, "Value found an item that is also array element.");
-        JsonObj_destroy(&json_obj);
     }
-    PRINT_TEST_TITLE("object and array");
+}
+
+// ---------- Tree building ----------
+// Shared by `_deserialize` and the streaming parser.
+
+// Turn `item_p` into an object or an array, according to `value_type`, and return its first child.
+static inline JsonItem* _open_container(
+    JsonArena* arena_p,
+    JsonItemStack* element_stack_p,
+    JsonItem* item_p,
+    ValueType value_type)
+{
+    JsonItem* new_item = JsonItem_new(arena_p);
+    if ((new_item == NULL)
+        || ((value_type == VALUE_ARRAY) && is_err(_JsonItemStack_push(element_stack_p, new_item))))
+    {
+        return NULL;
+    }
+    new_item->parent            = item_p;
+    item_p->value.value_type    = value_type;
+    item_p->value.value_child_p = new_item;
+    return new_item;
+}
+
+// Add a child to `container_p` after `last_item_p`, its current last child.
+static inline JsonItem* _append_sibling(
+    JsonArena* arena_p,
+    JsonItemStack* element_stack_p,
+    JsonItem* container_p,
+    JsonItem* last_item_p)
+{
+    JsonItem* new_item = JsonItem_new(arena_p);
+    if (new_item == NULL)
+    {
+        return NULL;
+    }
+    new_item->parent          = container_p;
+    last_item_p->next_sibling = new_item;
+    if (container_p->value.value_type == VALUE_ARRAY)
+    {
+        if (is_err(_JsonItemStack_push(element_stack_p, new_item)))
+        {
+            return NULL;
+        }
+        new_item->index = last_item_p->index + 1;
+    }
+    else
+    {
+        // Members are counted on the first one until the object is closed.
+        container_p->value.value_child_p->index++;
+    }
+    return new_item;
+}
+
+// Build the JsonArray of a closed array, or the key table of a closed large object.
+static inline Error _close_container(
+    JsonArena* arena_p,
+    JsonItemStack* element_stack_p,
+    JsonItem* container_p,
+    const JsonItem* last_item_p)
+{
+    if (container_p->value.value_type == VALUE_ARRAY)
+    {
+        return _JsonArray_build(arena_p, container_p, element_stack_p, last_item_p->index + 1);
+    }
+    JsonItem* first_item_p    = container_p->value.value_child_p;
+    const size_t num_of_items = first_item_p->index + 1;
+    first_item_p->key_table_p = NULL;
+    if (num_of_items >= JSON_KEY_TABLE_MIN_ITEMS)
+    {
+        return _JsonKeyTable_build(arena_p, first_item_p, num_of_items);
+    }
+    return ERR_ALL_GOOD;
+}
+
+// Where `_deserialize_range` stopped. The state is EXPECT_END once the root object is closed.
+typedef struct
+{
+    const uint32_t* pos_p;
+    JsonItem* container_p;
+    JsonItem* curr_item_p;
+    ParserState state;
+} JsonCursor;
+
+// Walk the structural index from `cursor_p` until `pos_end_p` or the end of the root object, and
+// build the tree hanging from `root_p`. Strings and keys are null-terminated in place, so the buffer
+// must outlive the tree. Brackets are matched against the container being filled, which is tracked
+// through the `parent` pointers, hence no recursion and no auxiliary stack are needed.
+static Error _deserialize_range(
+    JsonArena* arena_p,
+    JsonItemStack* element_stack_p,
+    JsonItem* root_p,
+    char* json_string,
+    const char* end_p,
+    JsonCursor* cursor_p,
+    const uint32_t* pos_end_p)
+{
+    const uint32_t* pos_p = cursor_p->pos_p;
+    JsonItem* container_p = cursor_p->container_p;
+    JsonItem* curr_item_p = cursor_p->curr_item_p;
+    ParserState state     = cursor_p->state;
+    while (pos_p != pos_end_p)
+    {
+        char* curr_pos_p = &json_string[*pos_p];
+        if (state == EXPECT_KEY)
+        {
+            if (*curr_pos_p != '"')
+            {
+                LOG_ERROR("Expected key, found `%c`", *curr_pos_p);
+                return ERR_JSON_INVALID;
+            }
+            return_on_err(
+                _terminate_str(json_string, pos_p, &curr_item_p->key_p, &curr_item_p->key_len));
+            LOG_TRACE("Found key: \"%s\"", curr_item_p->key_p);
+            pos_p += 2;
+            if ((pos_p == pos_end_p) || (json_string[*pos_p] != ':'))
+            {
+                LOG_ERROR("Missing `:` after key \"%s\"", curr_item_p->key_p);
+                return ERR_JSON_INVALID;
+            }
+            pos_p++; // Skip the ':'.
+            state = EXPECT_VALUE;
+        }
+        else if (state == EXPECT_VALUE)
+        {
+            state = EXPECT_COMMA_OR_CLOSE;
+            pos_p++;
+            switch (*curr_pos_p)
+            {
+            case '{':
+            {
+                if ((pos_p < pos_end_p) && (json_string[*pos_p] == '}'))
+                {
+                    LOG_TRACE("Found empty object - skipping");
+                    pos_p++;
+                    break;
+                }
+                LOG_TRACE("Found new object");
+                JsonItem* new_item
+                    = _open_container(arena_p, element_stack_p, curr_item_p, VALUE_ITEM);
+                if (new_item == NULL)
+                {
+                    return ERR_FATAL;
+                }
+                container_p = curr_item_p;
+                curr_item_p = new_item;
+                state       = EXPECT_KEY;
+                break;
+            }
+            case '[':
+            {
+                LOG_TRACE("Found beginning of array.");
+                curr_item_p->value.value_type = VALUE_ARRAY;
+                if ((pos_p < pos_end_p) && (json_string[*pos_p] == ']'))
+                {
+                    pos_p++;
+                    return_on_err(_JsonArray_build(arena_p, curr_item_p, element_stack_p, 0));
+                    break;
+                }
+                JsonItem* new_item
+                    = _open_container(arena_p, element_stack_p, curr_item_p, VALUE_ARRAY);
+                if (new_item == NULL)
+                {
+                    return ERR_FATAL;
+                }
+                container_p = curr_item_p;
+                curr_item_p = new_item;
+                state       = EXPECT_VALUE;
+                break;
+            }
+            case '"':
+            {
+                curr_item_p->value.value_type = VALUE_STR;
+                return_on_err(_terminate_str(
+                    json_string,
+                    pos_p - 1,
+                    &curr_item_p->value.value_char_p,
+                    &curr_item_p->value.value_len));
+                pos_p++; // Skip the closing quote.
+                LOG_TRACE("Found value \"%s\"", curr_item_p->value.value_char_p);
+                break;
+            }
+            case ' ':
+            {
+                // An element left out by a projection, see _JsonProjector_drop_element.
+                LOG_TRACE("Found element left out - skipping");
+                break;
+            }
+            default:
+            {
+                return_on_err(_deserialize_scalar(curr_pos_p, end_p, &curr_item_p->value));
+                break;
+            }
+            }
+        }
+        else if (*curr_pos_p == ',')
+        {
+            curr_item_p = _append_sibling(arena_p, element_stack_p, container_p, curr_item_p);
+            if (curr_item_p == NULL)
+            {
+                return ERR_FATAL;
+            }
+            state = (container_p->value.value_type == VALUE_ARRAY) ? EXPECT_VALUE : EXPECT_KEY;
+            pos_p++;
+        }
+        else if ((*curr_pos_p == '}') || (*curr_pos_p == ']'))
+        {
+            if ((container_p->value.value_type == VALUE_ARRAY) != (*curr_pos_p == ']'))
+            {
+                LOG_ERROR("Mismatched `%c`", *curr_pos_p);
+                return ERR_JSON_INVALID;
+            }
+            return_on_err(_close_container(arena_p, element_stack_p, container_p, curr_item_p));
+            pos_p++;
+            if (container_p == root_p)
+            {
+                state = EXPECT_END;
+                break;
+            }
+            curr_item_p = container_p;
+            container_p = container_p->parent;
+        }
+        else
+        {
+            LOG_ERROR("Expected `,` or closing bracket, found `%c`", *curr_pos_p);
+            return ERR_JSON_INVALID;
+        }
+    }
+    cursor_p->pos_p       = pos_p;
+    cursor_p->container_p = container_p;
+    cursor_p->curr_item_p = curr_item_p;
+    cursor_p->state       = state;
+    return ERR_ALL_GOOD;
+}
+
+// Check that `first_char`, the first structural character of a document, opens the root object.
+// Shared by _deserialize and JsonParser.
+static Error _check_root(char first_char)
+{
+    if (first_char != '{')
+    {
+        // TODO: Handle case in which the JSON string starts with [{ (array of objects).
+        LOG_ERROR("Invalid JSON string.");
+        return ERR_JSON_INVALID;
+    }
+    return ERR_ALL_GOOD;
+}
+
+// Place `cursor_p` on the first member of the root object, whose `{` is the first position of
+// `index_p`.
+static Error _deserialize_begin(
+    JsonItem* root_p,
+    const char* json_string,
+    const JsonIndex* index_p,
+    JsonCursor* cursor_p)
+{
+    const uint32_t* pos_p     = index_p->positions;
+    const uint32_t* pos_end_p = index_p->positions + index_p->count;
+    return_on_err(_check_root((pos_p < pos_end_p) ? json_string[*pos_p] : '\0'));
+    pos_p++;
+    cursor_p->pos_p       = pos_p;
+    cursor_p->container_p = root_p;
+    cursor_p->curr_item_p = root_p->next_sibling;
+    // An empty root object is closed right away.
+    cursor_p->state = ((pos_p < pos_end_p) && (json_string[*pos_p] == '}')) ? EXPECT_COMMA_OR_CLOSE
+                                                                             : EXPECT_KEY;
+    return ERR_ALL_GOOD;
+}
+
+// Build the tree hanging from `root_p` by walking the structural index of `json_string` once.
+static Error _deserialize(
+    JsonArena* arena_p,
+    JsonItemStack* element_stack_p,
+    JsonItem* root_p,
+    char* json_string,
+    size_t len,
+    const JsonIndex* index_p)
+{
+    const uint32_t* pos_end_p = index_p->positions + index_p->count;
+    JsonCursor cursor;
+    return_on_err(_deserialize_begin(root_p, json_string, index_p, &cursor));
+    return_on_err(_deserialize_range(
+        arena_p, element_stack_p, root_p, json_string, json_string + len, &cursor, pos_end_p));
+    if (cursor.state != EXPECT_END)
+    {
+        LOG_ERROR("Unexpected end of JSON string");
+        return ERR_JSON_INVALID;
+    }
+    if (cursor.pos_p != pos_end_p)
+    {
+        LOG_ERROR("Unexpected characters after the root object");
+        return ERR_JSON_INVALID;
+    }
+    return ERR_ALL_GOOD;
+}
+
+static void _JsonObj_unmap(JsonObj* json_obj_p)
+{
+    if (json_obj_p->json_string_mapped_len > 0)
+    {
+        munmap(json_obj_p->json_string, json_obj_p->json_string_mapped_len);
+        json_obj_p->json_string            = NULL;
+        json_obj_p->json_string_mapped_len = 0;
+    }
+}
+
+// Forget the buffers of `json_obj_p` unless it has been passed to JsonObj_reset. A borrowed input
+// buffer is never recycled.
+static void _JsonObj_prepare(JsonObj* json_obj_p)
+{
+    if (json_obj_p->recycle_p != json_obj_p)
+    {
+        json_obj_p->json_string            = NULL;
+        json_obj_p->json_string_capacity   = 0;
+        json_obj_p->json_string_mapped_len = 0;
+        json_obj_p->arena.first_chunk_p    = NULL;
+        json_obj_p->arena.curr_chunk_p     = NULL;
+        json_obj_p->index.positions        = NULL;
+        json_obj_p->index.count            = 0;
+        json_obj_p->index.capacity         = 0;
+        json_obj_p->element_stack.items    = NULL;
+        json_obj_p->element_stack.capacity = 0;
+        json_obj_p->error_p                = NULL;
+    }
+    else if (json_obj_p->json_string_capacity == 0)
+    {
+        json_obj_p->json_string = NULL;
+    }
+    json_obj_p->element_stack.count    = 0;
+    json_obj_p->recycle_p              = NULL;
+    json_obj_p->parallel_scratch_bytes = 0;
+    json_obj_p->num_of_dropped_values  = 0;
+    json_obj_p->dropped_bytes          = 0;
+}
+
+// Create a dummy root item as the entry point of the JSON object. The first actual item is the
+// first sibling of root. This prevents root's value type from being overwritten, hence causing
+// errors. `json_obj_p` is NULL for a stand-in root that does not outlive the parse.
+static Error _init_root(JsonArena* arena_p, JsonItem* root_p, JsonObj* json_obj_p)
+{
+    root_p->key_p            = NULL;
+    root_p->key_len          = 0;
+    root_p->obj_p            = json_obj_p;
+    root_p->value.value_type = VALUE_ROOT;
+    root_p->parent           = root_p; // Set the parent to itself to recognize 'root'.
+    JsonItem* new_item          = JsonItem_new(arena_p);
+    root_p->next_sibling        = new_item;
+    root_p->value.value_child_p = new_item; // Lets the parser treat root as an object.
+    if (new_item == NULL)
+    {
+        return ERR_FATAL;
+    }
+    new_item->parent = root_p;
+    return ERR_ALL_GOOD;
+}
+
+static Error _JsonObj_init_root(JsonObj* json_obj_p)
+{
+    if (is_err(_init_root(&json_obj_p->arena, &json_obj_p->root, json_obj_p)))
+    {
+        JsonObj_destroy(json_obj_p);
+        return ERR_FATAL;
+    }
+    return ERR_ALL_GOOD;
+}
+
+// Parse the first `json_string_len` bytes of `json_obj_p->json_string`.
+static Error _JsonProjection_filter(const JsonProjection*, JsonObj*);
+
+// Index and deserialize the JSON string of `json_obj_p`. With a projection, the index is filtered
+// in between, so that the values left out are never built.
+static Error _JsonObj_parse(
+    JsonObj* json_obj_p,
+    size_t json_string_len,
+    const JsonProjection* projection_p)
+{
+    return_on_err(_JsonObj_init_root(json_obj_p));
+
+    LOG_DEBUG("JSON deserialization started.");
+    Error ret_res = _index_structurals(
+        _select_index_kernel(), json_obj_p->json_string, json_string_len, &json_obj_p->index);
+    if (is_ok(ret_res) && (projection_p != NULL))
+    {
+        ret_res = _JsonProjection_filter(projection_p, json_obj_p);
+    }
+    if (is_ok(ret_res))
+    {
+        ret_res = _deserialize(
+            &json_obj_p->arena,
+            &json_obj_p->element_stack,
+            &json_obj_p->root,
+            json_obj_p->json_string,
+            json_string_len,
+            &json_obj_p->index);
+    }
+    if (is_err(ret_res))
+    {
+        JsonObj_destroy(json_obj_p);
+        LOG_ERROR("Failed to deserialize JSON");
+        return (ret_res == ERR_FATAL) ? ERR_FATAL : ERR_JSON_INVALID;
+    }
+    LOG_DEBUG("JSON deserialization ended successfully.")
+
+    return ERR_ALL_GOOD;
+}
+
+Error JsonObj_new(
+    const char* json_string_p,
+    JsonObj* out_json_obj_p)
+{
+    return JsonObj_new_projected(json_string_p, NULL, out_json_obj_p);
+}
+
+// Same as JsonObj_new, but only the values selected by `projection_p` are built, see
+// JsonProjection_compile. Everything is built when `projection_p` is NULL.
+Error JsonObj_new_projected(
+    const char* json_string_p,
+    const JsonProjection* projection_p,
+    JsonObj* out_json_obj_p)
+{
+    _JsonObj_prepare(out_json_obj_p);
+    const size_t json_string_len = strlen(json_string_p);
+    if (json_string_len == 0)
+    {
+        JsonObj_destroy(out_json_obj_p);
+        LOG_ERROR("Empty JSON string detected");
+        return ERR_EMPTY_STRING;
+    }
+    // The only copy of the input: strings are null-terminated in place and point into it.
+    if (out_json_obj_p->json_string_capacity < json_string_len + 1)
+    {
+        char* json_string = realloc(out_json_obj_p->json_string, json_string_len + 1);
+        if (json_string == NULL)
+        {
+            JsonObj_destroy(out_json_obj_p);
+            LOG_PERROR("Out of memory");
+            return ERR_FATAL;
+        }
+        out_json_obj_p->json_string          = json_string;
+        out_json_obj_p->json_string_capacity = json_string_len + 1;
+    }
+    memcpy(out_json_obj_p->json_string, json_string_p, json_string_len + 1);
+    return _JsonObj_parse(out_json_obj_p, json_string_len, projection_p);
+}
+
+// Parse `len` bytes of `buf` without copying them. Strings and keys are null-terminated in place,
+// so `buf` is modified (even if parsing fails) and must outlive the JsonObj. `buf` does not need to
+// be null-terminated.
+Error JsonObj_new_insitu(
+    char* buf,
+    size_t len,
+    JsonObj* out_json_obj_p)
+{
+    _JsonObj_prepare(out_json_obj_p);
+    if ((buf == NULL) || (len == 0))
+    {
+        JsonObj_destroy(out_json_obj_p);
+        LOG_ERROR("Empty JSON string detected");
+        return ERR_EMPTY_STRING;
+    }
+    // A buffer kept by JsonObj_reset is of no use here.
+    free(out_json_obj_p->json_string);
+    out_json_obj_p->json_string          = buf;
+    out_json_obj_p->json_string_capacity = 0;
+    return _JsonObj_parse(out_json_obj_p, len, NULL);
+}
+
+// Map the file at `path` and parse it in place. The mapping is private: the null terminators
+// written by the parser go to copy-on-write pages and never reach the file.
+Error JsonObj_from_file(
+    const char* path,
+    JsonObj* out_json_obj_p)
+{
+    _JsonObj_prepare(out_json_obj_p);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        JsonObj_destroy(out_json_obj_p);
+        LOG_PERROR("Failed to open `%s`", path);
+        return ERR_INVALID;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0)
+    {
+        close(fd);
+        JsonObj_destroy(out_json_obj_p);
+        LOG_PERROR("Failed to read the size of `%s`", path);
+        return ERR_INVALID;
+    }
+    const size_t len = (size_t)file_stat.st_size;
+    if (len == 0)
+    {
+        close(fd);
+        JsonObj_destroy(out_json_obj_p);
+        LOG_ERROR("Empty JSON file `%s`", path);
+        return ERR_EMPTY_STRING;
+    }
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    flags |= MAP_POPULATE; // Fault the whole file in with one call.
+#endif /* MAP_POPULATE */
+    char* mapping_p = mmap(NULL, len, PROT_READ | PROT_WRITE, flags, fd, 0);
+    close(fd);
+    if (mapping_p == MAP_FAILED)
+    {
+        JsonObj_destroy(out_json_obj_p);
+        LOG_PERROR("Failed to map `%s`", path);
+        return ERR_FATAL;
+    }
+    madvise(mapping_p, len, MADV_SEQUENTIAL);
+    // A buffer kept by JsonObj_reset is of no use here.
+    free(out_json_obj_p->json_string);
+    out_json_obj_p->json_string            = mapping_p;
+    out_json_obj_p->json_string_capacity   = 0;
+    out_json_obj_p->json_string_mapped_len = len;
+    return _JsonObj_parse(out_json_obj_p, len, NULL);
+}
+
+// ---------- Streaming parser ----------
+// The input arrives in chunks of any size, so characters are classified one at a time and a token
+// may be split anywhere. The tree is built with the same steps as in `_deserialize`. The chunks do
+// not outlive `JsonParser_feed`, hence strings are copied into the arena.
+
+static Error _JsonParser_append_token(JsonParser* parser_p, const char* chunk_p, size_t len)
+{
+    if (parser_p->token_len + len > parser_p->token_capacity)
+    {
+        size_t capacity = (parser_p->token_capacity == 0) ? 64 : 2 * parser_p->token_capacity;
+        if (capacity < parser_p->token_len + len)
+        {
+            capacity = parser_p->token_len + len;
+        }
+        char* token = realloc(parser_p->token, capacity);
+        if (token == NULL)
+        {
+            LOG_PERROR("Out of memory");
+            return ERR_FATAL;
+        }
+        parser_p->token          = token;
+        parser_p->token_capacity = capacity;
+    }
+    memcpy(&parser_p->token[parser_p->token_len], chunk_p, len);
+    parser_p->token_len += len;
+    return ERR_ALL_GOOD;
+}
+
+// A key or a string value, without quotes.
+static Error _JsonParser_on_string(JsonParser* parser_p, const char* str_p, size_t len)
+{
+    // Lengths are stored on 32 bits, as are the offsets of the structural index.
+    if (len >= UINT32_MAX)
+    {
+        LOG_ERROR("String of %lu bytes too long", len);
+        return ERR_JSON_INVALID;
+    }
+    char* copy_p = _JsonArena_alloc(&parser_p->json_obj_p->arena, len + 1);
+    if (copy_p == NULL)
+    {
+        return ERR_FATAL;
+    }
+    memcpy(copy_p, str_p, len);
+    return_on_err(_decode_str(copy_p, len, &len));
+
+    JsonItem* curr_item_p = parser_p->curr_item_p;
+    parser_p->just_opened = false;
+    if (parser_p->state == EXPECT_KEY)
+    {
+        curr_item_p->key_p   = copy_p;
+        curr_item_p->key_len = (uint32_t)len;
+        LOG_TRACE("Found key: \"%s\"", curr_item_p->key_p);
+        parser_p->state = EXPECT_COLON;
+    }
+    else if (parser_p->state == EXPECT_VALUE)
+    {
+        curr_item_p->value.value_type   = VALUE_STR;
+        curr_item_p->value.value_char_p = copy_p;
+        curr_item_p->value.value_len    = (uint32_t)len;
+        LOG_TRACE("Found value \"%s\"", curr_item_p->value.value_char_p);
+        parser_p->state = EXPECT_COMMA_OR_CLOSE;
+    }
+    else
+    {
+        LOG_ERROR("Unexpected string \"%s\"", copy_p);
+        return ERR_JSON_INVALID;
+    }
+    return ERR_ALL_GOOD;
+}
+
+// `true`, `false` or a number, held in `token`.
+static Error _JsonParser_on_scalar(JsonParser* parser_p)
+{
+    const char* token_p = parser_p->token;
+    const char* end_p   = parser_p->token + parser_p->token_len;
+    parser_p->token_len = 0;
+    if (parser_p->state != EXPECT_VALUE)
+    {
+        LOG_ERROR("Unexpected `%c`", *token_p);
+        return ERR_JSON_INVALID;
+    }
+    // Only read once a value is expected: before the root `{` there is no current item.
+    JsonValue* value_p    = &parser_p->curr_item_p->value;
+    parser_p->just_opened = false;
+    parser_p->state       = EXPECT_COMMA_OR_CLOSE;
+    if ((end_p - token_p == 4) && (strncmp(token_p, "true", 4) == 0))
+    {
+        value_p->value_type = VALUE_BOOL;
+        value_p->value_bool = true;
+        LOG_TRACE("Found value TRUE");
+    }
+    else if ((end_p - token_p == 5) && (strncmp(token_p, "false", 5) == 0))
+    {
+        value_p->value_type = VALUE_BOOL;
+        value_p->value_bool = false;
+        LOG_TRACE("Found value FALSE");
+    }
+    else
+    {
+        return_on_err(_deserialize_number(&token_p, end_p, value_p));
+        if (token_p != end_p)
+        {
+            LOG_ERROR("Unexpected character `%c` after number", *token_p);
+            return ERR_JSON_INVALID;
+        }
+    }
+    return ERR_ALL_GOOD;
+}
+
+static Error _JsonParser_close(JsonParser* parser_p, char closing_char)
+{
+    JsonItem* container_p = parser_p->container_p;
+    if ((container_p->value.value_type == VALUE_ARRAY) != (closing_char == ']'))
+    {
+        LOG_ERROR("Mismatched `%c`", closing_char);
+        return ERR_JSON_INVALID;
+    }
+    return_on_err(_close_container(
+        &parser_p->json_obj_p->arena,
+        &parser_p->json_obj_p->element_stack,
+        container_p,
+        parser_p->curr_item_p));
+    if (container_p == &parser_p->json_obj_p->root)
+    {
+        parser_p->state = EXPECT_END;
+        return ERR_ALL_GOOD;
+    }
+    parser_p->curr_item_p = container_p;
+    parser_p->container_p = container_p->parent;
+    parser_p->state       = EXPECT_COMMA_OR_CLOSE;
+    return ERR_ALL_GOOD;
+}
+
+// One of `{}[],:`.
+static Error _JsonParser_on_structural(JsonParser* parser_p, char curr_char)
+{
+    JsonArena* arena_p             = &parser_p->json_obj_p->arena;
+    JsonItemStack* element_stack_p = &parser_p->json_obj_p->element_stack;
+    JsonItem* root_p               = &parser_p->json_obj_p->root;
+    const bool just_opened         = parser_p->just_opened;
+    parser_p->just_opened          = false;
+    switch (parser_p->state)
+    {
+    case EXPECT_ROOT:
+    {
+        return_on_err(_check_root(curr_char));
+        parser_p->container_p = root_p;
+        parser_p->curr_item_p = root_p->next_sibling;
+        parser_p->state       = EXPECT_KEY;
+        parser_p->just_opened = true;
+        return ERR_ALL_GOOD;
+    }
+    case EXPECT_COLON:
+    {
+        if (curr_char != ':')
+        {
+            LOG_ERROR("Missing `:` after key \"%s\"", parser_p->curr_item_p->key_p);
+            return ERR_JSON_INVALID;
+        }
+        parser_p->state = EXPECT_VALUE;
+        return ERR_ALL_GOOD;
+    }
+    case EXPECT_VALUE:
+    {
+        if ((curr_char == '{') || (curr_char == '['))
+        {
+            JsonItem* new_item = _open_container(
+                arena_p,
+                element_stack_p,
+                parser_p->curr_item_p,
+                (curr_char == '{') ? VALUE_ITEM : VALUE_ARRAY);
+            if (new_item == NULL)
+            {
+                return ERR_FATAL;
+            }
+            parser_p->container_p = parser_p->curr_item_p;
+            parser_p->curr_item_p = new_item;
+            parser_p->state       = (curr_char == '{') ? EXPECT_KEY : EXPECT_VALUE;
+            parser_p->just_opened = true;
+            return ERR_ALL_GOOD;
+        }
+        if ((curr_char == ']') && just_opened)
+        {
+            // Empty array: drop the element created for `[`.
+            element_stack_p->count--;
+            parser_p->curr_item_p = parser_p->container_p;
+            parser_p->container_p = parser_p->container_p->parent;
+            parser_p->state       = EXPECT_COMMA_OR_CLOSE;
+            return _JsonArray_build(arena_p, parser_p->curr_item_p, element_stack_p, 0);
+        }
+        break;
+    }
+    case EXPECT_KEY:
+    {
+        if ((curr_char == '}') && just_opened)
+        {
+            if (parser_p->container_p == root_p)
+            {
+                return _JsonParser_close(parser_p, curr_char);
+            }
+            LOG_TRACE("Found empty object - skipping");
+            parser_p->curr_item_p                   = parser_p->container_p;
+            parser_p->curr_item_p->value.value_type = VALUE_UNDEFINED;
+            parser_p->container_p                   = parser_p->container_p->parent;
+            parser_p->state                         = EXPECT_COMMA_OR_CLOSE;
+            return ERR_ALL_GOOD;
+        }
+        break;
+    }
+    case EXPECT_COMMA_OR_CLOSE:
+    {
+        if (curr_char == ',')
+        {
+            parser_p->curr_item_p = _append_sibling(
+                arena_p, element_stack_p, parser_p->container_p, parser_p->curr_item_p);
+            if (parser_p->curr_item_p == NULL)
+            {
+                return ERR_FATAL;
+            }
+            parser_p->state = (parser_p->container_p->value.value_type == VALUE_ARRAY)
+                                  ? EXPECT_VALUE
+                                  : EXPECT_KEY;
+            return ERR_ALL_GOOD;
+        }
+        if ((curr_char == '}') || (curr_char == ']'))
+        {
+            return _JsonParser_close(parser_p, curr_char);
+        }
+        break;
+    }
+    case EXPECT_END:
+    {
+        LOG_ERROR("Unexpected characters after the root object");
+        return ERR_JSON_INVALID;
+    }
+    }
+    LOG_ERROR("Unexpected `%c`", curr_char);
+    return ERR_JSON_INVALID;
+}
+
+static void _JsonParser_fail(JsonParser* parser_p, Error error)
+{
+    JsonObj_destroy(parser_p->json_obj_p);
+    free(parser_p->token);
+    parser_p->token          = NULL;
+    parser_p->token_len      = 0;
+    parser_p->token_capacity = 0;
+    parser_p->error          = (error == ERR_FATAL) ? ERR_FATAL : ERR_JSON_INVALID;
+    LOG_ERROR("Failed to deserialize JSON");
+}
+
+// Start parsing a document into `out_json_obj_p`, which is treated as in JsonObj_new.
+Error JsonParser_new(
+    JsonParser* out_parser_p,
+    JsonObj* out_json_obj_p)
+{
+    out_parser_p->json_obj_p     = out_json_obj_p;
+    out_parser_p->container_p    = NULL;
+    out_parser_p->curr_item_p    = NULL;
+    out_parser_p->state          = EXPECT_ROOT;
+    out_parser_p->lex_state      = LEX_BETWEEN_TOKENS;
+    out_parser_p->escaped        = false;
+    out_parser_p->just_opened    = false;
+    out_parser_p->token          = NULL;
+    out_parser_p->token_len      = 0;
+    out_parser_p->token_capacity = 0;
+    _JsonObj_prepare(out_json_obj_p);
+    out_parser_p->error = _JsonObj_init_root(out_json_obj_p);
+    LOG_DEBUG("JSON deserialization started.");
+    return out_parser_p->error;
+}
+
+// Parse the next `len` bytes of the document. A token split between two chunks is kept until the
+// next call. On failure the JsonObj is destroyed and every later call fails.
+Error JsonParser_feed(
+    JsonParser* parser_p,
+    const char* chunk_p,
+    size_t len)
+{
+    if (is_err(parser_p->error))
+    {
+        return parser_p->error;
+    }
+    const char* end_p = chunk_p + len;
+    Error ret_res     = ERR_ALL_GOOD;
+    while ((chunk_p < end_p) && is_ok(ret_res))
+    {
+        if (parser_p->lex_state == LEX_STRING)
+        {
+            const char* start_p = chunk_p;
+            for (; chunk_p < end_p; chunk_p++)
+            {
+                if (parser_p->escaped)
+                {
+                    parser_p->escaped = false;
+                }
+                else if (*chunk_p == '\\')
+                {
+                    parser_p->escaped = true;
+                }
+                else if (*chunk_p == '"')
+                {
+                    break;
+                }
+            }
+            if (chunk_p == end_p)
+            {
+                ret_res = _JsonParser_append_token(parser_p, start_p, chunk_p - start_p);
+            }
+            else if (parser_p->token_len == 0)
+            {
+                ret_res             = _JsonParser_on_string(parser_p, start_p, chunk_p - start_p);
+                parser_p->lex_state = LEX_BETWEEN_TOKENS;
+                chunk_p++; // Skip the closing quote.
+            }
+            else
+            {
+                ret_res = _JsonParser_append_token(parser_p, start_p, chunk_p - start_p);
+                if (is_ok(ret_res))
+                {
+                    ret_res = _JsonParser_on_string(parser_p, parser_p->token, parser_p->token_len);
+                }
+                parser_p->token_len = 0;
+                parser_p->lex_state = LEX_BETWEEN_TOKENS;
+                chunk_p++; // Skip the closing quote.
+            }
+        }
+        else if (parser_p->lex_state == LEX_SCALAR)
+        {
+            const char* start_p = chunk_p;
+            while ((chunk_p < end_p) && !_is_scalar_end(chunk_p, end_p))
+            {
+                chunk_p++;
+            }
+            ret_res = _JsonParser_append_token(parser_p, start_p, chunk_p - start_p);
+            if (is_ok(ret_res) && (chunk_p < end_p))
+            {
+                parser_p->lex_state = LEX_BETWEEN_TOKENS;
+                ret_res             = _JsonParser_on_scalar(parser_p);
+            }
+        }
+        else if ((unsigned char)*chunk_p <= ' ')
+        {
+            chunk_p++;
+        }
+        else if (*chunk_p == '"')
+        {
+            parser_p->lex_state = LEX_STRING;
+            chunk_p++;
+        }
+        else if (_is_scalar_end(chunk_p, end_p))
+        {
+            ret_res = _JsonParser_on_structural(parser_p, *chunk_p);
+            chunk_p++;
+        }
+        else
+        {
+            parser_p->lex_state = LEX_SCALAR;
+        }
+    }
+    if (is_err(ret_res))
+    {
+        _JsonParser_fail(parser_p, ret_res);
+    }
+    return parser_p->error;
+}
+
+// Parse the last token and check that the document is complete. The parser releases its memory
+// and every later call fails, while the JsonObj is ready to use.
+Error JsonParser_finish(JsonParser* parser_p)
+{
+    if (is_err(parser_p->error))
+    {
+        return parser_p->error;
+    }
+    Error ret_res = ERR_ALL_GOOD;
+    if (parser_p->lex_state == LEX_SCALAR)
+    {
+        parser_p->lex_state = LEX_BETWEEN_TOKENS;
+        ret_res             = _JsonParser_on_scalar(parser_p);
+    }
+    else if (parser_p->lex_state == LEX_STRING)
+    {
+        LOG_ERROR("Unterminated string");
+        ret_res = ERR_JSON_INVALID;
+    }
+    if (is_ok(ret_res) && (parser_p->state != EXPECT_END))
+    {
+        LOG_ERROR("Unexpected end of JSON string");
+        ret_res = ERR_JSON_INVALID;
+    }
+    if (is_err(ret_res))
+    {
+        _JsonParser_fail(parser_p, ret_res);
+        return parser_p->error;
+    }
+    free(parser_p->token);
+    parser_p->token          = NULL;
+    parser_p->token_len      = 0;
+    parser_p->token_capacity = 0;
+    parser_p->error          = ERR_INVALID;
+    LOG_DEBUG("JSON deserialization ended successfully.")
+    return ERR_ALL_GOOD;
+}
+
+// Drop the tree but keep the buffers (string, index and arena chunks) for the next `JsonObj_new`, so
+// that parsing a stream of documents of similar size does not allocate once warmed up.
+void JsonObj_reset(JsonObj* json_obj_p)
+{
+    if (json_obj_p == NULL)
+    {
+        return;
+    }
+    _JsonArena_rewind(&json_obj_p->arena);
+    // Unlike a copy, a mapped file cannot hold the next document.
+    _JsonObj_unmap(json_obj_p);
+    json_obj_p->root.value.value_type = VALUE_UNDEFINED;
+    json_obj_p->root.next_sibling     = NULL;
+    json_obj_p->recycle_p             = json_obj_p;
+}
+
+void JsonObj_destroy(JsonObj* json_obj_p)
+{
+    if (json_obj_p == NULL)
+    {
+        return;
+    }
+    // All the nodes live in the arena, so they are released chunk by chunk.
+    _JsonArena_destroy(&json_obj_p->arena);
+    free(json_obj_p->index.positions);
+    json_obj_p->index.positions = NULL;
+    json_obj_p->index.count     = 0;
+    json_obj_p->index.capacity  = 0;
+    free(json_obj_p->element_stack.items);
+    json_obj_p->element_stack.items    = NULL;
+    json_obj_p->element_stack.count    = 0;
+    json_obj_p->element_stack.capacity = 0;
+    json_obj_p->root.value.value_type = VALUE_UNDEFINED;
+    json_obj_p->root.next_sibling     = NULL;
+    if (json_obj_p->json_string_capacity > 0)
+    {
+        free(json_obj_p->json_string);
+    }
+    _JsonObj_unmap(json_obj_p);
+    json_obj_p->json_string          = NULL;
+    json_obj_p->json_string_capacity = 0;
+    json_obj_p->recycle_p            = NULL;
+}
+
+Error JsonObj_stats(const JsonObj* json_obj_p, JsonStats* out_stats_p)
+{
+    if ((json_obj_p == NULL) || (out_stats_p == NULL))
+    {
+        return ERR_NULL;
+    }
+    *out_stats_p = (JsonStats){0};
+    // Depth-first walk through the parent pointers, so that the stack stays constant.
+    const JsonItem* root_p = &json_obj_p->root;
+    const JsonItem* item_p = (root_p->value.value_type == VALUE_ROOT) ? root_p->next_sibling : NULL;
+    size_t depth           = 1;
+    while (item_p != NULL)
+    {
+        const ValueType value_type = item_p->value.value_type;
+        // An empty object is left undefined; the root of `{}` is only a placeholder.
+        if ((value_type != VALUE_UNDEFINED) || (item_p->parent != root_p)
+            || (item_p->key_p != NULL))
+        {
+            out_stats_p->num_of_nodes++;
+            out_stats_p->nodes_by_type[value_type]++;
+            if (depth > out_stats_p->max_depth)
+            {
+                out_stats_p->max_depth = depth;
+            }
+        }
+        const JsonItem* child_p = NULL;
+        if (value_type == VALUE_ITEM)
+        {
+            child_p = item_p->value.value_child_p;
+        }
+        else if ((value_type == VALUE_ARRAY) && (item_p->value.value_array_p->len > 0))
+        {
+            child_p = item_p->value.value_array_p->elements[0];
+        }
+        if (child_p != NULL)
+        {
+            item_p = child_p;
+            depth++;
+            continue;
+        }
+        while ((item_p != root_p) && (item_p->next_sibling == NULL))
+        {
+            item_p = item_p->parent;
+            depth--;
+        }
+        item_p = (item_p != root_p) ? item_p->next_sibling : NULL;
+    }
+    // Chunks after the current one are kept by JsonObj_reset but hold nothing yet.
+    bool is_in_use = true;
+    for (const JsonArenaChunk* chunk_p = json_obj_p->arena.first_chunk_p; chunk_p != NULL;
+         chunk_p                       = chunk_p->next_p)
+    {
+        out_stats_p->node_bytes += is_in_use ? chunk_p->used : 0;
+        out_stats_p->arena_bytes += sizeof(JsonArenaChunk) + chunk_p->capacity;
+        is_in_use = is_in_use && (chunk_p != json_obj_p->arena.curr_chunk_p);
+    }
+    out_stats_p->string_bytes = (json_obj_p->json_string_mapped_len > 0)
+                                  ? json_obj_p->json_string_mapped_len
+                                  : json_obj_p->json_string_capacity;
+    out_stats_p->transient_bytes = json_obj_p->index.capacity * sizeof(uint32_t)
+                                 + json_obj_p->element_stack.capacity * sizeof(JsonItem*);
+    out_stats_p->peak_transient_bytes
+        = out_stats_p->transient_bytes + json_obj_p->parallel_scratch_bytes;
+    out_stats_p->num_of_dropped_values = json_obj_p->num_of_dropped_values;
+    out_stats_p->dropped_bytes         = json_obj_p->dropped_bytes;
+    out_stats_p->total_bytes
+        = out_stats_p->string_bytes + out_stats_p->arena_bytes + out_stats_p->transient_bytes;
+    return ERR_ALL_GOOD;
+}
+
+size_t JsonArray_len(const JsonArray* json_array)
+{
+    return (json_array == NULL) ? 0 : json_array->len;
+}
+
+// ---------- Newline-delimited JSON ----------
+
+// Bytes indexed at a time by JsonBatch_new, rounded up to the end of a line.
+#define JSON_BATCH_WINDOW_SIZE (64 * 1024)
+
+static Error _JsonBatch_push(JsonBatch* batch_p, const JsonRecord* record_p)
+{
+    if (batch_p->num_of_records == batch_p->records_capacity)
+    {
+        const size_t capacity = (batch_p->records_capacity == 0) ? 64 : batch_p->records_capacity * 2;
+        JsonRecord* records   = realloc(batch_p->records, capacity * sizeof(JsonRecord));
+        if (records == NULL)
+        {
+            LOG_PERROR("Out of memory");
+            return ERR_FATAL;
+        }
+        batch_p->records          = records;
+        batch_p->records_capacity = capacity;
+    }
+    batch_p->records[batch_p->num_of_records] = *record_p;
+    return ERR_ALL_GOOD;
+}
+
+// Parse the record whose structural characters are `positions[0, count)` and which ends at
+// `json_string[record_end]`.
+static Error _JsonBatch_parse_record(
+    JsonBatch* batch_p,
+    uint32_t* positions,
+    size_t count,
+    size_t record_end,
+    JsonRecord* record_p)
+{
+    JsonObj* json_obj_p = &batch_p->json_obj;
+    JsonItem* root_p    = JsonItem_new(&json_obj_p->arena);
+    if ((root_p == NULL) || is_err(_init_root(&json_obj_p->arena, root_p, json_obj_p)))
+    {
+        return ERR_FATAL;
+    }
+    const JsonIndex record_index     = {positions, count, count};
+    json_obj_p->element_stack.count = 0;
+    Error ret_res                    = _deserialize(
+        &json_obj_p->arena,
+        &json_obj_p->element_stack,
+        root_p,
+        json_obj_p->json_string,
+        record_end,
+        &record_index);
+    if (ret_res == ERR_FATAL)
+    {
+        return ERR_FATAL;
+    }
+    if (is_err(ret_res))
+    {
+        LOG_ERROR("Invalid record at line %lu", record_p->line);
+        record_p->error = ERR_JSON_INVALID;
+        return ERR_ALL_GOOD;
+    }
+    record_p->item_p = root_p->next_sibling;
+    return ERR_ALL_GOOD;
+}
+
+// Parse `len` bytes of `buf` as one JSON object per line (NDJSON), in place as JsonObj_new_insitu
+// does. The buffer is indexed in a single scan, window by window, into one index, and every record
+// is built in the same arena. Blank
+// lines are skipped. An invalid record is reported in its JsonRecord and does not stop the batch.
+// Without a `handler`, the records are stored in `out_batch_p->records` and stay valid until
+// JsonBatch_destroy. Otherwise, `handler` is called with each record, which is only valid during
+// the call: the arena is rewound afterwards, so the memory used does not grow with the batch.
+// Fails only if the buffer cannot be processed at all.
+Error JsonBatch_new(
+    char* buf,
+    size_t len,
+    JsonBatch* out_batch_p,
+    JsonRecordHandler handler,
+    void* ctx_p)
+{
+    JsonObj* json_obj_p   = &out_batch_p->json_obj;
+    json_obj_p->recycle_p = NULL;
+    _JsonObj_prepare(json_obj_p);
+    json_obj_p->json_string         = buf;
+    json_obj_p->root.next_sibling   = NULL;
+    out_batch_p->records            = NULL;
+    out_batch_p->num_of_records     = 0;
+    out_batch_p->num_of_errors      = 0;
+    out_batch_p->records_capacity   = 0;
+    if ((buf == NULL) || (len == 0))
+    {
+        LOG_ERROR("Empty JSON string detected");
+        return ERR_EMPTY_STRING;
+    }
+    const JsonIndexBlocksFn index_blocks = _select_index_kernel();
+    if (len >= UINT32_MAX)
+    {
+        LOG_ERROR("JSON string too large to be indexed");
+        return ERR_INVALID;
+    }
+    JsonIndex* index_p  = &json_obj_p->index;
+    size_t line         = 0;
+    size_t window_start = 0;
+    while (window_start < len)
+    {
+        // The index of a window is consumed while the window is still in the cache.
+        size_t window_end = len;
+        if (len - window_start > JSON_BATCH_WINDOW_SIZE)
+        {
+            const char* newline_p = memchr(
+                &buf[window_start + JSON_BATCH_WINDOW_SIZE],
+                '\n',
+                len - window_start - JSON_BATCH_WINDOW_SIZE);
+            window_end = (newline_p == NULL) ? len : (size_t)(newline_p - buf) + 1;
+        }
+        // A window starts after a newline, hence outside any string or scalar.
+        JsonScanState state = {0, 0, 0};
+        index_p->count      = 0;
+        if (is_err(_index_range(index_blocks, buf, window_start, window_end, index_p, &state)))
+        {
+            JsonBatch_destroy(out_batch_p);
+            return ERR_FATAL;
+        }
+        // Positions are tracked by offset because indexing again may move the index.
+        size_t pos          = 0;
+        size_t record_start = window_start;
+        while (record_start < window_end)
+        {
+            line++;
+            const char* newline_p = memchr(&buf[record_start], '\n', window_end - record_start);
+            const size_t record_end = (newline_p == NULL) ? window_end : (size_t)(newline_p - buf);
+            const size_t first_pos  = pos;
+            size_t num_of_quotes    = 0;
+            while ((pos < index_p->count) && (index_p->positions[pos] < record_end))
+            {
+                num_of_quotes += (buf[index_p->positions[pos]] == '"');
+                pos++;
+            }
+            record_start = record_end + 1;
+            if (first_pos == pos)
+            {
+                continue; // Blank line
+            }
+            JsonRecord record = {NULL, line, ERR_ALL_GOOD};
+            if (num_of_quotes % 2 != 0)
+            {
+                // A string runs past the end of the line, so every quote that follows has been
+                // taken for the wrong side of a string: index the rest of the window again.
+                LOG_ERROR("Unterminated string at line %lu", line);
+                record.error   = ERR_JSON_INVALID;
+                index_p->count = pos;
+                state          = (JsonScanState){0, 0, 0};
+                if ((record_start < window_end)
+                    && is_err(_index_range(
+                        index_blocks, buf, record_start, window_end, index_p, &state)))
+                {
+                    JsonBatch_destroy(out_batch_p);
+                    return ERR_FATAL;
+                }
+            }
+            else if (is_err(_JsonBatch_parse_record(
+                         out_batch_p,
+                         &index_p->positions[first_pos],
+                         pos - first_pos,
+                         record_end,
+                         &record)))
+            {
+                JsonBatch_destroy(out_batch_p);
+                return ERR_FATAL;
+            }
+            out_batch_p->num_of_errors += is_err(record.error);
+            if (handler == NULL)
+            {
+                if (is_err(_JsonBatch_push(out_batch_p, &record)))
+                {
+                    JsonBatch_destroy(out_batch_p);
+                    return ERR_FATAL;
+                }
+                out_batch_p->num_of_records++;
+                continue;
+            }
+            out_batch_p->num_of_records++;
+            const bool carry_on = handler(&record, ctx_p);
+            _JsonArena_rewind(&json_obj_p->arena);
+            if (!carry_on)
+            {
+                return ERR_ALL_GOOD;
+            }
+        }
+        window_start = window_end;
+    }
+    return ERR_ALL_GOOD;
+}
+
+void JsonBatch_destroy(JsonBatch* batch_p)
+{
+    if (batch_p == NULL)
+    {
+        return;
+    }
+    JsonObj_destroy(&batch_p->json_obj);
+    free(batch_p->records);
+    batch_p->records          = NULL;
+    batch_p->num_of_records   = 0;
+    batch_p->num_of_errors    = 0;
+    batch_p->records_capacity = 0;
+}
+
+// ---------- Events ----------
+// Json_parse_events walks the structural index like `_deserialize`, but reports every token to a
+// JsonHandler instead of building a tree. The buffer is only read: the index is built one window at
+// a time, strings are decoded into a scratch buffer and the open brackets are kept on a stack, so
+// that memory grows with the depth of the document and its longest string, not with its size.
+
+// Bytes indexed at a time by Json_parse_events.
+#define JSON_EVENTS_WINDOW_SIZE (64 * 1024)
+// Positions read by the longest step of the walk: a key, its closing quote and the `:`.
+#define JSON_EVENTS_LOOKAHEAD (3)
+
+typedef struct
+{
+    const JsonHandler* handler_p;
+    void* ctx_p;
+    const char* buf;
+    const char* end_p;
+    JsonIndex index; // Positions relative to `base`
+    size_t base;     // Offset in `buf` of the first position of the window
+    size_t first;    // First position of `index` not consumed yet
+    ParserState state;
+    char* brackets; // `{` or `[` of each open container
+    size_t depth;
+    size_t brackets_capacity;
+    char* scratch_p; // Last string decoded
+    size_t scratch_capacity;
+    bool stopped; // Set when a callback returns false
+} JsonEvents;
+
+// Report an event to the handler if it listens to it. A callback returning false stops the parse.
+#define EMIT_EVENT(events_p, callback, ...)                                                     \
+    if (((events_p)->handler_p->callback != NULL)                                               \
+        && !(events_p)->handler_p->callback(__VA_ARGS__))                                       \
+    {                                                                                           \
+        (events_p)->stopped = true;                                                             \
+        return ERR_ALL_GOOD;                                                                    \
+    }
+
+static Error _JsonEvents_push(JsonEvents* events_p, char bracket)
+{
+    if (events_p->depth == events_p->brackets_capacity)
+    {
+        const size_t capacity
+            = (events_p->brackets_capacity == 0) ? 64 : 2 * events_p->brackets_capacity;
+        char* brackets = realloc(events_p->brackets, capacity);
+        if (brackets == NULL)
+        {
+            LOG_PERROR("Out of memory");
+            return ERR_FATAL;
+        }
+        events_p->brackets          = brackets;
+        events_p->brackets_capacity = capacity;
+    }
+    events_p->brackets[events_p->depth++] = bracket;
+    return ERR_ALL_GOOD;
+}
+
+// Decode the string between the quotes at `quote_pos_p[0]` and `quote_pos_p[1]` into the scratch
+// buffer.
+static Error _JsonEvents_str(JsonEvents* events_p, const uint32_t* quote_pos_p, size_t* out_len_p)
+{
+    const size_t len = quote_pos_p[1] - quote_pos_p[0] - 1;
+    if (len >= events_p->scratch_capacity)
+    {
+        size_t capacity = (events_p->scratch_capacity == 0) ? 256 : 2 * events_p->scratch_capacity;
+        if (capacity <= len)
+        {
+            capacity = len + 1;
+        }
+        char* scratch_p = realloc(events_p->scratch_p, capacity);
+        if (scratch_p == NULL)
+        {
+            LOG_PERROR("Out of memory");
+            return ERR_FATAL;
+        }
+        events_p->scratch_p        = scratch_p;
+        events_p->scratch_capacity = capacity;
+    }
+    memcpy(events_p->scratch_p, &events_p->buf[events_p->base + quote_pos_p[0] + 1], len);
+    return _decode_str(events_p->scratch_p, len, out_len_p);
+}
+
+// Consume the positions of the current window. Unless `is_last` is set, the last
+// JSON_EVENTS_LOOKAHEAD positions are left for the next window, so that no step runs out of them.
+static Error _JsonEvents_walk(JsonEvents* events_p, bool is_last)
+{
+    const char* window_p      = &events_p->buf[events_p->base];
+    const uint32_t* positions = events_p->index.positions;
+    const size_t count        = events_p->index.count;
+    size_t pos                = events_p->first;
+    ParserState state         = events_p->state;
+    void* ctx_p               = events_p->ctx_p;
+    while ((pos < count) && (is_last || (count - pos >= JSON_EVENTS_LOOKAHEAD)))
+    {
+        const char curr_char = window_p[positions[pos]];
+        if (state == EXPECT_ROOT)
+        {
+            if ((curr_char != '{') && (curr_char != '['))
+            {
+                LOG_ERROR("Invalid JSON string.");
+                return ERR_JSON_INVALID;
+            }
+            state = EXPECT_VALUE;
+        }
+        if (state == EXPECT_KEY)
+        {
+            if (curr_char != '"')
+            {
+                LOG_ERROR("Expected key, found `%c`", curr_char);
+                return ERR_JSON_INVALID;
+            }
+            size_t len;
+            return_on_err(_JsonEvents_str(events_p, &positions[pos], &len));
+            LOG_TRACE("Found key: \"%s\"", events_p->scratch_p);
+            if ((pos + 2 >= count) || (window_p[positions[pos + 2]] != ':'))
+            {
+                LOG_ERROR("Missing `:` after key \"%s\"", events_p->scratch_p);
+                return ERR_JSON_INVALID;
+            }
+            EMIT_EVENT(events_p, on_key, events_p->scratch_p, len, ctx_p);
+            pos += 3;
+            state = EXPECT_VALUE;
+        }
+        else if (state == EXPECT_VALUE)
+        {
+            switch (curr_char)
+            {
+            case '{':
+            case '[':
+            {
+                const bool is_array = (curr_char == '[');
+                if (is_array)
+                {
+                    EMIT_EVENT(events_p, on_array_start, ctx_p);
+                }
+                else
+                {
+                    EMIT_EVENT(events_p, on_object_start, ctx_p);
+                }
+                pos++;
+                if ((pos < count) && (window_p[positions[pos]] == (is_array ? ']' : '}')))
+                {
+                    LOG_TRACE("Found empty container");
+                    pos++;
+                    if (is_array)
+                    {
+                        EMIT_EVENT(events_p, on_array_end, ctx_p);
+                    }
+                    else
+                    {
+                        EMIT_EVENT(events_p, on_object_end, ctx_p);
+                    }
+                    state = (events_p->depth == 0) ? EXPECT_END : EXPECT_COMMA_OR_CLOSE;
+                    break;
+                }
+                return_on_err(_JsonEvents_push(events_p, curr_char));
+                state = is_array ? EXPECT_VALUE : EXPECT_KEY;
+                break;
+            }
+            case '"':
+            {
+                size_t len;
+                return_on_err(_JsonEvents_str(events_p, &positions[pos], &len));
+                LOG_TRACE("Found value \"%s\"", events_p->scratch_p);
+                EMIT_EVENT(events_p, on_string, events_p->scratch_p, len, ctx_p);
+                pos += 2;
+                state = EXPECT_COMMA_OR_CLOSE;
+                break;
+            }
+            default:
+            {
+                JsonValue value;
+                return_on_err(
+                    _deserialize_scalar(&window_p[positions[pos]], events_p->end_p, &value));
+                switch (value.value_type)
+                {
+                case VALUE_INT:
+                    EMIT_EVENT(events_p, on_int, value.value_int, ctx_p);
+                    break;
+                case VALUE_LLU:
+                    EMIT_EVENT(events_p, on_llu, value.value_llu, ctx_p);
+                    break;
+                case VALUE_DOUBLE:
+                    EMIT_EVENT(events_p, on_double, value.value_double, ctx_p);
+                    break;
+                default:
+                    EMIT_EVENT(events_p, on_bool, value.value_bool, ctx_p);
+                    break;
+                }
+                pos++;
+                state = EXPECT_COMMA_OR_CLOSE;
+                break;
+            }
+            }
+        }
+        else if (state == EXPECT_END)
+        {
+            LOG_ERROR("Unexpected characters after the root object");
+            return ERR_JSON_INVALID;
+        }
+        else if (curr_char == ',')
+        {
+            state = (events_p->brackets[events_p->depth - 1] == '[') ? EXPECT_VALUE : EXPECT_KEY;
+            pos++;
+        }
+        else if ((curr_char == '}') || (curr_char == ']'))
+        {
+            const bool is_array = (curr_char == ']');
+            if ((events_p->brackets[events_p->depth - 1] == '[') != is_array)
+            {
+                LOG_ERROR("Mismatched `%c`", curr_char);
+                return ERR_JSON_INVALID;
+            }
+            events_p->depth--;
+            if (is_array)
+            {
+                EMIT_EVENT(events_p, on_array_end, ctx_p);
+            }
+            else
+            {
+                EMIT_EVENT(events_p, on_object_end, ctx_p);
+            }
+            pos++;
+            state = (events_p->depth == 0) ? EXPECT_END : EXPECT_COMMA_OR_CLOSE;
+        }
+        else
+        {
+            LOG_ERROR("Expected `,` or closing bracket, found `%c`", curr_char);
+            return ERR_JSON_INVALID;
+        }
+    }
+    events_p->first = pos;
+    events_p->state = state;
+    return ERR_ALL_GOOD;
+}
+
+// Index `buf` one window at a time and walk each window as soon as it is indexed. The positions
+// left over by the walk are moved to the front of the index and rebased on the first of them, so
+// the offsets fit in 32 bits whatever the size of the document. With `release_pages`, the pages of
+// `buf` that have been consumed are dropped from memory.
+static Error _JsonEvents_parse(JsonEvents* events_p, size_t len, bool release_pages)
+{
+    const JsonIndexBlocksFn index_blocks = _select_index_kernel();
+    const size_t page_size               = (size_t)sysconf(_SC_PAGESIZE);
+    JsonIndex* index_p                   = &events_p->index;
+    JsonScanState scan_state             = {0, 0, 0};
+    size_t indexed                       = 0;
+    size_t released                      = 0;
+    while (indexed < len)
+    {
+        const size_t num_left = index_p->count - events_p->first;
+        const size_t base
+            = (num_left == 0) ? indexed : events_p->base + index_p->positions[events_p->first];
+        for (size_t i = 0; i < num_left; i++)
+        {
+            index_p->positions[i]
+                = (uint32_t)(events_p->base + index_p->positions[events_p->first + i] - base);
+        }
+        index_p->count   = num_left;
+        events_p->first  = 0;
+        events_p->base   = base;
+        const size_t end = (len - indexed > JSON_EVENTS_WINDOW_SIZE)
+                               ? indexed + JSON_EVENTS_WINDOW_SIZE
+                               : len;
+        if (end - base >= UINT32_MAX)
+        {
+            LOG_ERROR("String too large to be indexed");
+            return ERR_INVALID;
+        }
+        return_on_err(_index_range(
+            index_blocks, &events_p->buf[base], indexed - base, end - base, index_p, &scan_state));
+        indexed = end;
+        if ((indexed == len) && scan_state.prev_in_string)
+        {
+            LOG_ERROR("Unterminated string");
+            return ERR_JSON_INVALID;
+        }
+        return_on_err(_JsonEvents_walk(events_p, indexed == len));
+        if (events_p->stopped)
+        {
+            return ERR_ALL_GOOD;
+        }
+        if (release_pages)
+        {
+            // The bytes before the first position left over are not read again.
+            const size_t consumed = (events_p->first < index_p->count)
+                                        ? events_p->base + index_p->positions[events_p->first]
+                                        : indexed;
+            const size_t boundary = consumed - consumed % page_size;
+            if (boundary > released)
+            {
+                madvise((char*)&events_p->buf[released], boundary - released, MADV_DONTNEED);
+                released = boundary;
+            }
+        }
+    }
+    if (events_p->state == EXPECT_ROOT)
+    {
+        LOG_ERROR("Invalid JSON string.");
+        return ERR_JSON_INVALID;
+    }
+    if (events_p->state != EXPECT_END)
+    {
+        LOG_ERROR("Unexpected end of JSON string");
+        return ERR_JSON_INVALID;
+    }
+    return ERR_ALL_GOOD;
+}
+
+static Error _Json_parse_events(
+    const char* buf,
+    size_t len,
+    const JsonHandler* handler_p,
+    void* ctx_p,
+    bool release_pages)
+{
+    JsonEvents events = {
+        .handler_p = handler_p,
+        .ctx_p     = ctx_p,
+        .buf       = buf,
+        .end_p     = buf + len,
+        .index     = {NULL, 0, 0},
+        .state     = EXPECT_ROOT,
+    };
+    const Error ret_res = _JsonEvents_parse(&events, len, release_pages);
+    free(events.index.positions);
+    free(events.brackets);
+    free(events.scratch_p);
+    return ret_res;
+}
+
+// Report the tokens of the JSON document `buf`, of length `len`, to `handler_p` in document order
+// without building a tree. The root may be an object or an array. The buffer is not modified.
+// Returns ERR_ALL_GOOD when a callback stops the parse.
+Error Json_parse_events(const char* buf, size_t len, const JsonHandler* handler_p, void* ctx_p)
+{
+    if ((buf == NULL) || (len == 0))
+    {
+        LOG_ERROR("Empty JSON string detected");
+        return ERR_EMPTY_STRING;
+    }
+    if (handler_p == NULL)
+    {
+        LOG_ERROR("Missing handler");
+        return ERR_NULL;
+    }
+    return _Json_parse_events(buf, len, handler_p, ctx_p, false);
+}
+
+// Same as Json_parse_events on the file at `path`, which is mapped but not loaded: pages are read
+// in as the parse reaches them and dropped once consumed, so the file may be larger than memory.
+Error Json_parse_events_file(const char* path, const JsonHandler* handler_p, void* ctx_p)
+{
+    if (handler_p == NULL)
+    {
+        LOG_ERROR("Missing handler");
+        return ERR_NULL;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        LOG_PERROR("Failed to open `%s`", path);
+        return ERR_INVALID;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0)
+    {
+        close(fd);
+        LOG_PERROR("Failed to read the size of `%s`", path);
+        return ERR_INVALID;
+    }
+    const size_t len = (size_t)file_stat.st_size;
+    if (len == 0)
+    {
+        close(fd);
+        LOG_ERROR("Empty JSON file `%s`", path);
+        return ERR_EMPTY_STRING;
+    }
+    char* mapping_p = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping_p == MAP_FAILED)
+    {
+        LOG_PERROR("Failed to map `%s`", path);
+        return ERR_FATAL;
+    }
+    madvise(mapping_p, len, MADV_SEQUENTIAL);
+    const Error ret_res = _Json_parse_events(mapping_p, len, handler_p, ctx_p, true);
+    munmap(mapping_p, len);
+    return ret_res;
+}
+
+// ---------- Parallel parsing ----------
+// Both stages of JsonObj_new_parallel are split across threads. Stage 1 indexes one chunk of the
+// input per thread. A chunk cannot know whether it starts inside a string, so it is indexed as if
+// it did not: the exclusive prefix xor of the quote parities of the chunks tell which ones must be
+// indexed again. Stage 2 splits the members of the root object, or the elements of its largest
+// member, at commas found in parallel. Each segment is parsed from a JsonCursor into an arena of
+// its own, then the segments are stitched into one tree.
+
+// Smallest chunk worth a thread.
+#define JSON_PARALLEL_MIN_CHUNK_SIZE (64 * 1024)
+// Deepest start of a chunk, relative to the root object, at which split points are looked for.
+#define JSON_PARALLEL_MAX_DEPTH (64)
+#define JSON_NO_POS (SIZE_MAX)
+
+typedef struct JsonParallelParse JsonParallelParse;
+
+typedef struct JsonWorker
+{
+    JsonParallelParse* parse_p;
+    size_t id;
+    pthread_t thread;
+    bool has_thread;
+    // Stage 1: bytes [start, end), indexed into `index`
+    size_t start;
+    size_t end;
+    JsonIndex index;
+    bool index_done;
+    bool starts_in_string;
+    bool ends_in_string;
+    // Split search: positions [first_pos, end_pos) of the index of the JsonObj. The depth at
+    // `first_pos` is only known after the scan, so the candidates are recorded for every depth
+    // `1 - i` relative to it.
+    size_t first_pos;
+    size_t end_pos;
+    ptrdiff_t depth; // Change of depth over the chunk, then depth at `first_pos`
+    size_t first_comma_pos[JSON_PARALLEL_MAX_DEPTH];    // Where a segment can start
+    size_t comma_open_pos[JSON_PARALLEL_MAX_DEPTH];     // Last `{[` one level up, before that comma
+    size_t last_open_pos[JSON_PARALLEL_MAX_DEPTH];      // Last `{[` at this depth
+    size_t split_pos[2];   // First comma at depth 1 (root members) and 2 where a segment can start
+    size_t split_open_pos; // Bracket opening the container of `split_pos[1]`
+    // Stage 2: positions [seg_begin, seg_end)
+    size_t seg_begin;
+    size_t seg_end;
+    JsonArena arena;
+    JsonItemStack element_stack;
+    JsonArena* arena_p; // The arena and the element stack of the JsonObj for the first worker
+    JsonItemStack* element_stack_p;
+    JsonItem* container_p; // Stand-in for the container being split, NULL for the first worker
+    JsonCursor cursor;
+    size_t element_offset;
+    size_t num_of_children;
+    Error error;
+} JsonWorker;
+
+struct JsonParallelParse
+{
+    JsonObj* json_obj_p;
+    JsonIndexBlocksFn index_blocks;
+    size_t len;
+    JsonWorker* workers;
+    size_t num_of_workers;
+    size_t split_depth;          // 1 to split the root object, 2 to split one of its members
+    size_t split_open_pos;       // Bracket opening the member being split
+    JsonItem* split_container_p; // Container whose children are split into segments
+    JsonArray* split_array_p;    // Its element table, if it is an array
+};
+
+// Run `job` on the first `num_of_workers` workers, one thread each, the first one being the
+// calling thread. A worker whose thread cannot be created runs on the calling thread.
+static void _run_workers(JsonWorker* workers, size_t num_of_workers, void* (*job)(void*))
+{
+    for (size_t i = 1; i < num_of_workers; i++)
+    {
+        workers[i].has_thread = (pthread_create(&workers[i].thread, NULL, job, &workers[i]) == 0);
+        if (!workers[i].has_thread)
+        {
+            job(&workers[i]);
+        }
+    }
+    job(&workers[0]);
+    for (size_t i = 1; i < num_of_workers; i++)
+    {
+        if (workers[i].has_thread)
+        {
+            pthread_join(workers[i].thread, NULL);
+        }
+    }
+}
+
+// Number of backslashes right before `json_string[pos]`.
+static size_t _count_backslashes_before(const char* json_string, size_t pos)
+{
+    size_t count = 0;
+    while ((count < pos) && (json_string[pos - 1 - count] == '\\'))
+    {
+        count++;
+    }
+    return count;
+}
+
+static void* _JsonWorker_index(void* worker_p)
+{
+    JsonWorker* w = worker_p;
+    if (w->index_done)
+    {
+        return NULL;
+    }
+    const char* json_string = w->parse_p->json_obj_p->json_string;
+    // Escapes and scalars do not depend on strings, so their state is found in the previous bytes.
+    const size_t num_of_backslashes = _count_backslashes_before(json_string, w->start);
+    JsonScanState state = {num_of_backslashes % 2, w->starts_in_string ? ~0ULL : 0, 0};
+    if (w->start > 0)
+    {
+        const char prev_char = json_string[w->start - 1];
+        state.prev_scalar
+            = (strchr("{}[],:", prev_char) == NULL) && ((unsigned char)prev_char > ' ')
+           && ((prev_char != '"') || (_count_backslashes_before(json_string, w->start - 1) % 2 != 0));
+    }
+    w->index.count = 0;
+    w->error       = _index_range(
+        w->parse_p->index_blocks, json_string, w->start, w->end, &w->index, &state);
+    w->ends_in_string = (state.prev_in_string != 0);
+    return NULL;
+}
+
+// Move the positions of the chunk to the index of the JsonObj and look for split points on the way.
+static void* _JsonWorker_scan(void* worker_p)
+{
+    JsonWorker* w             = worker_p;
+    const JsonObj* json_obj_p = w->parse_p->json_obj_p;
+    const char* json_string   = json_obj_p->json_string;
+    uint32_t* positions       = json_obj_p->index.positions;
+    for (size_t i = 0; i < JSON_PARALLEL_MAX_DEPTH; i++)
+    {
+        w->first_comma_pos[i] = JSON_NO_POS;
+        w->comma_open_pos[i]  = JSON_NO_POS;
+        w->last_open_pos[i]   = JSON_NO_POS;
+    }
+    // `depth` is relative to the start of the chunk: the slot of depth `d` is `1 - d`.
+    ptrdiff_t depth = 0;
+    for (size_t i = 0; i < w->index.count; i++)
+    {
+        const size_t pos = w->first_pos + i;
+        positions[pos]   = w->index.positions[i];
+        switch (json_string[positions[pos]])
+        {
+        case '{':
+        case '[':
+            if ((depth <= 1) && (1 - depth < JSON_PARALLEL_MAX_DEPTH))
+            {
+                w->last_open_pos[1 - depth] = pos;
+            }
+            depth++;
+            break;
+        case '}':
+        case ']':
+            depth--;
+            break;
+        case ',':
+            // A segment must not start with what would close an empty container.
+            if ((depth <= 1) && (1 - depth < JSON_PARALLEL_MAX_DEPTH)
+                && (w->first_comma_pos[1 - depth] == JSON_NO_POS)
+                && ((i + 1 == w->index.count)
+                    || (strchr(",]}", json_string[w->index.positions[i + 1]]) == NULL)))
+            {
+                w->first_comma_pos[1 - depth] = pos;
+                w->comma_open_pos[1 - depth]
+                    = (2 - depth < JSON_PARALLEL_MAX_DEPTH) ? w->last_open_pos[2 - depth] : JSON_NO_POS;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    w->depth = depth;
+    free(w->index.positions);
+    w->index = (JsonIndex){NULL, 0, 0};
+    return NULL;
+}
+
+static void* _JsonWorker_parse(void* worker_p)
+{
+    JsonWorker* w             = worker_p;
+    JsonParallelParse* par_p  = w->parse_p;
+    JsonObj* json_obj_p       = par_p->json_obj_p;
+    char* json_string         = json_obj_p->json_string;
+    const uint32_t* positions = json_obj_p->index.positions;
+    const bool is_last        = (w->id + 1 == par_p->num_of_workers);
+    JsonItem* root_p          = &json_obj_p->root;
+    if (w->id == 0)
+    {
+        w->error = _deserialize_begin(root_p, json_string, &json_obj_p->index, &w->cursor);
+        if (is_err(w->error))
+        {
+            return NULL;
+        }
+    }
+    else
+    {
+        // Parse the children of a stand-in for the container being split.
+        root_p = JsonItem_new(w->arena_p);
+        if ((root_p == NULL) || is_err(_init_root(w->arena_p, root_p, NULL)))
+        {
+            w->error = ERR_FATAL;
+            return NULL;
+        }
+        w->container_p = root_p;
+        w->cursor      = (JsonCursor){
+            &positions[w->seg_begin], root_p, root_p->next_sibling, EXPECT_KEY};
+        if (par_p->split_depth == 2)
+        {
+            const ValueType value_type = (json_string[positions[par_p->split_open_pos]] == '[')
+                                           ? VALUE_ARRAY
+                                           : VALUE_ITEM;
+            w->container_p             = root_p->next_sibling;
+            w->container_p->key_p      = ""; // Hashed if the stand-in root gets a key table
+            w->cursor.container_p      = w->container_p;
+            w->cursor.curr_item_p
+                = _open_container(w->arena_p, w->element_stack_p, w->container_p, value_type);
+            w->cursor.state = (value_type == VALUE_ARRAY) ? EXPECT_VALUE : EXPECT_KEY;
+            if (w->cursor.curr_item_p == NULL)
+            {
+                w->error = ERR_FATAL;
+                return NULL;
+            }
+        }
+    }
+    w->error = _deserialize_range(
+        w->arena_p,
+        w->element_stack_p,
+        root_p,
+        json_string,
+        json_string + par_p->len,
+        &w->cursor,
+        &positions[w->seg_end]);
+    if (is_err(w->error))
+    {
+        return NULL;
+    }
+    bool at_end;
+    if (is_last)
+    {
+        at_end = (w->cursor.state == EXPECT_END) && (w->cursor.pos_p == &positions[w->seg_end]);
+    }
+    else if (w->id > 0)
+    {
+        at_end = (w->cursor.state == EXPECT_COMMA_OR_CLOSE)
+              && (w->cursor.container_p == w->container_p);
+    }
+    else
+    {
+        // The first segment opens the container being split.
+        at_end = (w->cursor.state == EXPECT_COMMA_OR_CLOSE)
+              && ((par_p->split_depth == 1) ? (w->cursor.container_p == root_p)
+                                            : (w->cursor.container_p->parent == root_p));
+    }
+    if (!at_end)
+    {
+        LOG_ERROR("Unexpected end of JSON segment");
+        w->error = ERR_JSON_INVALID;
+    }
+    return NULL;
+}
+
+// The stand-in of the last worker has been closed, hence an array has its element table.
+static JsonItem* _JsonWorker_first_child(const JsonWorker* w)
+{
+    if ((w->id + 1 == w->parse_p->num_of_workers)
+        && (w->container_p->value.value_type == VALUE_ARRAY))
+    {
+        return w->container_p->value.value_array_p->elements[0];
+    }
+    return w->container_p->value.value_child_p;
+}
+
+// Attach the children of the stand-in of a worker to the container being split.
+static void* _JsonWorker_stitch(void* worker_p)
+{
+    JsonWorker* w            = worker_p;
+    JsonParallelParse* par_p = w->parse_p;
+    JsonItem* container_p    = par_p->split_container_p;
+    JsonArray* array_p       = par_p->split_array_p;
+    if (w->id == 0)
+    {
+        if (array_p != NULL)
+        {
+            memcpy(
+                array_p->elements,
+                w->element_stack_p->items,
+                w->element_stack_p->count * sizeof(JsonItem*));
+            w->element_stack_p->count = 0;
+        }
+        else
+        {
+            w->num_of_children = container_p->value.value_child_p->index + 1;
+        }
+        return NULL;
+    }
+    JsonItem* first_item_p = _JsonWorker_first_child(w);
+    w->num_of_children     = 0;
+    for (JsonItem* item_p = first_item_p; item_p != NULL; item_p = item_p->next_sibling)
+    {
+        item_p->parent = container_p;
+        if (array_p != NULL)
+        {
+            item_p->index += w->element_offset;
+        }
+        w->num_of_children++;
+    }
+    if (array_p != NULL)
+    {
+        JsonItem** elements_p = (w->id + 1 == par_p->num_of_workers)
+                                  ? w->container_p->value.value_array_p->elements
+                                  : w->element_stack_p->items;
+        memcpy(
+            &array_p->elements[w->element_offset],
+            elements_p,
+            w->num_of_children * sizeof(JsonItem*));
+    }
+    else
+    {
+        first_item_p->key_table_p = NULL;
+    }
+    return NULL;
+}
+
+// Build the index of the JsonObj with one chunk per worker.
+static Error _JsonParallelParse_index(JsonParallelParse* par_p)
+{
+    JsonWorker* workers = par_p->workers;
+    const size_t n      = par_p->num_of_workers;
+    // Chunks are made of whole blocks, except for the last one.
+    const size_t chunk_len = (par_p->len / n + JSON_BLOCK_SIZE - 1) / JSON_BLOCK_SIZE * JSON_BLOCK_SIZE;
+    for (size_t i = 0; i < n; i++)
+    {
+        workers[i].start = (i * chunk_len < par_p->len) ? i * chunk_len : par_p->len;
+        workers[i].end   = ((i + 1 == n) || ((i + 1) * chunk_len > par_p->len)) ? par_p->len
+                                                                                : (i + 1) * chunk_len;
+    }
+    _run_workers(workers, n, _JsonWorker_index);
+    bool in_string          = false;
+    size_t num_of_positions = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        return_on_err(workers[i].error);
+        // Prefix xor of the quote parities: the chunks starting inside a string are done again.
+        workers[i].starts_in_string = in_string;
+        workers[i].index_done       = !in_string;
+        in_string ^= workers[i].ends_in_string;
+    }
+    if (in_string)
+    {
+        LOG_ERROR("Unterminated string");
+        return ERR_JSON_INVALID;
+    }
+    _run_workers(workers, n, _JsonWorker_index);
+    for (size_t i = 0; i < n; i++)
+    {
+        return_on_err(workers[i].error);
+        workers[i].first_pos = num_of_positions;
+        num_of_positions += workers[i].index.count;
+        workers[i].end_pos = num_of_positions;
+    }
+    JsonIndex* index_p = &par_p->json_obj_p->index;
+    return_on_err(_JsonIndex_reserve(index_p, num_of_positions));
+    index_p->count = num_of_positions;
+    _run_workers(workers, n, _JsonWorker_scan);
+    // Translate the candidates of every chunk to depths relative to the root object.
+    ptrdiff_t depth = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        JsonWorker* w     = &workers[i];
+        w->split_pos[0]   = JSON_NO_POS;
+        w->split_pos[1]   = JSON_NO_POS;
+        w->split_open_pos = JSON_NO_POS;
+        // Slots of the depths 1 and 2.
+        const ptrdiff_t slot = depth;
+        if ((slot >= 0) && (slot < JSON_PARALLEL_MAX_DEPTH))
+        {
+            w->split_pos[0] = w->first_comma_pos[slot];
+            // Only the last `{[` of a root member matters from now on.
+            w->last_open_pos[0] = w->last_open_pos[slot];
+        }
+        else
+        {
+            w->last_open_pos[0] = JSON_NO_POS;
+        }
+        if ((slot - 1 >= 0) && (slot - 1 < JSON_PARALLEL_MAX_DEPTH))
+        {
+            w->split_pos[1]   = w->first_comma_pos[slot - 1];
+            w->split_open_pos = w->comma_open_pos[slot - 1];
+        }
+        depth += w->depth;
+    }
+    return ERR_ALL_GOOD;
+}
+
+// Choose where the segments start: at the members of the root object, or at the elements of the
+// member holding the most candidates. Return the number of segments.
+static size_t _JsonParallelParse_plan(JsonParallelParse* par_p)
+{
+    JsonWorker* workers = par_p->workers;
+    const size_t n      = par_p->num_of_workers;
+    size_t num_of_root_splits = 0;
+    for (size_t i = 1; i < n; i++)
+    {
+        num_of_root_splits += (workers[i].split_pos[0] != JSON_NO_POS);
+        if ((workers[i].split_pos[1] != JSON_NO_POS) && (workers[i].split_open_pos == JSON_NO_POS))
+        {
+            // The member was opened in a previous chunk.
+            for (size_t j = i; (j > 0) && (workers[i].split_open_pos == JSON_NO_POS); j--)
+            {
+                workers[i].split_open_pos = workers[j - 1].last_open_pos[0];
+            }
+        }
+    }
+    size_t best_open_pos      = JSON_NO_POS;
+    size_t num_of_best_splits = 0;
+    for (size_t i = 1; i < n; i++)
+    {
+        if ((workers[i].split_pos[1] == JSON_NO_POS) || (workers[i].split_open_pos == JSON_NO_POS))
+        {
+            continue;
+        }
+        size_t num_of_splits = 0;
+        for (size_t j = 1; j < n; j++)
+        {
+            num_of_splits += (workers[j].split_pos[1] != JSON_NO_POS)
+                          && (workers[j].split_open_pos == workers[i].split_open_pos);
+        }
+        if (num_of_splits > num_of_best_splits)
+        {
+            best_open_pos      = workers[i].split_open_pos;
+            num_of_best_splits = num_of_splits;
+        }
+    }
+    par_p->split_depth    = (num_of_best_splits > num_of_root_splits) ? 2 : 1;
+    par_p->split_open_pos = best_open_pos;
+    // Worker `num_of_segments` takes the segment starting at the split found by worker `i`.
+    size_t num_of_segments = 1;
+    for (size_t i = 1; i < n; i++)
+    {
+        const size_t split_pos = workers[i].split_pos[par_p->split_depth - 1];
+        if ((split_pos != JSON_NO_POS)
+            && ((par_p->split_depth == 1)
+                || ((workers[i].split_open_pos == best_open_pos) && (best_open_pos != JSON_NO_POS))))
+        {
+            workers[num_of_segments - 1].seg_end = split_pos;
+            workers[num_of_segments].seg_begin   = split_pos + 1;
+            num_of_segments++;
+        }
+    }
+    workers[num_of_segments - 1].seg_end = par_p->json_obj_p->index.count;
+    return num_of_segments;
+}
+
+// Parse one segment per worker and stitch them into the tree of the JsonObj.
+static Error _JsonParallelParse_build(JsonParallelParse* par_p)
+{
+    JsonObj* json_obj_p = par_p->json_obj_p;
+    JsonWorker* workers = par_p->workers;
+    const size_t n      = par_p->num_of_workers;
+    _run_workers(workers, n, _JsonWorker_parse);
+    for (size_t i = 0; i < n; i++)
+    {
+        return_on_err(workers[i].error);
+    }
+    JsonItem* container_p = (par_p->split_depth == 1) ? &json_obj_p->root
+                                                       : workers[0].cursor.container_p;
+    const JsonWorker* last_worker_p = &workers[n - 1];
+    size_t num_of_elements          = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        workers[i].element_offset = num_of_elements;
+        if (i == 0)
+        {
+            num_of_elements += workers[i].element_stack_p->count;
+        }
+        else if (&workers[i] == last_worker_p)
+        {
+            num_of_elements += (container_p->value.value_type == VALUE_ARRAY)
+                                 ? last_worker_p->container_p->value.value_array_p->len
+                                 : 0;
+        }
+        else
+        {
+            num_of_elements += workers[i].element_stack_p->count;
+        }
+    }
+    par_p->split_container_p = container_p;
+    par_p->split_array_p     = NULL;
+    if (container_p->value.value_type == VALUE_ARRAY)
+    {
+        par_p->split_array_p = _JsonArena_alloc(
+            &json_obj_p->arena, sizeof(JsonArray) + num_of_elements * sizeof(JsonItem*));
+        if (par_p->split_array_p == NULL)
+        {
+            return ERR_FATAL;
+        }
+        par_p->split_array_p->len          = num_of_elements;
+        container_p->value.value_array_p = par_p->split_array_p;
+    }
+    _run_workers(workers, n, _JsonWorker_stitch);
+    for (size_t i = 1; i < n; i++)
+    {
+        workers[i - 1].cursor.curr_item_p->next_sibling = _JsonWorker_first_child(&workers[i]);
+    }
+    if (par_p->split_depth == 2)
+    {
+        // The members of the root object after the one being split.
+        container_p->next_sibling = last_worker_p->container_p->next_sibling;
+        for (JsonItem* item_p = container_p->next_sibling; item_p != NULL;
+             item_p           = item_p->next_sibling)
+        {
+            item_p->parent = &json_obj_p->root;
+        }
+    }
+    // Build the key tables of the objects spanning several segments.
+    if (container_p->value.value_type != VALUE_ARRAY)
+    {
+        size_t num_of_children = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            num_of_children += workers[i].num_of_children;
+        }
+        container_p->value.value_child_p->index = num_of_children - 1;
+        return_on_err(_close_container(&json_obj_p->arena, NULL, container_p, NULL));
+    }
+    if (par_p->split_depth == 2)
+    {
+        size_t num_of_members = 0;
+        for (const JsonItem* item_p = json_obj_p->root.next_sibling; item_p != NULL;
+             item_p                 = item_p->next_sibling)
+        {
+            num_of_members++;
+        }
+        json_obj_p->root.next_sibling->index = num_of_members - 1;
+        return_on_err(_close_container(&json_obj_p->arena, NULL, &json_obj_p->root, NULL));
+    }
+    // Hand the chunks of the workers over to the JsonObj.
+    JsonArenaChunk* last_chunk_p = json_obj_p->arena.curr_chunk_p;
+    for (size_t i = 1; i < n; i++)
+    {
+        while ((last_chunk_p != NULL) && (last_chunk_p->next_p != NULL))
+        {
+            last_chunk_p = last_chunk_p->next_p;
+        }
+        if (workers[i].arena.first_chunk_p != NULL)
+        {
+            last_chunk_p->next_p = workers[i].arena.first_chunk_p;
+        }
+        workers[i].arena.first_chunk_p = NULL;
+        workers[i].arena.curr_chunk_p  = NULL;
+    }
+    while ((last_chunk_p != NULL) && (last_chunk_p->next_p != NULL))
+    {
+        last_chunk_p = last_chunk_p->next_p;
+    }
+    json_obj_p->arena.curr_chunk_p = last_chunk_p;
+    return ERR_ALL_GOOD;
+}
+
+// Parse `len` bytes of `buf` in place, as JsonObj_new_insitu does, on up to `num_of_threads`
+// threads. Each thread gets at least JSON_PARALLEL_MIN_CHUNK_SIZE bytes. A document whose root
+// object cannot be split is parsed on one thread after the parallel indexing stage.
+Error JsonObj_new_parallel(
+    char* buf,
+    size_t len,
+    size_t num_of_threads,
+    JsonObj* out_json_obj_p)
+{
+    size_t num_of_workers = len / JSON_PARALLEL_MIN_CHUNK_SIZE;
+    if (num_of_workers > num_of_threads)
+    {
+        num_of_workers = num_of_threads;
+    }
+    if ((num_of_workers <= 1) || (len >= UINT32_MAX))
+    {
+        return JsonObj_new_insitu(buf, len, out_json_obj_p);
+    }
+    _JsonObj_prepare(out_json_obj_p);
+    // A buffer kept by JsonObj_reset is of no use here.
+    free(out_json_obj_p->json_string);
+    out_json_obj_p->json_string          = buf;
+    out_json_obj_p->json_string_capacity = 0;
+    return_on_err(_JsonObj_init_root(out_json_obj_p));
+    JsonWorker* workers = calloc(num_of_workers, sizeof(JsonWorker));
+    if (workers == NULL)
+    {
+        JsonObj_destroy(out_json_obj_p);
+        LOG_PERROR("Out of memory");
+        return ERR_FATAL;
+    }
+    JsonParallelParse parse = {
+        .json_obj_p     = out_json_obj_p,
+        .index_blocks   = _select_index_kernel(),
+        .len            = len,
+        .workers        = workers,
+        .num_of_workers = num_of_workers,
+    };
+    for (size_t i = 0; i < num_of_workers; i++)
+    {
+        workers[i].parse_p         = &parse;
+        workers[i].id              = i;
+        workers[i].arena_p         = (i == 0) ? &out_json_obj_p->arena : &workers[i].arena;
+        workers[i].element_stack_p = (i == 0) ? &out_json_obj_p->element_stack
+                                              : &workers[i].element_stack;
+    }
+    LOG_DEBUG("JSON deserialization started.");
+    Error ret_res = _JsonParallelParse_index(&parse);
+    if (is_ok(ret_res))
+    {
+        parse.num_of_workers = _JsonParallelParse_plan(&parse);
+        if (parse.num_of_workers > 1)
+        {
+            ret_res = _JsonParallelParse_build(&parse);
+        }
+        else
+        {
+            ret_res = _deserialize(
+                &out_json_obj_p->arena,
+                &out_json_obj_p->element_stack,
+                &out_json_obj_p->root,
+                buf,
+                len,
+                &out_json_obj_p->index);
+        }
+    }
+    out_json_obj_p->parallel_scratch_bytes = num_of_workers * sizeof(JsonWorker);
+    for (size_t i = 0; i < num_of_workers; i++)
+    {
+        out_json_obj_p->parallel_scratch_bytes
+            += workers[i].index.capacity * sizeof(uint32_t)
+             + workers[i].element_stack.capacity * sizeof(JsonItem*);
+        free(workers[i].index.positions);
+        free(workers[i].element_stack.items);
+        _JsonArena_destroy(&workers[i].arena);
+    }
+    free(workers);
+    if (is_err(ret_res))
+    {
+        JsonObj_destroy(out_json_obj_p);
+        LOG_ERROR("Failed to deserialize JSON");
+        return (ret_res == ERR_FATAL) ? ERR_FATAL : ERR_JSON_INVALID;
+    }
+    LOG_DEBUG("JSON deserialization ended successfully.")
+    return ERR_ALL_GOOD;
+}
+
+// ---------- Error context ----------
+// Getters describe where they look for a value in a JsonSite, which costs a few stores, and turn
+// it into a JsonError only when the lookup fails or converts the value. The JsonError passed to
+// Json_get_err takes precedence over the one attached to the document. A tree item reaches its
+// JsonObj through its root, so that the walk up the tree is only paid on those paths.
+
+// Where a getter looks for a value.
+typedef struct JsonSite
+{
+    const JsonItem* item_p; // Item of a tree, leading to its JsonObj; NULL otherwise
+    JsonError* error_p;     // JsonError attached to a JsonDoc or a JsonTape
+    const char* key_p;
+    size_t index;
+    size_t offset; // Known for a JsonDoc or a JsonTape, computed from `item_p` in a tree
+} JsonSite;
+
+static _Thread_local JsonError* _json_call_error_p = NULL;
+
+void _JsonError_begin(JsonError* error_p) { _json_call_error_p = error_p; }
+
+Error _JsonError_end(Error ret_res)
+{
+    _json_call_error_p = NULL;
+    return ret_res;
+}
+
+// Offset of the key or of the string value of `item_p` in the buffer of `obj_p`, if it has one.
+static size_t _JsonItem_offset(const JsonItem* item_p, const JsonObj* obj_p)
+{
+    const char* json_string = obj_p->json_string;
+    const char* str_p
+        = (item_p->value.value_type == VALUE_STR) ? item_p->value.value_char_p : item_p->key_p;
+    const size_t len = (obj_p->json_string_capacity > 0) ? obj_p->json_string_capacity
+                                                         : obj_p->json_string_mapped_len;
+    // Keys copied by the streaming parser are not in the buffer.
+    if ((json_string == NULL) || (str_p == NULL) || (str_p < json_string)
+        || ((len > 0) && (str_p >= json_string + len)))
+    {
+        return JSON_NO_OFFSET;
+    }
+    return (size_t)(str_p - json_string);
+}
+
+static void _JsonError_record(
+    const JsonSite* site_p,
+    Error code,
+    ValueType requested,
+    ValueType found,
+    const char* note)
+{
+    JsonError* error_p     = _json_call_error_p;
+    const JsonObj* obj_p   = NULL;
+    const JsonItem* root_p = site_p->item_p;
+    if (root_p != NULL)
+    {
+        while ((root_p->parent != NULL) && (root_p->parent != root_p))
+        {
+            root_p = root_p->parent;
+        }
+        obj_p = (root_p->parent == root_p) ? root_p->obj_p : NULL;
+    }
+    if (error_p == NULL)
+    {
+        error_p = (obj_p != NULL) ? obj_p->error_p : site_p->error_p;
+    }
+    if (error_p == NULL)
+    {
+        return;
+    }
+    size_t offset = site_p->offset;
+    if ((offset == JSON_NO_OFFSET) && (obj_p != NULL) && (found != VALUE_INVALID))
+    {
+        offset = _JsonItem_offset(site_p->item_p, obj_p);
+    }
+    *error_p = (JsonError){
+        .code      = code,
+        .note      = note,
+        .key_p     = site_p->key_p,
+        .index     = site_p->index,
+        .offset    = offset,
+        .requested = requested,
+        .found     = found,
+    };
+}
+
+// ---------- Lazy documents ----------
+// A JsonDoc is nothing but the structural index of its buffer. Each Json_get walks the index from
+// the requested object or array, compares the keys in place and steps over the other values: a
+// string takes two positions, a literal or a number one, and a container all the positions up to
+// its matching bracket. Only the value found is converted, so the cost grows with the number of
+// values read rather than with the size of the document. The grammar is checked on the way, but
+// skipped containers are only checked for matching brackets.
+
+// Character at the position `pos` of the index, or '\0' past its end.
+static inline char _JsonDoc_char(const JsonDoc* doc_p, size_t pos)
+{
+    return (pos < doc_p->json_obj.index.count)
+               ? doc_p->json_obj.json_string[doc_p->json_obj.index.positions[pos]]
+               : '\0';
+}
+
+// Words of 64 open containers kept on the stack by _skip_value before it moves them to the heap.
+#define JSON_SKIP_STACK_WORDS 8
+
+// Change of depth at each character of the index.
+static const int8_t _bracket_depth[256] = {['{'] = 1, ['['] = 1, ['}'] = -1, [']'] = -1};
+
+// Move `*pos_p` from the `{` or `[` at `*pos_p` in `index_p` to the position following its
+// matching bracket. Strings are not in the index but for their quotes, so only brackets are seen.
+static Error _skip_container(const char* json_string, const JsonIndex* index_p, size_t* pos_p)
+{
+    const uint32_t* positions = index_p->positions;
+    const size_t count        = index_p->count;
+    size_t pos                = *pos_p;
+    // Bit 0 of `is_object` tells whether the innermost open container is an object. Every 64
+    // levels, the bits of the outer containers are moved to `spilled_p`.
+    uint64_t is_object = 0;
+    uint64_t stack[JSON_SKIP_STACK_WORDS];
+    uint64_t* spilled_p = stack;
+    size_t num_of_words = JSON_SKIP_STACK_WORDS;
+    size_t depth        = 0;
+    Error ret_res       = ERR_ALL_GOOD;
+    do
+    {
+        const char c      = json_string[positions[pos++]];
+        const int8_t step = _bracket_depth[(unsigned char)c];
+        if (step > 0)
+        {
+            if ((depth > 0) && (depth % 64 == 0))
+            {
+                if (depth / 64 > num_of_words)
+                {
+                    uint64_t* grown_p = malloc(2 * num_of_words * sizeof(uint64_t));
+                    if (grown_p == NULL)
+                    {
+                        LOG_PERROR("Out of memory");
+                        ret_res = ERR_NULL;
+                        break;
+                    }
+                    memcpy(grown_p, spilled_p, num_of_words * sizeof(uint64_t));
+                    if (spilled_p != stack)
+                    {
+                        free(spilled_p);
+                    }
+                    spilled_p = grown_p;
+                    num_of_words *= 2;
+                }
+                spilled_p[depth / 64 - 1] = is_object;
+            }
+            is_object = (is_object << 1) | (c == '{');
+            depth++;
+        }
+        else if (step < 0)
+        {
+            if ((is_object & 1) != (c == '}'))
+            {
+                LOG_ERROR("Unexpected `%c`", c);
+                ret_res = ERR_JSON_INVALID;
+                break;
+            }
+            is_object >>= 1;
+            depth--;
+            if ((depth > 0) && (depth % 64 == 0))
+            {
+                is_object = spilled_p[depth / 64 - 1];
+            }
+        }
+    } while ((depth > 0) && (pos < count));
+    if (spilled_p != stack)
+    {
+        free(spilled_p);
+    }
+    if (is_ok(ret_res) && (depth > 0))
+    {
+        LOG_ERROR("Unbalanced brackets");
+        ret_res = ERR_JSON_INVALID;
+    }
+    if (is_ok(ret_res))
+    {
+        *pos_p = pos;
+    }
+    return ret_res;
+}
+
+// Move `*pos_p` from the first position of a value in `index_p` to the position following it.
+static Error _skip_value(const char* json_string, const JsonIndex* index_p, size_t* pos_p)
+{
+    const uint32_t* positions = index_p->positions;
+    const size_t count        = index_p->count;
+    size_t pos                = *pos_p;
+    switch ((pos < count) ? json_string[positions[pos]] : '\0')
+    {
+    case '"':
+        pos += 2;
+        break;
+    case '{':
+    case '[':
+        return_on_err(_skip_container(json_string, index_p, &pos));
+        break;
+    case '\0':
+    case ',':
+    case ':':
+    case '}':
+    case ']':
+        LOG_ERROR("Expected value");
+        return ERR_JSON_INVALID;
+    default:
+        pos++;
+        break;
+    }
+    *pos_p = pos;
+    return ERR_ALL_GOOD;
+}
+
+static inline Error _JsonDoc_skip(const JsonDoc* doc_p, size_t* pos_p)
+{
+    return _skip_value(doc_p->json_obj.json_string, &doc_p->json_obj.index, pos_p);
+}
+
+// Decode the string or the key at the position `pos` in place, unless it has already been read. The
+// index entry of its closing quote is then moved onto the terminator, so that a string is decoded
+// only once however many times it is read.
+static Error _JsonDoc_str(
+    const JsonDoc* doc_p,
+    size_t pos,
+    const char** out_str_pp,
+    uint32_t* out_len_p)
+{
+    char* json_string     = doc_p->json_obj.json_string;
+    uint32_t* quote_pos_p = &doc_p->json_obj.index.positions[pos];
+    if (json_string[quote_pos_p[1]] == '\0')
+    {
+        *out_str_pp = &json_string[quote_pos_p[0] + 1];
+        *out_len_p  = quote_pos_p[1] - quote_pos_p[0] - 1;
+        return ERR_ALL_GOOD;
+    }
+    return_on_err(_terminate_str(json_string, quote_pos_p, out_str_pp, out_len_p));
+    quote_pos_p[1] = quote_pos_p[0] + 1 + *out_len_p;
+    return ERR_ALL_GOOD;
+}
+
+// Read the value at the position `pos`. Strings are decoded in place; objects and arrays only get
+// their type.
+static Error _JsonDoc_read(const JsonDoc* doc_p, size_t pos, JsonValue* value_p)
+{
+    char* json_string = doc_p->json_obj.json_string;
+    switch (_JsonDoc_char(doc_p, pos))
+    {
+    case '"':
+        value_p->value_type = VALUE_STR;
+        return _JsonDoc_str(doc_p, pos, &value_p->value_char_p, &value_p->value_len);
+    case '{':
+        value_p->value_type    = VALUE_ITEM;
+        value_p->value_child_p = NULL;
+        return ERR_ALL_GOOD;
+    case '[':
+        value_p->value_type    = VALUE_ARRAY;
+        value_p->value_array_p = NULL;
+        return ERR_ALL_GOOD;
+    case '\0':
+        LOG_ERROR("Expected value");
+        return ERR_JSON_INVALID;
+    default:
+        return _deserialize_scalar(
+            &json_string[doc_p->json_obj.index.positions[pos]],
+            json_string + doc_p->len,
+            value_p);
+    }
+}
+
+// Site of the value at `pos` in `doc_p`, or of a missing value if `pos` is JSON_NO_OFFSET.
+static inline JsonSite _JsonDoc_site(
+    const JsonDoc* doc_p,
+    const char* key_p,
+    size_t index,
+    size_t pos)
+{
+    JsonSite site = {.key_p = key_p, .index = index, .offset = JSON_NO_OFFSET};
+    if (doc_p != NULL)
+    {
+        site.error_p = doc_p->json_obj.error_p;
+        if (pos != JSON_NO_OFFSET)
+        {
+            site.offset = doc_p->json_obj.index.positions[pos];
+        }
+    }
+    return site;
+}
+
+// Find the value of `key`, of length `key_len`, in `item_p`. Returns ERR_JSON_MISSING_ENTRY if
+// there is none.
+static Error _JsonDocItem_find(
+    const JsonDocItem* item_p,
+    const char* key,
+    size_t key_len,
+    size_t* out_pos_p)
+{
+    if ((item_p == NULL) || (item_p->doc_p == NULL))
+    {
+        LOG_ERROR("Input item is NULL - key `%s`.", key);
+        return ERR_NULL;
+    }
+    const JsonDoc* doc_p = item_p->doc_p;
+    size_t pos           = item_p->pos + 1;
+    if (_JsonDoc_char(doc_p, pos) == '}')
+    {
+        return ERR_JSON_MISSING_ENTRY;
+    }
+    while (true)
+    {
+        if ((_JsonDoc_char(doc_p, pos) != '"') || (_JsonDoc_char(doc_p, pos + 2) != ':'))
+        {
+            LOG_ERROR("Expected key followed by `:`");
+            return ERR_JSON_INVALID;
+        }
+        // Keys are decoded in place the first time they are compared.
+        const char* key_p;
+        uint32_t len;
+        return_on_err(_JsonDoc_str(doc_p, pos, &key_p, &len));
+        pos += 3;
+        if (_keys_equal(key_p, len, key, key_len))
+        {
+            *out_pos_p = pos;
+            return ERR_ALL_GOOD;
+        }
+        return_on_err(_JsonDoc_skip(doc_p, &pos));
+        const char curr_char = _JsonDoc_char(doc_p, pos);
+        if (curr_char == '}')
+        {
+            return ERR_JSON_MISSING_ENTRY;
+        }
+        if (curr_char != ',')
+        {
+            LOG_ERROR("Expected `,` or `}`");
+            return ERR_JSON_INVALID;
+        }
+        pos++;
+    }
+}
+
+// Find the element `index` of `array_p`, starting from the last element reached if it comes
+// before. Returns ERR_NULL if there is none.
+static Error _JsonDocArray_find(JsonDocArray* array_p, size_t index, size_t* out_pos_p)
+{
+    if ((array_p == NULL) || (array_p->doc_p == NULL))
+    {
+        LOG_ERROR("Input item is NULL");
+        return ERR_JSON_MISSING_ENTRY;
+    }
+    const JsonDoc* doc_p = array_p->doc_p;
+    size_t curr_index    = 0;
+    size_t pos           = array_p->pos + 1;
+    if ((array_p->cached_pos > 0) && (array_p->cached_index <= index))
+    {
+        curr_index = array_p->cached_index;
+        pos        = array_p->cached_pos;
+    }
+    else if (_JsonDoc_char(doc_p, pos) == ']')
+    {
+        return ERR_NULL;
+    }
+    while (curr_index < index)
+    {
+        return_on_err(_JsonDoc_skip(doc_p, &pos));
+        const char curr_char = _JsonDoc_char(doc_p, pos);
+        if (curr_char == ']')
+        {
+            return ERR_NULL;
+        }
+        if (curr_char != ',')
+        {
+            LOG_ERROR("Expected `,` or `]`");
+            return ERR_JSON_INVALID;
+        }
+        pos++;
+        curr_index++;
+    }
+    array_p->cached_index = curr_index;
+    array_p->cached_pos   = pos;
+    *out_pos_p            = pos;
+    return ERR_ALL_GOOD;
+}
+
+// Index `len` bytes of `buf` and nothing else. Like JsonObj_new_insitu, `buf` is borrowed and
+// string values are null-terminated in place when they are read.
+Error JsonDoc_new(
+    char* buf,
+    size_t len,
+    JsonDoc* out_doc_p)
+{
+    JsonObj* json_obj_p   = &out_doc_p->json_obj;
+    json_obj_p->recycle_p = NULL;
+    _JsonObj_prepare(json_obj_p);
+    json_obj_p->json_string       = buf;
+    json_obj_p->root.next_sibling = NULL;
+    out_doc_p->len                = len;
+    if ((buf == NULL) || (len == 0))
+    {
+        LOG_ERROR("Empty JSON string detected");
+        return ERR_EMPTY_STRING;
+    }
+    Error ret_res = _index_structurals(_select_index_kernel(), buf, len, &json_obj_p->index);
+    if (is_ok(ret_res) && (_JsonDoc_char(out_doc_p, 0) != '{'))
+    {
+        LOG_ERROR("Invalid JSON string.");
+        ret_res = ERR_JSON_INVALID;
+    }
+    if (is_err(ret_res))
+    {
+        JsonDoc_destroy(out_doc_p);
+        return (ret_res == ERR_FATAL) ? ERR_FATAL : ERR_JSON_INVALID;
+    }
+    return ERR_ALL_GOOD;
+}
+
+void JsonDoc_destroy(JsonDoc* doc_p)
+{
+    if (doc_p == NULL)
+    {
+        return;
+    }
+    JsonObj_destroy(&doc_p->json_obj);
+    doc_p->len = 0;
+}
+
+// Count the elements of `array_p` by stepping over them, or the elements before the first error.
+size_t JsonDocArray_len(JsonDocArray* array_p)
+{
+    if ((array_p == NULL) || (array_p->doc_p == NULL))
+    {
+        return 0;
+    }
+    size_t pos = array_p->pos + 1;
+    if (_JsonDoc_char(array_p->doc_p, pos) == ']')
+    {
+        return 0;
+    }
+    size_t len = 1;
+    while (is_ok(_JsonDoc_skip(array_p->doc_p, &pos))
+           && (_JsonDoc_char(array_p->doc_p, pos) == ','))
+    {
+        pos++;
+        len++;
+    }
+    return len;
+}
+
+// ---------- Compiled paths ----------
+// JsonPath_compile splits a path into steps once, with the length and the hash of every key, so
+// that JsonPath_eval only follows them: keys are looked up through the key table of large objects
+// without hashing them again, and indices go straight to the element table of arrays.
+
+// Parse `path`, a sequence of keys separated by `.` and of indices in brackets, e.g. `a.b[3][0].c`.
+// A key runs up to the next `.` or `[`, so it cannot contain them. With `allow_any_index`, an index
+// may be `*`, see JsonProjection_compile.
+static Error _JsonPath_compile(const char* path, bool allow_any_index, JsonPath* out_path_p)
+{
+    out_path_p->steps        = NULL;
+    out_path_p->num_of_steps = 0;
+    if ((path == NULL) || (*path == '\0'))
+    {
+        LOG_ERROR("Empty path");
+        return ERR_EMPTY_STRING;
+    }
+    // Every step but the first starts with a `.` or a `[`.
+    size_t max_num_of_steps = 1;
+    for (const char* char_p = path; *char_p != '\0'; char_p++)
+    {
+        max_num_of_steps += (*char_p == '.') || (*char_p == '[');
+    }
+    const size_t path_len = strlen(path);
+    JsonPathStep* steps   = malloc(max_num_of_steps * sizeof(JsonPathStep) + path_len + 1);
+    if (steps == NULL)
+    {
+        LOG_PERROR("Out of memory");
+        return ERR_FATAL;
+    }
+    char* key_p         = (char*)&steps[max_num_of_steps];
+    size_t num_of_steps = 0;
+    const char* char_p  = path;
+    while (*char_p != '\0')
+    {
+        JsonPathStep* step_p = &steps[num_of_steps];
+        if (*char_p == '[')
+        {
+            char_p++;
+            size_t index         = 0;
+            const char* digits_p = char_p;
+            while (_is_digit(*char_p) && (index <= (SIZE_MAX - 9) / 10))
+            {
+                index = index * 10 + (size_t)(*char_p - '0');
+                char_p++;
+            }
+            const bool any_index = allow_any_index && (char_p == digits_p) && (*char_p == '*');
+            if (any_index)
+            {
+                index = JSON_PATH_ANY_INDEX;
+                char_p++;
+            }
+            if ((!any_index && (char_p == digits_p)) || (*char_p != ']'))
+            {
+                LOG_ERROR("Invalid index in path `%s`", path);
+                free(steps);
+                return ERR_INVALID;
+            }
+            char_p++;
+            step_p->key_p    = NULL;
+            step_p->key_len  = 0;
+            step_p->key_hash = 0;
+            step_p->index    = index;
+        }
+        else
+        {
+            if ((num_of_steps > 0) && (*char_p++ != '.'))
+            {
+                LOG_ERROR("Expected `.` or `[` in path `%s`", path);
+                free(steps);
+                return ERR_INVALID;
+            }
+            const size_t key_len = strcspn(char_p, ".[");
+            if (key_len == 0)
+            {
+                LOG_ERROR("Empty key in path `%s`", path);
+                free(steps);
+                return ERR_INVALID;
+            }
+            memcpy(key_p, char_p, key_len);
+            key_p[key_len] = '\0';
+            step_p->key_p    = key_p;
+            step_p->key_len  = key_len;
+            step_p->key_hash = _hash_key(key_p, key_len);
+            step_p->index    = 0;
+            key_p += key_len + 1;
+            char_p += key_len;
+        }
+        num_of_steps++;
+    }
+    out_path_p->steps        = steps;
+    out_path_p->num_of_steps = num_of_steps;
+    return ERR_ALL_GOOD;
+}
+
+Error JsonPath_compile(const char* path, JsonPath* out_path_p)
+{
+    return _JsonPath_compile(path, false, out_path_p);
+}
+
+void JsonPath_destroy(JsonPath* path_p)
+{
+    if (path_p == NULL)
+    {
+        return;
+    }
+    free(path_p->steps);
+    path_p->steps        = NULL;
+    path_p->num_of_steps = 0;
+}
+
+// Follow `path_p` from the object whose first member is `item_p`, and return the item holding the
+// value it leads to. `site_p` follows the steps, and a step that fails is recorded with the type
+// the caller requested if the value is missing, or with the type the step needed otherwise.
+static Error _JsonPath_find(
+    const JsonItem* item_p,
+    const JsonPath* path_p,
+    ValueType requested,
+    JsonSite* site_p,
+    const JsonItem** out_p)
+{
+    if ((path_p == NULL) || (path_p->num_of_steps == 0))
+    {
+        LOG_ERROR("Path not compiled");
+        return ERR_NULL;
+    }
+    // Value reached so far, starting with the object.
+    ValueType value_type     = VALUE_ITEM;
+    const JsonItem* child_p  = item_p;
+    const JsonArray* array_p = NULL;
+    for (size_t i = 0; i < path_p->num_of_steps; i++)
+    {
+        const JsonPathStep* step_p = &path_p->steps[i];
+        site_p->key_p              = step_p->key_p;
+        site_p->index              = step_p->index;
+        if (step_p->key_p != NULL)
+        {
+            // An empty object is left undefined.
+            if ((value_type != VALUE_ITEM) && (value_type != VALUE_UNDEFINED))
+            {
+                _JsonError_record(
+                    site_p, ERR_TYPE_MISMATCH, VALUE_ITEM, value_type, "path step type mismatch");
+                return ERR_TYPE_MISMATCH;
+            }
+            item_p = ((value_type == VALUE_ITEM) && (child_p != NULL) && (child_p->key_p != NULL))
+                         ? child_p
+                         : NULL;
+            if ((item_p != NULL) && (item_p->key_table_p != NULL))
+            {
+                item_p = _JsonKeyTable_find_hashed(
+                    item_p->key_table_p, step_p->key_p, step_p->key_len, step_p->key_hash);
+            }
+            else
+            {
+                while ((item_p != NULL)
+                       && !_keys_equal(
+                           item_p->key_p, item_p->key_len, step_p->key_p, step_p->key_len))
+                {
+                    item_p = item_p->next_sibling;
+                }
+            }
+            if (item_p == NULL)
+            {
+                _JsonError_record(
+                    site_p, ERR_JSON_MISSING_ENTRY, requested, VALUE_INVALID, "key not found");
+                return ERR_JSON_MISSING_ENTRY;
+            }
+        }
+        else
+        {
+            if (value_type != VALUE_ARRAY)
+            {
+                _JsonError_record(
+                    site_p, ERR_TYPE_MISMATCH, VALUE_ARRAY, value_type, "path step type mismatch");
+                return ERR_TYPE_MISMATCH;
+            }
+            if (step_p->index >= array_p->len)
+            {
+                _JsonError_record(
+                    site_p, ERR_NULL, requested, VALUE_INVALID, "index out of bounds");
+                return ERR_NULL;
+            }
+            item_p = array_p->elements[step_p->index];
+        }
+        site_p->item_p = item_p;
+        value_type     = item_p->value.value_type;
+        child_p    = item_p->value.value_child_p;
+        array_p    = item_p->value.value_array_p;
+    }
+    *out_p = item_p;
+    return ERR_ALL_GOOD;
+}
+
+// Same as _JsonPath_find in a JsonDoc, returning the position of the value in the index.
+static Error _JsonPath_find_pos(
+    const JsonDoc* doc_p,
+    const JsonPath* path_p,
+    ValueType requested,
+    JsonSite* site_p,
+    size_t* out_pos_p)
+{
+    if ((doc_p == NULL) || (path_p == NULL) || (path_p->num_of_steps == 0))
+    {
+        LOG_ERROR("Document or path missing");
+        return ERR_NULL;
+    }
+    size_t pos = 0;
+    for (size_t i = 0; i < path_p->num_of_steps; i++)
+    {
+        const JsonPathStep* step_p = &path_p->steps[i];
+        const ValueType step_type  = (step_p->key_p != NULL) ? VALUE_ITEM : VALUE_ARRAY;
+        site_p->key_p              = step_p->key_p;
+        site_p->index              = step_p->index;
+        JsonValue value;
+        return_on_err(_JsonDoc_read(doc_p, pos, &value));
+        if (value.value_type != step_type)
+        {
+            _JsonError_record(
+                site_p, ERR_TYPE_MISMATCH, step_type, value.value_type, "path step type mismatch");
+            return ERR_TYPE_MISMATCH;
+        }
+        site_p->offset = JSON_NO_OFFSET;
+        Error ret_res  = ERR_ALL_GOOD;
+        if (step_p->key_p != NULL)
+        {
+            const JsonDocItem doc_item = {doc_p, pos};
+            ret_res = _JsonDocItem_find(&doc_item, step_p->key_p, step_p->key_len, &pos);
+        }
+        else
+        {
+            JsonDocArray doc_array = {doc_p, pos, 0, 0};
+            ret_res                = _JsonDocArray_find(&doc_array, step_p->index, &pos);
+        }
+        if ((ret_res == ERR_JSON_MISSING_ENTRY) || (ret_res == ERR_NULL))
+        {
+            _JsonError_record(
+                site_p,
+                ret_res,
+                requested,
+                VALUE_INVALID,
+                (ret_res == ERR_NULL) ? "index out of bounds" : "key not found");
+        }
+        return_on_err(ret_res);
+        site_p->offset = doc_p->json_obj.index.positions[pos];
+    }
+    *out_pos_p = pos;
+    return ERR_ALL_GOOD;
+}
+
+// ---------- Projections ----------
+// JsonProjection_compile merges the paths of a projection into a trie whose root stands for the
+// root object. Between the two stages of JsonObj_new_projected, `_JsonProjection_filter` walks the
+// structural index along the trie and compacts it in place. A value is left out when no path
+// reaches into it: no path names it, or the paths through it go on with keys and it is not an
+// object, or with indices and it is not an array. A member left out is removed with its key. An
+// element left out keeps a single position, on its first character overwritten with a space, so
+// that the indices of the next ones hold: stage 1 never indexes a space, so stage 2 reads it as an
+// element left out and leaves it undefined. What is left out is stepped over by bracket matching,
+// as in a JsonDoc, and stage 2 never sees it: no string is decoded and no number converted, and an
+// element costs one undefined item.
+
+// Find the child of `parent` for a key, or for an index when `key_p` is NULL, and add it if needed.
+static Error _JsonProjection_child(
+    JsonProjection* projection_p,
+    size_t parent,
+    const char* key_p,
+    size_t key_len,
+    size_t index,
+    size_t* out_child_p)
+{
+    size_t* link_p = &projection_p->nodes[parent].first_child;
+    for (; *link_p != 0; link_p = &projection_p->nodes[*link_p].next_sibling)
+    {
+        const JsonProjectionNode* node_p = &projection_p->nodes[*link_p];
+        if ((key_p == NULL) ? ((node_p->key_p == NULL) && (node_p->index == index))
+                            : ((node_p->key_p != NULL)
+                               && _keys_equal(node_p->key_p, node_p->key_len, key_p, key_len)))
+        {
+            *out_child_p = *link_p;
+            return ERR_ALL_GOOD;
+        }
+    }
+    if (projection_p->num_of_nodes == projection_p->nodes_capacity)
+    {
+        const size_t capacity = 2 * projection_p->nodes_capacity;
+        // `link_p` points into the nodes.
+        const ptrdiff_t link_offset = (char*)link_p - (char*)projection_p->nodes;
+        JsonProjectionNode* nodes
+            = realloc(projection_p->nodes, capacity * sizeof(JsonProjectionNode));
+        if (nodes == NULL)
+        {
+            LOG_PERROR("Out of memory");
+            return ERR_FATAL;
+        }
+        link_p                       = (size_t*)((char*)nodes + link_offset);
+        projection_p->nodes          = nodes;
+        projection_p->nodes_capacity = capacity;
+    }
+    const size_t child = projection_p->num_of_nodes++;
+    projection_p->nodes[child]
+        = (JsonProjectionNode){key_p, key_len, index, 0, 0, false, false, false};
+    *link_p      = child;
+    *out_child_p = child;
+    projection_p->nodes[parent].has_keys |= (key_p != NULL);
+    projection_p->nodes[parent].has_indices |= (key_p == NULL);
+    return ERR_ALL_GOOD;
+}
+
+// Add the subtree of `src` to that of `dst`.
+static Error _JsonProjection_merge(JsonProjection* projection_p, size_t dst, size_t src)
+{
+    projection_p->nodes[dst].keep_all |= projection_p->nodes[src].keep_all;
+    // Adding a child may move the nodes.
+    size_t child = projection_p->nodes[src].first_child;
+    while (child != 0)
+    {
+        const JsonProjectionNode node = projection_p->nodes[child];
+        size_t dst_child;
+        return_on_err(_JsonProjection_child(
+            projection_p, dst, node.key_p, node.key_len, node.index, &dst_child));
+        return_on_err(_JsonProjection_merge(projection_p, dst_child, child));
+        child = projection_p->nodes[child].next_sibling;
+    }
+    return ERR_ALL_GOOD;
+}
+
+// Copy the subtree of the `[*]` child of `parent`, if any, into each of its other index children,
+// so that an element is filtered by one node alone. Then do the same below every child.
+static Error _JsonProjection_spread(JsonProjection* projection_p, size_t parent)
+{
+    size_t any_child = 0;
+    size_t child     = projection_p->nodes[parent].first_child;
+    while (child != 0)
+    {
+        if ((projection_p->nodes[child].key_p == NULL)
+            && (projection_p->nodes[child].index == JSON_PATH_ANY_INDEX))
+        {
+            any_child = child;
+        }
+        child = projection_p->nodes[child].next_sibling;
+    }
+    child = projection_p->nodes[parent].first_child;
+    while (child != 0)
+    {
+        if ((any_child != 0) && (child != any_child) && (projection_p->nodes[child].key_p == NULL))
+        {
+            return_on_err(_JsonProjection_merge(projection_p, child, any_child));
+        }
+        return_on_err(_JsonProjection_spread(projection_p, child));
+        child = projection_p->nodes[child].next_sibling;
+    }
+    return ERR_ALL_GOOD;
+}
+
+// Compile the `num_of_paths` paths of a projection, in the syntax of JsonPath_compile, where an
+// index may also be `*` for every element of an array, e.g. `items[*].id`. A value is built if a
+// path leads to it, or to one of its ancestors, in which case it is built whole. The projection is
+// never modified after compilation, so threads can share it.
+Error JsonProjection_compile(
+    const char* const* paths,
+    size_t num_of_paths,
+    JsonProjection* out_projection_p)
+{
+    out_projection_p->paths          = NULL;
+    out_projection_p->num_of_paths   = 0;
+    out_projection_p->nodes          = NULL;
+    out_projection_p->num_of_nodes   = 0;
+    out_projection_p->nodes_capacity = 0;
+    if ((paths == NULL) || (num_of_paths == 0))
+    {
+        LOG_ERROR("Empty projection");
+        return ERR_EMPTY_STRING;
+    }
+    out_projection_p->paths = malloc(num_of_paths * sizeof(JsonPath));
+    out_projection_p->nodes = malloc(16 * sizeof(JsonProjectionNode));
+    if ((out_projection_p->paths == NULL) || (out_projection_p->nodes == NULL))
+    {
+        JsonProjection_destroy(out_projection_p);
+        LOG_PERROR("Out of memory");
+        return ERR_FATAL;
+    }
+    out_projection_p->nodes[0]
+        = (JsonProjectionNode){NULL, 0, 0, 0, 0, false, false, false};
+    out_projection_p->num_of_nodes   = 1;
+    out_projection_p->nodes_capacity = 16;
+    for (size_t i = 0; i < num_of_paths; i++)
+    {
+        JsonPath* path_p    = &out_projection_p->paths[i];
+        const Error ret_res = _JsonPath_compile(paths[i], true, path_p);
+        if (is_err(ret_res))
+        {
+            JsonProjection_destroy(out_projection_p);
+            return ret_res;
+        }
+        out_projection_p->num_of_paths++;
+        size_t node = 0;
+        for (size_t j = 0; j < path_p->num_of_steps; j++)
+        {
+            const JsonPathStep* step_p = &path_p->steps[j];
+            if (is_err(_JsonProjection_child(
+                    out_projection_p, node, step_p->key_p, step_p->key_len, step_p->index, &node)))
+            {
+                JsonProjection_destroy(out_projection_p);
+                return ERR_FATAL;
+            }
+        }
+        out_projection_p->nodes[node].keep_all = true;
+    }
+    if (is_err(_JsonProjection_spread(out_projection_p, 0)))
+    {
+        JsonProjection_destroy(out_projection_p);
+        return ERR_FATAL;
+    }
+    return ERR_ALL_GOOD;
+}
+
+void JsonProjection_destroy(JsonProjection* projection_p)
+{
+    if (projection_p == NULL)
+    {
+        return;
+    }
+    for (size_t i = 0; i < projection_p->num_of_paths; i++)
+    {
+        JsonPath_destroy(&projection_p->paths[i]);
+    }
+    free(projection_p->paths);
+    free(projection_p->nodes);
+    projection_p->paths          = NULL;
+    projection_p->num_of_paths   = 0;
+    projection_p->nodes          = NULL;
+    projection_p->num_of_nodes   = 0;
+    projection_p->nodes_capacity = 0;
+}
+
+// Walk of `_JsonProjection_filter`. Positions are read at `read` and written back at `write`,
+// which never overtakes it.
+typedef struct
+{
+    const JsonProjectionNode* nodes;
+    char* json_string; // Elements left out are overwritten
+    JsonIndex* index_p;
+    size_t read;
+    size_t write;
+    char* scratch_p; // Keys with escapes, decoded to be compared
+    size_t scratch_capacity;
+    size_t num_of_dropped_values;
+    size_t dropped_bytes;
+} JsonProjector;
+
+static inline char _JsonProjector_char(const JsonProjector* projector_p, size_t pos)
+{
+    return (pos < projector_p->index_p->count)
+               ? projector_p->json_string[projector_p->index_p->positions[pos]]
+               : '\0';
+}
+
+// Move the `num_of_positions` positions at `read` to `write`. Most runs are a few positions long,
+// and copying forwards is safe since `write` comes first.
+static inline void _JsonProjector_keep(JsonProjector* projector_p, size_t num_of_positions)
+{
+    uint32_t* positions = projector_p->index_p->positions;
+    if (projector_p->write != projector_p->read)
+    {
+        for (size_t i = 0; i < num_of_positions; i++)
+        {
+            positions[projector_p->write + i] = positions[projector_p->read + i];
+        }
+    }
+    projector_p->read += num_of_positions;
+    projector_p->write += num_of_positions;
+}
+
+// Find the child of `node_p` named by the key whose opening quote is at `key_pos`, or NULL.
+static Error _JsonProjector_find_key(
+    JsonProjector* projector_p,
+    const JsonProjectionNode* node_p,
+    size_t key_pos,
+    const JsonProjectionNode** out_child_pp)
+{
+    const uint32_t* positions       = projector_p->index_p->positions;
+    const JsonProjectionNode* nodes = projector_p->nodes;
+    const char* key_p               = &projector_p->json_string[positions[key_pos] + 1];
+    size_t key_len                  = positions[key_pos + 1] - positions[key_pos] - 1;
+    *out_child_pp                   = NULL;
+    // A key equal to one of the projection is equal once decoded, since the keys of the
+    // projection hold no backslash.
+    for (size_t child = node_p->first_child; child != 0; child = nodes[child].next_sibling)
+    {
+        if ((nodes[child].key_p != NULL)
+            && _keys_equal(nodes[child].key_p, nodes[child].key_len, key_p, key_len))
+        {
+            *out_child_pp = &nodes[child];
+            return ERR_ALL_GOOD;
+        }
+    }
+    if (memchr(key_p, '\\', key_len) != NULL)
+    {
+        // The buffer is left as it is for stage 2.
+        if (key_len >= projector_p->scratch_capacity)
+        {
+            char* scratch_p = realloc(projector_p->scratch_p, key_len + 1);
+            if (scratch_p == NULL)
+            {
+                LOG_PERROR("Out of memory");
+                return ERR_FATAL;
+            }
+            projector_p->scratch_p        = scratch_p;
+            projector_p->scratch_capacity = key_len + 1;
+        }
+        memcpy(projector_p->scratch_p, key_p, key_len);
+        return_on_err(_decode_str(projector_p->scratch_p, key_len, &key_len));
+        for (size_t child = node_p->first_child; child != 0; child = nodes[child].next_sibling)
+        {
+            if ((nodes[child].key_p != NULL)
+                && _keys_equal(
+                    nodes[child].key_p, nodes[child].key_len, projector_p->scratch_p, key_len))
+            {
+                *out_child_pp = &nodes[child];
+                break;
+            }
+        }
+    }
+    return ERR_ALL_GOOD;
+}
+
+// Child of `node_p` selecting the element at `index`, or NULL. `[*]` has been copied into the
+// other index children by `_JsonProjection_spread`, so an exact index wins.
+static inline const JsonProjectionNode* _JsonProjector_find_index(
+    const JsonProjector* projector_p,
+    const JsonProjectionNode* node_p,
+    size_t index)
+{
+    const JsonProjectionNode* nodes       = projector_p->nodes;
+    const JsonProjectionNode* any_child_p = NULL;
+    for (size_t child = node_p->first_child; child != 0; child = nodes[child].next_sibling)
+    {
+        const JsonProjectionNode* child_p = &nodes[child];
+        if (child_p->key_p == NULL)
+        {
+            if (child_p->index == index)
+            {
+                return child_p;
+            }
+            if (child_p->index == JSON_PATH_ANY_INDEX)
+            {
+                any_child_p = child_p;
+            }
+        }
+    }
+    return any_child_p;
+}
+
+static Error _JsonProjector_value(JsonProjector*, const JsonProjectionNode*);
+
+// Whether the paths through `node_p` reach into the value whose first character is `first_char`.
+static inline bool _JsonProjector_reaches(const JsonProjectionNode* node_p, char first_char)
+{
+    return node_p->keep_all || ((first_char == '{') && node_p->has_keys)
+           || ((first_char == '[') && node_p->has_indices);
+}
+
+// Replace the element at `read`, which no path reaches, with one position on a space.
+static Error _JsonProjector_drop_element(JsonProjector* projector_p)
+{
+    uint32_t* positions  = projector_p->index_p->positions;
+    const uint32_t first = positions[projector_p->read];
+    size_t end           = projector_p->read;
+    return_on_err(_skip_value(projector_p->json_string, projector_p->index_p, &end));
+    if (end == projector_p->index_p->count)
+    {
+        LOG_ERROR("Unexpected end of JSON string");
+        return ERR_JSON_INVALID;
+    }
+    projector_p->num_of_dropped_values++;
+    projector_p->dropped_bytes += positions[end] - first;
+    projector_p->json_string[first] = ' ';
+    positions[projector_p->write++] = first;
+    projector_p->read               = end;
+    return ERR_ALL_GOOD;
+}
+
+// Keep the `,` or the closing bracket that follows a value. Returns ERR_ALL_GOOD and sets
+// `*is_closed_p` if the container is closed.
+static inline Error _JsonProjector_next(JsonProjector* projector_p, char closing, bool* is_closed_p)
+{
+    const char next_char = _JsonProjector_char(projector_p, projector_p->read);
+    *is_closed_p         = (next_char == closing);
+    if (*is_closed_p)
+    {
+        _JsonProjector_keep(projector_p, 1);
+        return ERR_ALL_GOOD;
+    }
+    if ((next_char == '}') || (next_char == ']'))
+    {
+        LOG_ERROR("Mismatched `%c`", next_char);
+        return ERR_JSON_INVALID;
+    }
+    if (next_char != ',')
+    {
+        LOG_ERROR("Expected `,` or closing bracket, found `%c`", next_char);
+        return ERR_JSON_INVALID;
+    }
+    return ERR_ALL_GOOD;
+}
+
+static Error _JsonProjector_object(JsonProjector* projector_p, const JsonProjectionNode* node_p)
+{
+    uint32_t* positions = projector_p->index_p->positions;
+    _JsonProjector_keep(projector_p, 1); // {
+    if (_JsonProjector_char(projector_p, projector_p->read) == '}')
+    {
+        _JsonProjector_keep(projector_p, 1);
+        return ERR_ALL_GOOD;
+    }
+    bool has_members = false;
+    bool is_closed   = false;
+    while (!is_closed)
+    {
+        const size_t key_pos = projector_p->read;
+        if (_JsonProjector_char(projector_p, key_pos) != '"')
+        {
+            LOG_ERROR("Expected key, found `%c`", _JsonProjector_char(projector_p, key_pos));
+            return ERR_JSON_INVALID;
+        }
+        if (_JsonProjector_char(projector_p, key_pos + 2) != ':')
+        {
+            LOG_ERROR("Missing `:` after key");
+            return ERR_JSON_INVALID;
+        }
+        const JsonProjectionNode* child_p;
+        return_on_err(_JsonProjector_find_key(projector_p, node_p, key_pos, &child_p));
+        if ((child_p == NULL)
+            || !_JsonProjector_reaches(child_p, _JsonProjector_char(projector_p, key_pos + 3)))
+        {
+            size_t end = key_pos + 3;
+            return_on_err(_skip_value(projector_p->json_string, projector_p->index_p, &end));
+            if (end == projector_p->index_p->count)
+            {
+                LOG_ERROR("Unexpected end of JSON string");
+                return ERR_JSON_INVALID;
+            }
+            projector_p->num_of_dropped_values++;
+            projector_p->dropped_bytes += positions[end] - positions[key_pos];
+            projector_p->read = end;
+        }
+        else
+        {
+            if (has_members)
+            {
+                // The `,` before the key, dropped with the previous member.
+                positions[projector_p->write++] = positions[key_pos - 1];
+            }
+            has_members = true;
+            _JsonProjector_keep(projector_p, 3); // "key":
+            return_on_err(_JsonProjector_value(projector_p, child_p));
+        }
+        return_on_err(_JsonProjector_next(projector_p, '}', &is_closed));
+        projector_p->read += !is_closed; // The `,` is written before the next member kept.
+    }
+    return ERR_ALL_GOOD;
+}
+
+static Error _JsonProjector_array(JsonProjector* projector_p, const JsonProjectionNode* node_p)
+{
+    _JsonProjector_keep(projector_p, 1); // [
+    if (_JsonProjector_char(projector_p, projector_p->read) == ']')
+    {
+        _JsonProjector_keep(projector_p, 1);
+        return ERR_ALL_GOOD;
+    }
+    bool is_closed = false;
+    for (size_t index = 0; !is_closed; index++)
+    {
+        const JsonProjectionNode* child_p = _JsonProjector_find_index(projector_p, node_p, index);
+        if ((child_p != NULL)
+            && _JsonProjector_reaches(
+                child_p, _JsonProjector_char(projector_p, projector_p->read)))
+        {
+            return_on_err(_JsonProjector_value(projector_p, child_p));
+        }
+        else
+        {
+            return_on_err(_JsonProjector_drop_element(projector_p));
+        }
+        return_on_err(_JsonProjector_next(projector_p, ']', &is_closed));
+        if (!is_closed)
+        {
+            _JsonProjector_keep(projector_p, 1); // ,
+        }
+    }
+    return ERR_ALL_GOOD;
+}
+
+// Filter the value at `read`, which the paths through `node_p` reach. The depth of the recursion
+// is bounded by the paths of the projection, since a value that they do not reach is stepped over
+// or kept whole.
+static Error _JsonProjector_value(JsonProjector* projector_p, const JsonProjectionNode* node_p)
+{
+    if (!node_p->keep_all)
+    {
+        return (_JsonProjector_char(projector_p, projector_p->read) == '{')
+                   ? _JsonProjector_object(projector_p, node_p)
+                   : _JsonProjector_array(projector_p, node_p);
+    }
+    size_t end = projector_p->read;
+    return_on_err(_skip_value(projector_p->json_string, projector_p->index_p, &end));
+    _JsonProjector_keep(projector_p, end - projector_p->read);
+    return ERR_ALL_GOOD;
+}
+
+// Remove from the index of `json_obj_p` the values that `projection_p` leaves out. The grammar of
+// what is kept is checked again by stage 2; what is removed is only checked for matching brackets.
+static Error _JsonProjection_filter(const JsonProjection* projection_p, JsonObj* json_obj_p)
+{
+    JsonProjector projector = {
+        .nodes       = projection_p->nodes,
+        .json_string = json_obj_p->json_string,
+        .index_p     = &json_obj_p->index,
+    };
+    Error ret_res = ERR_ALL_GOOD;
+    // Anything but a root object is left for stage 2 to reject.
+    if (_JsonProjector_char(&projector, 0) == '{')
+    {
+        ret_res = _JsonProjector_object(&projector, &projection_p->nodes[0]);
+    }
+    free(projector.scratch_p);
+    return_on_err(ret_res);
+    // Whatever follows the root object, for stage 2 to reject.
+    _JsonProjector_keep(&projector, json_obj_p->index.count - projector.read);
+    json_obj_p->index.count           = projector.write;
+    json_obj_p->num_of_dropped_values = projector.num_of_dropped_values;
+    json_obj_p->dropped_bytes         = projector.dropped_bytes;
+    return ERR_ALL_GOOD;
+}
+
+// ---------- Tapes ----------
+// A JsonTape holds a whole document in one array of 64-bit words, in the order of the document,
+// instead of a node per value: a member takes two or three words (key, value and the bits of a
+// number) where the tree takes a JsonItem, and a full scan reads the array sequentially.
+// The start word of an object or an array holds the position of its end word, so that any value
+// is stepped over in O(1). Strings stay in the buffer, decoded in place when the tape is built.
+
+#define JSON_TAPE_MAX_COUNT (0xFFFFFF) // Saturated number of elements, or length of a string
+
+static inline uint64_t _tape_word(JsonTapeTag tag, uint64_t count, uint64_t pos)
+{
+    return ((uint64_t)tag << 56) | (count << 32) | pos;
+}
+
+static inline JsonTapeTag _tape_tag(uint64_t word)
+{
+    return (JsonTapeTag)(word >> 56);
+}
+
+static inline size_t _tape_count(uint64_t word)
+{
+    return (size_t)((word >> 32) & JSON_TAPE_MAX_COUNT);
+}
+
+static inline size_t _tape_pos(uint64_t word)
+{
+    return (size_t)(uint32_t)word;
+}
+
+// Decode the string whose opening quote is at `quote_pos_p` in the index and return its word.
+static inline Error _tape_str_word(char* json_string, const uint32_t* quote_pos_p, uint64_t* out_p)
+{
+    const char* str_p;
+    uint32_t len;
+    return_on_err(_terminate_str(json_string, quote_pos_p, &str_p, &len));
+    *out_p = _tape_word(
+        TAPE_STR, (len < JSON_TAPE_MAX_COUNT) ? len : JSON_TAPE_MAX_COUNT, quote_pos_p[0] + 1);
+    return ERR_ALL_GOOD;
+}
+
+// Position following the value whose first word is at `pos`.
+static inline size_t _JsonTape_next(const JsonTape* tape_p, size_t pos)
+{
+    const uint64_t word = tape_p->words[pos];
+    switch (_tape_tag(word))
+    {
+    case TAPE_OBJECT_START:
+    case TAPE_ARRAY_START:
+        return _tape_pos(word) + 1;
+    case TAPE_INT:
+    case TAPE_LLU:
+    case TAPE_DOUBLE:
+        return pos + 2;
+    default:
+        return pos + 1;
+    }
+}
+
+// Fill the words of `tape_p` by walking the structural index of its buffer once, with the same
+// checks as _deserialize. Until it is closed, the start word of a container holds the position of
+// the start word of its own container instead of that of its end word, so no stack is needed.
+static Error _JsonTape_build(JsonTape* tape_p, size_t len, const JsonIndex* index_p)
+{
+    char* json_string         = tape_p->json_string;
+    const char* end_p         = json_string + len;
+    const uint32_t* pos_p     = index_p->positions;
+    const uint32_t* pos_end_p = index_p->positions + index_p->count;
+    uint64_t* words           = tape_p->words;
+    size_t num_of_words       = 0;
+    size_t container          = 0; // Start word of the innermost open container
+    ParserState state         = EXPECT_KEY;
+    if ((pos_p == pos_end_p) || (json_string[*pos_p] != '{'))
+    {
+        LOG_ERROR("Invalid JSON string.");
+        return ERR_JSON_INVALID;
+    }
+    words[num_of_words++] = _tape_word(TAPE_OBJECT_START, 0, 0);
+    pos_p++;
+    if ((pos_p < pos_end_p) && (json_string[*pos_p] == '}'))
+    {
+        state = EXPECT_COMMA_OR_CLOSE;
+    }
+    while (pos_p != pos_end_p)
+    {
+        char* curr_pos_p = &json_string[*pos_p];
+        if (state == EXPECT_KEY)
+        {
+            if (*curr_pos_p != '"')
+            {
+                LOG_ERROR("Expected key, found `%c`", *curr_pos_p);
+                return ERR_JSON_INVALID;
+            }
+            if ((pos_end_p - pos_p < 3) || (json_string[pos_p[2]] != ':'))
+            {
+                LOG_ERROR("Missing `:` after key");
+                return ERR_JSON_INVALID;
+            }
+            return_on_err(_tape_str_word(json_string, pos_p, &words[num_of_words++]));
+            pos_p += 3;
+            state = EXPECT_VALUE;
+        }
+        else if (state == EXPECT_VALUE)
+        {
+            if (_tape_count(words[container]) < JSON_TAPE_MAX_COUNT)
+            {
+                words[container] += (uint64_t)1 << 32;
+            }
+            state = EXPECT_COMMA_OR_CLOSE;
+            pos_p++;
+            switch (*curr_pos_p)
+            {
+            case '{':
+            case '[':
+            {
+                const bool is_object  = (*curr_pos_p == '{');
+                words[num_of_words]   = _tape_word(
+                    is_object ? TAPE_OBJECT_START : TAPE_ARRAY_START, 0, container);
+                container             = num_of_words++;
+                const char close_char = is_object ? '}' : ']';
+                if ((pos_p == pos_end_p) || (json_string[*pos_p] != close_char))
+                {
+                    state = is_object ? EXPECT_KEY : EXPECT_VALUE;
+                }
+                break;
+            }
+            case '"':
+            {
+                return_on_err(_tape_str_word(json_string, pos_p - 1, &words[num_of_words++]));
+                pos_p++; // Skip the closing quote.
+                break;
+            }
+            default:
+            {
+                JsonValue value;
+                return_on_err(_deserialize_scalar(curr_pos_p, end_p, &value));
+                switch (value.value_type)
+                {
+                case VALUE_INT:
+                    words[num_of_words++] = _tape_word(TAPE_INT, 0, 0);
+                    words[num_of_words++] = (uint64_t)value.value_int;
+                    break;
+                case VALUE_LLU:
+                    words[num_of_words++] = _tape_word(TAPE_LLU, 0, 0);
+                    words[num_of_words++] = value.value_llu;
+                    break;
+                case VALUE_DOUBLE:
+                    words[num_of_words++] = _tape_word(TAPE_DOUBLE, 0, 0);
+                    memcpy(&words[num_of_words++], &value.value_double, sizeof(uint64_t));
+                    break;
+                default:
+                    words[num_of_words++]
+                        = _tape_word(value.value_bool ? TAPE_TRUE : TAPE_FALSE, 0, 0);
+                    break;
+                }
+                break;
+            }
+            }
+        }
+        else if (*curr_pos_p == ',')
+        {
+            state = (_tape_tag(words[container]) == TAPE_ARRAY_START) ? EXPECT_VALUE : EXPECT_KEY;
+            pos_p++;
+        }
+        else if ((*curr_pos_p == '}') || (*curr_pos_p == ']'))
+        {
+            const bool is_array = (_tape_tag(words[container]) == TAPE_ARRAY_START);
+            if (is_array != (*curr_pos_p == ']'))
+            {
+                LOG_ERROR("Mismatched `%c`", *curr_pos_p);
+                return ERR_JSON_INVALID;
+            }
+            const size_t parent = _tape_pos(words[container]);
+            words[container]    = (words[container] & ~(uint64_t)UINT32_MAX) | num_of_words;
+            words[num_of_words++]
+                = _tape_word(is_array ? TAPE_ARRAY_END : TAPE_OBJECT_END, 0, container);
+            pos_p++;
+            if (container == 0)
+            {
+                state = EXPECT_END;
+                break;
+            }
+            container = parent;
+        }
+        else
+        {
+            LOG_ERROR("Expected `,` or closing bracket, found `%c`", *curr_pos_p);
+            return ERR_JSON_INVALID;
+        }
+    }
+    if (state != EXPECT_END)
+    {
+        LOG_ERROR("Unexpected end of JSON string");
+        return ERR_JSON_INVALID;
+    }
+    if (pos_p != pos_end_p)
+    {
+        LOG_ERROR("Unexpected characters after the root object");
+        return ERR_JSON_INVALID;
+    }
+    tape_p->num_of_words = num_of_words;
+    return ERR_ALL_GOOD;
+}
+
+// Parse `len` bytes of `buf` into a tape. Like JsonObj_new_insitu, `buf` is borrowed and strings
+// are null-terminated in place. The structural index is only kept while the tape is built.
+Error JsonTape_new(
+    char* buf,
+    size_t len,
+    JsonTape* out_tape_p)
+{
+    out_tape_p->json_string  = buf;
+    out_tape_p->words        = NULL;
+    out_tape_p->num_of_words = 0;
+    out_tape_p->error_p      = NULL;
+    if ((buf == NULL) || (len == 0))
+    {
+        LOG_ERROR("Empty JSON string detected");
+        return ERR_EMPTY_STRING;
+    }
+    JsonIndex index = {NULL, 0, 0};
+    Error ret_res   = _index_structurals(_select_index_kernel(), buf, len, &index);
+    if (is_ok(ret_res))
+    {
+        // A structural character gives at most two words, for a number.
+        out_tape_p->words = malloc((2 * index.count + 1) * sizeof(uint64_t));
+        if (out_tape_p->words == NULL)
+        {
+            LOG_PERROR("Out of memory");
+            ret_res = ERR_FATAL;
+        }
+    }
+    if (is_ok(ret_res))
+    {
+        ret_res = _JsonTape_build(out_tape_p, len, &index);
+    }
+    free(index.positions);
+    if (is_err(ret_res))
+    {
+        JsonTape_destroy(out_tape_p);
+        return (ret_res == ERR_FATAL) ? ERR_FATAL : ERR_JSON_INVALID;
+    }
+    uint64_t* words = realloc(out_tape_p->words, out_tape_p->num_of_words * sizeof(uint64_t));
+    if (words != NULL)
+    {
+        out_tape_p->words = words;
+    }
+    return ERR_ALL_GOOD;
+}
+
+void JsonTape_destroy(JsonTape* tape_p)
+{
+    if (tape_p == NULL)
+    {
+        return;
+    }
+    free(tape_p->words);
+    tape_p->words        = NULL;
+    tape_p->num_of_words = 0;
+}
+
+// Read the value at the position `pos`. Objects and arrays only get their type.
+static Error _JsonTape_read(const JsonTape* tape_p, size_t pos, JsonValue* value_p)
+{
+    const uint64_t word = tape_p->words[pos];
+    switch (_tape_tag(word))
+    {
+    case TAPE_STR:
+        value_p->value_type   = VALUE_STR;
+        value_p->value_char_p = &tape_p->json_string[_tape_pos(word)];
+        value_p->value_len    = (_tape_count(word) < JSON_TAPE_MAX_COUNT)
+                                  ? (uint32_t)_tape_count(word)
+                                  : (uint32_t)strlen(value_p->value_char_p);
+        return ERR_ALL_GOOD;
+    case TAPE_INT:
+        value_p->value_type = VALUE_INT;
+        value_p->value_int  = (json_int_t)tape_p->words[pos + 1];
+        return ERR_ALL_GOOD;
+    case TAPE_LLU:
+        value_p->value_type = VALUE_LLU;
+        value_p->value_llu  = tape_p->words[pos + 1];
+        return ERR_ALL_GOOD;
+    case TAPE_DOUBLE:
+        value_p->value_type = VALUE_DOUBLE;
+        memcpy(&value_p->value_double, &tape_p->words[pos + 1], sizeof(uint64_t));
+        return ERR_ALL_GOOD;
+    case TAPE_TRUE:
+    case TAPE_FALSE:
+        value_p->value_type = VALUE_BOOL;
+        value_p->value_bool = (_tape_tag(word) == TAPE_TRUE);
+        return ERR_ALL_GOOD;
+    case TAPE_OBJECT_START:
+        value_p->value_type    = VALUE_ITEM;
+        value_p->value_child_p = NULL;
+        return ERR_ALL_GOOD;
+    case TAPE_ARRAY_START:
+        value_p->value_type    = VALUE_ARRAY;
+        value_p->value_array_p = NULL;
+        return ERR_ALL_GOOD;
+    default:
+        LOG_ERROR("Expected value");
+        return ERR_JSON_INVALID;
+    }
+}
+
+// Site of the value at `pos` in `tape_p`, or of a missing value if `pos` is JSON_NO_OFFSET. Only
+// strings and keys keep their offset in the tape: a member found by key is located by its key.
+static inline JsonSite _JsonTape_site(
+    const JsonTape* tape_p,
+    const char* key_p,
+    size_t index,
+    size_t pos)
+{
+    JsonSite site = {.key_p = key_p, .index = index, .offset = JSON_NO_OFFSET};
+    if ((tape_p == NULL) || (tape_p->words == NULL))
+    {
+        return site;
+    }
+    site.error_p = tape_p->error_p;
+    if (pos == JSON_NO_OFFSET)
+    {
+        return site;
+    }
+    if (_tape_tag(tape_p->words[pos]) == TAPE_STR)
+    {
+        site.offset = _tape_pos(tape_p->words[pos]);
+    }
+    else if ((key_p != NULL) && (pos > 0) && (_tape_tag(tape_p->words[pos - 1]) == TAPE_STR))
+    {
+        site.offset = _tape_pos(tape_p->words[pos - 1]);
+    }
+    return site;
+}
+
+// Find the value of `key`, of length `key_len`, in `item_p`. Returns ERR_JSON_MISSING_ENTRY if
+// there is none.
+static Error _JsonTapeItem_find(
+    const JsonTapeItem* item_p,
+    const char* key,
+    size_t key_len,
+    size_t* out_pos_p)
+{
+    if ((item_p == NULL) || (item_p->tape_p == NULL) || (item_p->tape_p->words == NULL))
+    {
+        LOG_ERROR("Input item is NULL - key `%s`.", key);
+        return ERR_NULL;
+    }
+    const JsonTape* tape_p = item_p->tape_p;
+    const size_t end       = _tape_pos(tape_p->words[item_p->pos]);
+    size_t pos             = item_p->pos + 1;
+    while (pos < end)
+    {
+        // Keys are compared in place, with their length taken from the tape unless saturated.
+        const uint64_t word = tape_p->words[pos];
+        const char* key_p   = &tape_p->json_string[_tape_pos(word)];
+        size_t len          = _tape_count(word);
+        if (len == JSON_TAPE_MAX_COUNT)
+        {
+            len = strlen(key_p);
+        }
+        if ((len == key_len) && (memcmp(key_p, key, len) == 0))
+        {
+            *out_pos_p = pos + 1;
+            return ERR_ALL_GOOD;
+        }
+        pos = _JsonTape_next(tape_p, pos + 1);
+    }
+    return ERR_JSON_MISSING_ENTRY;
+}
+
+// Find the element `index` of `array_p`, starting from the last element reached if it comes
+// before. Returns ERR_NULL if there is none.
+static Error _JsonTapeArray_find(JsonTapeArray* array_p, size_t index, size_t* out_pos_p)
+{
+    if ((array_p == NULL) || (array_p->tape_p == NULL) || (array_p->tape_p->words == NULL))
+    {
+        LOG_ERROR("Input item is NULL");
+        return ERR_JSON_MISSING_ENTRY;
+    }
+    const JsonTape* tape_p = array_p->tape_p;
+    const uint64_t word    = tape_p->words[array_p->pos];
+    const size_t end       = _tape_pos(word);
+    if ((_tape_count(word) < JSON_TAPE_MAX_COUNT) && (index >= _tape_count(word)))
+    {
+        return ERR_NULL;
+    }
+    size_t curr_index = 0;
+    size_t pos        = array_p->pos + 1;
+    if ((array_p->cached_pos > 0) && (array_p->cached_index <= index))
+    {
+        curr_index = array_p->cached_index;
+        pos        = array_p->cached_pos;
+    }
+    for (; (curr_index < index) && (pos < end); curr_index++)
+    {
+        pos = _JsonTape_next(tape_p, pos);
+    }
+    if (pos >= end)
+    {
+        return ERR_NULL;
+    }
+    array_p->cached_index = curr_index;
+    array_p->cached_pos   = pos;
+    *out_pos_p            = pos;
+    return ERR_ALL_GOOD;
+}
+
+// Number of elements of `array_p`, read from its start word unless saturated.
+size_t JsonTapeArray_len(JsonTapeArray* array_p)
+{
+    if ((array_p == NULL) || (array_p->tape_p == NULL) || (array_p->tape_p->words == NULL))
+    {
+        return 0;
+    }
+    const JsonTape* tape_p = array_p->tape_p;
+    const uint64_t word    = tape_p->words[array_p->pos];
+    size_t len             = _tape_count(word);
+    if (len == JSON_TAPE_MAX_COUNT)
+    {
+        len = 0;
+        for (size_t pos = array_p->pos + 1; pos < _tape_pos(word); len++)
+        {
+            pos = _JsonTape_next(tape_p, pos);
+        }
+    }
+    return len;
+}
+
+// Follow `path_p` from the root of `tape_p` and return the position of the value it leads to.
+static Error _JsonPath_find_tape_pos(
+    const JsonTape* tape_p,
+    const JsonPath* path_p,
+    ValueType requested,
+    JsonSite* site_p,
+    size_t* out_pos_p)
+{
+    if ((tape_p == NULL) || (tape_p->words == NULL) || (path_p == NULL)
+        || (path_p->num_of_steps == 0))
+    {
+        LOG_ERROR("Tape or path missing");
+        return ERR_NULL;
+    }
+    size_t pos = 0;
+    for (size_t i = 0; i < path_p->num_of_steps; i++)
+    {
+        const JsonPathStep* step_p = &path_p->steps[i];
+        const ValueType step_type  = (step_p->key_p != NULL) ? VALUE_ITEM : VALUE_ARRAY;
+        site_p->key_p              = step_p->key_p;
+        site_p->index              = step_p->index;
+        JsonValue value;
+        return_on_err(_JsonTape_read(tape_p, pos, &value));
+        if (value.value_type != step_type)
+        {
+            _JsonError_record(
+                site_p, ERR_TYPE_MISMATCH, step_type, value.value_type, "path step type mismatch");
+            return ERR_TYPE_MISMATCH;
+        }
+        site_p->offset = JSON_NO_OFFSET;
+        Error ret_res  = ERR_ALL_GOOD;
+        if (step_p->key_p != NULL)
+        {
+            const JsonTapeItem tape_item = {tape_p, pos};
+            ret_res = _JsonTapeItem_find(&tape_item, step_p->key_p, step_p->key_len, &pos);
+        }
+        else
+        {
+            JsonTapeArray tape_array = {tape_p, pos, 0, 0};
+            ret_res                  = _JsonTapeArray_find(&tape_array, step_p->index, &pos);
+        }
+        if ((ret_res == ERR_JSON_MISSING_ENTRY) || (ret_res == ERR_NULL))
+        {
+            _JsonError_record(
+                site_p,
+                ret_res,
+                requested,
+                VALUE_INVALID,
+                (ret_res == ERR_NULL) ? "index out of bounds" : "key not found");
+        }
+        return_on_err(ret_res);
+        site_p->offset = _JsonTape_site(tape_p, step_p->key_p, 0, pos).offset;
+    }
+    *out_pos_p = pos;
+    return ERR_ALL_GOOD;
+}
+
+// Copy the member `suffix` of a JsonValue whose type has been checked to the caller's variable.
+// A JsonStr takes the length stored next to the string.
+#define VALUE_READ_c(suffix, out_type)                                                        \
+    static inline void _JsonValue_read_##suffix(const JsonValue* value_p, out_type out_value) \
+    {                                                                                         \
+        *out_value = value_p->suffix;                                                         \
+    }
+// clang-format off
+VALUE_READ_c(value_char_p, const char**)
+VALUE_READ_c(value_child_p, JsonItem**)
+VALUE_READ_c(value_array_p, JsonArray**)
+VALUE_READ_c(value_int, json_int_t*)
+VALUE_READ_c(value_llu, json_uint_t*)
+VALUE_READ_c(value_double, json_decimal_t*)
+VALUE_READ_c(value_bool, json_bool_t*)
+// clang-format on
+
+static inline void _JsonValue_read_value_str(const JsonValue* value_p, JsonStr* out_value)
+{
+    *out_value = (JsonStr){.ptr = value_p->value_char_p, .len = value_p->value_len};
+}
+
+#define OBJ_GET_VALUE_c(suffix, value_token, out_type, ACTION)                      \
+    Error obj_get_##suffix(const JsonObj* obj, const char* key, out_type out_value) \
+    {                                                                               \
+        if (obj)                                                                    \
+        {                                                                           \
+            return get_##suffix(obj->root.next_sibling, key, out_value);            \
+        }                                                                           \
+        else                                                                        \
+        {                                                                           \
+            return ERR_NULL;                                                        \
+        }                                                                           \
+    }
+
+// get_* probe the key table of a large object, or walk the siblings in a loop, so that the stack
+// does not grow with the width of the object. Failures and conversions are recorded, not logged.
+#define GET_VALUE_c(suffix, value_token, out_type, ACTION)                                    \
+    static inline Error _value_get_##suffix(                                                  \
+        const JsonValue* value_p,                                                             \
+        out_type out_value,                                                                   \
+        const JsonSite* site_p)                                                               \
+    {                                                                                         \
+        if (value_p->value_type == value_token)                                               \
+        {                                                                                     \
+            _JsonValue_read_##suffix(value_p, out_value);                                     \
+            ACTION;                                                                           \
+            return ERR_ALL_GOOD;                                                              \
+        }                                                                                     \
+        _JsonError_record(                                                                    \
+            site_p, ERR_TYPE_MISMATCH, value_token, value_p->value_type, "type mismatch");    \
+        return ERR_TYPE_MISMATCH;                                                             \
+    }                                                                                         \
+    static inline Error _value_missing_##suffix(out_type out_value, const JsonSite* site_p)   \
+    {                                                                                         \
+        memset(out_value, 0, sizeof(*out_value));                                             \
+        _JsonError_record(                                                                    \
+            site_p, ERR_JSON_MISSING_ENTRY, value_token, VALUE_INVALID, "key not found");     \
+        return ERR_JSON_MISSING_ENTRY;                                                        \
+    }                                                                                         \
+    Error get_##suffix(const JsonItem* item, const char* key, out_type out_value)             \
+    {                                                                                         \
+        JsonSite site = {.item_p = item, .key_p = key, .offset = JSON_NO_OFFSET};             \
+        const size_t key_len = strlen(key);                                                   \
+        if ((item != NULL) && (item->key_p != NULL) && (item->key_table_p != NULL))           \
+        {                                                                                     \
+            item = _JsonKeyTable_find(item->key_table_p, key, key_len);                       \
+        }                                                                                     \
+        for (; item != NULL; item = item->next_sibling)                                       \
+        {                                                                                     \
+            site.item_p = item;                                                               \
+            if (!item->key_p)                                                                 \
+            {                                                                                 \
+                _JsonError_record(                                                            \
+                    &site, ERR_NULL, value_token, VALUE_INVALID, "item is not in an object"); \
+                return ERR_NULL;                                                              \
+            }                                                                                 \
+            if (_keys_equal(item->key_p, item->key_len, key, key_len))                        \
+            {                                                                                 \
+                return _value_get_##suffix(&item->value, out_value, &site);                   \
+            }                                                                                 \
+        }                                                                                     \
+        return _value_missing_##suffix(out_value, &site);                                     \
+    }
+
+#define OBJ_GET_NUMBER_c(suffix, value_token, out_type, ACTION)                     \
+    Error obj_get_##suffix(const JsonObj* obj, const char* key, out_type out_value) \
+    {                                                                               \
+        return get_##suffix(obj->root.next_sibling, key, out_value);                \
+    }
+
+#define GET_NUMBER_c(suffix, value_token, out_type, ACTION)                                     \
+    static inline Error _value_get_##suffix(                                                    \
+        const JsonValue* value_p,                                                               \
+        out_type out_value,                                                                     \
+        const JsonSite* site_p)                                                                 \
+    {                                                                                           \
+        const ValueType found = value_p->value_type;                                            \
+        if (found == value_token)                                                               \
+        {                                                                                       \
+            _JsonValue_read_##suffix(value_p, out_value);                                       \
+            ACTION;                                                                             \
+            return ERR_ALL_GOOD;                                                                \
+        }                                                                                       \
+        else if ((found == VALUE_INT) && (value_token == VALUE_DOUBLE))                         \
+        {                                                                                       \
+            _JsonError_record(site_p, ERR_ALL_GOOD, value_token, found, "int to double");       \
+            *out_value = (double)(1.0 * value_p->value_int);                                    \
+            ACTION;                                                                             \
+            return ERR_ALL_GOOD;                                                                \
+        }                                                                                       \
+        else if ((found == VALUE_LLU) && (value_token == VALUE_DOUBLE))                         \
+        {                                                                                       \
+            _JsonError_record(site_p, ERR_ALL_GOOD, value_token, found, "uint to double");      \
+            *out_value = (double)(1.0 * value_p->value_llu);                                    \
+            ACTION;                                                                             \
+            return ERR_ALL_GOOD;                                                                \
+        }                                                                                       \
+        else if ((found == VALUE_INT) && (value_token == VALUE_LLU))                            \
+        {                                                                                       \
+            if (value_p->value_int < 0)                                                         \
+            {                                                                                   \
+                _JsonError_record(site_p, ERR_INVALID, value_token, found, "negative int");     \
+                return ERR_INVALID;                                                             \
+            };                                                                                  \
+            _JsonError_record(site_p, ERR_ALL_GOOD, value_token, found, "int to uint");         \
+            *out_value = (json_uint_t)value_p->value_int;                                       \
+            ACTION;                                                                             \
+            return ERR_ALL_GOOD;                                                                \
+        }                                                                                       \
+        else if ((found == VALUE_LLU) && (value_token == VALUE_INT))                            \
+        {                                                                                       \
+            *out_value = (json_int_t)value_p->value_llu;                                        \
+            /* check for overflow */                                                            \
+            if (*out_value < 0)                                                                 \
+            {                                                                                   \
+                _JsonError_record(site_p, ERR_INVALID, value_token, found, "int overflow");     \
+                return ERR_INVALID;                                                             \
+            };                                                                                  \
+            _JsonError_record(site_p, ERR_ALL_GOOD, value_token, found, "uint to int");         \
+            ACTION;                                                                             \
+            return ERR_ALL_GOOD;                                                                \
+        }                                                                                       \
+        _JsonError_record(site_p, ERR_TYPE_MISMATCH, value_token, found, "type mismatch");      \
+        return ERR_TYPE_MISMATCH;                                                               \
+    }                                                                                           \
+    static inline Error _value_missing_##suffix(out_type out_value, const JsonSite* site_p)     \
+    {                                                                                           \
+        (void)out_value;                                                                        \
+        _JsonError_record(site_p, ERR_NULL, value_token, VALUE_INVALID, "key not found");       \
+        return ERR_NULL;                                                                        \
+    }                                                                                           \
+    Error get_##suffix(const JsonItem* item, const char* key, out_type out_value)               \
+    {                                                                                           \
+        JsonSite site = {.item_p = item, .key_p = key, .offset = JSON_NO_OFFSET};               \
+        const size_t key_len = strlen(key);                                                     \
+        if ((item != NULL) && (item->key_p != NULL) && (item->key_table_p != NULL))             \
+        {                                                                                       \
+            item = _JsonKeyTable_find(item->key_table_p, key, key_len);                         \
+        }                                                                                       \
+        for (; item != NULL; item = item->next_sibling)                                         \
+        {                                                                                       \
+            site.item_p = item;                                                                 \
+            if (!item->key_p)                                                                   \
+            {                                                                                   \
+                _JsonError_record(                                                              \
+                    &site, ERR_NULL, value_token, VALUE_INVALID, "item is not in an object");   \
+                return ERR_NULL;                                                                \
+            }                                                                                   \
+            if (_keys_equal(item->key_p, item->key_len, key, key_len))                          \
+            {                                                                                   \
+                return _value_get_##suffix(&item->value, out_value, &site);                     \
+            }                                                                                   \
+        }                                                                                       \
+        return _value_missing_##suffix(out_value, &site);                                       \
+    }
+
+#define GET_ARRAY_VALUE_c(suffix, value_token, out_type)                                    \
+    Error get_array_##suffix(const JsonArray* json_array, size_t index, out_type out_value) \
+    {                                                                                       \
+        if (json_array == NULL)                                                             \
+        {                                                                                   \
+            LOG_ERROR("Input item is NULL");                                                \
+            return ERR_JSON_MISSING_ENTRY;                                                  \
+        }                                                                                   \
+        JsonSite site = {.index = index, .offset = JSON_NO_OFFSET};                         \
+        if (index >= json_array->len)                                                       \
+        {                                                                                   \
+            site.item_p = (json_array->len > 0) ? json_array->elements[0] : NULL;           \
+            _JsonError_record(                                                              \
+                &site, ERR_NULL, value_token, VALUE_INVALID, "index out of bounds");        \
+            return ERR_NULL;                                                                \
+        }                                                                                   \
+        const JsonItem* json_item = json_array->elements[index];                            \
+        if (json_item->value.value_type != value_token)                                     \
+        {                                                                                   \
+            site.item_p = json_item;                                                        \
+            _JsonError_record(                                                              \
+                &site,                                                                      \
+                ERR_TYPE_MISMATCH,                                                          \
+                value_token,                                                                \
+                json_item->value.value_type,                                                \
+                "type mismatch");                                                           \
+            return ERR_TYPE_MISMATCH;                                                       \
+        }                                                                                   \
+        _JsonValue_read_##suffix(&json_item->value, out_value);                             \
+        return ERR_ALL_GOOD;                                                                \
+    }
+
+// The value found in a JsonDoc goes through the same type checks and conversions as in the tree.
+#define DOC_GET_VALUE_c(suffix, value_token, out_type)                                          \
+    Error doc_get_##suffix(const JsonDoc* doc_p, const char* key, out_type out_value)           \
+    {                                                                                           \
+        const JsonDocItem root = {doc_p, 0};                                                    \
+        return doc_item_get_##suffix(&root, key, out_value);                                    \
+    }                                                                                           \
+    Error doc_item_get_##suffix(const JsonDocItem* item_p, const char* key, out_type out_value) \
+    {                                                                                           \
+        size_t pos          = 0;                                                                \
+        const Error ret_res = _JsonDocItem_find(item_p, key, strlen(key), &pos);                \
+        if (ret_res == ERR_JSON_MISSING_ENTRY)                                                  \
+        {                                                                                       \
+            const JsonSite site = _JsonDoc_site(item_p->doc_p, key, 0, JSON_NO_OFFSET);         \
+            return _value_missing_##suffix(out_value, &site);                                   \
+        }                                                                                       \
+        return_on_err(ret_res);                                                                 \
+        JsonValue value;                                                                        \
+        return_on_err(_JsonDoc_read(item_p->doc_p, pos, &value));                               \
+        const JsonSite site = _JsonDoc_site(item_p->doc_p, key, 0, pos);                        \
+        return _value_get_##suffix(&value, out_value, &site);                                   \
+    }                                                                                           \
+    Error doc_array_get_##suffix(JsonDocArray* array_p, size_t index, out_type out_value)       \
+    {                                                                                           \
+        size_t pos          = 0;                                                                \
+        const Error ret_res = _JsonDocArray_find(array_p, index, &pos);                         \
+        if (ret_res == ERR_NULL)                                                                \
+        {                                                                                       \
+            const JsonSite site = _JsonDoc_site(array_p->doc_p, NULL, index, JSON_NO_OFFSET);   \
+            _JsonError_record(                                                                  \
+                &site, ERR_NULL, value_token, VALUE_INVALID, "index out of bounds");            \
+        }                                                                                       \
+        return_on_err(ret_res);                                                                 \
+        JsonValue value;                                                                        \
+        return_on_err(_JsonDoc_read(array_p->doc_p, pos, &value));                              \
+        if (value.value_type != value_token)                                                    \
+        {                                                                                       \
+            const JsonSite site = _JsonDoc_site(array_p->doc_p, NULL, index, pos);              \
+            _JsonError_record(                                                                  \
+                &site, ERR_TYPE_MISMATCH, value_token, value.value_type, "type mismatch");      \
+            return ERR_TYPE_MISMATCH;                                                           \
+        }                                                                                       \
+        _JsonValue_read_##suffix(&value, out_value);                                            \
+        return ERR_ALL_GOOD;                                                                    \
+    }
+
+// Objects and arrays of a JsonDoc are returned as the position of their opening bracket.
+#define DOC_GET_CONTAINER_c(suffix, value_token, handle_type)                                   \
+    static Error _doc_fill_##suffix(                                                            \
+        const JsonDoc* doc_p,                                                                   \
+        size_t pos,                                                                             \
+        const JsonSite* site_p,                                                                 \
+        handle_type* out_p)                                                                     \
+    {                                                                                           \
+        JsonValue value;                                                                        \
+        return_on_err(_JsonDoc_read(doc_p, pos, &value));                                       \
+        if (value.value_type != value_token)                                                    \
+        {                                                                                       \
+            _JsonError_record(                                                                  \
+                site_p, ERR_TYPE_MISMATCH, value_token, value.value_type, "type mismatch");     \
+            return ERR_TYPE_MISMATCH;                                                           \
+        }                                                                                       \
+        *out_p = (handle_type){.doc_p = doc_p, .pos = pos};                                     \
+        return ERR_ALL_GOOD;                                                                    \
+    }                                                                                           \
+    Error doc_get_##suffix(const JsonDoc* doc_p, const char* key, handle_type* out_p)           \
+    {                                                                                           \
+        const JsonDocItem root = {doc_p, 0};                                                    \
+        return doc_item_get_##suffix(&root, key, out_p);                                        \
+    }                                                                                           \
+    Error doc_item_get_##suffix(const JsonDocItem* item_p, const char* key, handle_type* out_p) \
+    {                                                                                           \
+        size_t pos          = 0;                                                                \
+        const Error ret_res = _JsonDocItem_find(item_p, key, strlen(key), &pos);                \
+        if (ret_res == ERR_JSON_MISSING_ENTRY)                                                  \
+        {                                                                                       \
+            const JsonSite site = _JsonDoc_site(item_p->doc_p, key, 0, JSON_NO_OFFSET);         \
+            _JsonError_record(                                                                  \
+                &site, ERR_JSON_MISSING_ENTRY, value_token, VALUE_INVALID, "key not found");    \
+        }                                                                                       \
+        return_on_err(ret_res);                                                                 \
+        const JsonSite site = _JsonDoc_site(item_p->doc_p, key, 0, pos);                        \
+        return _doc_fill_##suffix(item_p->doc_p, pos, &site, out_p);                            \
+    }                                                                                           \
+    Error doc_array_get_##suffix(JsonDocArray* array_p, size_t index, handle_type* out_p)       \
+    {                                                                                           \
+        size_t pos          = 0;                                                                \
+        const Error ret_res = _JsonDocArray_find(array_p, index, &pos);                         \
+        if (ret_res == ERR_NULL)                                                                \
+        {                                                                                       \
+            const JsonSite site = _JsonDoc_site(array_p->doc_p, NULL, index, JSON_NO_OFFSET);   \
+            _JsonError_record(                                                                  \
+                &site, ERR_NULL, value_token, VALUE_INVALID, "index out of bounds");            \
+        }                                                                                       \
+        return_on_err(ret_res);                                                                 \
+        const JsonSite site = _JsonDoc_site(array_p->doc_p, NULL, index, pos);                  \
+        return _doc_fill_##suffix(array_p->doc_p, pos, &site, out_p);                           \
+    }
+
+// The value a path leads to goes through the same type checks and conversions as with Json_get on an
+// object.
+#define PATH_GET_VALUE_c(suffix, value_token, out_type)                                           \
+    Error path_get_##suffix(const JsonItem* item_p, const JsonPath* path_p, out_type out_value)   \
+    {                                                                                             \
+        JsonSite site           = {.item_p = item_p, .offset = JSON_NO_OFFSET};                   \
+        const JsonItem* found_p = NULL;                                                           \
+        return_on_err(_JsonPath_find(item_p, path_p, value_token, &site, &found_p));              \
+        return _value_get_##suffix(&found_p->value, out_value, &site);                            \
+    }                                                                                             \
+    Error path_obj_get_##suffix(const JsonObj* obj_p, const JsonPath* path_p, out_type out_value) \
+    {                                                                                             \
+        if (obj_p == NULL)                                                                        \
+        {                                                                                         \
+            return ERR_NULL;                                                                      \
+        }                                                                                         \
+        return path_get_##suffix(obj_p->root.next_sibling, path_p, out_value);                    \
+    }
+
+#define DOC_PATH_GET_VALUE_c(suffix, value_token, out_type)                                       \
+    Error path_doc_get_##suffix(const JsonDoc* doc_p, const JsonPath* path_p, out_type out_value) \
+    {                                                                                             \
+        size_t pos    = 0;                                                                        \
+        JsonSite site = _JsonDoc_site(doc_p, NULL, 0, JSON_NO_OFFSET);                            \
+        return_on_err(_JsonPath_find_pos(doc_p, path_p, value_token, &site, &pos));               \
+        JsonValue value;                                                                          \
+        return_on_err(_JsonDoc_read(doc_p, pos, &value));                                         \
+        return _value_get_##suffix(&value, out_value, &site);                                     \
+    }
+
+#define DOC_PATH_GET_CONTAINER_c(suffix, value_token, handle_type)                               \
+    Error path_doc_get_##suffix(const JsonDoc* doc_p, const JsonPath* path_p, handle_type* out_p) \
+    {                                                                                             \
+        size_t pos    = 0;                                                                        \
+        JsonSite site = _JsonDoc_site(doc_p, NULL, 0, JSON_NO_OFFSET);                            \
+        return_on_err(_JsonPath_find_pos(doc_p, path_p, value_token, &site, &pos));               \
+        return _doc_fill_##suffix(doc_p, pos, &site, out_p);                                      \
+    }
+
+// Getters of a JsonTape, with the same checks and conversions as those of a JsonDoc.
+#define TAPE_GET_VALUE_c(suffix, value_token, out_type)                                           \
+    Error tape_get_##suffix(const JsonTape* tape_p, const char* key, out_type out_value)          \
+    {                                                                                             \
+        const JsonTapeItem root = {tape_p, 0};                                                    \
+        return tape_item_get_##suffix(&root, key, out_value);                                     \
+    }                                                                                             \
+    Error tape_item_get_##suffix(const JsonTapeItem* item_p, const char* key, out_type out_value) \
+    {                                                                                             \
+        size_t pos          = 0;                                                                  \
+        const Error ret_res = _JsonTapeItem_find(item_p, key, strlen(key), &pos);                 \
+        if (ret_res == ERR_JSON_MISSING_ENTRY)                                                    \
+        {                                                                                         \
+            const JsonSite site = _JsonTape_site(item_p->tape_p, key, 0, JSON_NO_OFFSET);         \
+            return _value_missing_##suffix(out_value, &site);                                     \
+        }                                                                                         \
+        return_on_err(ret_res);                                                                   \
+        JsonValue value;                                                                          \
+        return_on_err(_JsonTape_read(item_p->tape_p, pos, &value));                               \
+        const JsonSite site = _JsonTape_site(item_p->tape_p, key, 0, pos);                        \
+        return _value_get_##suffix(&value, out_value, &site);                                     \
+    }                                                                                             \
+    Error tape_array_get_##suffix(JsonTapeArray* array_p, size_t index, out_type out_value)       \
+    {                                                                                             \
+        size_t pos          = 0;                                                                  \
+        const Error ret_res = _JsonTapeArray_find(array_p, index, &pos);                          \
+        if (ret_res == ERR_NULL)                                                                  \
+        {                                                                                         \
+            const JsonSite site = _JsonTape_site(array_p->tape_p, NULL, index, JSON_NO_OFFSET);   \
+            _JsonError_record(                                                                    \
+                &site, ERR_NULL, value_token, VALUE_INVALID, "index out of bounds");              \
+        }                                                                                         \
+        return_on_err(ret_res);                                                                   \
+        JsonValue value;                                                                          \
+        return_on_err(_JsonTape_read(array_p->tape_p, pos, &value));                              \
+        if (value.value_type != value_token)                                                      \
+        {                                                                                         \
+            const JsonSite site = _JsonTape_site(array_p->tape_p, NULL, index, pos);              \
+            _JsonError_record(                                                                    \
+                &site, ERR_TYPE_MISMATCH, value_token, value.value_type, "type mismatch");        \
+            return ERR_TYPE_MISMATCH;                                                             \
+        }                                                                                         \
+        _JsonValue_read_##suffix(&value, out_value);                                              \
+        return ERR_ALL_GOOD;                                                                      \
+    }                                                                                             \
+    Error path_tape_get_##suffix(                                                                 \
+        const JsonTape* tape_p,                                                                   \
+        const JsonPath* path_p,                                                                   \
+        out_type out_value)                                                                       \
+    {                                                                                             \
+        size_t pos    = 0;                                                                        \
+        JsonSite site = _JsonTape_site(tape_p, NULL, 0, JSON_NO_OFFSET);                          \
+        return_on_err(_JsonPath_find_tape_pos(tape_p, path_p, value_token, &site, &pos));         \
+        JsonValue value;                                                                          \
+        return_on_err(_JsonTape_read(tape_p, pos, &value));                                       \
+        return _value_get_##suffix(&value, out_value, &site);                                     \
+    }
+
+// Objects and arrays of a JsonTape are returned as the position of their start word.
+#define TAPE_GET_CONTAINER_c(suffix, value_token, handle_type)                                   \
+    static Error _tape_fill_##suffix(                                                            \
+        const JsonTape* tape_p,                                                                  \
+        size_t pos,                                                                              \
+        const JsonSite* site_p,                                                                  \
+        handle_type* out_p)                                                                      \
+    {                                                                                            \
+        JsonValue value;                                                                         \
+        return_on_err(_JsonTape_read(tape_p, pos, &value));                                      \
+        if (value.value_type != value_token)                                                     \
+        {                                                                                        \
+            _JsonError_record(                                                                   \
+                site_p, ERR_TYPE_MISMATCH, value_token, value.value_type, "type mismatch");      \
+            return ERR_TYPE_MISMATCH;                                                            \
+        }                                                                                        \
+        *out_p = (handle_type){.tape_p = tape_p, .pos = pos};                                    \
+        return ERR_ALL_GOOD;                                                                     \
+    }                                                                                            \
+    Error tape_get_##suffix(const JsonTape* tape_p, const char* key, handle_type* out_p)         \
+    {                                                                                            \
+        const JsonTapeItem root = {tape_p, 0};                                                   \
+        return tape_item_get_##suffix(&root, key, out_p);                                        \
+    }                                                                                            \
+    Error tape_item_get_##suffix(const JsonTapeItem* item_p, const char* key, handle_type* out_p)\
+    {                                                                                            \
+        size_t pos          = 0;                                                                 \
+        const Error ret_res = _JsonTapeItem_find(item_p, key, strlen(key), &pos);                \
+        if (ret_res == ERR_JSON_MISSING_ENTRY)                                                   \
+        {                                                                                        \
+            const JsonSite site = _JsonTape_site(item_p->tape_p, key, 0, JSON_NO_OFFSET);        \
+            _JsonError_record(                                                                   \
+                &site, ERR_JSON_MISSING_ENTRY, value_token, VALUE_INVALID, "key not found");     \
+        }                                                                                        \
+        return_on_err(ret_res);                                                                  \
+        const JsonSite site = _JsonTape_site(item_p->tape_p, key, 0, pos);                       \
+        return _tape_fill_##suffix(item_p->tape_p, pos, &site, out_p);                           \
+    }                                                                                            \
+    Error tape_array_get_##suffix(JsonTapeArray* array_p, size_t index, handle_type* out_p)      \
+    {                                                                                            \
+        size_t pos          = 0;                                                                 \
+        const Error ret_res = _JsonTapeArray_find(array_p, index, &pos);                         \
+        if (ret_res == ERR_NULL)                                                                 \
+        {                                                                                        \
+            const JsonSite site = _JsonTape_site(array_p->tape_p, NULL, index, JSON_NO_OFFSET);  \
+            _JsonError_record(                                                                   \
+                &site, ERR_NULL, value_token, VALUE_INVALID, "index out of bounds");             \
+        }                                                                                        \
+        return_on_err(ret_res);                                                                  \
+        const JsonSite site = _JsonTape_site(array_p->tape_p, NULL, index, pos);                 \
+        return _tape_fill_##suffix(array_p->tape_p, pos, &site, out_p);                          \
+    }                                                                                            \
+    Error path_tape_get_##suffix(                                                                \
+        const JsonTape* tape_p,                                                                  \
+        const JsonPath* path_p,                                                                  \
+        handle_type* out_p)                                                                      \
+    {                                                                                            \
+        size_t pos    = 0;                                                                       \
+        JsonSite site = _JsonTape_site(tape_p, NULL, 0, JSON_NO_OFFSET);                         \
+        return_on_err(_JsonPath_find_tape_pos(tape_p, path_p, value_token, &site, &pos));        \
+        return _tape_fill_##suffix(tape_p, pos, &site, out_p);                                   \
+    }
+
+// clang-format off
+OBJ_GET_VALUE_c(value_char_p, VALUE_STR, const char**, )
+OBJ_GET_VALUE_c(value_str, VALUE_STR, JsonStr*, )
+OBJ_GET_VALUE_c(value_child_p, VALUE_ITEM, JsonItem**, )
+OBJ_GET_VALUE_c(value_array_p, VALUE_ARRAY, JsonArray**, )
+
+OBJ_GET_NUMBER_c(value_int, VALUE_INT, json_int_t*, )
+OBJ_GET_NUMBER_c(value_llu, VALUE_LLU, json_uint_t*, )
+OBJ_GET_NUMBER_c(value_double, VALUE_DOUBLE, json_decimal_t*, )
+OBJ_GET_NUMBER_c(value_bool, VALUE_BOOL, json_bool_t*, )
+
+GET_VALUE_c(value_char_p, VALUE_STR, const char**, )
+GET_VALUE_c(value_str, VALUE_STR, JsonStr*, )
+GET_VALUE_c(value_child_p, VALUE_ITEM, JsonItem**, )
+GET_VALUE_c(value_array_p, VALUE_ARRAY, JsonArray**, )
+
+GET_NUMBER_c(value_int, VALUE_INT, json_int_t*, )
+GET_NUMBER_c(value_llu, VALUE_LLU, json_uint_t *, )
+GET_NUMBER_c(value_double, VALUE_DOUBLE, double*, )
+GET_NUMBER_c(value_bool, VALUE_BOOL, bool*, )
+
+GET_ARRAY_VALUE_c(value_char_p, VALUE_STR, const char**)
+GET_ARRAY_VALUE_c(value_str, VALUE_STR, JsonStr*)
+GET_ARRAY_VALUE_c(value_int, VALUE_INT, json_int_t*)
+GET_ARRAY_VALUE_c(value_llu, VALUE_LLU, json_uint_t*)
+GET_ARRAY_VALUE_c(value_double, VALUE_DOUBLE, double*)
+GET_ARRAY_VALUE_c(value_bool, VALUE_BOOL, bool*)
+GET_ARRAY_VALUE_c(value_child_p, VALUE_ITEM, JsonItem**)
+
+DOC_GET_VALUE_c(value_char_p, VALUE_STR, const char**)
+DOC_GET_VALUE_c(value_str, VALUE_STR, JsonStr*)
+DOC_GET_VALUE_c(value_int, VALUE_INT, json_int_t*)
+DOC_GET_VALUE_c(value_llu, VALUE_LLU, json_uint_t*)
+DOC_GET_VALUE_c(value_double, VALUE_DOUBLE, json_decimal_t*)
+DOC_GET_VALUE_c(value_bool, VALUE_BOOL, json_bool_t*)
+DOC_GET_CONTAINER_c(value_child_p, VALUE_ITEM, JsonDocItem)
+DOC_GET_CONTAINER_c(value_array_p, VALUE_ARRAY, JsonDocArray)
+
+PATH_GET_VALUE_c(value_char_p, VALUE_STR, const char**)
+PATH_GET_VALUE_c(value_str, VALUE_STR, JsonStr*)
+PATH_GET_VALUE_c(value_int, VALUE_INT, json_int_t*)
+PATH_GET_VALUE_c(value_llu, VALUE_LLU, json_uint_t*)
+PATH_GET_VALUE_c(value_double, VALUE_DOUBLE, json_decimal_t*)
+PATH_GET_VALUE_c(value_bool, VALUE_BOOL, json_bool_t*)
+PATH_GET_VALUE_c(value_child_p, VALUE_ITEM, JsonItem**)
+PATH_GET_VALUE_c(value_array_p, VALUE_ARRAY, JsonArray**)
+
+DOC_PATH_GET_VALUE_c(value_char_p, VALUE_STR, const char**)
+DOC_PATH_GET_VALUE_c(value_str, VALUE_STR, JsonStr*)
+DOC_PATH_GET_VALUE_c(value_int, VALUE_INT, json_int_t*)
+DOC_PATH_GET_VALUE_c(value_llu, VALUE_LLU, json_uint_t*)
+DOC_PATH_GET_VALUE_c(value_double, VALUE_DOUBLE, json_decimal_t*)
+DOC_PATH_GET_VALUE_c(value_bool, VALUE_BOOL, json_bool_t*)
+DOC_PATH_GET_CONTAINER_c(value_child_p, VALUE_ITEM, JsonDocItem)
+DOC_PATH_GET_CONTAINER_c(value_array_p, VALUE_ARRAY, JsonDocArray)
+
+TAPE_GET_VALUE_c(value_char_p, VALUE_STR, const char**)
+TAPE_GET_VALUE_c(value_str, VALUE_STR, JsonStr*)
+TAPE_GET_VALUE_c(value_int, VALUE_INT, json_int_t*)
+TAPE_GET_VALUE_c(value_llu, VALUE_LLU, json_uint_t*)
+TAPE_GET_VALUE_c(value_double, VALUE_DOUBLE, json_decimal_t*)
+TAPE_GET_VALUE_c(value_bool, VALUE_BOOL, json_bool_t*)
+TAPE_GET_CONTAINER_c(value_child_p, VALUE_ITEM, JsonTapeItem)
+TAPE_GET_CONTAINER_c(value_array_p, VALUE_ARRAY, JsonTapeArray)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wextra-semi"
+; // ensure clang-format works when turned on again
+#pragma clang diagnostic pop
+                                                                                  // clang-format on
+
+// ---------- Columns ----------
+// Json_extract_columns visits the elements of an array once, in order, and walks the members of
+// each element once, storing the members of the columns at the row of the element through the
+// conversions of Json_get. Members whose key length is not that of a column are passed over with
+// one test, and the walk of an element stops when every column is found. The key table of a large
+// element is probed instead. A member that does not convert counts as missing. The nodes of the
+// elements a few rows ahead are prefetched, and the bits of 64 rows are written to the bitmaps at
+// once. Up to 64 columns are filled per pass over the array.
+
+// Columns whose key lengths and hashes are kept on the stack rather than allocated.
+#define JSON_COLUMN_STACK_KEYS (16)
+#define JSON_COLUMNS_PER_PASS (64)
+// Elements ahead of the one read whose nodes are prefetched, up to a number of cache lines.
+#define JSON_COLUMNS_PREFETCH_ROWS (4)
+#define JSON_COLUMNS_PREFETCH_LINES (8)
+
+// Key of a column, measured and hashed once per call.
+typedef struct
+{
+    size_t key_len;
+    uint64_t head; // See _JsonColumn_key_head
+    uint64_t hash;
+} JsonColumnKey;
+
+// Bytes of a key packed in a word, reading only the `len` bytes of the key: all of them up to 8
+// bytes, and the first 8 beyond. Two keys of the same length and up to 8 bytes are equal if their
+// heads are, with no call to memcmp for a length only known at run time.
+static inline uint64_t _JsonColumn_key_head(const char* key_p, size_t len)
+{
+    uint64_t head = 0;
+    if (len >= sizeof(uint64_t))
+    {
+        memcpy(&head, key_p, sizeof(uint64_t));
+    }
+    else if (len >= sizeof(uint32_t))
+    {
+        uint32_t first;
+        uint32_t last;
+        memcpy(&first, key_p, sizeof(uint32_t));
+        memcpy(&last, &key_p[len - sizeof(uint32_t)], sizeof(uint32_t));
+        head = ((uint64_t)last << 32) | first;
+    }
+    else if (len > 0)
+    {
+        head = (uint64_t)(unsigned char)key_p[0] | ((uint64_t)(unsigned char)key_p[len / 2] << 8)
+               | ((uint64_t)(unsigned char)key_p[len - 1] << 16);
+    }
+    return head;
+}
+
+// Bit of a key length in the mask of the lengths of the keys of the columns, which rules out most
+// other members with one test. Lengths from 63 on share the last bit.
+static inline uint64_t _JsonColumn_len_bit(size_t len)
+{
+    return (uint64_t)1 << ((len < 63) ? len : 63);
+}
+
+// Whether the key of `item_p` is that of a column.
+static inline bool _JsonColumn_key_equal(
+    const JsonItem* item_p,
+    const char* key_p,
+    const JsonColumnKey* key_info_p)
+{
+    const size_t len = key_info_p->key_len;
+    return (item_p->key_len == len)
+           && (_JsonColumn_key_head(item_p->key_p, len) == key_info_p->head)
+           && ((len <= sizeof(uint64_t))
+               || (memcmp(&item_p->key_p[sizeof(uint64_t)], &key_p[sizeof(uint64_t)],
+                          len - sizeof(uint64_t))
+                   == 0));
+}
+
+// Size of a value of a column of `value_type`, 0 if the type is not that of a column.
+static inline size_t _JsonColumn_value_size(ValueType value_type)
+{
+    switch (value_type)
+    {
+    case VALUE_DOUBLE:
+        return sizeof(json_decimal_t);
+    case VALUE_INT:
+        return sizeof(json_int_t);
+    case VALUE_LLU:
+        return sizeof(json_uint_t);
+    case VALUE_BOOL:
+        return sizeof(json_bool_t);
+    case VALUE_STR:
+        return sizeof(JsonStr);
+    default:
+        return 0;
+    }
+}
+
+// Store `value_p` at `row` of `column_p` with the conversions of Json_get. A value that does not
+// convert is zeroed and false is returned. The site has no item, so nothing is recorded.
+__attribute__((noinline)) static bool
+_JsonColumn_convert(const JsonColumn* column_p, size_t row, const JsonValue* value_p)
+{
+    static const JsonSite no_site = {.offset = JSON_NO_OFFSET};
+    Error ret_res;
+    switch (column_p->value_type)
+    {
+    case VALUE_DOUBLE:
+        ret_res = _value_get_value_double(
+            value_p, &((json_decimal_t*)column_p->values_p)[row], &no_site);
+        break;
+    case VALUE_INT:
+        ret_res
+            = _value_get_value_int(value_p, &((json_int_t*)column_p->values_p)[row], &no_site);
+        break;
+    case VALUE_LLU:
+        ret_res
+            = _value_get_value_llu(value_p, &((json_uint_t*)column_p->values_p)[row], &no_site);
+        break;
+    case VALUE_BOOL:
+        ret_res
+            = _value_get_value_bool(value_p, &((json_bool_t*)column_p->values_p)[row], &no_site);
+        break;
+    default:
+        ret_res = _value_get_value_str(value_p, &((JsonStr*)column_p->values_p)[row], &no_site);
+        break;
+    }
+    if (is_err(ret_res))
+    {
+        const size_t value_size = _JsonColumn_value_size(column_p->value_type);
+        memset((char*)column_p->values_p + row * value_size, 0, value_size);
+        return false;
+    }
+    return true;
+}
+
+// Same as _JsonColumn_convert, copying a value of the type of the column without a check.
+static inline bool
+_JsonColumn_store(const JsonColumn* column_p, size_t row, const JsonValue* value_p)
+{
+    if (value_p->value_type != column_p->value_type)
+    {
+        return _JsonColumn_convert(column_p, row, value_p);
+    }
+    switch (column_p->value_type)
+    {
+    case VALUE_DOUBLE:
+        ((json_decimal_t*)column_p->values_p)[row] = value_p->value_double;
+        break;
+    case VALUE_INT:
+        ((json_int_t*)column_p->values_p)[row] = value_p->value_int;
+        break;
+    case VALUE_LLU:
+        ((json_uint_t*)column_p->values_p)[row] = value_p->value_llu;
+        break;
+    case VALUE_BOOL:
+        ((json_bool_t*)column_p->values_p)[row] = value_p->value_bool;
+        break;
+    default:
+        _JsonValue_read_value_str(value_p, &((JsonStr*)column_p->values_p)[row]);
+        break;
+    }
+    return true;
+}
+
+// Store the members of the element at `row` whose first member `item_p` holds a key table, and
+// return the mask of the columns stored.
+__attribute__((noinline)) static uint64_t _JsonColumns_store_indexed(
+    const JsonColumn* columns,
+    const JsonColumnKey* keys,
+    size_t num_of_columns,
+    const JsonItem* item_p,
+    size_t row)
+{
+    uint64_t stored = 0;
+    for (size_t column = 0; column < num_of_columns; column++)
+    {
+        const JsonItem* found_p = _JsonKeyTable_find_hashed(
+            item_p->key_table_p, columns[column].key, keys[column].key_len, keys[column].hash);
+        if ((found_p != NULL) && _JsonColumn_store(&columns[column], row, &found_p->value))
+        {
+            stored |= (uint64_t)1 << column;
+        }
+    }
+    return stored;
+}
+
+// Store the members of `element_p`, the element at `row`, in the `num_of_columns` columns and
+// return the mask of the columns stored. `key_lens` holds the bits of the lengths of their keys.
+// Each key is first compared with the column following the last one matched, starting from the
+// first column, so that an element does not wait for the previous one.
+static inline uint64_t _JsonColumns_store_row(
+    const JsonColumn* columns,
+    const JsonColumnKey* keys,
+    size_t num_of_columns,
+    uint64_t key_lens,
+    const JsonItem* element_p,
+    size_t row)
+{
+    const JsonItem* item_p = element_p->value.value_child_p;
+    // An empty object or an element that is not an object has no member.
+    if ((element_p->value.value_type != VALUE_ITEM) || (item_p == NULL) || (item_p->key_p == NULL))
+    {
+        return 0;
+    }
+    if (item_p->key_table_p != NULL)
+    {
+        return _JsonColumns_store_indexed(columns, keys, num_of_columns, item_p, row);
+    }
+    const uint64_t all_columns = UINT64_MAX >> (64 - num_of_columns);
+    uint64_t matched           = 0;
+    uint64_t stored            = 0;
+    size_t column              = 0;
+    for (; (item_p != NULL) && (matched != all_columns); item_p = item_p->next_sibling)
+    {
+        if ((key_lens & _JsonColumn_len_bit(item_p->key_len)) == 0)
+        {
+            continue;
+        }
+        for (size_t i = 0; i < num_of_columns; i++)
+        {
+            const size_t curr_column = column;
+            column                   = (column + 1 == num_of_columns) ? 0 : column + 1;
+            if (_JsonColumn_key_equal(item_p, columns[curr_column].key, &keys[curr_column]))
+            {
+                // When a key is repeated, the first occurrence wins, as with Json_get.
+                const uint64_t bit = (uint64_t)1 << curr_column;
+                if (((matched & bit) == 0)
+                    && _JsonColumn_store(&columns[curr_column], row, &item_p->value))
+                {
+                    stored |= bit;
+                }
+                matched |= bit;
+                break;
+            }
+        }
+    }
+    return stored;
+}
+
+// Prefetch the nodes of an element, which the arena lays out from the element to the next one.
+// The walk of an array is a chain of loads the hardware does not see far enough ahead.
+static inline void _JsonColumns_prefetch(const JsonItem* element_p, const JsonItem* next_p)
+{
+    const uintptr_t end = (uintptr_t)next_p;
+    uintptr_t line      = (uintptr_t)element_p;
+    for (size_t i = 0; (i < JSON_COLUMNS_PREFETCH_LINES) && (line < end); i++, line += 64)
+    {
+        __builtin_prefetch((const void*)line);
+    }
+}
+
+// Fill the `num_of_columns` columns, at most 64, from every element of `array_p`.
+static void _JsonColumns_extract(
+    const JsonArray* array_p,
+    JsonColumn* columns,
+    const JsonColumnKey* keys,
+    size_t num_of_columns)
+{
+    const uint64_t all_columns = UINT64_MAX >> (64 - num_of_columns);
+    uint64_t present[JSON_COLUMNS_PER_PASS] = {0}; // Bits of the current 64 rows, per column
+    uint64_t key_lens                       = 0;
+    for (size_t column = 0; column < num_of_columns; column++)
+    {
+        key_lens |= _JsonColumn_len_bit(keys[column].key_len);
+    }
+    for (size_t row = 0; row < array_p->len; row++)
+    {
+        if (row + JSON_COLUMNS_PREFETCH_ROWS + 1 < array_p->len)
+        {
+            _JsonColumns_prefetch(
+                array_p->elements[row + JSON_COLUMNS_PREFETCH_ROWS],
+                array_p->elements[row + JSON_COLUMNS_PREFETCH_ROWS + 1]);
+        }
+        const uint64_t stored = _JsonColumns_store_row(
+            columns, keys, num_of_columns, key_lens, array_p->elements[row], row);
+        for (uint64_t mask = stored; mask != 0; mask &= mask - 1)
+        {
+            present[__builtin_ctzll(mask)] |= (uint64_t)1 << (row % 64);
+        }
+        // Missing values are rare, and zeroed on the way.
+        for (uint64_t mask = all_columns & ~stored; mask != 0; mask &= mask - 1)
+        {
+            const JsonColumn* column_p = &columns[__builtin_ctzll(mask)];
+            const size_t value_size    = _JsonColumn_value_size(column_p->value_type);
+            memset((char*)column_p->values_p + row * value_size, 0, value_size);
+        }
+        if ((row % 64 == 63) || (row + 1 == array_p->len))
+        {
+            for (size_t column = 0; column < num_of_columns; column++)
+            {
+                columns[column].present_p[row / 64] = present[column];
+                columns[column].num_of_present += (size_t)__builtin_popcountll(present[column]);
+                present[column] = 0;
+            }
+        }
+    }
+}
+
+// Check the columns and measure and hash their keys into `keys`.
+static Error _JsonColumns_prepare(JsonColumn* columns, size_t num_of_columns, JsonColumnKey* keys)
+{
+    for (size_t column = 0; column < num_of_columns; column++)
+    {
+        JsonColumn* column_p = &columns[column];
+        if ((column_p->key == NULL) || (column_p->values_p == NULL)
+            || (column_p->present_p == NULL))
+        {
+            LOG_ERROR("Column %lu has no key, values or bitmap", column);
+            return ERR_NULL;
+        }
+        if (_JsonColumn_value_size(column_p->value_type) == 0)
+        {
+            LOG_ERROR("Column `%s` is not of a scalar type", column_p->key);
+            return ERR_INVALID;
+        }
+        keys[column].key_len = strlen(column_p->key);
+        keys[column].head    = _JsonColumn_key_head(column_p->key, keys[column].key_len);
+        keys[column].hash    = _hash_key(column_p->key, keys[column].key_len);
+        for (size_t other = 0; other < column; other++)
+        {
+            if (_keys_equal(
+                    columns[other].key, keys[other].key_len, column_p->key, keys[column].key_len))
+            {
+                LOG_ERROR("Column `%s` requested twice", column_p->key);
+                return ERR_INVALID;
+            }
+        }
+        column_p->num_of_present = 0;
+    }
+    return ERR_ALL_GOOD;
+}
+
+Error Json_extract_columns(const JsonArray* array_p, JsonColumn* columns, size_t num_of_columns)
+{
+    if ((array_p == NULL) || (columns == NULL))
+    {
+        LOG_ERROR("Input is NULL");
+        return ERR_NULL;
+    }
+    JsonColumnKey stack_keys[JSON_COLUMN_STACK_KEYS];
+    JsonColumnKey* keys = stack_keys;
+    if (num_of_columns > JSON_COLUMN_STACK_KEYS)
+    {
+        keys = malloc(num_of_columns * sizeof(JsonColumnKey));
+        if (keys == NULL)
+        {
+            LOG_PERROR("Out of memory");
+            return ERR_FATAL;
+        }
+    }
+    const Error ret_res = _JsonColumns_prepare(columns, num_of_columns, keys);
+    for (size_t first = 0; is_ok(ret_res) && (first < num_of_columns);
+         first += JSON_COLUMNS_PER_PASS)
+    {
+        const size_t num_of_pass_columns = (num_of_columns - first < JSON_COLUMNS_PER_PASS)
+                                               ? num_of_columns - first
+                                               : JSON_COLUMNS_PER_PASS;
+        _JsonColumns_extract(array_p, &columns[first], &keys[first], num_of_pass_columns);
+    }
+    if (keys != stack_keys)
+    {
+        free(keys);
+    }
+    return ret_res;
+}
+
+Error Json_extract_column(
+    const JsonArray* array_p,
+    const char* key,
+    ValueType value_type,
+    void* out_values_p,
+    uint64_t* out_present_p,
+    size_t* out_num_of_present_p)
+{
+    JsonColumn column = {
+        .key        = key,
+        .value_type = value_type,
+        .values_p   = out_values_p,
+        .present_p  = out_present_p,
+    };
+    const Error ret_res = Json_extract_columns(array_p, &column, 1);
+    if (out_num_of_present_p != NULL)
+    {
+        *out_num_of_present_p = column.num_of_present;
+    }
+    return ret_res;
+}
+
+// ---------- Schema binding ----------
+// JsonDoc_bind walks the structural index of a document once, in the order of the document, and
+// writes every value whose key is in the schema straight into the struct, through the conversions
+// of Json_get. No node is created. Other members are stepped over by matching their brackets.
+// Documents usually list their keys in the order of the schema, so a key is first compared with
+// the field following the last one matched.
+
+// Convert the scalar at the position `pos` to `type` and write it at `out_p`.
+static Error _bind_scalar(const JsonDoc* doc_p, size_t pos, JsonFieldType type, void* out_p)
+{
+    JsonValue value;
+    return_on_err(_JsonDoc_read(doc_p, pos, &value));
+    const JsonSite site = _JsonDoc_site(doc_p, NULL, 0, pos);
+    switch (type)
+    {
+    case JSON_FIELD_INT:
+        return _value_get_value_int(&value, out_p, &site);
+    case JSON_FIELD_UINT:
+        return _value_get_value_llu(&value, out_p, &site);
+    case JSON_FIELD_DOUBLE:
+        return _value_get_value_double(&value, out_p, &site);
+    case JSON_FIELD_BOOL:
+        return _value_get_value_bool(&value, out_p, &site);
+    case JSON_FIELD_STR:
+        return _value_get_value_char_p(&value, out_p, &site);
+    default:
+        LOG_ERROR("Invalid field type %d", type);
+        return ERR_INVALID;
+    }
+}
+
+static Error _bind_object(const JsonDoc*, size_t*, const JsonSchema*, char*);
+
+// Bind the value at `*pos_p` to a single element of type `type`, and move `*pos_p` past it.
+static Error _bind_element(
+    const JsonDoc* doc_p,
+    size_t* pos_p,
+    JsonFieldType type,
+    const JsonSchema* schema_p,
+    char* out_p)
+{
+    if (type == JSON_FIELD_OBJECT)
+    {
+        return _bind_object(doc_p, pos_p, schema_p, out_p);
+    }
+    return_on_err(_bind_scalar(doc_p, *pos_p, type, out_p));
+    return _JsonDoc_skip(doc_p, pos_p);
+}
+
+// Bind the array at `*pos_p` to the C array of `field_p`, and move `*pos_p` past it.
+static Error _bind_array(
+    const JsonDoc* doc_p,
+    size_t* pos_p,
+    const JsonField* field_p,
+    char* base_p)
+{
+    if (_JsonDoc_char(doc_p, *pos_p) != '[')
+    {
+        LOG_ERROR("Requested an array for key `%s`", field_p->key);
+        return ERR_TYPE_MISMATCH;
+    }
+    size_t pos   = *pos_p + 1;
+    size_t count = 0;
+    if (_JsonDoc_char(doc_p, pos) != ']')
+    {
+        while (true)
+        {
+            if (count == field_p->capacity)
+            {
+                LOG_ERROR("More than %lu elements for key `%s`", field_p->capacity, field_p->key);
+                return ERR_INVALID;
+            }
+            char* element_p = base_p + field_p->offset + count * field_p->element_size;
+            return_on_err(_bind_element(doc_p, &pos, field_p->type, field_p->schema_p, element_p));
+            count++;
+            const char curr_char = _JsonDoc_char(doc_p, pos);
+            if (curr_char == ']')
+            {
+                break;
+            }
+            if (curr_char != ',')
+            {
+                LOG_ERROR("Expected `,` or `]`");
+                return ERR_JSON_INVALID;
+            }
+            pos++;
+        }
+    }
+    *(size_t*)(base_p + field_p->count_offset) = count;
+    *pos_p                                     = pos + 1;
+    return ERR_ALL_GOOD;
+}
+
+// Bind the object at `*pos_p` to the struct at `base_p`, and move `*pos_p` past it.
+static Error _bind_object(
+    const JsonDoc* doc_p,
+    size_t* pos_p,
+    const JsonSchema* schema_p,
+    char* base_p)
+{
+    if (schema_p == NULL)
+    {
+        LOG_ERROR("Missing schema");
+        return ERR_NULL;
+    }
+    if (_JsonDoc_char(doc_p, *pos_p) != '{')
+    {
+        LOG_ERROR("Requested an object for a different value type.");
+        return ERR_TYPE_MISMATCH;
+    }
+    const JsonField* fields    = schema_p->fields;
+    const size_t num_of_fields = schema_p->num_of_fields;
+    size_t next_field          = 0;
+    size_t pos                 = *pos_p + 1;
+    if (_JsonDoc_char(doc_p, pos) != '}')
+    {
+        while (true)
+        {
+            if ((_JsonDoc_char(doc_p, pos) != '"') || (_JsonDoc_char(doc_p, pos + 2) != ':'))
+            {
+                LOG_ERROR("Expected key followed by `:`");
+                return ERR_JSON_INVALID;
+            }
+            const char* key_p;
+            uint32_t len;
+            return_on_err(_JsonDoc_str(doc_p, pos, &key_p, &len));
+            const JsonField* field_p = NULL;
+            for (size_t i = 0; i < num_of_fields; i++)
+            {
+                const JsonField* candidate_p = &fields[(next_field + i) % num_of_fields];
+                if ((candidate_p->key_len == len) && (memcmp(candidate_p->key, key_p, len) == 0))
+                {
+                    field_p    = candidate_p;
+                    next_field = (size_t)(candidate_p - fields) + 1;
+                    break;
+                }
+            }
+            pos += 3;
+            if (field_p == NULL)
+            {
+                return_on_err(_JsonDoc_skip(doc_p, &pos));
+            }
+            else if (field_p->is_array)
+            {
+                return_on_err(_bind_array(doc_p, &pos, field_p, base_p));
+            }
+            else
+            {
+                return_on_err(_bind_element(
+                    doc_p, &pos, field_p->type, field_p->schema_p, base_p + field_p->offset));
+            }
+            const char curr_char = _JsonDoc_char(doc_p, pos);
+            if (curr_char == '}')
+            {
+                break;
+            }
+            if (curr_char != ',')
+            {
+                LOG_ERROR("Expected `,` or `}`");
+                return ERR_JSON_INVALID;
+            }
+            pos++;
+        }
+    }
+    *pos_p = pos + 1;
+    return ERR_ALL_GOOD;
+}
+
+// Write the members of the root object of `doc_p` described by `schema_p` into the struct at
+// `out_p`. Members of the struct missing from the document are left untouched; on error, the
+// struct may be partly written.
+Error JsonDoc_bind(const JsonDoc* doc_p, const JsonSchema* schema_p, void* out_p)
+{
+    if ((doc_p == NULL) || (out_p == NULL) || (doc_p->json_obj.index.count == 0))
+    {
+        LOG_ERROR("Input document is NULL");
+        return ERR_NULL;
+    }
+    size_t pos = 0;
+    return _bind_object(doc_p, &pos, schema_p, out_p);
+}
+
+#if defined(TEST) || defined(BENCH)
+// Return a document whose member "items" holds `num_of_items` objects, in an array or in an object,
+// followed by `num_of_members` members. Strings hold escaped quotes and brackets, so that chunks
+// start inside them.
+static char* _make_large_json(size_t num_of_items, bool items_in_object, size_t num_of_members)
+{
+    char* json_string = malloc(128 * (num_of_items + num_of_members) + 64);
+    size_t len        = (size_t)sprintf(json_string, "{\"items\": %c", items_in_object ? '{' : '[');
+    for (size_t i = 0; i < num_of_items; i++)
+    {
+        if (items_in_object)
+        {
+            len += (size_t)sprintf(&json_string[len], "\"item_%lu\": ", i);
+        }
+        len += (size_t)sprintf(
+            &json_string[len],
+            "{\"id\": %lu, \"tag\": \"\\\"[%lu]\\\\\", \"ok\": %s, \"v\": [%lu.5, {}]}%s",
+            i,
+            i,
+            (i % 2) ? "true" : "false",
+            i,
+            (i + 1 < num_of_items) ? ",\n" : "");
+    }
+    len += (size_t)sprintf(&json_string[len], "%c", items_in_object ? '}' : ']');
+    for (size_t i = 0; i < num_of_members; i++)
+    {
+        len += (size_t)sprintf(&json_string[len], ", \"member_%lu\": [%lu]", i, i);
+    }
+    sprintf(&json_string[len], "}");
+    return json_string;
+}
+
+// Return `{"a": [0, 1, ..., 9, 0, 1, ...]}` with `num_of_elements` one-digit elements, and its length
+// in `*len_p`.
+static char* _make_wide_array(size_t num_of_elements, size_t* len_p)
+{
+    char* json_string = malloc(2 * num_of_elements + 16);
+    size_t len        = (size_t)sprintf(json_string, "{\"a\": [");
+    for (size_t i = 0; i < num_of_elements; i++)
+    {
+        json_string[len++] = (char)('0' + i % 10);
+        json_string[len++] = ',';
+    }
+    *len_p = len - 1 + (size_t)sprintf(&json_string[len - 1], "]}");
+    return json_string;
+}
+
+// Return `{"k0": 0, "k1": 1, ...}` with `num_of_keys` members, and its length in `*len_p`.
+static char* _make_wide_object(size_t num_of_keys, size_t* len_p)
+{
+    char* json_string = malloc(32 * num_of_keys + 2);
+    size_t len        = (size_t)sprintf(json_string, "{");
+    for (size_t i = 0; i < num_of_keys; i++)
+    {
+        len += (size_t)sprintf(&json_string[len], "%s\"k%lu\": %lu", i ? ", " : "", i, i);
+    }
+    *len_p = len + (size_t)sprintf(&json_string[len], "}");
+    return json_string;
+}
+
+// Bytes used by the tree of `json_obj_p` besides its buffer: the nodes, key tables and element
+// tables in the arena, the structural index and the stack of array elements.
+static size_t _JsonObj_used_bytes(const JsonObj* json_obj_p)
+{
+    size_t bytes = json_obj_p->index.count * sizeof(uint32_t)
+                   + json_obj_p->element_stack.capacity * sizeof(JsonItem*);
+    for (const JsonArenaChunk* chunk_p = json_obj_p->arena.first_chunk_p; chunk_p != NULL;
+         chunk_p                       = chunk_p->next_p)
+    {
+        bytes += sizeof(JsonArenaChunk) + chunk_p->used;
+    }
+    return bytes;
+}
+#endif /* TEST || BENCH */
+
+#ifdef TEST
+typedef struct
+{
+    FILE* file_p;
+    size_t thread_id;
+} TestLogTask;
+
+static void* _test_log_lines(void* task_p)
+{
+    const TestLogTask* log_task_p = task_p;
+    for (size_t i = 0; i < 3 * LOG_RING_LEN; i++)
+    {
+        log_enqueue(log_task_p->file_p, "INFO", __FILENAME__, __LINE__, "thread %zu line %zu",
+                    log_task_p->thread_id, i);
+    }
+    return NULL;
+}
+
+void test_logger(void)
+{
+    PRINT_BANNER()
+    PRINT_TEST_TITLE("Logging all levels");
+    PRINT_SEPARATOR();
+    LOG_TRACE("Log trace.");
+    LOG_DEBUG("Log debug.");
+    LOG_INFO("Log info.");
+    LOG_WARNING("Log warning.");
+    LOG_ERROR("Log error.");
+    PRINT_TEST_TITLE("Logging from several threads");
+    {
+        // Each thread logs three rings' worth of lines, so it has to wait for the writer thread.
+        FILE* file_p = tmpfile();
+        ASSERT(file_p != NULL, "Temporary log file created");
+        pthread_t threads[4];
+        TestLogTask log_tasks[4];
+        for (size_t t = 0; t < 4; t++)
+        {
+            log_tasks[t] = (TestLogTask){.file_p = file_p, .thread_id = t};
+            pthread_create(&threads[t], NULL, _test_log_lines, &log_tasks[t]);
+        }
+        for (size_t t = 0; t < 4; t++)
+        {
+            pthread_join(threads[t], NULL);
+        }
+        logger_flush();
+        rewind(file_p);
+        char line[LOG_MESSAGE_LEN + 128];
+        size_t next_line[4] = {0};
+        size_t num_of_lines = 0;
+        bool in_order       = true;
+        bool prefixed       = true;
+        while (fgets(line, sizeof(line), file_p) != NULL)
+        {
+            size_t thread_id = 0;
+            size_t line_num  = 0;
+            const char* message_p = strstr(line, "| thread ");
+            if ((message_p == NULL) ||
+                (sscanf(message_p, "| thread %zu line %zu", &thread_id, &line_num) != 2) ||
+                (thread_id >= 4) || (line_num != next_line[thread_id]))
+            {
+                in_order = false;
+                break;
+            }
+            prefixed = prefixed && (strncmp(line, "[ INFO] <", 9) == 0);
+            next_line[thread_id]++;
+            num_of_lines++;
+        }
+        ASSERT_EQ(num_of_lines, 4 * 3 * LOG_RING_LEN, "Every line written once flushed");
+        ASSERT(in_order, "Lines of each thread in order");
+        ASSERT(prefixed, "Prefix added by the writer thread");
+        fclose(file_p);
+    }
+}
+
+static char* load_file_alloc(char* filename)
+{
+    FILE* json_file = fopen(filename, "r");
+    if (json_file == NULL)
+    {
+        LOG_PERROR("Could not read file");
+    }
+    int c;
+    size_t chars_read = 0;
+    size_t size       = 4096;
+    char* ret_str     = malloc(size);
+    if (ret_str == NULL)
+    {
+        LOG_PERROR("out of memory");
+        exit(1);
+    }
+    while ((c = fgetc(json_file)) != EOF)
+    {
+        if (chars_read >= size - 1)
+        {
+            /* time to make it bigger */
+            size    = (size_t)(size * 1.5);
+            ret_str = realloc(ret_str, size);
+            if (ret_str == NULL)
+            {
+                LOG_PERROR("out of memory");
+                exit(1);
+            }
+        }
+        ret_str[chars_read++] = c;
+    }
+    ret_str[chars_read++] = '\0';
+    fclose(json_file);
+    return ret_str;
+}
+
+// Sum the `n` of the valid records in `sums[0]` and count the invalid ones in `sums[1]`. Stop
+// after the record with `n` = 4.
+static bool _sum_until_4(const JsonRecord* record_p, void* sums_p)
+{
+    json_int_t* sums = sums_p;
+    json_int_t n     = 0;
+    if (is_err(record_p->error))
+    {
+        sums[1]++;
+        return true;
+    }
+    if (is_err(Json_get(record_p->item_p, "n", &n)))
+    {
+        return false;
+    }
+    sums[0] += n;
+    return n != 4;
+}
+
+// Events recorded by the test of Json_parse_events: appended to `text` while it has room, and
+// counted.
+typedef struct
+{
+    char text[256];
+    size_t text_len;
+    size_t num_of_events;
+    size_t stop_after; // The callbacks return false on this event, unless 0
+    json_int_t int_sum; // Integers, signed or not
+    size_t str_bytes;   // Bytes of the keys and strings
+} EventLog;
+
+static bool _log_event(void* log_p, const char* event)
+{
+    EventLog* event_log_p = log_p;
+    const size_t len      = strlen(event);
+    if (event_log_p->text_len + len + 2 < sizeof(event_log_p->text))
+    {
+        if (event_log_p->text_len > 0)
+        {
+            event_log_p->text[event_log_p->text_len++] = ' ';
+        }
+        memcpy(&event_log_p->text[event_log_p->text_len], event, len + 1);
+        event_log_p->text_len += len;
+    }
+    return ++event_log_p->num_of_events != event_log_p->stop_after;
+}
+
+static bool _log_object_start(void* log_p) { return _log_event(log_p, "{"); }
+static bool _log_object_end(void* log_p) { return _log_event(log_p, "}"); }
+static bool _log_array_start(void* log_p) { return _log_event(log_p, "["); }
+static bool _log_array_end(void* log_p) { return _log_event(log_p, "]"); }
+
+static bool _log_key(const char* key_p, size_t len, void* log_p)
+{
+    char event[64];
+    snprintf(event, sizeof(event), "k:%s", key_p);
+    ((EventLog*)log_p)->str_bytes += len;
+    return _log_event(log_p, event);
+}
+
+static bool _log_string(const char* str_p, size_t len, void* log_p)
+{
+    char event[64];
+    snprintf(event, sizeof(event), "s:%s", str_p);
+    ((EventLog*)log_p)->str_bytes += len;
+    return _log_event(log_p, event);
+}
+
+static bool _log_int(json_int_t value, void* log_p)
+{
+    char event[64];
+    snprintf(event, sizeof(event), "i:%lld", value);
+    ((EventLog*)log_p)->int_sum += value;
+    return _log_event(log_p, event);
+}
+
+static bool _log_llu(json_uint_t value, void* log_p)
+{
+    char event[64];
+    snprintf(event, sizeof(event), "u:%llu", value);
+    ((EventLog*)log_p)->int_sum += (json_int_t)value;
+    return _log_event(log_p, event);
+}
+
+static bool _log_double(json_decimal_t value, void* log_p)
+{
+    char event[64];
+    snprintf(event, sizeof(event), "d:%g", value);
+    return _log_event(log_p, event);
+}
+
+static bool _log_bool(json_bool_t value, void* log_p)
+{
+    return _log_event(log_p, value ? "b:1" : "b:0");
+}
+
+static const JsonHandler _log_handler = {
+    .on_object_start = _log_object_start,
+    .on_object_end   = _log_object_end,
+    .on_array_start  = _log_array_start,
+    .on_array_end    = _log_array_end,
+    .on_key          = _log_key,
+    .on_string       = _log_string,
+    .on_int          = _log_int,
+    .on_llu          = _log_llu,
+    .on_double       = _log_double,
+    .on_bool         = _log_bool,
+};
+
+// Structs bound by the test of JsonDoc_bind.
+typedef struct
+{
+    const char* name;
+    json_uint_t age;
+} TestCustomer;
+
+typedef struct
+{
+    const char* sku;
+    json_decimal_t price;
+} TestLine;
+
+typedef struct
+{
+    json_uint_t id;
+    json_int_t delta;
+    json_decimal_t total;
+    json_bool_t paid;
+    const char* note;
+    TestCustomer customer;
+    json_int_t tags[4];
+    size_t num_of_tags;
+    TestLine lines[2];
+    size_t num_of_lines;
+} TestOrder;
+
+#define TEST_CUSTOMER_FIELDS(FIELD, OBJECT, ARRAY, OBJECT_ARRAY) \
+    FIELD(TestCustomer, name, "name")                            \
+    FIELD(TestCustomer, age, "age")
+JSON_SCHEMA(test_customer_schema, TEST_CUSTOMER_FIELDS);
+
+#define TEST_LINE_FIELDS(FIELD, OBJECT, ARRAY, OBJECT_ARRAY) \
+    FIELD(TestLine, sku, "sku")                              \
+    FIELD(TestLine, price, "price")
+JSON_SCHEMA(test_line_schema, TEST_LINE_FIELDS);
+
+#define TEST_ORDER_FIELDS(FIELD, OBJECT, ARRAY, OBJECT_ARRAY)                        \
+    FIELD(TestOrder, id, "id")                                                       \
+    FIELD(TestOrder, delta, "delta")                                                 \
+    FIELD(TestOrder, total, "total")                                                 \
+    FIELD(TestOrder, paid, "paid")                                                   \
+    FIELD(TestOrder, note, "note")                                                   \
+    OBJECT(TestOrder, customer, "customer", &test_customer_schema)                   \
+    ARRAY(TestOrder, tags, "tags", num_of_tags)                                      \
+    OBJECT_ARRAY(TestOrder, lines, "lines", num_of_lines, &test_line_schema)
+JSON_SCHEMA(test_order_schema, TEST_ORDER_FIELDS);
+
+// Evaluate the path `paths[1]` on a document of its own and store the result in `paths[0]`.
+static void* _eval_shared_path(void* paths_p)
+{
+    const JsonPath** paths = paths_p;
+    JsonObj json_obj;
+    json_uint_t value_llu = 0;
+    char json_string[]    = "{\"a\": {\"b\": [0, {\"c\": 42}]}}";
+    paths[0]              = NULL;
+    if (is_ok(JsonObj_new_insitu(json_string, strlen(json_string), &json_obj)))
+    {
+        for (size_t i = 0; i < 10000; i++)
+        {
+            if (is_err(JsonPath_eval(&json_obj, paths[1], &value_llu)) || (value_llu != 42))
+            {
+                break;
+            }
+            paths[0] = (i == 9999) ? paths[1] : NULL;
+        }
+        JsonObj_destroy(&json_obj);
+    }
+    return NULL;
+}
+
+// Compare two trees item by item, starting from two lists of siblings.
+static bool _items_equal(const JsonItem* item_1_p, const JsonItem* item_2_p)
+{
+    for (; (item_1_p != NULL) && (item_2_p != NULL);
+         item_1_p = item_1_p->next_sibling, item_2_p = item_2_p->next_sibling)
+    {
+        if (((item_1_p->key_p == NULL) != (item_2_p->key_p == NULL))
+            || ((item_1_p->key_p != NULL) && strcmp(item_1_p->key_p, item_2_p->key_p))
+            || (item_1_p->key_len != item_2_p->key_len)
+            || ((item_1_p->key_p != NULL) && (strlen(item_1_p->key_p) != item_1_p->key_len))
+            || (item_1_p->value.value_type != item_2_p->value.value_type))
+        {
+            return false;
+        }
+        const JsonValue* value_1_p = &item_1_p->value;
+        const JsonValue* value_2_p = &item_2_p->value;
+        switch (value_1_p->value_type)
+        {
+        case VALUE_STR:
+            if (strcmp(value_1_p->value_char_p, value_2_p->value_char_p)
+                || (value_1_p->value_len != value_2_p->value_len)
+                || (strlen(value_1_p->value_char_p) != value_1_p->value_len))
+            {
+                return false;
+            }
+            break;
+        case VALUE_ITEM:
+            if (!_items_equal(value_1_p->value_child_p, value_2_p->value_child_p))
+            {
+                return false;
+            }
+            break;
+        case VALUE_ARRAY:
+            if ((value_1_p->value_array_p->len != value_2_p->value_array_p->len)
+                || ((value_1_p->value_array_p->len > 0)
+                    && !_items_equal(
+                        value_1_p->value_array_p->elements[0],
+                        value_2_p->value_array_p->elements[0])))
+            {
+                return false;
+            }
+            break;
+        case VALUE_UNDEFINED:
+            break;
+        case VALUE_BOOL:
+            // Only the first byte of the value is written.
+            if (value_1_p->value_bool != value_2_p->value_bool)
+            {
+                return false;
+            }
+            break;
+        default:
+            // Every other scalar fits in 8 bytes.
+            if (value_1_p->value_llu != value_2_p->value_llu)
+            {
+                return false;
+            }
+            break;
+        }
+    }
+    return (item_1_p == NULL) && (item_2_p == NULL);
+}
+
+void test_json_deserializer(void)
+{
+    PRINT_BANNER();
+    PRINT_TEST_TITLE("Validate brackets")
+    {
+        JsonObj json_obj;
+        {
+            const char* json_char_p = "{[}]";
+            ASSERT_ERR(JsonObj_new(json_char_p, &json_obj), "Crossed brackets.");
+        }
+        {
+            const char* json_char_p = "{\"a\":[[],[[]]],\"b\":{},\"c\":{\"d\":{}}}";
+            ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Valid JSON");
+            JsonObj_destroy(&json_obj);
+        }
+        {
+            const char* json_char_p = "{";
+            ASSERT_ERR(JsonObj_new(json_char_p, &json_obj), "Missing }.");
+        }
+        {
+            const char* json_char_p = "}";
+            ASSERT_ERR(JsonObj_new(json_char_p, &json_obj), "Extra }.");
+        }
+        {
+            const char* json_char_p = "{\"a\":[}";
+            ASSERT_ERR(JsonObj_new(json_char_p, &json_obj), "Extra }.");
+        }
+        {
+            const char* json_char_p = "{\"a\":[1";
+            ASSERT_ERR(JsonObj_new(json_char_p, &json_obj), "Missing ].");
+        }
+        {
+            const char* json_char_p = "{\"a\":1]}";
+            ASSERT_ERR(JsonObj_new(json_char_p, &json_obj), "Extra ].");
+        }
+        {
+            const char* json_char_p = "{]";
+            ASSERT_ERR(JsonObj_new(json_char_p, &json_obj), "Extra ].");
+        }
+        {
+            const char* json_char_p = "{\"a\":1}}";
+            ASSERT_ERR(JsonObj_new(json_char_p, &json_obj), "Trailing }.");
+        }
+        {
+            const char* json_char_p = "{\"a\":\"b\\\"}\"}";
+            const char* value_str;
+            ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Escaped quote inside a string.");
+            Json_get(&json_obj, "a", &value_str);
+            ASSERT_EQ(value_str, "b\"}", "Escaped quote does not terminate the string.");
+            JsonObj_destroy(&json_obj);
+        }
+    }
+    PRINT_TEST_TITLE("Structural index")
+    {
+        // Backslash runs and quotes straddling the 64-byte block boundary.
+        const char* json_char_p   = "{\"k\": \"...............................................\\\\\\\"\\\\\",\"\\"
+                                    "\\\\\"\": [1 ,true,{\"x\":\"}\"}],\"b\\\"\":-2.5e3}";
+        const uint32_t expected[] = {0,  1,  3,  4,  6,  60, 61, 62, 67, 68, 70, 71, 73,  74, 78,
+                                     79, 80, 82, 83, 84, 86, 87, 88, 89, 90, 94, 95, 96, 102};
+        const size_t len             = strlen(json_char_p);
+        JsonIndexBlocksFn kernels[3] = {_index_blocks_scalar, NULL, NULL};
+#if defined(__x86_64__)
+        if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul"))
+        {
+            kernels[1] = _index_blocks_sse42;
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("pclmul"))
+        {
+            kernels[2] = _index_blocks_avx2;
+        }
+#endif /* __x86_64__ */
+        for (size_t i = 0; i < 3; i++)
+        {
+            if (kernels[i] == NULL)
+            {
+                printf("Kernel %lu not supported - skipping\n", i);
+                continue;
+            }
+            JsonIndex index = {NULL, 0, 0};
+            ASSERT_OK(_index_structurals(kernels[i], json_char_p, len, &index), "Indexed");
+            ASSERT_EQ(index.count, sizeof(expected) / sizeof(expected[0]), "Structural count");
+            ASSERT(
+                memcmp(index.positions, expected, sizeof(expected)) == 0, "Structural positions");
+            ASSERT_ERR(_index_structurals(kernels[i], "{\"a\":\"b\\\"}", 10, &index), "Unterminated");
+            free(index.positions);
+        }
+        JsonObj json_obj;
+        const char* value_str;
+        json_decimal_t value_double;
+        JsonArray* json_array;
+        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
+        ASSERT_OK(Json_get(&json_obj, "b\"", &value_double), "Key with escaped quote found");
+        ASSERT_EQ(value_double, -2500.0, "Value correct");
+        ASSERT_OK(Json_get(&json_obj, "k", &value_str), "String with backslashes found");
+        ASSERT_EQ(strlen(value_str), 50lu, "String length correct");
+        ASSERT_OK(Json_get(&json_obj, "\\\"", &json_array), "Key across blocks found");
+        JsonObj_destroy(&json_obj);
+        ASSERT_ERR(JsonObj_new("{\"a\":truex}", &json_obj), "Unexpected character after literal");
+        ASSERT_ERR(JsonObj_new("{\"a\":12ab}", &json_obj), "Unexpected character after number");
+        ASSERT_ERR(JsonObj_new("{\"a\":1 2}", &json_obj), "Missing comma");
+        ASSERT_ERR(JsonObj_new("{\"a\":\"b\"c}", &json_obj), "Unexpected character after string");
+    }
+    PRINT_TEST_TITLE("Empty object")
+    {
+        JsonObj json_obj;
+        JsonItem* json_item_p;
+        const char* json_char_p = "{}";
+        json_int_t a;
+        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Empty JSON created");
+        ASSERT_ERR(Json_get(&json_obj, "missing key", &json_item_p), "Fix NULL on key");
+        ASSERT_ERR(Json_get(&json_obj, "missing key", &a), "Fix NULL on key");
+        JsonObj_destroy(&json_obj);
+    }
+    PRINT_TEST_TITLE("Wrong object")
+    {
+        JsonObj json_obj;
+        const char* json_char_p = "{:}";
+        ASSERT_ERR(JsonObj_new(json_char_p, &json_obj), "Invalid JSON");
+    }
+    PRINT_TEST_TITLE("Empty nested object")
+    {
+        JsonObj json_obj;
+        const char* value_str;
+        const char* json_char_p = "{\"key\":{}}";
+        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Empty nested JSON");
+        ASSERT_ERR(Json_get(&json_obj, "key", &value_str), "Key found but value cannot be retrieved");
+        JsonObj_destroy(&json_obj);
+    }
+    PRINT_TEST_TITLE("Key-value pair");
+    {
+        JsonObj json_obj;
+        const char* value_str;
+        const char* json_char_p = " {\"key\": \"value string\"}";
+        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
+        Json_get(&json_obj, "key", &value_str);
+        ASSERT_EQ("value string", value_str, "Key for root found with correct value STRING");
+        ASSERT_ERR(Json_get(&json_obj, "missing key", &value_str), "Missing key detected.");
+        ASSERT_EQ(value_str == NULL, true, "Returned null due to missing key.");
+        JsonObj_destroy(&json_obj);
+    }
+    PRINT_TEST_TITLE("Sibling key-value pair");
+    {
+        JsonObj json_obj;
+        const char* value_str;
+        json_uint_t value_llu;
+        const char* json_char_p = " {\"key\": \"value string\", \"sibling\": 56}";
+        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
+        Json_get(&json_obj, "key", &value_str);
+        Json_get(&json_obj, "sibling", &value_llu);
+        ASSERT_EQ("value string", value_str, "Key for root value STRING");
+        ASSERT_EQ(56, value_llu, "Key for root found with correct value INT");
+        JsonObj_destroy(&json_obj);
+    }
+    PRINT_TEST_TITLE("Simple array");
+    {
+        JsonObj json_obj;
+        const char* value_str;
+        json_uint_t value_llu;
+        JsonArray* json_array;
+        const char* json_char_p = " {\"key\": [\"array value\", 56]}";
+        printf("\n%s\n", json_char_p);
+        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
+        Json_get(&json_obj, "key", &json_array);
+        Json_get(json_array, 0, &value_str);
+        ASSERT_EQ("array value", value_str, "Array STRING element retrieved.");
+        Json_get(json_array, 1, &value_llu);
+        ASSERT_EQ(56, value_llu, "Array LLU element retrieved.");
+        JsonObj_destroy(&json_obj);
+    }
+    PRINT_TEST_TITLE("Array of objects");
+    {
+        JsonObj json_obj;
+        JsonItem* json_item;
+        json_uint_t value_llu;
+        JsonArray* json_array;
+        const char* json_char_p = " {\"key\": [ {\"array key\": 56}]}";
+        printf("\n%s\n", json_char_p);
+        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
+        Json_get(&json_obj, "key", &json_array);
+        Json_get(json_array, 0, &json_item);
+        ASSERT_EQ(json_item->key_p, "array key", "Array STRING element retrieved.");
+        printf("%d\n", json_item->value.value_type);
+        Json_get(json_item, "array key", &value_llu);
+        ASSERT_EQ(value_llu, 56, "Value found an item that is also array element.");
+        JsonObj_destroy(&json_obj);
+    }
+    PRINT_TEST_TITLE("object and array");
+    {
+        JsonObj json_obj;
+        JsonItem* json_item;
+        JsonArray* json_array;
+        const char* json_char_p = " {\"object\": {\"array\": [ {\"array key\": 56}]}}";
+        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
+        ASSERT_OK(Json_get(&json_obj, "object", &json_item), "Object retrieved");
+        ASSERT_OK(Json_get(json_item, "array", &json_array), "Array retrieved");
+        JsonObj_destroy(&json_obj);
+        JsonObj_destroy(&json_obj);
+    }
+    PRINT_TEST_TITLE("test_json_array_1.json");
+    {
+        JsonObj json_obj;
+        JsonItem* json_item;
+        json_uint_t value_llu;
+        const char* value_str;
+        double value_double;
+        bool value_bool;
+        JsonArray* json_array;
+        char* json_string = load_file_alloc("test/assets/test_json_array_1.json");
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Json object created");
+        Json_get(&json_obj, "array_key", &json_array);
+        ASSERT_EQ(json_array != NULL, true, "Array found as root element.");
+        Json_get(json_array, 0, &json_item);
+        ASSERT_EQ(json_item != NULL, true, "First array element is an item.");
+        Json_get(json_item, "object 1", &value_llu);
+        ASSERT_EQ(value_llu, 56, "Value LLU found");
+        Json_get(json_array, 1, &json_item);
+        ASSERT_EQ(json_item != NULL, true, "Second array element is an item.");
+        Json_get(json_item, "object 2", &value_double);
+        ASSERT_EQ(value_double, 404.5f, "Value DOUBLE found");
+        Json_get(json_array, 2, &json_item);
+        Json_get(json_item, "object 3", &value_str);
+        ASSERT_EQ(value_str, "SOME STRING", "Array element STRING found.");
+        Json_get(json_array, 3, &value_llu);
+        ASSERT_EQ(value_llu, 32, "Array element INT found.");
+        Json_get(json_array, 4, &value_bool);
+        ASSERT_EQ(value_bool, false, "Array element BOOL found.");
+        JsonObj_destroy(&json_obj);
+        free(json_string);
+    }
+    PRINT_TEST_TITLE("test_json_array_2.json");
+    {
+        char* json_string = load_file_alloc("test/assets/test_json_array_2.json");
+        JsonItem* json_item;
+        JsonObj json_obj;
+        json_uint_t value_llu;
+        const char* value_str;
+        double value_double;
+        bool value_bool;
+        JsonArray* json_array;
+        JsonArray* json_array_2;
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Json object created");
+        Json_get(&json_obj, "array_key", &json_array);
+        ASSERT_EQ(json_array != NULL, true, "Array found as root element.");
+        Json_get(json_array, 0, &json_item);
+        ASSERT_EQ(json_item != NULL, true, "First array element is an item.");
+        Json_get(json_item, "inner array 1", &json_array_2);
+        Json_get(json_array_2, 0, &value_llu);
+        ASSERT_EQ(value_llu, 12314, "Value LLU found");
+        Json_get(json_array_2, 1, &value_double);
+        ASSERT_EQ(value_double, -32.4, "Value DOUBLE found");
+        Json_get(json_array_2, 2, &value_bool);
+        ASSERT_EQ(value_bool, true, "Value TRUE found");
+        Json_get(json_array, 1, &json_item);
+        ASSERT_EQ(json_item != NULL, true, "Second array element is an item.");
+        Json_get(json_item, "inner array 2", &json_array_2);
+        Json_get(json_array_2, 0, &value_double);
+        ASSERT_EQ(value_double, 1.4, "Value DOUBLE found");
+        Json_get(json_array_2, 1, &value_str);
+        ASSERT_EQ(value_str, "hello", "Value STRING found");
+        Json_get(json_array_2, 2, &value_bool);
+        ASSERT_EQ(value_bool, false, "Value FALSE found");
+        JsonObj_destroy(&json_obj);
+        free(json_string);
+    }
+    PRINT_TEST_TITLE("test_json_array_3.json");
+    {
+        JsonObj json_obj;
+        JsonItem* json_item;
+        const char* value_str;
+        json_uint_t value_llu;
+        JsonArray* json_array;
+        char* json_string = load_file_alloc("test/assets/test_json_array_3.json");
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Json object created");
+        ASSERT(Json_get(&json_obj, "Snapshot", &json_item) == ERR_ALL_GOOD, "Ok");
+        ASSERT(Json_get(json_item, "Value", &value_llu) == ERR_ALL_GOOD, "Ok");
+        ASSERT(Json_get(json_item, "Data", &json_array) == ERR_ALL_GOOD, "Ok");
+        ASSERT(Json_get(json_array, 0, &json_item) == ERR_ALL_GOOD, "Ok");
+        ASSERT(Json_get(json_item, "Time", &value_str) == ERR_ALL_GOOD, "Ok");
+        ASSERT_EQ(value_str, "2021-07-23T08:09:00.000000Z", "Time correct.");
+        JsonObj_destroy(&json_obj);
+        free(json_string);
+    }
+    PRINT_TEST_TITLE("test_json_array_4.json");
+    {
+        JsonObj json_obj;
+        json_uint_t value_llu;
+        JsonArray* json_array;
+        bool value_bool;
+        char* json_string = load_file_alloc("test/assets/test_json_array_4.json");
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Json object created");
+        ASSERT_OK(Json_get(&json_obj, "array_key1", &json_array), "Ok");
+        ASSERT_OK(Json_get(json_array, 0, &value_llu), "Ok");
+        ASSERT_EQ(value_llu, 32, "Ok");
+        ASSERT_OK(Json_get(json_array, 1, &value_bool), "Ok");
+        ASSERT_EQ(value_bool, false, "Ok");
+        ASSERT_OK(Json_get(&json_obj, "array_key2", &json_array), "Ok");
+        ASSERT_OK(Json_get(json_array, 0, &value_llu), "Ok");
+        ASSERT_EQ(value_llu, 33, "Ok");
+        ASSERT_OK(Json_get(json_array, 1, &value_bool), "Ok");
+        ASSERT_EQ(value_bool, true, "Ok");
+        ASSERT_OK(Json_get(&json_obj, "key", &value_llu), "Ok");
+        ASSERT_EQ(value_llu, 34, "Ok");
+        JsonObj_destroy(&json_obj);
+        free(json_string);
+    }
+    PRINT_TEST_TITLE("Testing test/assets/test_json.json");
+    {
+        JsonObj json_obj;
+        JsonItem* json_item;
+        const char* value_str;
+        json_uint_t value_llu;
+        double value_double;
+        bool value_bool;
+        JsonArray* json_array;
+        char* json_string = load_file_alloc("test/assets/test_json.json");
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Json object created");
+        free(json_string); // We can delete it.
+        Json_get(&json_obj, "text_key", &value_str);
+        ASSERT_EQ("text_value", value_str, "String*value found in first item");
+
+        Json_get(&json_obj, "text_sibling", &value_str);
+        ASSERT_EQ("sibling_value", value_str, "String*value found in sibling");
+
+        Json_get(&json_obj, "nested_1", &json_item);
+        ASSERT_EQ(json_item->key_p, "object_1.1", "Found nested object key");
+
+        Json_get(json_item, "object_1.1", &value_str);
+        ASSERT_EQ(value_str, "item_1.1", "Found nested object value");
+        Json_get(json_item, "object_1.2", &value_str);
+        ASSERT_EQ(value_str, "item_1.2", "Found nested sibling object value");
+        ASSERT(
+            Json_get(json_item, "object_32", &value_str) == ERR_JSON_MISSING_ENTRY,
+            "Object not found");
+        ASSERT(value_str == NULL, "Null returned.");
+
+        Json_get(&json_obj, "nested_2", &json_item);
+        Json_get(json_item, "object_2.1", &value_str);
+        ASSERT_EQ(value_str, "item_2.1", "Found nested object value");
+        Json_get(json_item, "object_2.2", &json_item);
+        ASSERT_EQ(json_item->key_p, "item_2.2", "Found nested object key");
+        Json_get(json_item, "item_2.2", &value_str);
+        ASSERT_EQ(value_str, "value_2.2.1", "Found nested sibling object value");
+
+        PRINT_TEST_TITLE("Test integer");
+        Json_get(&json_obj, "test_integer", &value_llu);
+        ASSERT_EQ(value_llu, 435234, "Integer found and read correctly");
+
+        PRINT_TEST_TITLE("Test double");
+        Json_get(&json_obj, "test_double", &value_double);
+        ASSERT_EQ(value_double, 435.234, "Float found and read correctly");
+
+        PRINT_TEST_TITLE("Test bool true");
+        Json_get(&json_obj, "test_bool_true", &value_bool);
+        ASSERT_EQ(value_bool, true, "Boolean found and read correctly");
+
+        PRINT_TEST_TITLE("Test bool false");
+        Json_get(&json_obj, "test_bool_false", &value_bool);
+        ASSERT_EQ(value_bool, false, "Boolean found and read correctly");
+
+        Json_get(&json_obj, "test_array", &json_array);
+        Json_get(json_array, 0, &value_llu);
+        ASSERT_EQ(value_llu, 14352, "Array element of type INT read correctly");
+        Json_get(json_array, 1, &value_double);
+        ASSERT_EQ(value_double, 2.15, "Array element of type DOUBLE read correctly");
+        Json_get(json_array, 2, &value_str);
+        ASSERT_EQ(value_str, "string_element", "Array element of type C-string read correctly");
+        JsonObj_destroy(&json_obj);
+    }
+    PRINT_TEST_TITLE("Invalid JSON string - empty")
+    {
+        JsonObj json_obj;
+        char* json_string = "";
+        ASSERT(JsonObj_new(json_string, &json_obj) == ERR_EMPTY_STRING, "Empty JSON fails to initialize.");
+    }
+    PRINT_TEST_TITLE("Invalid JSON string - string not starting with '{'")
+    { // TODO: crate token analyzer and add TC's.
+        JsonObj json_obj;
+        char* json_string = "This is not a JSON file";
+        ASSERT(JsonObj_new(json_string, &json_obj) == ERR_JSON_INVALID, "Invalid JSON fails to initialize.");
+    }
+    PRINT_TEST_TITLE("Fixed memory leak");
+    {
+        JsonArray* json_array;
+        const char* value_str;
+        const char* json_char_p = "{\"request\":[\"Required parameter is missing\"]}";
+        JsonObj json_with_vector_obj;
+        ASSERT(is_ok(JsonObj_new(json_char_p, &json_with_vector_obj)), "Json object created");
+        Json_get(&json_with_vector_obj, "request", &json_array);
+        Json_get(json_array, 0, &value_str);
+        ASSERT_EQ(value_str, "Required parameter is missing", "");
+        JsonObj_destroy(&json_with_vector_obj);
+    }
+    PRINT_TEST_TITLE("Reset and reuse");
+    {
+        JsonObj json_obj;
+        JsonArray* json_array;
+        json_uint_t value_llu;
+        const char* value_str;
+        // Large enough to span several arena chunks.
+        const size_t num_of_elements = 10000;
+        char* json_string            = malloc(16 + 8 * num_of_elements);
+        size_t len                   = sprintf(json_string, "{\"array\":[0");
+        for (size_t i = 1; i < num_of_elements; i++)
+        {
+            len += sprintf(&json_string[len], ",%lu", i);
+        }
+        sprintf(&json_string[len], "]}");
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Json object created");
+        const char* buffer_p    = json_obj.json_string;
+        JsonArenaChunk* first_p = json_obj.arena.first_chunk_p;
+        JsonArenaChunk* last_p  = json_obj.arena.curr_chunk_p;
+        size_t num_of_chunks    = 0;
+        for (JsonArenaChunk* chunk_p = first_p; chunk_p != NULL; chunk_p = chunk_p->next_p)
+        {
+            num_of_chunks++;
+        }
+        ASSERT(num_of_chunks > 1, "Nodes span several chunks");
+        for (size_t round = 0; round < 3; round++)
+        {
+            JsonObj_reset(&json_obj);
+            ASSERT_OK(JsonObj_new("{\"key\": \"value\"}", &json_obj), "Small object in reset JsonObj");
+            ASSERT_OK(Json_get(&json_obj, "key", &value_str), "Value found");
+            ASSERT_EQ(value_str, "value", "Value correct");
+            ASSERT(json_obj.json_string == buffer_p, "String buffer reused");
+            ASSERT(json_obj.arena.curr_chunk_p == first_p, "First chunk reused");
+            JsonObj_reset(&json_obj);
+            ASSERT_OK(JsonObj_new(json_string, &json_obj), "Large object in reset JsonObj");
+            ASSERT_OK(Json_get(&json_obj, "array", &json_array), "Array found");
+            ASSERT_OK(Json_get(json_array, num_of_elements - 1, &value_llu), "Last element found");
+            ASSERT_EQ(value_llu, num_of_elements - 1, "Last element correct");
+            ASSERT(json_obj.json_string == buffer_p, "String buffer reused");
+            ASSERT(json_obj.arena.curr_chunk_p == last_p, "No chunk added");
+        }
+        JsonObj_destroy(&json_obj);
+        ASSERT(json_obj.arena.first_chunk_p == NULL, "Arena released");
+        free(json_string);
+    }
+    PRINT_TEST_TITLE("Data conversion");
+    {
+        JsonObj json_obj;
+        json_uint_t value_llu;
+        json_int_t value_int;
+        Error ret_res;
+        char* json_string = load_file_alloc("test/assets/test_json_numbers.json");
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Json object created");
+        Json_get(&json_obj, "value_int", &value_llu);
+        ASSERT_EQ((json_uint_t)23, value_llu, "Conversion from INT to LLU successfull");
+        Json_get(&json_obj, "value_small_uint", &value_int);
+        ASSERT_EQ((json_int_t)43, value_int, "Conversion from LLU to INT successfull");
+        ret_res = Json_get(&json_obj, "value_negative_int", &value_llu);
+        ASSERT(ret_res == ERR_INVALID, "Conversion from negative INT to LLU failed");
+        ret_res = Json_get(&json_obj, "value_uint", &value_int);
+        ASSERT(ret_res == ERR_INVALID, "Conversion from large LLU to INT failed");
+        JsonObj_destroy(&json_obj);
+        free(json_string);
+    }
+    PRINT_TEST_TITLE("Numbers");
+    {
+        JsonObj json_obj;
+        json_uint_t value_llu;
+        json_int_t value_int;
+        json_decimal_t value_double;
+        const char* json_string = "{\"exp\": 1e5, \"neg_exp\": -25E-2, \"min\": -9223372036854775808, "
+                                  "\"max\": 18446744073709551615, \"long\": "
+                                  "3.14159265358979323846264338327950288419716939937510, "
+                                  "\"halfway\": 9007199254740993.0, \"huge\": 1e400}";
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Json object created");
+        ASSERT_OK(Json_get(&json_obj, "exp", &value_double), "Exponent without dot is a double");
+        ASSERT_EQ(value_double, 1e5, "Exponent value correct");
+        ASSERT_OK(Json_get(&json_obj, "neg_exp", &value_double), "Negative exponent found");
+        ASSERT_EQ(value_double, -0.25, "Negative exponent value correct");
+        ASSERT_OK(Json_get(&json_obj, "min", &value_int), "Smallest int found");
+        ASSERT_EQ(value_int, INT64_MIN, "Smallest int correct");
+        ASSERT_OK(Json_get(&json_obj, "max", &value_llu), "Largest unsigned found");
+        ASSERT_EQ(value_llu, UINT64_MAX, "Largest unsigned correct");
+        ASSERT_OK(Json_get(&json_obj, "long", &value_double), "Number longer than 29 chars found");
+        ASSERT_EQ(value_double, 3.14159265358979323846264338327950288419716939937510, "Long number correct");
+        ASSERT_OK(Json_get(&json_obj, "halfway", &value_double), "Halfway number found");
+        ASSERT_EQ(value_double, 9007199254740992.0, "Halfway number rounded to even");
+        ASSERT_OK(Json_get(&json_obj, "huge", &value_double), "Out-of-range double found");
+        ASSERT_EQ(value_double, strtod("1e400", NULL), "Out-of-range double matches strtod");
+        JsonObj_destroy(&json_obj);
+        ASSERT_ERR(JsonObj_new("{\"a\": 18446744073709551616}", &json_obj), "Unsigned overflow rejected");
+        ASSERT_ERR(JsonObj_new("{\"a\": -9223372036854775809}", &json_obj), "Signed overflow rejected");
+        ASSERT_ERR(JsonObj_new("{\"a\": 1.}", &json_obj), "Missing fraction digits rejected");
+        ASSERT_ERR(JsonObj_new("{\"a\": 1e}", &json_obj), "Missing exponent digits rejected");
+    }
+    PRINT_TEST_TITLE("Key table");
+    {
+        JsonObj json_obj;
+        JsonArray* json_array;
+        JsonItem* json_item;
+        json_uint_t value_llu;
+        const char* value_str;
+        char key[32];
+        const size_t num_of_keys = 1000;
+        char* json_string        = malloc(64 + 32 * num_of_keys);
+        // A repeated key, a nested object inside an array and a small object.
+        size_t len = sprintf(
+            json_string, "{\"key_1\": \"first\", \"small\": {\"a\": 1}, \"array\": [{\"key_0\": 0");
+        for (size_t i = 1; i < JSON_KEY_TABLE_MIN_ITEMS; i++)
+        {
+            len += sprintf(&json_string[len], ", \"key_%lu\": %lu", i, i);
+        }
+        len += sprintf(&json_string[len], "}]");
+        for (size_t i = 0; i < num_of_keys; i++)
+        {
+            len += sprintf(&json_string[len], ", \"key_%lu\": %lu", i, i);
+        }
+        sprintf(&json_string[len], "}");
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Json object created");
+        ASSERT(json_obj.root.next_sibling->key_table_p != NULL, "Large object indexed");
+        bool all_found = true;
+        for (size_t i = 0; i < num_of_keys; i++)
+        {
+            sprintf(key, "key_%lu", i);
+            if ((i != 1) && (is_err(Json_get(&json_obj, key, &value_llu)) || (value_llu != i)))
+            {
+                all_found = false;
+            }
+        }
+        ASSERT(all_found, "All keys found");
+        ASSERT_OK(Json_get(&json_obj, "key_1", &value_str), "Repeated key found");
+        ASSERT_EQ(value_str, "first", "First occurrence of a repeated key returned");
+        ASSERT(Json_get(&json_obj, "missing", &value_str) == ERR_JSON_MISSING_ENTRY, "Missing key");
+        ASSERT(Json_get(&json_obj, "missing", &value_llu) == ERR_NULL, "Missing number");
+        ASSERT_OK(Json_get(&json_obj, "small", &json_item), "Small object found");
+        ASSERT(json_item->key_table_p == NULL, "Small object not indexed");
+        ASSERT_OK(Json_get(&json_obj, "array", &json_array), "Array found");
+        ASSERT_OK(Json_get(json_array, 0, &json_item), "Nested object found");
+        ASSERT(json_item->key_table_p != NULL, "Nested object indexed");
+        ASSERT_OK(Json_get(json_item, "key_15", &value_llu), "Nested key found");
+        ASSERT_EQ(value_llu, (json_uint_t)15, "Nested value correct");
+        ASSERT_OK(Json_get(json_item->next_sibling, "key_2", &value_llu), "Search from a sibling");
+        ASSERT(Json_get(json_item->next_sibling, "key_0", &value_llu) == ERR_NULL, "Only later siblings");
+        JsonObj_destroy(&json_obj);
+        free(json_string);
+    }
+    PRINT_TEST_TITLE("Array length and indexed access");
+    {
+        JsonObj json_obj;
+        JsonArray* json_array;
+        json_uint_t value_llu;
+        const char* value_str;
+        const size_t num_of_elements = 100000;
+        char* json_string            = malloc(64 + 8 * num_of_elements);
+        size_t len = sprintf(json_string, "{\"empty\": [], \"strings\": [\"a\", \"b\"], \"array\": [0");
+        for (size_t i = 1; i < num_of_elements; i++)
+        {
+            len += sprintf(&json_string[len], ",%lu", i);
+        }
+        sprintf(&json_string[len], "]}");
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Json object created");
+        ASSERT_OK(Json_get(&json_obj, "empty", &json_array), "Empty array found");
+        ASSERT_EQ(JsonArray_len(json_array), (size_t)0, "Empty array length");
+        ASSERT(Json_get(json_array, 0, &value_llu) == ERR_NULL, "Empty array has no element");
+        ASSERT_OK(Json_get(&json_obj, "strings", &json_array), "Array of strings found");
+        ASSERT_EQ(JsonArray_len(json_array), (size_t)2, "Array of strings length");
+        ASSERT_OK(Json_get(json_array, 1, &value_str), "Last string found");
+        ASSERT_EQ(value_str, "b", "Last string correct");
+        ASSERT(Json_get(json_array, 2, &value_str) == ERR_NULL, "Index out of boundaries");
+        ASSERT_OK(Json_get(&json_obj, "array", &json_array), "Large array found");
+        ASSERT_EQ(JsonArray_len(json_array), num_of_elements, "Large array length");
+        bool all_found = true;
+        for (size_t i = 0; i < JsonArray_len(json_array); i++)
+        {
+            if (is_err(Json_get(json_array, i, &value_llu)) || (value_llu != i))
+            {
+                all_found = false;
+            }
+        }
+        ASSERT(all_found, "All elements found");
+        ASSERT_EQ(JsonArray_len(NULL), (size_t)0, "NULL array has no length");
+        JsonObj_destroy(&json_obj);
+        free(json_string);
+    }
+    PRINT_TEST_TITLE("In-situ parsing");
+    {
+        JsonObj json_obj;
+        JsonArray* json_array;
+        json_decimal_t value_double;
+        const char* value_str;
+        const char* json_string = "{\"key\": \"value\", \"array\": [1.5, \"last\"]}";
+        const size_t len        = strlen(json_string);
+        // Not null-terminated: any read past `len` is caught by the address sanitizer.
+        char* buf = malloc(len);
+        memcpy(buf, json_string, len);
+        ASSERT_OK(JsonObj_new_insitu(buf, len, &json_obj), "Json object created in place");
+        ASSERT_OK(Json_get(&json_obj, "key", &value_str), "String found");
+        ASSERT_EQ(value_str, "value", "String correct");
+        ASSERT(value_str == &buf[9], "String points into the caller's buffer");
+        ASSERT_OK(Json_get(&json_obj, "array", &json_array), "Array found");
+        ASSERT_OK(Json_get(json_array, 0, &value_double), "Number found");
+        ASSERT_EQ(value_double, 1.5, "Number correct");
+        ASSERT_OK(Json_get(json_array, 1, &value_str), "Last string found");
+        ASSERT_EQ(value_str, "last", "Last string correct");
+        // Switching between copied and borrowed input on a reset JsonObj.
+        JsonObj_reset(&json_obj);
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Copied input after borrowed input");
+        ASSERT_OK(Json_get(&json_obj, "key", &value_str), "String found in the copy");
+        ASSERT(value_str != &buf[9], "String points into the copy");
+        JsonObj_reset(&json_obj);
+        memcpy(buf, json_string, len);
+        ASSERT_OK(JsonObj_new_insitu(buf, len, &json_obj), "Borrowed input after copied input");
+        ASSERT(json_obj.json_string == buf, "Caller's buffer used");
+        JsonObj_destroy(&json_obj);
+        memcpy(buf, json_string, len);
+        ASSERT_ERR(JsonObj_new_insitu(buf, len - 1, &json_obj), "Length excludes the last `}`");
+        ASSERT(JsonObj_new_insitu(buf, 0, &json_obj) == ERR_EMPTY_STRING, "Empty buffer");
+        free(buf);
+    }
+    PRINT_TEST_TITLE("Memory-mapped file");
+    {
+        JsonObj json_obj;
+        JsonArray* json_array;
+        const char* value_str;
+        json_decimal_t value_double;
+        char* json_string = load_file_alloc("test/assets/test_json.json");
+        ASSERT_OK(JsonObj_from_file("test/assets/test_json.json", &json_obj), "Json object created");
+        ASSERT(json_obj.json_string_mapped_len == strlen(json_string), "Whole file mapped");
+        ASSERT_OK(Json_get(&json_obj, "text_sibling", &value_str), "String found");
+        ASSERT_EQ(value_str, "sibling_value", "String correct");
+        ASSERT_OK(Json_get(&json_obj, "test_array", &json_array), "Array found");
+        ASSERT_OK(Json_get(json_array, 1, &value_double), "Number found");
+        ASSERT_EQ(value_double, 2.15, "Number correct");
+        JsonObj_reset(&json_obj);
+        ASSERT(json_obj.json_string_mapped_len == 0, "File unmapped on reset");
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Copied input after a mapped file");
+        JsonObj_reset(&json_obj);
+        ASSERT_OK(JsonObj_from_file("test/assets/test_json.json", &json_obj), "Mapped file after reset");
+        JsonObj_destroy(&json_obj);
+        ASSERT(json_obj.json_string_mapped_len == 0, "File unmapped on destroy");
+        char* json_string_after = load_file_alloc("test/assets/test_json.json");
+        ASSERT_EQ(json_string_after, json_string, "File not modified by the parser");
+        ASSERT(
+            JsonObj_from_file("test/assets/missing.json", &json_obj) == ERR_INVALID, "Missing file");
+        free(json_string);
+        free(json_string_after);
+    }
+    PRINT_TEST_TITLE("Streaming parser");
+    {
+        JsonObj json_obj;
+        JsonObj json_obj_streamed;
+        JsonParser json_parser;
+        const char* value_str;
+        char* files[] = {
+            "test/assets/test_json.json",
+            "test/assets/test_json_array_1.json",
+            "test/assets/test_json_array_2.json",
+            "test/assets/test_json_array_3.json",
+            "test/assets/test_json_array_4.json",
+            "test/assets/test_json_numbers.json",
+            "test/assets/test_json_vec_of_obj.json",
+        };
+        bool all_equal = true;
+        for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++)
+        {
+            char* json_string = load_file_alloc(files[i]);
+            const size_t len  = strlen(json_string);
+            ASSERT_OK(JsonObj_new(json_string, &json_obj), "Reference object created");
+            // Every token is split at every position by the small chunk sizes.
+            for (size_t chunk_size = 1; chunk_size <= len; chunk_size += (chunk_size < 16) ? 1 : 61)
+            {
+                Error ret_res = JsonParser_new(&json_parser, &json_obj_streamed);
+                for (size_t j = 0; (j < len) && is_ok(ret_res); j += chunk_size)
+                {
+                    const size_t chunk_len = (len - j < chunk_size) ? len - j : chunk_size;
+                    ret_res = JsonParser_feed(&json_parser, &json_string[j], chunk_len);
+                }
+                if (is_err(ret_res) || is_err(JsonParser_finish(&json_parser))
+                    || !_items_equal(json_obj.root.next_sibling, json_obj_streamed.root.next_sibling))
+                {
+                    all_equal = false;
+                }
+                JsonObj_destroy(&json_obj_streamed);
+            }
+            JsonObj_destroy(&json_obj);
+            free(json_string);
+        }
+        ASSERT(all_equal, "Same tree for every test file and chunk size");
+
+        ASSERT_OK(JsonParser_new(&json_parser, &json_obj_streamed), "Parser created");
+        ASSERT_OK(JsonParser_feed(&json_parser, "{\"ke", 4), "Key split");
+        ASSERT_OK(JsonParser_feed(&json_parser, "y\": \"a \\", 8), "Escape split");
+        ASSERT_OK(JsonParser_feed(&json_parser, "\"b\", \"n\": [tr", 13), "Literal split");
+        ASSERT_OK(JsonParser_feed(&json_parser, "ue, 1.2", 7), "Number split");
+        ASSERT_OK(JsonParser_feed(&json_parser, "5e1]}", 5), "Last chunk");
+        ASSERT_OK(JsonParser_finish(&json_parser), "Document complete");
+        ASSERT_OK(Json_get(&json_obj_streamed, "key", &value_str), "Split key found");
+        ASSERT_EQ(value_str, "a \"b", "Split string correct");
+        ASSERT(JsonParser_feed(&json_parser, " ", 1) == ERR_INVALID, "Feeding a finished parser");
+        JsonObj_destroy(&json_obj_streamed);
+
+        ASSERT_OK(JsonParser_new(&json_parser, &json_obj_streamed), "Parser created");
+        ASSERT_OK(JsonParser_feed(&json_parser, "{\"a\": [1, 2", 11), "Incomplete document");
+        ASSERT_ERR(JsonParser_finish(&json_parser), "Truncated document rejected");
+        ASSERT_OK(JsonParser_new(&json_parser, &json_obj_streamed), "Parser created");
+        ASSERT_ERR(JsonParser_feed(&json_parser, "{\"a\": 1} x", 11), "Trailing characters rejected");
+        ASSERT_ERR(JsonParser_feed(&json_parser, "}", 1), "Error is sticky");
+        ASSERT_ERR(JsonParser_finish(&json_parser), "Finishing after an error");
+        ASSERT_OK(JsonParser_new(&json_parser, &json_obj_streamed), "Parser created");
+        ASSERT_OK(JsonParser_feed(&json_parser, "{\"a\": 1.", 8), "Number split after `.`");
+        ASSERT_ERR(JsonParser_finish(&json_parser), "Missing fraction digits rejected");
+        ASSERT_OK(JsonParser_new(&json_parser, &json_obj_streamed), "Parser created");
+        ASSERT_ERR(JsonParser_feed(&json_parser, "1 {}", 4), "Scalar before the root rejected");
+        ASSERT_ERR(JsonParser_finish(&json_parser), "Finishing after a scalar before the root");
+    }
+    PRINT_TEST_TITLE("Newline-delimited JSON");
+    {
+        JsonBatch json_batch;
+        json_int_t value_int;
+        const char* value_str;
+        char ndjson[] = "{\"id\": 1, \"name\": \"a\"}\n"
+                        "\n"
+                        "{\"id\": 2, \"tags\": [\"x\", \"y\"]}\r\n"
+                        "{\"id\": 3,}\n"
+                        "{\"id\": \"unterminated}\n"
+                        "{\"id\": 5, \"name\": \"\\\"e\\\"\"}\n"
+                        "  \n"
+                        "{\"id\": 6}";
+        ASSERT_OK(
+            JsonBatch_new(ndjson, strlen(ndjson), &json_batch, NULL, NULL), "Batch created");
+        ASSERT(json_batch.num_of_records == 6, "Blank lines skipped");
+        ASSERT(json_batch.num_of_errors == 2, "Invalid records counted");
+        ASSERT(json_batch.records[2].line == 4, "Line of an invalid record");
+        ASSERT_ERR(json_batch.records[2].error, "Trailing comma rejected");
+        ASSERT_ERR(json_batch.records[3].error, "Unterminated string rejected");
+        ASSERT(json_batch.records[3].item_p == NULL, "No item for an invalid record");
+        ASSERT_OK(json_batch.records[0].error, "First record parsed");
+        ASSERT_OK(Json_get(json_batch.records[0].item_p, "name", &value_str), "Key found");
+        ASSERT_EQ(value_str, "a", "Value correct");
+        ASSERT_OK(Json_get(json_batch.records[1].item_p, "id", &value_int), "Record after CRLF");
+        ASSERT_EQ(value_int, 2, "Value correct");
+        ASSERT_OK(json_batch.records[4].error, "Record after an unterminated string parsed");
+        ASSERT(json_batch.records[4].line == 6, "Line correct");
+        ASSERT_OK(Json_get(json_batch.records[4].item_p, "name", &value_str), "Key found");
+        ASSERT_EQ(value_str, "\"e\"", "Escaped quotes decoded");
+        ASSERT_OK(Json_get(json_batch.records[4].item_p, "id", &value_int), "Key found");
+        ASSERT_EQ(value_int, 5, "Value correct");
+        JsonBatch_destroy(&json_batch);
+
+        // Same trees as parsing the lines one by one.
+        char* json_string   = load_file_alloc("test/assets/test_json.json");
+        const size_t len    = strlen(json_string);
+        const size_t copies = 50;
+        char* lines         = malloc(copies * (len + 1));
+        size_t lines_len    = 0;
+        for (size_t i = 0; i < copies; i++)
+        {
+            for (size_t j = 0; j < len; j++)
+            {
+                // A record must fit in one line.
+                lines[lines_len++] = (json_string[j] == '\n') ? ' ' : json_string[j];
+            }
+            lines[lines_len++] = '\n';
+        }
+        JsonObj json_obj;
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Reference object created");
+        ASSERT_OK(JsonBatch_new(lines, lines_len, &json_batch, NULL, NULL), "Batch created");
+        bool all_equal = (json_batch.num_of_records == copies) && (json_batch.num_of_errors == 0);
+        for (size_t i = 0; all_equal && (i < copies); i++)
+        {
+            all_equal = _items_equal(json_obj.root.next_sibling, json_batch.records[i].item_p);
+        }
+        ASSERT(all_equal, "Every record equal to the reference object");
+        JsonBatch_destroy(&json_batch);
+        JsonObj_destroy(&json_obj);
+        free(lines);
+        free(json_string);
+
+        char ndjson_2[] = "{\"n\": 1}\n{\"n\": 2}\n[]\n{\"n\": 4}\n{\"n\": 5}\n";
+        json_int_t sums[2] = {0, 0};
+        ASSERT_OK(
+            JsonBatch_new(ndjson_2, strlen(ndjson_2), &json_batch, _sum_until_4, sums),
+            "Batch with handler created");
+        ASSERT(json_batch.records == NULL, "Records not stored");
+        ASSERT(json_batch.num_of_records == 4, "Handler stopped the batch");
+        ASSERT(json_batch.num_of_errors == 1, "Invalid record passed to the handler");
+        ASSERT_EQ(sums[0], 7, "Valid records passed to the handler");
+        ASSERT_EQ(sums[1], 1, "Invalid record reported to the handler");
+        JsonBatch_destroy(&json_batch);
+    }
+    PRINT_TEST_TITLE("Parallel parsing");
+    {
+        JsonObj json_obj;
+        JsonObj json_obj_parallel;
+        JsonArray* items_p;
+        JsonItem* item_p;
+        json_int_t value_int;
+        json_uint_t value_llu;
+        const char* value_str;
+        // Elements of one member, members of an object member and members of the root object.
+        const size_t shapes[3][3] = {{8000, false, 20}, {8000, true, 0}, {40, false, 8000}};
+        for (size_t i = 0; i < 3; i++)
+        {
+            char* json_string = _make_large_json(shapes[i][0], shapes[i][1], shapes[i][2]);
+            const size_t len  = strlen(json_string);
+            char* copy        = strdup(json_string);
+            ASSERT_OK(JsonObj_new_insitu(copy, len, &json_obj), "Reference object created");
+            for (size_t num_of_threads = 1; num_of_threads <= 8; num_of_threads *= 2)
+            {
+                strcpy(copy, json_string);
+                ASSERT_OK(
+                    JsonObj_new_parallel(copy, len, num_of_threads, &json_obj_parallel),
+                    "Parallel object created");
+                ASSERT(
+                    _items_equal(json_obj.root.next_sibling, json_obj_parallel.root.next_sibling),
+                    "Same tree as on one thread");
+                if (shapes[i][1])
+                {
+                    ASSERT_OK(Json_get(&json_obj_parallel, "items", &item_p), "Object found");
+                    ASSERT_OK(Json_get(item_p, "item_7999", &item_p), "Last member found");
+                    ASSERT_OK(Json_get(item_p, "id", &value_int), "Member correct");
+                    ASSERT_EQ(value_int, 7999, "Key table of a split object");
+                    JsonObj_destroy(&json_obj_parallel);
+                    continue;
+                }
+                ASSERT_OK(Json_get(&json_obj_parallel, "items", &items_p), "Array found");
+                bool indices_correct = true;
+                for (size_t j = 0; j < JsonArray_len(items_p); j++)
+                {
+                    item_p = items_p->elements[j];
+                    indices_correct &= (item_p->index == j)
+                                    && is_ok(Json_get(item_p->value.value_child_p, "id", &value_int))
+                                    && (value_int == (json_int_t)j);
+                }
+                ASSERT(JsonArray_len(items_p) == shapes[i][0], "Length of a split array");
+                ASSERT(indices_correct, "Elements of a split array");
+                ASSERT_OK(Json_get(items_p, 9, &item_p), "Element found");
+                ASSERT_OK(Json_get(item_p, "tag", &value_str), "String found");
+                ASSERT_EQ(value_str, "\"[9]\\", "Escapes decoded");
+                if (shapes[i][2] > 0)
+                {
+                    ASSERT_OK(
+                        Json_get(&json_obj_parallel, "member_19", &items_p),
+                        "Member after the split array found");
+                    ASSERT_OK(Json_get(items_p, 0, &value_llu), "Element found");
+                    ASSERT_EQ(value_llu, 19, "Root key table");
+                }
+                JsonObj_destroy(&json_obj_parallel);
+            }
+            JsonObj_destroy(&json_obj);
+
+            // An error anywhere fails the whole document.
+            strcpy(copy, json_string);
+            char* error_p = strchr(&copy[len / 2], ',');
+            error_p[1]    = ']';
+            ASSERT_ERR(JsonObj_new_parallel(copy, len, 4, &json_obj_parallel), "Bracket rejected");
+            strcpy(copy, json_string);
+            copy[len - 1] = ',';
+            ASSERT_ERR(JsonObj_new_parallel(copy, len, 4, &json_obj_parallel), "Open root rejected");
+            strcpy(copy, json_string);
+            // The closing quote of a key.
+            error_p    = strstr(&copy[len / 3], "\": ");
+            error_p[0] = ' ';
+            ASSERT_ERR(
+                JsonObj_new_parallel(copy, len, 4, &json_obj_parallel),
+                "Unterminated string rejected");
+            free(copy);
+            free(json_string);
+        }
+    }
+    PRINT_TEST_TITLE("Lazy documents");
+    {
+        JsonDoc json_doc;
+        JsonDocItem doc_item;
+        JsonDocArray doc_array;
+        JsonDocArray doc_array_2;
+        const char* value_str;
+        json_int_t value_int;
+        json_uint_t value_llu;
+        json_decimal_t value_double;
+        json_bool_t value_bool;
+        char* json_string = load_file_alloc("test/assets/test_json.json");
+        ASSERT_OK(JsonDoc_new(json_string, strlen(json_string), &json_doc), "Document indexed");
+        ASSERT_OK(Json_get(&json_doc, "text_key", &value_str), "First key found");
+        ASSERT_EQ(value_str, "text_value", "String correct");
+        ASSERT_OK(Json_get(&json_doc, "test_bool_false", &value_bool), "Last key found");
+        ASSERT_EQ(value_bool, false, "Bool correct");
+        ASSERT_OK(Json_get(&json_doc, "test_integer", &value_double), "Integer found");
+        ASSERT_EQ(value_double, 435234.0, "Same conversions as the tree");
+        ASSERT_OK(Json_get(&json_doc, "nested_2", &doc_item), "Object found");
+        ASSERT_OK(Json_get(&doc_item, "object_2.2", &doc_item), "Nested object found");
+        ASSERT_OK(Json_get(&doc_item, "item_2.2", &value_str), "Nested string found");
+        ASSERT_EQ(value_str, "value_2.2.1", "Nested string correct");
+        ASSERT_OK(Json_get(&json_doc, "text_sibling", &value_str), "Key after objects found");
+        ASSERT_EQ(value_str, "sibling_value", "Objects stepped over");
+        ASSERT_OK(Json_get(&json_doc, "test_array", &doc_array), "Array found");
+        ASSERT_EQ(JsonDocArray_len(&doc_array), 3, "Array length");
+        ASSERT_OK(Json_get(&doc_array, 2, &value_str), "Last element found");
+        ASSERT_EQ(value_str, "string_element", "Last element correct");
+        ASSERT_OK(Json_get(&doc_array, 0, &value_llu), "First element found after the last");
+        ASSERT_EQ(value_llu, 14352, "First element correct");
+        ASSERT_OK(Json_get(&doc_array, 1, &value_double), "Next element found");
+        ASSERT_EQ(value_double, 2.15, "Next element correct");
+        ASSERT(Json_get(&doc_array, 3, &value_str) == ERR_NULL, "Index out of boundaries");
+        ASSERT(Json_get(&doc_array, 0, &value_str) == ERR_TYPE_MISMATCH, "Strict element type");
+        ASSERT(Json_get(&json_doc, "missing", &value_int) == ERR_NULL, "Missing number");
+        ASSERT(Json_get(&json_doc, "missing", &value_str) == ERR_JSON_MISSING_ENTRY, "Missing key");
+        ASSERT(Json_get(&json_doc, "missing", &doc_item) == ERR_JSON_MISSING_ENTRY, "No object");
+        ASSERT(Json_get(&json_doc, "nested_1", &value_str) == ERR_TYPE_MISMATCH, "Not a string");
+        ASSERT(Json_get(&json_doc, "nested_1", &doc_array) == ERR_TYPE_MISMATCH, "Not an array");
+        ASSERT(Json_get(&json_doc, "text_key", &doc_item) == ERR_TYPE_MISMATCH, "Not an object");
+        ASSERT(Json_get(&json_doc, "text_", &value_str) == ERR_JSON_MISSING_ENTRY, "Key prefix");
+        JsonDoc_destroy(&json_doc);
+        free(json_string);
+
+        // Same values as the tree, read in order and out of order.
+        json_string = _make_large_json(1000, false, 50);
+        char* copy  = strdup(json_string);
+        JsonObj json_obj;
+        JsonArray* items_p;
+        JsonItem* item_p;
+        ASSERT_OK(JsonObj_new_insitu(copy, strlen(copy), &json_obj), "Reference object created");
+        ASSERT_OK(Json_get(&json_obj, "items", &items_p), "Reference array found");
+        ASSERT_OK(JsonDoc_new(json_string, strlen(json_string), &json_doc), "Large document indexed");
+        ASSERT_OK(Json_get(&json_doc, "items", &doc_array), "Large array found");
+        ASSERT_EQ(JsonDocArray_len(&doc_array), 1000, "Large array length");
+        bool values_correct = true;
+        for (size_t i = 0; i < 2000; i++)
+        {
+            const size_t j = (i < 1000) ? i : (i * 7919) % 1000;
+            const char* value_str_2;
+            values_correct &= is_ok(Json_get(&doc_array, j, &doc_item))
+                           && is_ok(Json_get(&doc_item, "tag", &value_str))
+                           && is_ok(Json_get(items_p, j, &item_p))
+                           && is_ok(Json_get(item_p, "tag", &value_str_2))
+                           && (strcmp(value_str, value_str_2) == 0)
+                           && is_ok(Json_get(&doc_item, "v", &doc_array_2))
+                           && is_ok(Json_get(&doc_array_2, 0, &value_double))
+                           && (value_double == (json_decimal_t)j + 0.5);
+        }
+        ASSERT(values_correct, "Elements correct");
+        ASSERT_OK(Json_get(&json_doc, "member_49", &doc_array), "Member after the array found");
+        ASSERT_OK(Json_get(&doc_array, 0, &value_llu), "Element of the last member found");
+        ASSERT_EQ(value_llu, 49, "Element of the last member correct");
+        JsonDoc_destroy(&json_doc);
+        JsonObj_destroy(&json_obj);
+        free(copy);
+        free(json_string);
+
+        // Only the values on the way are checked.
+        char invalid_json[] = "{\"a\": [1, ], \"b\": {\"c\": 1 2}, \"d\": tru, \"e\": 1}";
+        ASSERT_OK(JsonDoc_new(invalid_json, strlen(invalid_json), &json_doc), "Only indexed");
+        ASSERT_OK(Json_get(&json_doc, "e", &value_llu), "Matching subtrees stepped over");
+        ASSERT_ERR(Json_get(&json_doc, "d", &value_bool), "Invalid literal rejected");
+        ASSERT_OK(Json_get(&json_doc, "b", &doc_item), "Object found");
+        ASSERT_OK(Json_get(&doc_item, "c", &value_llu), "Value before the error found");
+        ASSERT(Json_get(&doc_item, "x", &value_llu) == ERR_JSON_INVALID, "Missing comma rejected");
+        JsonDoc_destroy(&json_doc);
+        char unbalanced_json[] = "{\"a\": [[1], \"b\": 2}";
+        ASSERT_OK(JsonDoc_new(unbalanced_json, strlen(unbalanced_json), &json_doc), "Indexed");
+        ASSERT(Json_get(&json_doc, "b", &value_llu) == ERR_JSON_INVALID, "Unbalanced rejected");
+        JsonDoc_destroy(&json_doc);
+        char crossed_json[] = "{\"a\": [1, {]], \"b\": 2}";
+        ASSERT_OK(JsonDoc_new(crossed_json, strlen(crossed_json), &json_doc), "Indexed");
+        ASSERT(Json_get(&json_doc, "b", &value_llu) == ERR_JSON_INVALID, "Crossed rejected");
+        JsonDoc_destroy(&json_doc);
+        // Deeper than the bits kept on the stack by _skip_value.
+        const size_t deep_depth = JSON_SKIP_STACK_WORDS * 64 * 3;
+        char* deep_json         = malloc(4 * deep_depth + 32);
+        size_t deep_len         = (size_t)sprintf(deep_json, "{\"a\": ");
+        for (size_t j = 0; j < deep_depth; j++)
+        {
+            deep_json[deep_len++] = (j % 3 == 0) ? '{' : '[';
+            if (j % 3 == 0)
+            {
+                deep_len += (size_t)sprintf(&deep_json[deep_len], "\"k\":");
+            }
+        }
+        for (size_t j = deep_depth; j > 0; j--)
+        {
+            deep_json[deep_len++] = ((j - 1) % 3 == 0) ? '}' : ']';
+        }
+        deep_len += (size_t)sprintf(&deep_json[deep_len], ", \"b\": 2}");
+        ASSERT_OK(JsonDoc_new(deep_json, deep_len, &json_doc), "Deep document indexed");
+        ASSERT_OK(Json_get(&json_doc, "b", &value_llu), "Deep subtree stepped over");
+        ASSERT_EQ(value_llu, 2, "Value after the deep subtree correct");
+        JsonDoc_destroy(&json_doc);
+        free(deep_json);
+        char array_json[] = "[1]";
+        ASSERT(JsonDoc_new(array_json, 3, &json_doc) == ERR_JSON_INVALID, "Root must be an object");
+        ASSERT(JsonDoc_new(array_json, 0, &json_doc) == ERR_EMPTY_STRING, "Empty document");
+    }
+    PRINT_TEST_TITLE("Compiled paths");
+    {
+        JsonPath path;
+        JsonObj json_obj;
+        JsonDoc json_doc;
+        JsonItem* item_p;
+        JsonArray* array_p;
+        JsonDocItem doc_item;
+        JsonDocArray doc_array;
+        const char* value_str;
+        const char* value_str_2;
+        json_uint_t value_llu;
+        json_decimal_t value_double;
+        char json_string[]
+            = "{\"a\": {\"b\": {\"c\": [0, 1, 2, {\"d\": \"found\"}, [[], [5.5]]]}}, \"e\": {}, \"f\": []}";
+        char* copy         = strdup(json_string);
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Object created");
+        ASSERT_OK(JsonDoc_new(copy, strlen(copy), &json_doc), "Document indexed");
+        ASSERT_OK(JsonPath_compile("a.b.c[3].d", &path), "Path compiled");
+        ASSERT_EQ(path.num_of_steps, 5, "Number of steps");
+        ASSERT_EQ(path.steps[2].key_len, 1, "Key length");
+        ASSERT(path.steps[3].key_p == NULL, "Index step");
+        ASSERT_EQ(path.steps[3].index, 3, "Index");
+        ASSERT_OK(JsonPath_eval(&json_obj, &path, &value_str), "Path evaluated on a tree");
+        ASSERT_OK(JsonPath_eval(&json_doc, &path, &value_str_2), "Path evaluated on a document");
+        ASSERT_EQ(value_str, "found", "Value correct");
+        ASSERT_EQ(value_str_2, "found", "Same value in a document");
+        ASSERT(JsonPath_eval(&json_obj, &path, &value_llu) == ERR_TYPE_MISMATCH, "Type checked");
+        JsonPath_destroy(&path);
+
+        ASSERT_OK(JsonPath_compile("a.b.c[4][1][0]", &path), "Nested indices compiled");
+        ASSERT_OK(JsonPath_eval(&json_obj, &path, &value_double), "Array of arrays");
+        ASSERT_EQ(value_double, 5.5, "Element of an array of arrays");
+        ASSERT_OK(JsonPath_eval(&json_doc, &path, &value_double), "Array of arrays in a document");
+        ASSERT_EQ(value_double, 5.5, "Same element in a document");
+        JsonPath_destroy(&path);
+
+        ASSERT_OK(JsonPath_compile("a.b.c[2]", &path), "Integer path compiled");
+        ASSERT_OK(JsonPath_eval(&json_obj, &path, &value_double), "Integer as double");
+        ASSERT_EQ(value_double, 2.0, "Same conversions as Json_get");
+        JsonPath_destroy(&path);
+
+        ASSERT_OK(JsonPath_compile("a.b", &path), "Object path compiled");
+        ASSERT_OK(JsonPath_eval(&json_obj, &path, &item_p), "Object reached");
+        ASSERT_OK(Json_get(item_p, "c", &array_p), "Json_get from the object reached");
+        ASSERT_EQ(JsonArray_len(array_p), 5, "Array under the object reached");
+        ASSERT_OK(JsonPath_eval(&json_doc, &path, &doc_item), "Object reached in a document");
+        ASSERT_OK(Json_get(&doc_item, "c", &doc_array), "Json_get from the document item");
+        ASSERT_EQ(JsonDocArray_len(&doc_array), 5, "Array under the document item");
+        JsonPath_destroy(&path);
+
+        ASSERT_OK(JsonPath_compile("c[3].d", &path), "Relative path compiled");
+        ASSERT_OK(JsonPath_eval(item_p, &path, &value_str), "Path evaluated from an item");
+        ASSERT_EQ(value_str, "found", "Value from an item");
+        JsonPath_destroy(&path);
+
+        const char* missing_paths[] = {"a.x", "e.x", "f[0]", "a.b.c[5]", "x"};
+        const Error missing_errors[] = {
+            ERR_JSON_MISSING_ENTRY,
+            ERR_JSON_MISSING_ENTRY,
+            ERR_NULL,
+            ERR_NULL,
+            ERR_JSON_MISSING_ENTRY,
+        };
+        for (size_t i = 0; i < 5; i++)
+        {
+            ASSERT_OK(JsonPath_compile(missing_paths[i], &path), "Path compiled");
+            ASSERT(JsonPath_eval(&json_obj, &path, &value_llu) == missing_errors[i], "Missing");
+            ASSERT(JsonPath_eval(&json_doc, &path, &value_llu) == missing_errors[i], "Missing");
+            JsonPath_destroy(&path);
+        }
+        ASSERT_OK(JsonPath_compile("a[0]", &path), "Index of an object compiled");
+        ASSERT(JsonPath_eval(&json_obj, &path, &value_llu) == ERR_TYPE_MISMATCH, "Not an array");
+        ASSERT(JsonPath_eval(&json_doc, &path, &value_llu) == ERR_TYPE_MISMATCH, "Not an array");
+        JsonPath_destroy(&path);
+
+        const char* invalid_paths[]
+            = {"a..b", ".a", "a.", "a[", "a[]", "a[x]", "a[1", "a[1]b", "a.[1]"};
+        for (size_t i = 0; i < 9; i++)
+        {
+            ASSERT(JsonPath_compile(invalid_paths[i], &path) == ERR_INVALID, "Invalid path");
+            ASSERT(path.steps == NULL, "Nothing to destroy");
+        }
+        ASSERT(JsonPath_compile("", &path) == ERR_EMPTY_STRING, "Empty path");
+        JsonDoc_destroy(&json_doc);
+        JsonObj_destroy(&json_obj);
+        free(copy);
+
+        // Large objects are searched through their key table with the hash of the compiled path.
+        char* large_json_string = _make_large_json(100, true, 100);
+        ASSERT_OK(JsonObj_new(large_json_string, &json_obj), "Large object created");
+        ASSERT_OK(JsonPath_compile("items.item_77.v[0]", &path), "Path compiled");
+        ASSERT_OK(JsonPath_eval(&json_obj, &path, &value_double), "Path through key tables");
+        ASSERT_EQ(value_double, 77.5, "Value through key tables");
+        JsonPath_destroy(&path);
+        ASSERT_OK(JsonPath_compile("member_99[0]", &path), "Path compiled");
+        ASSERT_OK(JsonPath_eval(&json_obj, &path, &value_llu), "Path through the root key table");
+        ASSERT_EQ(value_llu, 99, "Value through the root key table");
+        JsonPath_destroy(&path);
+        JsonObj_destroy(&json_obj);
+        free(large_json_string);
+
+        // A compiled path is shared by threads.
+        ASSERT_OK(JsonPath_compile("a.b[1].c", &path), "Shared path compiled");
+        pthread_t threads[4];
+        const JsonPath* paths[4][2];
+        for (size_t i = 0; i < 4; i++)
+        {
+            paths[i][1] = &path;
+            pthread_create(&threads[i], NULL, _eval_shared_path, paths[i]);
+        }
+        bool all_found = true;
+        for (size_t i = 0; i < 4; i++)
+        {
+            pthread_join(threads[i], NULL);
+            all_found &= (paths[i][0] == &path);
+        }
+        ASSERT(all_found, "Path evaluated by several threads");
+        JsonPath_destroy(&path);
+    }
+    PRINT_TEST_TITLE("Schema binding");
+    {
+        JsonDoc json_doc;
+        TestOrder order = {.note = "default"};
+        char json_string[]
+            = "{\"skipped\": {\"id\": 7, \"x\": [[{}], \"]}\"]}, \"customer\": {\"age\": 42, "
+              "\"name\": \"Ada\"}, \"lines\": [{\"sku\": \"A-1\", \"price\": 2}, {\"price\": 0.5, "
+              "\"sku\": \"B-2\", \"extra\": false}], \"id\": 12, \"tags\": [-1, 2], \"delta\": -3, "
+              "\"paid\": true, \"total\": 2.5, \"more\": [1, {\"a\": \"{\"}]}";
+        ASSERT_OK(JsonDoc_new(json_string, strlen(json_string), &json_doc), "Document indexed");
+        ASSERT_OK(JsonDoc_bind(&json_doc, &test_order_schema, &order), "Document bound");
+        ASSERT_EQ(order.id, 12, "Unsigned member, after skipping a nested `id`");
+        ASSERT_EQ(order.delta, -3, "Signed member");
+        ASSERT_EQ(order.total, 2.5, "Decimal member");
+        ASSERT(order.paid, "Boolean member");
+        ASSERT_EQ(order.note, "default", "Missing member untouched");
+        ASSERT_EQ(order.customer.name, "Ada", "String in a nested struct");
+        ASSERT_EQ(order.customer.age, 42, "Keys in a different order");
+        ASSERT_EQ(order.num_of_tags, 2, "Number of elements");
+        ASSERT_EQ(order.tags[0], -1, "Element of an array");
+        ASSERT_EQ(order.tags[1], 2, "Element of an array");
+        ASSERT_EQ(order.num_of_lines, 2, "Number of structs");
+        ASSERT_EQ(order.lines[0].sku, "A-1", "Member of a struct in an array");
+        ASSERT_EQ(order.lines[0].price, 2.0, "Integer converted to decimal");
+        ASSERT_EQ(order.lines[1].price, 0.5, "Member of a struct in an array");
+        ASSERT_EQ(order.lines[1].sku, "B-2", "Member of a struct in an array");
+        JsonDoc_destroy(&json_doc);
+
+        char empty_string[] = "{\"tags\": [], \"lines\": [], \"customer\": {}}";
+        ASSERT_OK(JsonDoc_new(empty_string, strlen(empty_string), &json_doc), "Document indexed");
+        ASSERT_OK(JsonDoc_bind(&json_doc, &test_order_schema, &order), "Empty containers bound");
+        ASSERT_EQ(order.num_of_tags, 0, "No elements");
+        ASSERT_EQ(order.num_of_lines, 0, "No structs");
+        ASSERT_EQ(order.customer.name, "Ada", "Empty object leaves the struct untouched");
+        JsonDoc_destroy(&json_doc);
+
+        char full_string[] = "{\"tags\": [1, 2, 3, 4, 5]}";
+        ASSERT_OK(JsonDoc_new(full_string, strlen(full_string), &json_doc), "Document indexed");
+        ASSERT_ERR(JsonDoc_bind(&json_doc, &test_order_schema, &order), "Too many elements");
+        JsonDoc_destroy(&json_doc);
+
+        char mismatch_string[] = "{\"customer\": [\"Ada\"]}";
+        ASSERT_OK(
+            JsonDoc_new(mismatch_string, strlen(mismatch_string), &json_doc), "Document indexed");
+        ASSERT(
+            JsonDoc_bind(&json_doc, &test_order_schema, &order) == ERR_TYPE_MISMATCH,
+            "Array bound to a struct");
+        JsonDoc_destroy(&json_doc);
+
+        char scalar_string[] = "{\"id\": \"12\"}";
+        ASSERT_OK(JsonDoc_new(scalar_string, strlen(scalar_string), &json_doc), "Document indexed");
+        ASSERT(
+            JsonDoc_bind(&json_doc, &test_order_schema, &order) == ERR_TYPE_MISMATCH,
+            "String bound to a number");
+        JsonDoc_destroy(&json_doc);
+
+        char broken_string[] = "{\"unknown\": [1, 2}";
+        ASSERT_OK(JsonDoc_new(broken_string, strlen(broken_string), &json_doc), "Document indexed");
+        ASSERT_ERR(JsonDoc_bind(&json_doc, &test_order_schema, &order), "Unbalanced brackets");
+        JsonDoc_destroy(&json_doc);
+        char crossed_string[] = "{\"unknown\": [1, {]], \"id\": 1}";
+        ASSERT_OK(JsonDoc_new(crossed_string, strlen(crossed_string), &json_doc), "Indexed");
+        ASSERT(
+            JsonDoc_bind(&json_doc, &test_order_schema, &order) == ERR_JSON_INVALID,
+            "Crossed brackets");
+        JsonDoc_destroy(&json_doc);
+    }
+    PRINT_TEST_TITLE("Tapes");
+    {
+        JsonTape json_tape;
+        JsonTapeItem tape_item;
+        JsonTapeArray tape_array;
+        JsonTapeArray inner_array;
+        JsonPath path;
+        const char* value_str;
+        json_int_t value_int;
+        json_uint_t value_llu;
+        json_decimal_t value_double;
+        json_bool_t value_bool;
+        char json_string[]
+            = "{\"name\": \"tape\", \"n\": -7, \"u\": 18446744073709551615, \"d\": 0.25, "
+              "\"t\": true, \"f\": false, \"e\": {}, \"a\": [], \"obj\": {\"x\": [1, "
+              "\"two\", [3.5], {\"y\": 4}], \"z\": 5}, \"name\": \"duplicate\"}";
+        ASSERT_OK(JsonTape_new(json_string, strlen(json_string), &json_tape), "Tape built");
+        ASSERT_EQ(json_tape.num_of_words, 46, "Number of words");
+        ASSERT_EQ(json_tape.words[0] >> 56, TAPE_OBJECT_START, "Root start word");
+        ASSERT_EQ(json_tape.words[0] & UINT32_MAX, 45, "Root start word holds its end");
+        ASSERT_EQ((json_tape.words[0] >> 32) & 0xFFFFFF, 10, "Root start word holds its count");
+        ASSERT_EQ(json_tape.words[45] & UINT32_MAX, 0, "Root end word holds its start");
+        ASSERT_OK(Json_get(&json_tape, "name", &value_str), "String");
+        ASSERT_EQ(value_str, "tape", "First occurrence of a key");
+        ASSERT_OK(Json_get(&json_tape, "n", &value_int), "Signed");
+        ASSERT_EQ(value_int, -7, "Signed value");
+        ASSERT_OK(Json_get(&json_tape, "u", &value_llu), "Unsigned");
+        ASSERT_EQ(value_llu, 18446744073709551615ULL, "Unsigned value");
+        ASSERT_OK(Json_get(&json_tape, "d", &value_double), "Decimal");
+        ASSERT_EQ(value_double, 0.25, "Decimal value");
+        ASSERT_OK(Json_get(&json_tape, "n", &value_double), "Signed converted to decimal");
+        ASSERT_EQ(value_double, -7.0, "Converted value");
+        ASSERT_OK(Json_get(&json_tape, "t", &value_bool), "Boolean");
+        ASSERT(value_bool, "True");
+        ASSERT_OK(Json_get(&json_tape, "f", &value_bool), "Boolean");
+        ASSERT(!value_bool, "False");
+        ASSERT(Json_get(&json_tape, "t", &value_str) == ERR_TYPE_MISMATCH, "Type checked");
+        ASSERT(Json_get(&json_tape, "none", &value_str) == ERR_JSON_MISSING_ENTRY, "Missing key");
+        ASSERT(Json_get(&json_tape, "none", &value_int) == ERR_NULL, "Missing number");
+        ASSERT_OK(Json_get(&json_tape, "e", &tape_item), "Empty object");
+        ASSERT(Json_get(&tape_item, "x", &value_int) == ERR_NULL, "Nothing in an empty object");
+        ASSERT_OK(Json_get(&json_tape, "a", &tape_array), "Empty array");
+        ASSERT_EQ(JsonTapeArray_len(&tape_array), 0, "No elements");
+        ASSERT(Json_get(&tape_array, 0, &value_int) == ERR_NULL, "Nothing in an empty array");
+        ASSERT_OK(Json_get(&json_tape, "obj", &tape_item), "Object");
+        ASSERT_OK(Json_get(&tape_item, "z", &value_llu), "Member after an array");
+        ASSERT_EQ(value_llu, 5, "Member after an array");
+        ASSERT_OK(Json_get(&tape_item, "x", &tape_array), "Array");
+        ASSERT_EQ(JsonTapeArray_len(&tape_array), 4, "Number of elements");
+        ASSERT_OK(Json_get(&tape_array, 1, &value_str), "String element");
+        ASSERT_EQ(value_str, "two", "String element");
+        ASSERT(Json_get(&tape_array, 0, &value_double) == ERR_TYPE_MISMATCH, "Strict elements");
+        ASSERT_OK(Json_get(&tape_array, 2, &inner_array), "Array of arrays");
+        ASSERT_OK(Json_get(&inner_array, 0, &value_double), "Element of an inner array");
+        ASSERT_EQ(value_double, 3.5, "Element of an inner array");
+        ASSERT_OK(Json_get(&tape_array, 3, &tape_item), "Object in an array");
+        ASSERT_OK(Json_get(&tape_item, "y", &value_llu), "Member of an object in an array");
+        ASSERT_EQ(value_llu, 4, "Member of an object in an array");
+        ASSERT(Json_get(&tape_array, 4, &value_llu) == ERR_NULL, "Out of boundaries");
+        ASSERT_OK(JsonPath_compile("obj.x[3].y", &path), "Path compiled");
+        ASSERT_OK(JsonPath_eval(&json_tape, &path, &value_llu), "Path evaluated on a tape");
+        ASSERT_EQ(value_llu, 4, "Value of the path");
+        JsonPath_destroy(&path);
+        JsonTape_destroy(&json_tape);
+        ASSERT(json_tape.words == NULL, "Tape destroyed");
+
+        const char* invalid_strings[] = {
+            "{\"a\": [1, 2}}",
+            "{\"a\" 1}",
+            "{\"a\": 1,}",
+            "{\"a\": 1} {}",
+            "{\"a\": {\"b\": 1}",
+            "{\"a\": tru}",
+            "[1]",
+        };
+        bool all_rejected = true;
+        for (size_t i = 0; i < sizeof(invalid_strings) / sizeof(invalid_strings[0]); i++)
+        {
+            char* copy = strdup(invalid_strings[i]);
+            all_rejected &= (JsonTape_new(copy, strlen(copy), &json_tape) == ERR_JSON_INVALID);
+            all_rejected &= (json_tape.words == NULL);
+            free(copy);
+        }
+        ASSERT(all_rejected, "Invalid documents rejected");
+
+        // The tape of a large document holds the same values as its tree, in half the memory.
+        char* large_json_string = _make_large_json(2000, false, 100);
+        const size_t len        = strlen(large_json_string);
+        char* copy              = strdup(large_json_string);
+        JsonObj json_obj;
+        JsonArray* array_p;
+        JsonItem* item_p;
+        ASSERT_OK(JsonObj_new_insitu(large_json_string, len, &json_obj), "Tree built");
+        ASSERT_OK(JsonTape_new(copy, len, &json_tape), "Tape built");
+        ASSERT_OK(Json_get(&json_obj, "items", &array_p), "Items of the tree");
+        ASSERT_OK(Json_get(&json_tape, "items", &tape_array), "Items of the tape");
+        ASSERT_EQ(JsonTapeArray_len(&tape_array), JsonArray_len(array_p), "Same number of items");
+        bool all_equal = true;
+        for (size_t i = 0; i < JsonArray_len(array_p); i++)
+        {
+            const char* tag_1 = NULL;
+            const char* tag_2 = NULL;
+            Json_get(array_p, i, &item_p);
+            Json_get(&tape_array, i, &tape_item);
+            all_equal &= is_ok(Json_get(item_p, "tag", &tag_1));
+            all_equal &= is_ok(Json_get(&tape_item, "tag", &tag_2));
+            all_equal &= (tag_1 != NULL) && (tag_2 != NULL) && (strcmp(tag_1, tag_2) == 0);
+        }
+        ASSERT(all_equal, "Same values");
+        ASSERT_OK(Json_get(&json_tape, "member_99", &tape_array), "Last member of the tape");
+        ASSERT_OK(Json_get(&tape_array, 0, &value_llu), "Element of the last member");
+        ASSERT_EQ(value_llu, 99, "Element of the last member");
+        ASSERT(
+            2 * json_tape.num_of_words * sizeof(uint64_t) <= _JsonObj_used_bytes(&json_obj),
+            "Tape at most half the size of the tree");
+        JsonTape_destroy(&json_tape);
+        JsonObj_destroy(&json_obj);
+        free(copy);
+        free(large_json_string);
+    }
+    PRINT_TEST_TITLE("Stress - 10M-element array");
+    {
+        const size_t num_of_elements = 10000000;
+        size_t len                   = 0;
+        char* json_string            = _make_wide_array(num_of_elements, &len);
+        JsonObj json_obj;
+        JsonArray* array_p;
+        json_uint_t value_llu = 0;
+        ASSERT_OK(JsonObj_new_insitu(json_string, len, &json_obj), "Array parsed");
+        ASSERT_OK(Json_get(&json_obj, "a", &array_p), "Array found");
+        ASSERT_EQ(JsonArray_len(array_p), num_of_elements, "All elements");
+        ASSERT_OK(Json_get(array_p, num_of_elements - 1, &value_llu), "Last element");
+        ASSERT_EQ(value_llu, 9, "Last element");
+        ASSERT(
+            Json_get(array_p->elements[0], "a", &value_llu) == ERR_NULL,
+            "Key requested from an element");
+        JsonObj_destroy(&json_obj);
+        ASSERT(json_obj.root.next_sibling == NULL, "Array destroyed");
+        free(json_string);
+    }
+    PRINT_TEST_TITLE("Stress - 1M-key object");
+    {
+        size_t len        = 0;
+        char* json_string = _make_wide_object(1000000, &len);
+        JsonObj json_obj;
+        json_uint_t value_llu = 0;
+        ASSERT_OK(JsonObj_new_insitu(json_string, len, &json_obj), "Object parsed");
+        ASSERT_OK(Json_get(&json_obj, "k999999", &value_llu), "Last key through the key table");
+        ASSERT_EQ(value_llu, 999999, "Last key through the key table");
+        // Starting from the second member skips the key table and walks every sibling.
+        JsonItem* second_p = json_obj.root.next_sibling->next_sibling;
+        ASSERT_OK(Json_get(second_p, "k999999", &value_llu), "Last key by walking siblings");
+        ASSERT_EQ(value_llu, 999999, "Last key by walking the siblings");
+        ASSERT(
+            Json_get(second_p, "k1000000", &value_llu) == ERR_NULL, "Missing key after a walk");
+        JsonObj_destroy(&json_obj);
+        free(json_string);
+    }
+    PRINT_TEST_TITLE("Error context");
     {
         JsonObj json_obj;
-        JsonItem* json_item;
-        JsonArray* json_array;
-        const char* json_char_p = " {\"object\": {\"array\": [ {\"array key\": 56}]}}";
-        ASSERT_OK(JsonObj_new(json_char_p, &json_obj), "Json object created");
-        ASSERT_OK(Json_get(&json_obj, "object", &json_item), "Object retrieved");
-        ASSERT_OK(Json_get(json_item, "array", &json_array), "Array retrieved");
+        JsonDoc json_doc;
+        JsonTape json_tape;
+        JsonItem* item_p;
+        JsonArray* array_p;
+        JsonPath path;
+        JsonError error;
+        JsonError call_error;
+        const char* value_str;
+        json_int_t value_int;
+        json_uint_t value_llu;
+        const char* json_string
+            = "{\"name\": \"ctx\", \"n\": 42, \"neg\": -1, \"obj\": {\"x\": true}, \"a\": [1, 2]}";
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Document parsed");
+        ASSERT(json_obj.error_p == NULL, "No context attached by default");
+        json_obj.error_p = &error;
+        ASSERT(Json_get(&json_obj, "none", &value_str) == ERR_JSON_MISSING_ENTRY, "Missing key");
+        ASSERT(error.code == ERR_JSON_MISSING_ENTRY, "Missing key recorded");
+        ASSERT_EQ(error.key_p, "none", "Key recorded");
+        ASSERT_EQ(error.note, "key not found", "Note recorded");
+        ASSERT(error.found == VALUE_INVALID, "Nothing found");
+        ASSERT_EQ(error.offset, JSON_NO_OFFSET, "No offset for a missing key");
+        ASSERT(Json_get(&json_obj, "name", &value_int) == ERR_TYPE_MISMATCH, "Type mismatch");
+        ASSERT(error.code == ERR_TYPE_MISMATCH, "Type mismatch recorded");
+        ASSERT(error.requested == VALUE_INT, "Requested type recorded");
+        ASSERT(error.found == VALUE_STR, "Found type recorded");
+        ASSERT_EQ(error.offset, strstr(json_string, "ctx") - json_string, "Offset of the string");
+        ASSERT_OK(Json_get(&json_obj, "n", &value_int), "Unsigned read as signed");
+        ASSERT(error.code == ERR_ALL_GOOD, "Conversion is not an error");
+        ASSERT_EQ(error.note, "uint to int", "Conversion recorded");
+        ASSERT_EQ(error.offset, strstr(json_string, "n\"") - json_string, "Offset of the key");
+        ASSERT(Json_get(&json_obj, "neg", &value_llu) == ERR_INVALID, "Negative as unsigned");
+        ASSERT_EQ(error.note, "negative int", "Failed conversion recorded");
+        ASSERT_OK(Json_get(&json_obj, "obj", &item_p), "Nested object");
+        ASSERT(Json_get(item_p, "x", &value_str) == ERR_TYPE_MISMATCH, "Mismatch in nested object");
+        ASSERT_EQ(error.key_p, "x", "Nested item reaches the context of its document");
+        ASSERT_OK(Json_get(&json_obj, "a", &array_p), "Array");
+        ASSERT(Json_get(array_p, 5, &value_llu) == ERR_NULL, "Index out of bounds");
+        ASSERT_EQ(error.index, 5, "Index recorded");
+        ASSERT_EQ(error.note, "index out of bounds", "Out of bounds recorded");
+        ASSERT_OK(JsonPath_compile("obj.y", &path), "Path compiled");
+        ASSERT(JsonPath_eval(&json_obj, &path, &value_llu) == ERR_JSON_MISSING_ENTRY, "Path miss");
+        ASSERT_EQ(error.key_p, "y", "Failed step recorded");
+        ASSERT(error.requested == VALUE_LLU, "Requested type of a path recorded");
+        json_obj.error_p = NULL;
+        error.code       = ERR_FATAL;
+        ASSERT(Json_get_err(&json_obj, "none", &value_str, &call_error) == ERR_JSON_MISSING_ENTRY,
+               "Missing key with a context per call");
+        ASSERT(call_error.code == ERR_JSON_MISSING_ENTRY, "Recorded in the context of the call");
+        ASSERT(error.code == ERR_FATAL, "Detached context untouched");
+        ASSERT(Json_get(&json_obj, "none", &value_str) == ERR_JSON_MISSING_ENTRY, "No context");
+        ASSERT(JsonPath_eval_err(&json_obj, &path, &value_llu, &call_error) != ERR_ALL_GOOD,
+               "Path miss with a context per call");
+        ASSERT_EQ(call_error.key_p, "y", "Failed step recorded per call");
+        JsonObj_destroy(&json_obj);
+
+        char doc_string[] = "{\"a\": [1, \"two\"], \"b\": {\"c\": 3}}";
+        // Taken before the keys are terminated in place.
+        const ptrdiff_t offset_of_two = strstr(doc_string, "\"two") - doc_string;
+        JsonDocArray doc_array;
+        ASSERT_OK(JsonDoc_new(doc_string, strlen(doc_string), &json_doc), "Document indexed");
+        json_doc.json_obj.error_p = &error;
+        ASSERT_OK(Json_get(&json_doc, "a", &doc_array), "Array of a document");
+        ASSERT(Json_get(&doc_array, 1, &value_int) == ERR_TYPE_MISMATCH, "Mismatch in a document");
+        ASSERT(error.found == VALUE_STR, "Found type in a document");
+        ASSERT_EQ(error.offset, offset_of_two, "Offset in a document");
+        JsonPath_destroy(&path);
+        ASSERT_OK(JsonPath_compile("a.c", &path), "Path compiled");
+        ASSERT(JsonPath_eval(&json_doc, &path, &value_llu) == ERR_TYPE_MISMATCH, "Path step");
+        ASSERT_EQ(error.key_p, "c", "Path step recorded in a document");
+        ASSERT(error.requested == VALUE_ITEM, "Type needed by the step");
+        ASSERT(error.found == VALUE_ARRAY, "Type found by the step");
+        JsonDoc_destroy(&json_doc);
+
+        char tape_string[]       = "{\"a\": 1, \"s\": \"str\"}";
+        const size_t str_offset = strstr(tape_string, "str") - tape_string;
+        ASSERT_OK(JsonTape_new(tape_string, strlen(tape_string), &json_tape), "Tape built");
+        json_tape.error_p = &error;
+        ASSERT(Json_get(&json_tape, "s", &value_int) == ERR_TYPE_MISMATCH, "Mismatch in a tape");
+        ASSERT_EQ(error.offset, str_offset, "Offset in a tape");
+        ASSERT(Json_get(&json_tape, "b", &value_int) == ERR_NULL, "Missing key in a tape");
+        ASSERT_EQ(error.key_p, "b", "Missing key recorded in a tape");
+        JsonTape_destroy(&json_tape);
+        JsonPath_destroy(&path);
+    }
+    PRINT_TEST_TITLE("Document statistics");
+    {
+        JsonObj json_obj;
+        JsonObj json_obj_parallel;
+        JsonStats stats;
+        JsonStats parallel_stats;
+        JsonGlobalStats heap_before;
+        JsonGlobalStats heap_after;
+        const char* json_string
+            = "{\"a\": 1, \"b\": [true, 2.5, \"s\", -3], "
+              "\"c\": {\"d\": {\"e\": 18446744073709551615}}, \"f\": {}}";
+        JsonStats_global(&heap_before);
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Object created");
+        ASSERT_OK(JsonObj_stats(&json_obj, &stats), "Statistics filled");
+        ASSERT_EQ(stats.num_of_nodes, 10, "Nodes counted");
+        ASSERT_EQ(stats.nodes_by_type[VALUE_INT], 1, "Negative integers counted");
+        ASSERT_EQ(stats.nodes_by_type[VALUE_LLU], 2, "Positive integers counted");
+        ASSERT_EQ(stats.nodes_by_type[VALUE_DOUBLE], 1, "Decimals counted");
+        ASSERT_EQ(stats.nodes_by_type[VALUE_BOOL], 1, "Booleans counted");
+        ASSERT_EQ(stats.nodes_by_type[VALUE_STR], 1, "Strings counted");
+        ASSERT_EQ(stats.nodes_by_type[VALUE_ARRAY], 1, "Arrays counted");
+        ASSERT_EQ(stats.nodes_by_type[VALUE_ITEM], 2, "Objects counted");
+        ASSERT_EQ(stats.nodes_by_type[VALUE_UNDEFINED], 1, "Empty objects counted");
+        ASSERT_EQ(stats.max_depth, 3, "Depth of the innermost member");
+        ASSERT_EQ(stats.string_bytes, strlen(json_string) + 1, "Copy of the string");
+        ASSERT(stats.node_bytes >= 10 * sizeof(JsonItem), "Nodes in the arena");
+        ASSERT(stats.arena_bytes >= stats.node_bytes, "Arena holds the nodes");
+        ASSERT(stats.transient_bytes > 0, "Structural index kept");
+        ASSERT_EQ(stats.peak_transient_bytes, stats.transient_bytes, "Nothing freed while parsing");
+        ASSERT_EQ(
+            stats.total_bytes,
+            stats.string_bytes + stats.arena_bytes + stats.transient_bytes,
+            "Total of the document");
+        JsonObj_destroy(&json_obj);
+        ASSERT_OK(JsonObj_new("{}", &json_obj), "Empty object created");
+        ASSERT_OK(JsonObj_stats(&json_obj, &stats), "Statistics of an empty object");
+        ASSERT_EQ(stats.num_of_nodes, 0, "No nodes in an empty object");
+        ASSERT_EQ(stats.max_depth, 0, "No depth in an empty object");
+        JsonObj_reset(&json_obj);
+        ASSERT_OK(JsonObj_stats(&json_obj, &stats), "Statistics of a reset object");
+        ASSERT_EQ(stats.num_of_nodes, 0, "No nodes after a reset");
+        ASSERT_EQ(stats.node_bytes, 0, "Arena unused after a reset");
+        ASSERT(stats.arena_bytes > 0, "Arena kept after a reset");
+        JsonObj_destroy(&json_obj);
+        JsonStats_global(&heap_after);
+        ASSERT(heap_after.num_of_allocs > heap_before.num_of_allocs, "Allocations counted");
+        ASSERT(heap_after.allocated_bytes > heap_before.allocated_bytes, "Bytes counted");
+        ASSERT_EQ(
+            heap_after.num_of_allocs - heap_before.num_of_allocs,
+            heap_after.num_of_frees - heap_before.num_of_frees,
+            "Every allocation freed");
+        ASSERT(JsonObj_stats(NULL, &stats) == ERR_NULL, "Null object rejected");
+
+        char* large_string = _make_large_json(8000, false, 20);
+        const size_t len   = strlen(large_string);
+        char* copy         = strdup(large_string);
+        ASSERT_OK(JsonObj_new_insitu(copy, len, &json_obj), "Reference object created");
+        ASSERT_OK(JsonObj_stats(&json_obj, &stats), "Statistics of an object in situ");
+        ASSERT_EQ(stats.string_bytes, 0, "Borrowed string not counted");
+        char* parallel_copy = strdup(large_string);
+        ASSERT_OK(
+            JsonObj_new_parallel(parallel_copy, len, 4, &json_obj_parallel),
+            "Parallel object created");
+        ASSERT_OK(JsonObj_stats(&json_obj_parallel, &parallel_stats), "Statistics filled");
+        ASSERT_EQ(parallel_stats.num_of_nodes, stats.num_of_nodes, "Same nodes on 4 threads");
+        ASSERT_EQ(parallel_stats.max_depth, stats.max_depth, "Same depth on 4 threads");
+        ASSERT(
+            parallel_stats.peak_transient_bytes > parallel_stats.transient_bytes,
+            "Worker buffers counted");
+        JsonObj_destroy(&json_obj_parallel);
+        JsonObj_destroy(&json_obj);
+        free(parallel_copy);
+        free(copy);
+        free(large_string);
+    }
+    PRINT_TEST_TITLE("Strings with their length");
+    {
+        JsonObj json_obj;
+        JsonDoc json_doc;
+        JsonTape json_tape;
+        JsonPath path;
+        JsonStr value_str;
+        JsonArray* array_p;
+        json_uint_t value_llu;
+        const char* json_string
+            = "{\"greeting\": \"hello world\", \"long_key_of_many_bytes\": 1, "
+              "\"long_key_of_many_bytes_a\": 2, \"long_key_of_many_bytez\": 3, \"empty\": \"\", "
+              "\"list\": [\"ab\", \"cde\"], \"nested\": {\"name\": \"inner\"}}";
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Object created");
+        ASSERT_OK(Json_get(&json_obj, "greeting", &value_str), "String found");
+        ASSERT_EQ(value_str.ptr, "hello world", "String content");
+        ASSERT_EQ(value_str.len, 11, "String length");
+        ASSERT_OK(Json_get(&json_obj, "empty", &value_str), "Empty string found");
+        ASSERT_EQ(value_str.len, 0, "Empty string length");
+        ASSERT_OK(Json_get(&json_obj, "long_key_of_many_bytes", &value_llu), "Long key found");
+        ASSERT_EQ(value_llu, 1, "Longer keys of the same prefix skipped");
+        ASSERT_OK(Json_get(&json_obj, "long_key_of_many_bytes_a", &value_llu), "Longer key found");
+        ASSERT_EQ(value_llu, 2, "Key of a different length");
+        ASSERT_OK(Json_get(&json_obj, "long_key_of_many_bytez", &value_llu), "Last byte differs");
+        ASSERT_EQ(value_llu, 3, "Key differing in its last byte");
+        ASSERT(
+            Json_get(&json_obj, "long_key", &value_str) == ERR_JSON_MISSING_ENTRY,
+            "Prefix of a key not found");
+        ASSERT(value_str.ptr == NULL && value_str.len == 0, "Missing string cleared");
+        ASSERT(
+            Json_get(&json_obj, "long_key_of_many_bytes", &value_str) == ERR_TYPE_MISMATCH,
+            "Number is not a string");
+        ASSERT_OK(Json_get(&json_obj, "list", &array_p), "Array found");
+        ASSERT_OK(Json_get(array_p, 1, &value_str), "Element found");
+        ASSERT_EQ(value_str.len, 3, "Element length");
+        ASSERT_OK(JsonPath_compile("nested.name", &path), "Path compiled");
+        ASSERT_OK(JsonPath_eval(&json_obj, &path, &value_str), "Path evaluated");
+        ASSERT_EQ(value_str.len, 5, "String length through a path");
+        JsonObj_destroy(&json_obj);
+
+        char* buf = strdup(json_string);
+        ASSERT_OK(JsonDoc_new(buf, strlen(buf), &json_doc), "Document indexed");
+        ASSERT_OK(Json_get(&json_doc, "greeting", &value_str), "String found in a document");
+        ASSERT_EQ(value_str.len, 11, "String length in a document");
+        ASSERT_OK(JsonPath_eval(&json_doc, &path, &value_str), "Path evaluated in a document");
+        ASSERT_EQ(value_str.ptr, "inner", "String content through a path in a document");
+        JsonDoc_destroy(&json_doc);
+        strcpy(buf, json_string);
+        ASSERT_OK(JsonTape_new(buf, strlen(buf), &json_tape), "Tape built");
+        ASSERT_OK(Json_get(&json_tape, "greeting", &value_str), "String found in a tape");
+        ASSERT_EQ(value_str.len, 11, "String length in a tape");
+        ASSERT_OK(JsonPath_eval(&json_tape, &path, &value_str), "Path evaluated in a tape");
+        ASSERT_EQ(value_str.len, 5, "String length through a path in a tape");
+        JsonTape_destroy(&json_tape);
+        free(buf);
+        JsonPath_destroy(&path);
+
+        // Object large enough for a key table.
+        char large_string[1024];
+        size_t len = (size_t)sprintf(large_string, "{");
+        for (size_t i = 0; i < 2 * JSON_KEY_TABLE_MIN_ITEMS; i++)
+        {
+            len += (size_t)sprintf(
+                &large_string[len], "%s\"member_number_%lu\": \"%lu\"", (i > 0) ? ", " : "", i, i);
+        }
+        sprintf(&large_string[len], "}");
+        ASSERT_OK(JsonObj_new(large_string, &json_obj), "Large object created");
+        ASSERT_OK(Json_get(&json_obj, "member_number_17", &value_str), "Key found in a table");
+        ASSERT_EQ(value_str.ptr, "17", "Value found in a table");
+        ASSERT_EQ(value_str.len, 2, "Length found in a table");
+        ASSERT(
+            Json_get(&json_obj, "member_number_1", &value_str) == ERR_ALL_GOOD
+                && (value_str.len == 1),
+            "Shorter key found in a table");
+        ASSERT(
+            Json_get(&json_obj, "member_number_", &value_str) == ERR_JSON_MISSING_ENTRY,
+            "Prefix not found in a table");
+        JsonObj_destroy(&json_obj);
+    }
+    PRINT_TEST_TITLE("Escapes and UTF-8");
+    {
+        JsonObj json_obj;
+        JsonDoc json_doc;
+        JsonTape json_tape;
+        JsonParser json_parser;
+        JsonStr value_str;
+        JsonUtf8Fn kernels[3] = {_validate_utf8_scalar, NULL, NULL};
+#if defined(__x86_64__)
+        if (__builtin_cpu_supports("sse4.2"))
+        {
+            kernels[1] = _validate_utf8_sse42;
+        }
+        if (__builtin_cpu_supports("avx2"))
+        {
+            kernels[2] = _validate_utf8_avx2;
+        }
+#endif /* __x86_64__ */
+        const struct
+        {
+            const char* bytes;
+            bool is_valid;
+        } utf8_cases[] = {
+            {"plain ASCII", true},
+            {"caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80", true},
+            {"\xEF\xBF\xBF\xF4\x8F\xBF\xBF", true}, // U+FFFF and U+10FFFF
+            {"\xC3\x28", false},                     // Missing continuation
+            {"\xA9", false},                         // Lone continuation
+            {"\xC0\x80", false},                     // Overlong 2-byte
+            {"\xE0\x80\xAF", false},                 // Overlong 3-byte
+            {"\xF0\x80\x80\xAF", false},             // Overlong 4-byte
+            {"\xED\xA0\x80", false},                 // Surrogate
+            {"\xF4\x90\x80\x80", false},             // Past U+10FFFF
+            {"\xF8\x88\x80\x80\x80", false},         // 5-byte sequence
+            {"\xE2\x82", false},                     // Truncated
+        };
+        bool all_correct = true;
+        for (size_t i = 0; i < sizeof(utf8_cases) / sizeof(utf8_cases[0]); i++)
+        {
+            // Each case at the end of a 16-byte and of a 32-byte block, and straddling both.
+            char block[96];
+            for (size_t shift = 0; shift < 40; shift++)
+            {
+                const size_t len = strlen(utf8_cases[i].bytes);
+                memset(block, 'x', shift);
+                memcpy(&block[shift], utf8_cases[i].bytes, len);
+                for (size_t k = 0; k < 3; k++)
+                {
+                    all_correct &= (kernels[k] == NULL)
+                                || (kernels[k](block, shift + len) == utf8_cases[i].is_valid);
+                }
+            }
+        }
+        ASSERT(all_correct, "UTF-8 cases checked by every kernel at every offset");
+        // Random mixes of valid sequences and stray bytes.
+        uint64_t seed       = 0x9E3779B97F4A7C15ULL;
+        bool kernels_agree  = true;
+        size_t num_of_valid = 0;
+        for (size_t i = 0; i < 20000; i++)
+        {
+            char bytes[80];
+            size_t len = 0;
+            while (len < 72)
+            {
+                seed ^= seed << 13;
+                seed ^= seed >> 7;
+                seed ^= seed << 17;
+                static const char* sequences[]
+                    = {"a", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xED\x9F\xBF"};
+                const char* sequence_p = sequences[seed % 5];
+                memcpy(&bytes[len], sequence_p, strlen(sequence_p));
+                len += strlen(sequence_p);
+                if ((seed >> 8) % 64 == 0)
+                {
+                    bytes[(seed >> 16) % len] = (char)(seed >> 24);
+                }
+            }
+            const bool is_valid = _validate_utf8_scalar(bytes, len);
+            num_of_valid += is_valid;
+            for (size_t k = 1; k < 3; k++)
+            {
+                kernels_agree &= (kernels[k] == NULL) || (kernels[k](bytes, len) == is_valid);
+            }
+        }
+        ASSERT(kernels_agree, "SIMD kernels agree with the scalar one");
+        ASSERT(num_of_valid > 1000 && num_of_valid < 19000, "Valid and invalid inputs generated");
+
+        const char* json_string
+            = "{\"esc\": \"a\\nb\\t\\\"\\\\\\/\\b\\f\\r\", "
+              "\"uni\": \"\\u00e9\\u20AC\\uD83D\\ude00\", "
+              "\"nul\": \"x\\u0000y\", \"k\\u00e9y\": \"caf\xC3\xA9\"}";
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Escaped strings parsed");
+        ASSERT_OK(Json_get(&json_obj, "esc", &value_str), "String found");
+        ASSERT_EQ(value_str.ptr, "a\nb\t\"\\/\b\f\r", "Short escapes decoded");
+        ASSERT_EQ(value_str.len, 10, "Decoded length");
+        ASSERT_OK(Json_get(&json_obj, "uni", &value_str), "String found");
+        ASSERT_EQ(value_str.ptr, "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80", "\\u escapes decoded");
+        ASSERT_OK(Json_get(&json_obj, "nul", &value_str), "String found");
+        ASSERT(value_str.len == 3 && memcmp(value_str.ptr, "x\0y", 4) == 0, "Null character kept");
+        ASSERT_OK(Json_get(&json_obj, "k\xC3\xA9y", &value_str), "Escaped key found");
+        ASSERT_EQ(value_str.ptr, "caf\xC3\xA9", "Raw UTF-8 kept");
+        JsonObj_destroy(&json_obj);
+
+        // Runs longer than a block between escapes.
+        char long_string[2048];
+        char expected[2048];
+        size_t len          = (size_t)sprintf(long_string, "{\"s\": \"");
+        size_t expected_len = 0;
+        for (size_t i = 0; i < 1500; i++)
+        {
+            if (i % 41 == 40)
+            {
+                len += (size_t)sprintf(&long_string[len], "\\u00%02lX", 0x20 + i % 64);
+                expected[expected_len++] = (char)(0x20 + i % 64);
+            }
+            else
+            {
+                long_string[len++]       = (char)('a' + i % 26);
+                expected[expected_len++] = (char)('a' + i % 26);
+            }
+        }
+        sprintf(&long_string[len], "\"}");
+        expected[expected_len] = '\0';
+        ASSERT_OK(JsonObj_new(long_string, &json_obj), "Long escaped string parsed");
+        ASSERT_OK(Json_get(&json_obj, "s", &value_str), "String found");
+        ASSERT(value_str.len == expected_len, "Long decoded length");
+        ASSERT_EQ(value_str.ptr, expected, "Long string decoded");
+        JsonObj_destroy(&json_obj);
+
+        const char* invalid_strings[] = {
+            "{\"a\": \"\\x\"}",
+            "{\"a\": \"\\u12\"}",
+            "{\"a\": \"\\u12G4\"}",
+            "{\"a\": \"\\uD83D\"}",
+            "{\"a\": \"\\uDE00\\uD83D\"}",
+            "{\"a\": \"\\uD83D\\u0041\"}",
+            "{\"a\": \"\xC3\x28\"}",
+            "{\"\xED\xA0\x80\": 1}",
+            "{\"a\": \"\xE2\x82\"}",
+        };
+        bool all_rejected = true;
+        for (size_t i = 0; i < sizeof(invalid_strings) / sizeof(invalid_strings[0]); i++)
+        {
+            all_rejected &= (JsonObj_new(invalid_strings[i], &json_obj) == ERR_JSON_INVALID);
+        }
+        ASSERT(all_rejected, "Invalid escapes and UTF-8 rejected");
+
+        char* buf = strdup(json_string);
+        ASSERT_OK(JsonDoc_new(buf, strlen(buf), &json_doc), "Document indexed");
+        for (size_t i = 0; i < 2; i++)
+        {
+            ASSERT_OK(Json_get(&json_doc, "k\xC3\xA9y", &value_str), "Escaped key in a document");
+            ASSERT_OK(Json_get(&json_doc, "nul", &value_str), "String found in a document");
+            ASSERT(
+                value_str.len == 3 && memcmp(value_str.ptr, "x\0y", 4) == 0,
+                "Decoded once however many times it is read");
+        }
+        JsonDoc_destroy(&json_doc);
+        strcpy(buf, json_string);
+        ASSERT_OK(JsonTape_new(buf, strlen(buf), &json_tape), "Tape built");
+        ASSERT_OK(Json_get(&json_tape, "k\xC3\xA9y", &value_str), "Escaped key in a tape");
+        ASSERT_OK(Json_get(&json_tape, "esc", &value_str), "String found in a tape");
+        ASSERT(value_str.len == 10 && value_str.ptr[1] == '\n', "Decoded in a tape");
+        JsonTape_destroy(&json_tape);
+        free(buf);
+        char invalid_tape[] = "{\"a\": \"\\q\"}";
+        ASSERT_ERR(
+            JsonTape_new(invalid_tape, strlen(invalid_tape), &json_tape), "Rejected by a tape");
+
+        ASSERT_OK(JsonParser_new(&json_parser, &json_obj), "Parser created");
+        ASSERT_OK(JsonParser_feed(&json_parser, "{\"s\": \"\\uD8", 11), "Escape split");
+        ASSERT_OK(JsonParser_feed(&json_parser, "3D\\ude00\\n\"}", 12), "Escape completed");
+        ASSERT_OK(JsonParser_finish(&json_parser), "Document complete");
+        ASSERT_OK(Json_get(&json_obj, "s", &value_str), "Streamed string found");
+        ASSERT_EQ(value_str.ptr, "\xF0\x9F\x98\x80\n", "Streamed string decoded");
+        JsonObj_destroy(&json_obj);
+        ASSERT_OK(JsonParser_new(&json_parser, &json_obj), "Parser created");
+        ASSERT_ERR(JsonParser_feed(&json_parser, "{\"s\": \"\\uDE00\"}", 15), "Streamed surrogate");
+    }
+    PRINT_TEST_TITLE("Events");
+    {
+        const char* json_string = "{\"a\": -1, \"b\": [true, 2.5, \"x\\u00e9\"], \"c\": {},"
+                                  " \"d\": [], \"e\": {\"f\": 18446744073709551615}}";
+        EventLog event_log = {0};
+        ASSERT_OK(
+            Json_parse_events(json_string, strlen(json_string), &_log_handler, &event_log),
+            "Events reported");
+        ASSERT_EQ(
+            event_log.text,
+            "{ k:a i:-1 k:b [ b:1 d:2.5 s:x\xC3\xA9 ] k:c { } k:d [ ] k:e { k:f "
+            "u:18446744073709551615 } }",
+            "Events in document order");
+        event_log = (EventLog){.stop_after = 3};
+        ASSERT_OK(
+            Json_parse_events(json_string, strlen(json_string), &_log_handler, &event_log),
+            "Stopped by a callback");
+        ASSERT(event_log.num_of_events == 3, "No event after the stop");
+        ASSERT_EQ(event_log.text, "{ k:a i:-1", "Events up to the stop");
+
+        const char* root_array = "[1, [2], {\"a\": \"b\"}, []]";
+        event_log              = (EventLog){0};
+        ASSERT_OK(
+            Json_parse_events(root_array, strlen(root_array), &_log_handler, &event_log),
+            "Root array accepted");
+        ASSERT_EQ(event_log.text, "[ u:1 [ u:2 ] { k:a s:b } [ ] ]", "Root array events");
+        event_log = (EventLog){0};
+        ASSERT_OK(Json_parse_events(" {} ", 4, &_log_handler, &event_log), "Empty root object");
+        ASSERT_EQ(event_log.text, "{ }", "Empty root object events");
+
+        // Only the callbacks set are called. Integers are signed only when negative.
+        const JsonHandler int_handler = {.on_int = _log_int};
+        event_log                     = (EventLog){0};
+        ASSERT_OK(
+            Json_parse_events(json_string, strlen(json_string), &int_handler, &event_log),
+            "Partial handler");
+        ASSERT_EQ(event_log.text, "i:-1", "Other events skipped");
+
+        const char* invalid_strings[] = {
+            "{\"a\" 1}",
+            "{\"a\": 1,}",
+            "{\"a\": [1}",
+            "{\"a\": 1] ",
+            "{} 1",
+            "{\"a\": 1 \"b\": 2}",
+            "1",
+            "\"a\"",
+            "{\"a\": \"b",
+            "{\"a\": tru}",
+            "{\"a\": 1",
+            "   ",
+            "{\"a\": \"\\q\"}",
+            "{\"a\": 1x}",
+        };
+        bool all_rejected = true;
+        for (size_t i = 0; i < sizeof(invalid_strings) / sizeof(invalid_strings[0]); i++)
+        {
+            all_rejected &= (Json_parse_events(
+                                 invalid_strings[i],
+                                 strlen(invalid_strings[i]),
+                                 &_log_handler,
+                                 &event_log)
+                             == ERR_JSON_INVALID);
+        }
+        ASSERT(all_rejected, "Invalid documents rejected");
+        ASSERT(
+            Json_parse_events(json_string, 0, &_log_handler, NULL) == ERR_EMPTY_STRING,
+            "Empty buffer rejected");
+        ASSERT(
+            Json_parse_events(json_string, strlen(json_string), NULL, NULL) == ERR_NULL,
+            "Missing handler rejected");
+
+        // Tokens across many index windows, and a string longer than a window.
+        const size_t num_of_items = 20000;
+        const size_t long_len     = 3 * JSON_EVENTS_WINDOW_SIZE + 17;
+        char* large_string        = malloc(num_of_items * 80 + long_len + 64);
+        size_t len                = (size_t)sprintf(large_string, "{\"items\": [");
+        size_t str_bytes          = strlen("items");
+        json_int_t int_sum        = 0;
+        for (size_t i = 0; i < num_of_items; i++)
+        {
+            // Names of varying length move the tokens across the window boundaries.
+            const int name_len = (int)(i % 23);
+            len += (size_t)sprintf(
+                &large_string[len],
+                "%s{\"id\": %lu, \"name\": \"%.*s\", \"v\": %lu.5, \"ok\": %s}",
+                (i == 0) ? "" : ", ",
+                i,
+                name_len,
+                "abcdefghijklmnopqrstuvwxyz",
+                i,
+                (i % 2 == 0) ? "true" : "false");
+            str_bytes += strlen("id") + strlen("name") + (size_t)name_len + strlen("v")
+                         + strlen("ok");
+            int_sum += (json_int_t)i;
+        }
+        len += (size_t)sprintf(&large_string[len], "], \"long\": \"");
+        memset(&large_string[len], 'x', long_len);
+        len += long_len;
+        len += (size_t)sprintf(&large_string[len], "\", \"tail\": 7}");
+        str_bytes += strlen("long") + long_len + strlen("tail");
+        int_sum += 7;
+        char* large_copy = strdup(large_string);
+        event_log        = (EventLog){0};
+        ASSERT_OK(
+            Json_parse_events(large_string, len, &_log_handler, &event_log),
+            "Document spanning many windows");
+        ASSERT(event_log.num_of_events == 4 + num_of_items * 10 + 5, "Every event reported");
+        ASSERT(event_log.int_sum == int_sum, "Every integer reported");
+        ASSERT(event_log.str_bytes == str_bytes, "Every string reported");
+        ASSERT_EQ(large_string, large_copy, "Buffer not modified");
+        large_string[len - 1] = ']';
+        ASSERT_ERR(
+            Json_parse_events(large_string, len, &_log_handler, &event_log),
+            "Mismatched bracket after many windows");
+        free(large_copy);
+        free(large_string);
+
+        char* file_string = load_file_alloc("test/assets/test_json.json");
+        EventLog file_log = {0};
+        event_log         = (EventLog){0};
+        ASSERT_OK(
+            Json_parse_events(file_string, strlen(file_string), &_log_handler, &event_log),
+            "Events of a buffer");
+        ASSERT_OK(
+            Json_parse_events_file("test/assets/test_json.json", &_log_handler, &file_log),
+            "Events of a file");
+        ASSERT(file_log.num_of_events == event_log.num_of_events, "Same number of events");
+        ASSERT_EQ(file_log.text, event_log.text, "Same events");
+        ASSERT(
+            Json_parse_events_file("test/assets/missing.json", &_log_handler, &file_log)
+                == ERR_INVALID,
+            "Missing file rejected");
+        free(file_string);
+    }
+    PRINT_TEST_TITLE("Projections");
+    {
+        JsonProjection projection;
+        JsonObj json_obj;
+        JsonObj full_obj;
+        JsonPath path;
+        JsonItem* item_p;
+        JsonArray* array_p;
+        JsonStats stats;
+        JsonStats full_stats;
+        json_uint_t value_llu;
+        json_bool_t value_bool;
+        const char* value_str;
+        const char* json_string = "{\"id\": 7, \"name\": \"x\","
+                                  " \"meta\": {\"a\": 1, \"b\": [1, 2, 3], \"c\": {\"d\": true}},"
+                                  " \"items\": [{\"k\": 1, \"v\": \"a\"},"
+                                  " {\"k\": 2, \"v\": \"b\", \"w\": {\"x\": 1, \"y\": 2}},"
+                                  " 5, [1, 2], {}], \"big\": [[1], {\"a\": [2]}]}";
+        const char* paths[] = {"id", "meta.c", "items[*].k", "items[1].w.x"};
+        ASSERT_OK(JsonProjection_compile(paths, 4, &projection), "Projection compiled");
+        ASSERT_OK(JsonObj_new_projected(json_string, &projection, &json_obj), "Object projected");
+        ASSERT_OK(Json_get(&json_obj, "id", &value_llu), "Projected key found");
+        ASSERT_EQ(value_llu, 7, "Value correct");
+        ASSERT(Json_get(&json_obj, "big", &array_p) == ERR_JSON_MISSING_ENTRY, "Array dropped");
+        ASSERT_OK(Json_get(&json_obj, "meta", &item_p), "Projected object found");
+        ASSERT_ERR(Json_get(item_p, "a", &value_llu), "Nested key dropped");
+        ASSERT_OK(Json_get(item_p, "c", &item_p), "Object kept whole");
+        ASSERT_OK(Json_get(item_p, "d", &value_bool), "Value of an object kept whole");
+        ASSERT(value_bool, "Value correct");
+        ASSERT_OK(Json_get(&json_obj, "items", &array_p), "Projected array found");
+        ASSERT_EQ(JsonArray_len(array_p), 5, "Every element kept");
+        ASSERT_OK(JsonPath_compile("items[1].k", &path), "Path compiled");
+        ASSERT_OK(JsonPath_eval(&json_obj, &path, &value_llu), "Key selected by `[*]`");
+        ASSERT_EQ(value_llu, 2, "Value correct");
+        JsonPath_destroy(&path);
+        ASSERT_OK(JsonPath_compile("items[1].w.x", &path), "Path compiled");
+        ASSERT_OK(JsonPath_eval(&json_obj, &path, &value_llu), "Key selected by an index");
+        ASSERT_EQ(value_llu, 1, "Value correct");
+        JsonPath_destroy(&path);
+        ASSERT_OK(JsonPath_compile("items[1].w.y", &path), "Path compiled");
+        ASSERT(
+            JsonPath_eval(&json_obj, &path, &value_llu) == ERR_JSON_MISSING_ENTRY,
+            "Key outside the projection dropped");
+        JsonPath_destroy(&path);
+        ASSERT_OK(JsonPath_compile("items[0].v", &path), "Path compiled");
+        ASSERT(
+            JsonPath_eval(&json_obj, &path, &value_str) == ERR_JSON_MISSING_ENTRY,
+            "Member of an element dropped");
+        JsonPath_destroy(&path);
+        // A scalar and an array have no key `k`.
+        ASSERT(
+            array_p->elements[2]->value.value_type == VALUE_UNDEFINED, "Scalar element left out");
+        ASSERT(array_p->elements[3]->value.value_type == VALUE_UNDEFINED, "Array element left out");
+        // name, meta.a, meta.b, items[0].v, items[1].v, items[1].w.y, items[2], items[3] and big
+        ASSERT_EQ(json_obj.num_of_dropped_values, 9, "Dropped values counted");
+        ASSERT_OK(JsonObj_stats(&json_obj, &stats), "Stats read");
+        ASSERT_EQ(stats.num_of_dropped_values, 9, "Dropped values in the stats");
+        const size_t min_dropped_bytes
+            = strlen("\"big\": [[1], {\"a\": [2]}]") + strlen("\"name\": \"x\"");
+        ASSERT(
+            (stats.dropped_bytes > min_dropped_bytes)
+                && (stats.dropped_bytes < strlen(json_string)),
+            "Dropped bytes in the stats");
+        ASSERT_OK(JsonObj_new(json_string, &full_obj), "Full object created");
+        ASSERT_OK(JsonObj_stats(&full_obj, &full_stats), "Stats read");
+        ASSERT_EQ(full_stats.num_of_dropped_values, 0, "Nothing dropped without a projection");
+        ASSERT(stats.num_of_nodes < full_stats.num_of_nodes, "Fewer nodes built");
+        JsonObj_destroy(&full_obj);
+        JsonObj_reset(&json_obj);
+        ASSERT_OK(
+            JsonObj_new_projected(json_string, NULL, &json_obj), "Nothing dropped without paths");
+        ASSERT_EQ(json_obj.num_of_dropped_values, 0, "Counter reset");
+        ASSERT_OK(Json_get(&json_obj, "name", &value_str), "Key kept");
+        JsonObj_destroy(&json_obj);
+        JsonProjection_destroy(&projection);
+
+        // Projecting every member builds the same tree.
+        char* file_string = load_file_alloc("test/assets/test_json.json");
+        ASSERT_OK(JsonObj_new(file_string, &full_obj), "Full object created");
+        const char* keys[64];
+        size_t num_of_keys = 0;
+        for (const JsonItem* member_p = full_obj.root.next_sibling;
+             (member_p != NULL) && (num_of_keys < 64);
+             member_p = member_p->next_sibling)
+        {
+            keys[num_of_keys++] = member_p->key_p;
+        }
+        ASSERT_OK(JsonProjection_compile(keys, num_of_keys, &projection), "Projection compiled");
+        ASSERT_OK(JsonObj_new_projected(file_string, &projection, &json_obj), "Object projected");
+        ASSERT(
+            _items_equal(full_obj.root.next_sibling, json_obj.root.next_sibling),
+            "Same tree as without a projection");
+        ASSERT_EQ(json_obj.num_of_dropped_values, 0, "Nothing dropped");
+        JsonObj_destroy(&json_obj);
+        JsonProjection_destroy(&projection);
+        JsonObj_destroy(&full_obj);
+        free(file_string);
+
+        const char* vec_paths[] = {"Data[*].Close"};
+        json_decimal_t value_double;
+        file_string = load_file_alloc("test/assets/test_json_vec_of_obj.json");
+        ASSERT_OK(JsonProjection_compile(vec_paths, 1, &projection), "Projection compiled");
+        ASSERT_OK(JsonObj_new_projected(file_string, &projection, &json_obj), "Object projected");
+        ASSERT_OK(Json_get(&json_obj, "Data", &array_p), "Array found");
+        ASSERT_OK(Json_get(array_p, 1, &item_p), "Element found");
+        ASSERT_OK(Json_get(item_p, "Close", &value_double), "Member of an element found");
+        ASSERT_EQ(value_double, 223.2, "Value correct");
+        JsonObj_destroy(&json_obj);
+        JsonProjection_destroy(&projection);
+        free(file_string);
+
+        const char* escaped_paths[] = {"ab"};
+        ASSERT_OK(JsonProjection_compile(escaped_paths, 1, &projection), "Projection compiled");
+        ASSERT_OK(
+            JsonObj_new_projected("{\"a\\u0062\": 1, \"c\": 2}", &projection, &json_obj),
+            "Object projected");
+        ASSERT_OK(Json_get(&json_obj, "ab", &value_llu), "Escaped key matched");
+        ASSERT_EQ(json_obj.num_of_dropped_values, 1, "Other key dropped");
+        JsonObj_destroy(&json_obj);
+        const char* invalid_strings[] = {
+            "{\"a\": 1 \"ab\": 2}",
+            "{\"c\": {\"d\": [}, \"ab\": 1}",
+            "{\"c\": [1, 2}",
+            "{\"c\" 1}",
+            "{\"c\": 1,}",
+            "{\"ab\": 1} 2",
+            "{\"ab\": [1}",
+            "{\"z\": [1, {]], \"ab\": 1}",
+            "[1]",
+        };
+        bool all_rejected = true;
+        for (size_t i = 0; i < sizeof(invalid_strings) / sizeof(invalid_strings[0]); i++)
+        {
+            all_rejected
+                &= (JsonObj_new_projected(invalid_strings[i], &projection, &json_obj)
+                    == ERR_JSON_INVALID);
+        }
+        ASSERT(all_rejected, "Invalid documents rejected");
+        JsonProjection_destroy(&projection);
+
+        // `[*]` is merged into the other indices of the same array.
+        const char* nested_paths[] = {"m[*][0]", "m[1]"};
+        ASSERT_OK(JsonProjection_compile(nested_paths, 2, &projection), "Projection compiled");
+        ASSERT_OK(
+            JsonObj_new_projected(
+                "{\"m\": [[1, [2]], [3, [4]], [5, [6]]]}", &projection, &json_obj),
+            "Object projected");
+        ASSERT_OK(Json_get(&json_obj, "m", &array_p), "Array found");
+        const JsonArray* row_0_p = array_p->elements[0]->value.value_array_p;
+        const JsonArray* row_1_p = array_p->elements[1]->value.value_array_p;
+        ASSERT(
+            row_0_p->elements[1]->value.value_type == VALUE_UNDEFINED,
+            "Element outside the projection left out");
+        ASSERT_EQ(
+            JsonArray_len(row_1_p->elements[1]->value.value_array_p),
+            1,
+            "Element inside a value kept whole");
+        ASSERT_EQ(json_obj.num_of_dropped_values, 2, "Elements left out counted");
+        JsonObj_destroy(&json_obj);
+        JsonProjection_destroy(&projection);
+
+        // Elements keep their indices, but those left out are neither decoded nor converted.
+        const char* index_paths[] = {"arr[0]"};
+        ASSERT_OK(JsonProjection_compile(index_paths, 1, &projection), "Projection compiled");
+        ASSERT_OK(
+            JsonObj_new_projected(
+                "{\"arr\": [1, 2, \"x\", {\"q\": 1}, [5]]}", &projection, &json_obj),
+            "Object projected");
+        ASSERT_OK(Json_get(&json_obj, "arr", &array_p), "Array found");
+        ASSERT_EQ(JsonArray_len(array_p), 5, "Every element has its index");
+        ASSERT_OK(Json_get(array_p, 0, &value_llu), "Selected element found");
+        ASSERT_EQ(value_llu, 1, "Value correct");
+        bool all_left_out = true;
+        for (size_t i = 1; i < 5; i++)
+        {
+            all_left_out &= (array_p->elements[i]->value.value_type == VALUE_UNDEFINED);
+        }
+        ASSERT(all_left_out, "Other elements left out");
+        ASSERT_EQ(json_obj.num_of_dropped_values, 4, "Scalars and strings counted");
+        ASSERT_OK(JsonObj_stats(&json_obj, &stats), "Stats read");
+        ASSERT_EQ(stats.num_of_nodes, 6, "One node per element, none below");
+        JsonObj_destroy(&json_obj);
+        JsonProjection_destroy(&projection);
+
+        // A value that the paths cannot go into is left out, rather than emptied.
+        const char* key_paths[] = {"a.b", "c[0]", "d.e", "f"};
+        ASSERT_OK(JsonProjection_compile(key_paths, 4, &projection), "Projection compiled");
+        ASSERT_OK(
+            JsonObj_new_projected(
+                "{\"a\": [{\"b\": 1}], \"c\": {\"x\": 1}, \"d\": 2, \"f\": 3}",
+                &projection,
+                &json_obj),
+            "Object projected");
+        ASSERT(
+            Json_get(&json_obj, "a", &array_p) == ERR_JSON_MISSING_ENTRY,
+            "Array under a key path left out");
+        ASSERT(
+            Json_get(&json_obj, "c", &item_p) == ERR_JSON_MISSING_ENTRY,
+            "Object under an index path left out");
+        ASSERT_ERR(Json_get(&json_obj, "d", &value_llu), "Scalar under a key path left out");
+        ASSERT_OK(Json_get(&json_obj, "f", &value_llu), "Member named by a path kept");
+        ASSERT_EQ(json_obj.num_of_dropped_values, 3, "Members left out counted");
+        JsonObj_destroy(&json_obj);
+        JsonProjection_destroy(&projection);
+
+        const char* invalid_paths[] = {"a[*", "a..b", "a[x]", "a[*1]"};
+        all_rejected = true;
+        for (size_t i = 0; i < sizeof(invalid_paths) / sizeof(invalid_paths[0]); i++)
+        {
+            all_rejected &= is_err(JsonProjection_compile(&invalid_paths[i], 1, &projection));
+        }
+        ASSERT(all_rejected, "Invalid paths rejected");
+        ASSERT(
+            JsonProjection_compile(invalid_paths, 0, &projection) == ERR_EMPTY_STRING,
+            "Empty projection rejected");
+        ASSERT_ERR(JsonPath_compile("a[*]", &path), "`[*]` only in a projection");
+    }
+    PRINT_TEST_TITLE("Columns");
+    {
+        JsonObj json_obj;
+        JsonArray* array_p;
+        JsonError error;
+        json_decimal_t closes[2];
+        uint64_t present[JSON_BITMAP_WORDS(130)];
+        size_t num_of_present;
+        char* file_string = load_file_alloc("test/assets/test_json_vec_of_obj.json");
+        ASSERT_OK(JsonObj_new(file_string, &json_obj), "File parsed");
+        ASSERT_OK(Json_get(&json_obj, "Data", &array_p), "Array found");
+        ASSERT_OK(
+            Json_extract_column(array_p, "Close", VALUE_DOUBLE, closes, present, &num_of_present),
+            "Column extracted");
+        ASSERT_EQ(num_of_present, 2, "Every element has the member");
+        ASSERT_EQ(present[0], 3, "Bitmap set");
+        ASSERT_EQ(closes[0], 222.9, "First value correct");
+        ASSERT_EQ(closes[1], 223.2, "Second value correct");
+        JsonObj_destroy(&json_obj);
+        free(file_string);
+
+        const char* json_string = "{\"rows\": ["
+                                  "{\"id\": 1, \"price\": 1.5, \"name\": \"a\", \"ok\": true},"
+                                  " {\"name\": \"b\", \"id\": 2, \"price\": 2},"
+                                  " {},"
+                                  " {\"id\": 4, \"price\": -3, \"ok\": false, \"id\": 5},"
+                                  " {\"other\": [1], \"name\": \"e\\u0021\"}]}";
+        json_uint_t ids[5];
+        json_decimal_t prices[5];
+        JsonStr names[5];
+        json_bool_t oks[5];
+        uint64_t bitmaps[4];
+        JsonColumn columns[] = {
+            {"id", VALUE_LLU, ids, &bitmaps[0], 0},
+            {"price", VALUE_DOUBLE, prices, &bitmaps[1], 0},
+            {"name", VALUE_STR, names, &bitmaps[2], 0},
+            {"ok", VALUE_BOOL, oks, &bitmaps[3], 0},
+        };
+        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Document parsed");
+        ASSERT_OK(Json_get(&json_obj, "rows", &array_p), "Array found");
+        ASSERT_OK(Json_extract_columns(array_p, columns, 4), "Columns extracted");
+        ASSERT_EQ(bitmaps[0], 0x0b, "Ids present");
+        ASSERT_EQ(columns[0].num_of_present, 3, "Ids counted");
+        ASSERT_EQ(ids[1], 2, "Keys in another order found");
+        ASSERT_EQ(ids[2], 0, "Missing value zeroed");
+        ASSERT_EQ(ids[3], 4, "First occurrence of a repeated key kept");
+        ASSERT_EQ(bitmaps[1], 0x0b, "Prices present");
+        ASSERT_EQ(prices[1], 2.0, "Integer converted to double");
+        ASSERT_EQ(prices[3], -3.0, "Negative integer converted to double");
+        ASSERT_EQ(bitmaps[2], 0x13, "Names present");
+        ASSERT_EQ(names[4].ptr, "e!", "Escaped string decoded");
+        ASSERT_EQ(names[4].len, 2, "Length of the string");
+        ASSERT(names[2].ptr == NULL, "Missing string is NULL");
+        ASSERT_EQ(bitmaps[3], 0x09, "Booleans present");
+        ASSERT(oks[0] && !oks[3], "Booleans correct");
+
+        json_int_t values_int[5];
+        json_uint_t values_llu[5];
+        error.note       = NULL;
+        json_obj.error_p = &error;
+        ASSERT_OK(
+            Json_extract_column(array_p, "name", VALUE_INT, values_int, present, &num_of_present),
+            "Members of another type do not abort");
+        ASSERT_EQ(num_of_present, 0, "Members of another type missing");
+        ASSERT_EQ(present[0], 0, "Bitmap clear");
+        ASSERT_EQ(values_int[4], 0, "Value zeroed");
+        ASSERT_OK(
+            Json_extract_column(array_p, "price", VALUE_LLU, values_llu, present, &num_of_present),
+            "Column extracted");
+        ASSERT_EQ(present[0], 0x02, "Only the integer that converts present");
+        ASSERT_EQ(values_llu[1], 2, "Value converted");
+        ASSERT_EQ(values_llu[0], 0, "Decimal zeroed");
+        ASSERT_EQ(values_llu[3], 0, "Negative integer zeroed");
+        ASSERT(error.note == NULL, "Nothing recorded");
+        ASSERT(
+            Json_extract_column(array_p, "id", VALUE_ITEM, values_int, present, NULL)
+                == ERR_INVALID,
+            "Not a scalar type");
+        ASSERT(
+            Json_extract_columns(array_p, (JsonColumn[]){columns[0], columns[0]}, 2)
+                == ERR_INVALID,
+            "Column requested twice");
+        ASSERT(
+            Json_extract_column(array_p, "id", VALUE_INT, NULL, present, NULL) == ERR_NULL,
+            "No buffer");
+        ASSERT(
+            Json_extract_column(NULL, "id", VALUE_INT, values_int, present, NULL) == ERR_NULL,
+            "No array");
+        JsonObj_destroy(&json_obj);
+
+        ASSERT_OK(JsonObj_new("{\"a\": [{\"x\": 1}, 2]}", &json_obj), "Document parsed");
+        json_obj.error_p = &error;
+        ASSERT_OK(Json_get(&json_obj, "a", &array_p), "Array found");
+        ASSERT_OK(
+            Json_extract_column(array_p, "x", VALUE_INT, values_int, present, &num_of_present),
+            "Element not an object passed over");
+        ASSERT_EQ(present[0], 0x01, "Element not an object missing");
+        ASSERT_EQ(values_int[0], 1, "Value correct");
+        ASSERT_EQ(values_int[1], 0, "Value zeroed");
+        JsonObj_destroy(&json_obj);
+
+        // 130 rows span three words of the bitmap; every third row misses `v`, and the objects
+        // of 20 members have a key table.
+        char* rows_string = malloc(130 * 256);
+        size_t len        = (size_t)sprintf(rows_string, "{\"rows\": [");
+        for (size_t i = 0; i < 130; i++)
+        {
+            len += (size_t)sprintf(&rows_string[len], "%s{", (i > 0) ? ", " : "");
+            for (size_t k = 0; k < 19; k++)
+            {
+                len += (size_t)sprintf(&rows_string[len], "\"k%lu\": %lu, ", k, k);
+            }
+            len += (size_t)sprintf(&rows_string[len], "\"%s\": %lu}", (i % 3) ? "v" : "w", i);
+        }
+        sprintf(&rows_string[len], "]}");
+        json_int_t rows[130];
+        json_uint_t last_keys[130];
+        ASSERT_OK(JsonObj_new(rows_string, &json_obj), "Document parsed");
+        ASSERT_OK(Json_get(&json_obj, "rows", &array_p), "Array found");
+        ASSERT(array_p->elements[0]->value.value_child_p->key_table_p != NULL, "Key table built");
+        ASSERT_OK(
+            Json_extract_column(array_p, "v", VALUE_INT, rows, present, &num_of_present),
+            "Column extracted");
+        ASSERT_EQ(num_of_present, 86, "Rows counted");
+        bool all_correct = (present[2] >> 2) == 0;
+        for (size_t i = 0; i < 130; i++)
+        {
+            const bool is_present = (present[i / 64] >> (i % 64)) & 1;
+            const json_int_t expected = is_present ? (json_int_t)i : 0;
+            all_correct &= (is_present == ((i % 3) != 0)) && (rows[i] == expected);
+        }
+        ASSERT(all_correct, "Values and bitmap correct");
+        JsonColumn wide_columns[] = {
+            {"k18", VALUE_LLU, last_keys, present, 0},
+            {"w", VALUE_INT, rows, bitmaps, 0},
+        };
+        ASSERT_OK(Json_extract_columns(array_p, wide_columns, 2), "Columns extracted");
+        ASSERT_EQ(wide_columns[0].num_of_present, 130, "Every row has the first column");
+        ASSERT_EQ(last_keys[129], 18, "Value correct");
+        ASSERT_EQ(wide_columns[1].num_of_present, 44, "Rows of the second column counted");
+        ASSERT_EQ(rows[129], 129, "Value correct");
+        JsonObj_destroy(&json_obj);
+
+        // 70 columns take two passes over the array.
+        len = (size_t)sprintf(rows_string, "{\"a\": [{");
+        for (size_t k = 0; k < 70; k++)
+        {
+            len += (size_t)sprintf(&rows_string[len], "%s\"k%lu\": %lu", (k > 0) ? ", " : "", k, k);
+        }
+        sprintf(&rows_string[len], "}, {\"k69\": 1}]}");
+        char many_keys[70][4];
+        json_uint_t many_values[70][2];
+        uint64_t many_bitmaps[70];
+        JsonColumn many_columns[70];
+        for (size_t k = 0; k < 70; k++)
+        {
+            sprintf(many_keys[k], "k%lu", k);
+            many_columns[k]
+                = (JsonColumn){many_keys[k], VALUE_LLU, many_values[k], &many_bitmaps[k], 0};
+        }
+        ASSERT_OK(JsonObj_new(rows_string, &json_obj), "Document parsed");
+        ASSERT_OK(Json_get(&json_obj, "a", &array_p), "Array found");
+        ASSERT_OK(Json_extract_columns(array_p, many_columns, 70), "Columns extracted");
+        ASSERT_EQ(many_values[66][0], 66, "Column of the second pass filled");
+        ASSERT_EQ(many_bitmaps[66], 0x01, "Column of the second pass present");
+        ASSERT_EQ(many_bitmaps[69], 0x03, "Last column present");
+        ASSERT_EQ(many_values[69][1], 1, "Last column filled");
+        JsonObj_destroy(&json_obj);
+        free(rows_string);
+    }
+    /**/
+}
+#endif /* TEST */
+
+#ifdef BENCH
+static double _bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Best time out of three runs of JsonObj_new_parallel on a fresh copy of `json_string`.
+static double _bench_parse(const char* json_string, char* copy, size_t len, size_t num_of_threads)
+{
+    double best_time = 0;
+    for (size_t run = 0; run < 3; run++)
+    {
+        memcpy(copy, json_string, len);
+        JsonObj json_obj;
+        const double start_time = _bench_now();
+        if (is_err(JsonObj_new_parallel(copy, len, num_of_threads, &json_obj)))
+        {
+            LOG_ERROR("Benchmark document rejected");
+            return 0;
+        }
+        const double elapsed_time = _bench_now() - start_time;
         JsonObj_destroy(&json_obj);
+        best_time = ((run == 0) || (elapsed_time < best_time)) ? elapsed_time : best_time;
+    }
+    return best_time;
+}
+
+// Parse generated documents of about 60 MB with 1 to N threads, N being the number of online CPUs
+// or JSON_BENCH_THREADS.
+void bench_parallel_scaling(void)
+{
+    long max_threads         = sysconf(_SC_NPROCESSORS_ONLN);
+    const char* threads_env = getenv("JSON_BENCH_THREADS");
+    if (threads_env != NULL)
+    {
+        max_threads = strtol(threads_env, NULL, 10);
+    }
+    max_threads = (max_threads < 1) ? 1 : max_threads;
+    // Elements of one member, members of an object member and members of the root object.
+    const size_t shapes[3][3]   = {{800000, false, 0}, {800000, true, 0}, {2000, false, 2000000}};
+    const char* shape_names[3] = {"array member", "object member", "root members"};
+    printf("%-14s %8s %10s %10s %8s\n", "shape", "threads", "ms", "MB/s", "speedup");
+    for (size_t i = 0; i < 3; i++)
+    {
+        char* json_string = _make_large_json(shapes[i][0], shapes[i][1], shapes[i][2]);
+        const size_t len  = strlen(json_string);
+        char* copy        = malloc(len);
+        double base_time  = 0;
+        for (long num_of_threads = 1; num_of_threads <= max_threads;
+             num_of_threads      = (num_of_threads * 2 > max_threads && num_of_threads < max_threads)
+                                     ? max_threads
+                                     : num_of_threads * 2)
+        {
+            const double elapsed_time = _bench_parse(json_string, copy, len, (size_t)num_of_threads);
+            base_time                 = (num_of_threads == 1) ? elapsed_time : base_time;
+            printf(
+                "%-14s %8ld %10.1f %10.1f %8.2f\n",
+                shape_names[i],
+                num_of_threads,
+                elapsed_time * 1e3,
+                (double)len / 1e6 / elapsed_time,
+                base_time / elapsed_time);
+        }
+        free(copy);
+        free(json_string);
+    }
+}
+
+// Read 5 fields of a document of 500 members, through the tree and through a JsonDoc.
+void bench_lazy_access(void)
+{
+    const size_t num_of_members = 500;
+    const size_t num_of_runs    = 20000;
+    char* json_string           = malloc(128 * num_of_members);
+    size_t len                  = (size_t)sprintf(json_string, "{");
+    for (size_t i = 0; i < num_of_members; i++)
+    {
+        len += (size_t)sprintf(
+            &json_string[len],
+            "%s\"field_%lu\": {\"id\": %lu, \"name\": \"name_%lu\", \"score\": %lu.25}",
+            (i > 0) ? ", " : "",
+            i,
+            i,
+            i,
+            i);
+    }
+    len += (size_t)sprintf(&json_string[len], "}");
+    const char* keys[5] = {"field_3", "field_97", "field_201", "field_350", "field_499"};
+    char* copy          = malloc(len);
+    printf("%-14s %12s %10s\n", "mode", "ns/doc", "speedup");
+    double base_time = 0;
+    for (size_t lazy = 0; lazy < 2; lazy++)
+    {
+        json_decimal_t sum      = 0;
+        const double start_time = _bench_now();
+        for (size_t run = 0; run < num_of_runs; run++)
+        {
+            memcpy(copy, json_string, len);
+            json_decimal_t value_double = 0;
+            if (lazy)
+            {
+                JsonDoc json_doc;
+                JsonDocItem doc_item;
+                JsonDoc_new(copy, len, &json_doc);
+                for (size_t i = 0; i < 5; i++)
+                {
+                    Json_get(&json_doc, keys[i], &doc_item);
+                    Json_get(&doc_item, "score", &value_double);
+                    sum += value_double;
+                }
+                JsonDoc_destroy(&json_doc);
+            }
+            else
+            {
+                JsonObj json_obj;
+                JsonItem* item_p;
+                JsonObj_new_insitu(copy, len, &json_obj);
+                for (size_t i = 0; i < 5; i++)
+                {
+                    Json_get(&json_obj, keys[i], &item_p);
+                    Json_get(item_p, "score", &value_double);
+                    sum += value_double;
+                }
+                JsonObj_destroy(&json_obj);
+            }
+        }
+        const double elapsed_time = _bench_now() - start_time;
+        base_time                 = lazy ? base_time : elapsed_time;
+        if (sum != 5 * num_of_runs * (3 + 97 + 201 + 350 + 499 + 5 * 0.25) / 5)
+        {
+            LOG_ERROR("Wrong values read");
+        }
+        printf(
+            "%-14s %12.0f %10.2f\n",
+            lazy ? "JsonDoc" : "JsonObj",
+            elapsed_time * 1e9 / (double)num_of_runs,
+            base_time / elapsed_time);
+    }
+    free(copy);
+    free(json_string);
+}
+
+typedef struct
+{
+    json_uint_t id;
+    const char* name;
+    json_decimal_t score;
+    json_bool_t active;
+    json_uint_t tags[8];
+    size_t num_of_tags;
+} BenchRecord;
+
+#define BENCH_RECORD_FIELDS(FIELD, OBJECT, ARRAY, OBJECT_ARRAY) \
+    FIELD(BenchRecord, id, "id")                                \
+    FIELD(BenchRecord, name, "name")                            \
+    FIELD(BenchRecord, score, "score")                          \
+    FIELD(BenchRecord, active, "active")                        \
+    ARRAY(BenchRecord, tags, "tags", num_of_tags)
+JSON_SCHEMA(bench_record_schema, BENCH_RECORD_FIELDS);
+
+// Read the members of a record holding as many members again that are not needed, by building the
+// tree and getting them one by one, and by binding the record to a struct.
+void bench_schema_binding(void)
+{
+    const size_t num_of_runs = 200000;
+    const char json_string[]
+        = "{\"id\": 1234, \"name\": \"record\", \"meta\": {\"created\": \"2020-01-01\", "
+          "\"history\": [{\"a\": 1}, {\"b\": [2, 3]}]}, \"score\": 99.5, \"active\": true, "
+          "\"comment\": \"not needed\", \"tags\": [1, 2, 3, 4, 5, 6], \"ratio\": 0.125}";
+    const size_t len = strlen(json_string);
+    char* copy       = malloc(len + 1);
+    printf("%-14s %12s %10s\n", "mode", "ns/doc", "speedup");
+    double base_time = 0;
+    for (size_t bind = 0; bind < 2; bind++)
+    {
+        json_decimal_t sum      = 0;
+        const double start_time = _bench_now();
+        for (size_t run = 0; run < num_of_runs; run++)
+        {
+            memcpy(copy, json_string, len + 1);
+            BenchRecord record = {0};
+            if (bind)
+            {
+                JsonDoc json_doc;
+                JsonDoc_new(copy, len, &json_doc);
+                JsonDoc_bind(&json_doc, &bench_record_schema, &record);
+                JsonDoc_destroy(&json_doc);
+            }
+            else
+            {
+                JsonObj json_obj;
+                JsonArray* array_p;
+                JsonObj_new_insitu(copy, len, &json_obj);
+                Json_get(&json_obj, "id", &record.id);
+                Json_get(&json_obj, "name", &record.name);
+                Json_get(&json_obj, "score", &record.score);
+                Json_get(&json_obj, "active", &record.active);
+                Json_get(&json_obj, "tags", &array_p);
+                record.num_of_tags = array_p->len;
+                for (size_t i = 0; i < record.num_of_tags; i++)
+                {
+                    Json_get(array_p, i, &record.tags[i]);
+                }
+                JsonObj_destroy(&json_obj);
+            }
+            sum += (json_decimal_t)record.id + record.score + record.tags[record.num_of_tags - 1];
+        }
+        const double elapsed_time = _bench_now() - start_time;
+        base_time                 = bind ? base_time : elapsed_time;
+        if (sum != num_of_runs * (1234 + 99.5 + 6))
+        {
+            LOG_ERROR("Wrong values read");
+        }
+        printf(
+            "%-14s %12.0f %10.2f\n",
+            bind ? "JsonDoc_bind" : "Json_get",
+            elapsed_time * 1e9 / (double)num_of_runs,
+            base_time / elapsed_time);
+    }
+    free(copy);
+}
+
+// Sum the numbers of the siblings following `item_p` and of their children.
+static json_decimal_t _bench_sum_tree(const JsonItem* item_p)
+{
+    json_decimal_t sum = 0;
+    for (; item_p != NULL; item_p = item_p->next_sibling)
+    {
+        switch (item_p->value.value_type)
+        {
+        case VALUE_INT:
+            sum += (json_decimal_t)item_p->value.value_int;
+            break;
+        case VALUE_LLU:
+            sum += (json_decimal_t)item_p->value.value_llu;
+            break;
+        case VALUE_DOUBLE:
+            sum += item_p->value.value_double;
+            break;
+        case VALUE_ITEM:
+            sum += _bench_sum_tree(item_p->value.value_child_p);
+            break;
+        case VALUE_ARRAY:
+            if (item_p->value.value_array_p->len > 0)
+            {
+                sum += _bench_sum_tree(item_p->value.value_array_p->elements[0]);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return sum;
+}
+
+// Sum the numbers of a tape, in the order of its words.
+static json_decimal_t _bench_sum_tape(const JsonTape* tape_p)
+{
+    json_decimal_t sum = 0;
+    for (size_t pos = 0; pos < tape_p->num_of_words; pos++)
+    {
+        const uint64_t word = tape_p->words[pos];
+        switch (_tape_tag(word))
+        {
+        case TAPE_INT:
+            sum += (json_decimal_t)(json_int_t)tape_p->words[++pos];
+            break;
+        case TAPE_LLU:
+            sum += (json_decimal_t)tape_p->words[++pos];
+            break;
+        case TAPE_DOUBLE:
+        {
+            json_decimal_t value_double;
+            memcpy(&value_double, &tape_p->words[++pos], sizeof(uint64_t));
+            sum += value_double;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return sum;
+}
+
+// Compare the memory used by the tree and by the tape of a document of about 7 MB, the time to
+// build them, and the time to sum all their numbers.
+void bench_tape_scan(void)
+{
+    const size_t num_of_runs = 10;
+    char* json_string        = _make_large_json(100000, false, 10000);
+    const size_t len         = strlen(json_string);
+    char* copy               = malloc(len + 1);
+    printf("%-8s %10s %12s %12s\n", "mode", "MB", "parse ms", "scan ms");
+    json_decimal_t sums[2] = {0, 0};
+    for (size_t tape = 0; tape < 2; tape++)
+    {
+        double parse_time = 0;
+        double scan_time  = 0;
+        size_t used_bytes = 0;
+        for (size_t run = 0; run < num_of_runs; run++)
+        {
+            memcpy(copy, json_string, len + 1);
+            JsonObj json_obj;
+            JsonTape json_tape;
+            double start_time = _bench_now();
+            if (tape)
+            {
+                JsonTape_new(copy, len, &json_tape);
+            }
+            else
+            {
+                JsonObj_new_insitu(copy, len, &json_obj);
+            }
+            parse_time += _bench_now() - start_time;
+            start_time = _bench_now();
+            sums[tape] = tape ? _bench_sum_tape(&json_tape)
+                              : _bench_sum_tree(json_obj.root.next_sibling);
+            scan_time += _bench_now() - start_time;
+            if (tape)
+            {
+                used_bytes = json_tape.num_of_words * sizeof(uint64_t);
+                JsonTape_destroy(&json_tape);
+            }
+            else
+            {
+                used_bytes = _JsonObj_used_bytes(&json_obj);
+                JsonObj_destroy(&json_obj);
+            }
+        }
+        printf(
+            "%-8s %10.1f %12.2f %12.2f\n",
+            tape ? "JsonTape" : "JsonObj",
+            (double)used_bytes / 1e6,
+            parse_time * 1e3 / (double)num_of_runs,
+            scan_time * 1e3 / (double)num_of_runs);
+    }
+    if (sums[0] != sums[1])
+    {
+        LOG_ERROR("Different sums: %f and %f", sums[0], sums[1]);
+    }
+    free(copy);
+    free(json_string);
+}
+
+// Time the parsing, the lookups and the destruction of a 10M-element array and of a 1M-key object.
+// Lookups starting from the second member walk every sibling, in constant stack space.
+void bench_wide_documents(void)
+{
+    size_t len        = 0;
+    char* json_string = _make_wide_array(10000000, &len);
+    JsonObj json_obj;
+    JsonArray* array_p    = NULL;
+    json_uint_t value_llu = 0;
+    double start_time     = _bench_now();
+    JsonObj_new_insitu(json_string, len, &json_obj);
+    const double parse_time = _bench_now() - start_time;
+    start_time              = _bench_now();
+    Json_get(&json_obj, "a", &array_p);
+    json_uint_t sum = 0;
+    for (size_t i = 0; i < JsonArray_len(array_p); i++)
+    {
+        Json_get(array_p, i, &value_llu);
+        sum += value_llu;
+    }
+    const double get_time = _bench_now() - start_time;
+    start_time            = _bench_now();
+    JsonObj_destroy(&json_obj);
+    const double destroy_time = _bench_now() - start_time;
+    free(json_string);
+    if (sum != 45000000)
+    {
+        LOG_ERROR("Wrong sum %llu", sum);
+    }
+    printf("%-22s %10s %14s %12s\n", "document", "parse ms", "lookups ms", "destroy ms");
+    printf(
+        "%-22s %10.0f %14.0f %12.1f\n",
+        "10M-element array",
+        parse_time * 1e3,
+        get_time * 1e3,
+        destroy_time * 1e3);
+
+    json_string = _make_wide_object(1000000, &len);
+    start_time  = _bench_now();
+    JsonObj_new_insitu(json_string, len, &json_obj);
+    const double object_parse_time = _bench_now() - start_time;
+    start_time                     = _bench_now();
+    JsonItem* second_p             = json_obj.root.next_sibling->next_sibling;
+    for (size_t i = 0; i < 10; i++)
+    {
+        Json_get(second_p, "k999999", &value_llu);
+    }
+    const double walk_time = (_bench_now() - start_time) / 10;
+    start_time             = _bench_now();
+    JsonObj_destroy(&json_obj);
+    const double object_destroy_time = _bench_now() - start_time;
+    free(json_string);
+    printf(
+        "%-22s %10.0f %14.2f %12.1f\n",
+        "1M-key object (walk)",
+        object_parse_time * 1e3,
+        walk_time * 1e3,
+        object_destroy_time * 1e3);
+}
+
+#define BENCH_LOG_BURSTS 200
+#define BENCH_LOG_BURST_LEN (LOG_RING_LEN / 2)
+
+typedef struct
+{
+    FILE* file_p;
+    bool is_sync;
+    double seconds; // Spent inside the bursts, not waiting for the writer thread between them
+} BenchLogTask;
+
+// The logger as it was before the writer thread: format and write under a mutex on every call.
+static void _bench_log_sync(FILE* file_p, size_t i)
+{
+    char date_time_str[DATE_TIME_STR_LEN];
+    get_date_time(date_time_str);
+    pthread_mutex_lock(&log_mutex);
+    fprintf(file_p, "[%5s] <%d> %s %s:%d | line %zu\n", "INFO", getpid(), date_time_str,
+            __FILENAME__, __LINE__, i);
+    fflush(file_p);
+    pthread_mutex_unlock(&log_mutex);
+}
+
+static void* _bench_log_bursts(void* task_p)
+{
+    BenchLogTask* log_task_p = task_p;
+    log_task_p->seconds      = 0;
+    for (size_t burst = 0; burst < BENCH_LOG_BURSTS; burst++)
+    {
+        const double start_time = _bench_now();
+        for (size_t i = 0; i < BENCH_LOG_BURST_LEN; i++)
+        {
+            if (log_task_p->is_sync)
+            {
+                _bench_log_sync(log_task_p->file_p, i);
+            }
+            else
+            {
+                log_enqueue(log_task_p->file_p, "INFO", __FILENAME__, __LINE__, "line %zu", i);
+            }
+        }
+        log_task_p->seconds += _bench_now() - start_time;
+        logger_flush();
+    }
+    return NULL;
+}
+
+// Cost of a log line for its caller, synchronous against asynchronous, with 1 and 4 threads
+// logging bursts of half a ring to /dev/null.
+void bench_logging(void)
+{
+    FILE* file_p = fopen("/dev/null", "w");
+    if (file_p == NULL)
+    {
+        LOG_PERROR("Could not open /dev/null");
+        return;
+    }
+    printf("%-8s %8s %14s\n", "logger", "threads", "ns per line");
+    for (size_t is_sync = 0; is_sync < 2; is_sync++)
+    {
+        for (size_t num_of_threads = 1; num_of_threads <= 4; num_of_threads *= 4)
+        {
+            pthread_t threads[4];
+            BenchLogTask log_tasks[4];
+            for (size_t t = 0; t < num_of_threads; t++)
+            {
+                log_tasks[t] = (BenchLogTask){.file_p = file_p, .is_sync = is_sync};
+                pthread_create(&threads[t], NULL, _bench_log_bursts, &log_tasks[t]);
+            }
+            double seconds = 0;
+            for (size_t t = 0; t < num_of_threads; t++)
+            {
+                pthread_join(threads[t], NULL);
+                seconds += log_tasks[t].seconds;
+            }
+            printf(
+                "%-8s %8zu %14.1f\n",
+                is_sync ? "sync" : "async",
+                num_of_threads,
+                seconds * 1e9 / (num_of_threads * BENCH_LOG_BURSTS * BENCH_LOG_BURST_LEN));
+        }
+    }
+    fclose(file_p);
+}
+
+// ---------- Benchmark corpora ----------
+// bench_corpora parses every corpus with JsonObj_new and releases it with JsonObj_destroy, over
+// and over for at least BENCH_CORPUS_SECONDS, and writes one JSON object per corpus to the file
+// named by JSON_BENCH_OUT (bench.json by default), so that the results of two commits can be
+// diffed. The corpora are generated with different shapes, built from test/assets (or
+// JSON_BENCH_ASSETS) repeated up to JSON_BENCH_ASSETS_MB megabytes, and read from the *.json files
+// of JSON_BENCH_CORPORA if set.
+
+#define BENCH_CORPUS_SECONDS 0.5
+#define BENCH_CORPUS_MIN_DOCS 3
+#define BENCH_CORPUS_ASSETS_MB 16
+
+typedef struct
+{
+    char name[64];
+    char* json_string; // Null-terminated
+    size_t len;
+    size_t capacity;
+} BenchCorpus;
+
+static void _BenchCorpus_append(BenchCorpus* corpus_p, const char* fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+static void _BenchCorpus_append(BenchCorpus* corpus_p, const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    const size_t len = (size_t)vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+    if (corpus_p->len + len + 1 > corpus_p->capacity)
+    {
+        const size_t capacity = 2 * (corpus_p->len + len + 1);
+        char* json_string     = realloc(corpus_p->json_string, capacity);
+        if (json_string == NULL)
+        {
+            LOG_ERROR("Could not grow the corpus `%s`", corpus_p->name);
+            exit(1);
+        }
+        corpus_p->json_string = json_string;
+        corpus_p->capacity    = capacity;
+    }
+    va_start(args, fmt);
+    vsnprintf(&corpus_p->json_string[corpus_p->len], len + 1, fmt, args);
+    va_end(args);
+    corpus_p->len += len;
+}
+
+// `{"values": [...]}` holding integers, negative integers and decimals.
+static void _bench_corpus_numbers(BenchCorpus* corpus_p, size_t num_of_values)
+{
+    _BenchCorpus_append(corpus_p, "{\"values\": [");
+    for (size_t i = 0; i < num_of_values; i++)
+    {
+        const char* separator_p = (i > 0) ? ", " : "";
+        switch (i % 3)
+        {
+        case 0:
+            _BenchCorpus_append(corpus_p, "%s%lu", separator_p, i * 7919);
+            break;
+        case 1:
+            _BenchCorpus_append(corpus_p, "%s-%lu", separator_p, i % 100000);
+            break;
+        default:
+            _BenchCorpus_append(corpus_p, "%s%lu.%03lu", separator_p, i % 1000, i % 997);
+            break;
+        }
+    }
+    _BenchCorpus_append(corpus_p, "]}");
+}
+
+// `{"logs": [...]}` of records made mostly of strings, some of them with escapes.
+static void _bench_corpus_logs(BenchCorpus* corpus_p, size_t num_of_records)
+{
+    static const char* levels[] = {"TRACE", "DEBUG", "INFO", "WARNING", "ERROR"};
+    _BenchCorpus_append(corpus_p, "{\"logs\": [");
+    for (size_t i = 0; i < num_of_records; i++)
+    {
+        _BenchCorpus_append(
+            corpus_p,
+            "%s{\"ts\": \"2026-10-17T06:%02lu:%02lu.%06luZ\", \"level\": \"%s\", "
+            "\"host\": \"node-%lu.example.org\", "
+            "\"msg\": \"request %lu from \\\"10.0.%lu.%lu\\\" served in %lu ms by worker %lu\", "
+            "\"tags\": [\"http\", \"v%lu\"]}",
+            (i > 0) ? ", " : "",
+            (i / 60) % 60,
+            i % 60,
+            (i * 7919) % 1000000,
+            levels[i % 5],
+            i % 64,
+            i,
+            i % 256,
+            (i / 256) % 256,
+            i % 1000,
+            i % 16,
+            i % 3);
+    }
+    _BenchCorpus_append(corpus_p, "]}");
+}
+
+// `{"configs": [...]}` of objects nested `depth` levels deep, with a few members at each level.
+static void _bench_corpus_nested(BenchCorpus* corpus_p, size_t num_of_configs, size_t depth)
+{
+    _BenchCorpus_append(corpus_p, "{\"configs\": [");
+    for (size_t i = 0; i < num_of_configs; i++)
+    {
+        _BenchCorpus_append(corpus_p, "%s", (i > 0) ? ", " : "");
+        for (size_t level = 0; level < depth; level++)
+        {
+            _BenchCorpus_append(
+                corpus_p,
+                "{\"name\": \"service-%lu-%lu\", \"enabled\": %s, \"retries\": %lu, \"child\": ",
+                i,
+                level,
+                (level % 2) ? "true" : "false",
+                level);
+        }
+        _BenchCorpus_append(corpus_p, "{}");
+        for (size_t level = 0; level < depth; level++)
+        {
+            _BenchCorpus_append(corpus_p, "}");
+        }
+    }
+    _BenchCorpus_append(corpus_p, "]}");
+}
+
+static char* _bench_read_file(const char* path, size_t* len_p)
+{
+    FILE* file_p = fopen(path, "rb");
+    if (file_p == NULL)
+    {
+        return NULL;
+    }
+    fseek(file_p, 0, SEEK_END);
+    const long len = ftell(file_p);
+    fseek(file_p, 0, SEEK_SET);
+    char* json_string = (len >= 0) ? malloc((size_t)len + 1) : NULL;
+    if ((json_string == NULL) || (fread(json_string, 1, (size_t)len, file_p) != (size_t)len))
+    {
+        free(json_string);
+        fclose(file_p);
+        return NULL;
+    }
+    fclose(file_p);
+    json_string[len] = '\0';
+    *len_p           = (size_t)len;
+    return json_string;
+}
+
+static const char* bench_asset_names[] = {
+    "test_json.json",
+    "test_json_array_1.json",
+    "test_json_array_2.json",
+    "test_json_array_3.json",
+    "test_json_array_4.json",
+    "test_json_numbers.json",
+    "test_json_vec_of_obj.json",
+    "test_json_vector.json",
+};
+
+#define BENCH_NUM_OF_ASSETS (sizeof(bench_asset_names) / sizeof(bench_asset_names[0]))
+
+// `{"docs": [...]}` repeating the assets of `assets_dir` up to `target_len` bytes.
+static bool _bench_corpus_assets(BenchCorpus* corpus_p, const char* assets_dir, size_t target_len)
+{
+    char* assets[BENCH_NUM_OF_ASSETS] = {NULL};
+    bool all_read                     = true;
+    for (size_t i = 0; i < BENCH_NUM_OF_ASSETS; i++)
+    {
+        char path[PATH_MAX];
+        size_t len = 0;
+        snprintf(path, sizeof(path), "%s/%s", assets_dir, bench_asset_names[i]);
+        assets[i] = _bench_read_file(path, &len);
+        all_read  = all_read && (assets[i] != NULL);
+    }
+    if (all_read)
+    {
+        _BenchCorpus_append(corpus_p, "{\"docs\": [");
+        for (size_t i = 0; corpus_p->len < target_len; i++)
+        {
+            const char* asset_p = assets[i % BENCH_NUM_OF_ASSETS];
+            _BenchCorpus_append(corpus_p, "%s%s", (i > 0) ? ",\n" : "", asset_p);
+        }
+        _BenchCorpus_append(corpus_p, "]}");
+    }
+    for (size_t i = 0; i < BENCH_NUM_OF_ASSETS; i++)
+    {
+        free(assets[i]);
+    }
+    return all_read;
+}
+
+// Value of a field of /proc/self/status such as VmRSS or VmHWM, in kB, or 0 if unknown.
+static size_t _bench_status_kb(const char* field)
+{
+    FILE* file_p = fopen("/proc/self/status", "r");
+    if (file_p == NULL)
+    {
+        return 0;
+    }
+    char line[256];
+    size_t value_kb        = 0;
+    const size_t field_len = strlen(field);
+    while (fgets(line, sizeof(line), file_p) != NULL)
+    {
+        if ((strncmp(line, field, field_len) == 0) && (line[field_len] == ':'))
+        {
+            value_kb = strtoull(&line[field_len + 1], NULL, 10);
+            break;
+        }
+    }
+    fclose(file_p);
+    return value_kb;
+}
+
+// Reset the peak RSS of the process to its current RSS. Only Linux can; elsewhere the peak of
+// the whole process is reported.
+static void _bench_reset_peak_rss(void)
+{
+    FILE* file_p = fopen("/proc/self/clear_refs", "w");
+    if (file_p != NULL)
+    {
+        fputs("5", file_p);
+        fclose(file_p);
+    }
+}
+
+static size_t _bench_peak_rss_kb(void)
+{
+    const size_t peak_kb = _bench_status_kb("VmHWM");
+    if (peak_kb > 0)
+    {
+        return peak_kb;
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss / 1024;
+#else
+    return (size_t)usage.ru_maxrss;
+#endif /* __APPLE__ */
+}
+
+// Parse and release `corpus_p` for at least BENCH_CORPUS_SECONDS, print a line of the table and
+// append a JSON object to `out_p`.
+static void _bench_run_corpus(const BenchCorpus* corpus_p, FILE* out_p, bool is_first)
+{
+    JsonObj json_obj;
+    if (is_err(JsonObj_new(corpus_p->json_string, &json_obj)))
+    {
+        LOG_ERROR("Corpus `%s` rejected", corpus_p->name);
+        return;
+    }
+    JsonStats stats;
+    JsonObj_stats(&json_obj, &stats);
+    const size_t num_of_nodes = stats.num_of_nodes;
+    JsonObj_destroy(&json_obj);
+
+    const size_t rss_kb = _bench_status_kb("VmRSS");
+    _bench_reset_peak_rss();
+    JsonGlobalStats heap_before;
+    JsonStats_global(&heap_before);
+    size_t num_of_docs      = 0;
+    const double start_time = _bench_now();
+    double elapsed_time     = 0;
+    while ((elapsed_time < BENCH_CORPUS_SECONDS) || (num_of_docs < BENCH_CORPUS_MIN_DOCS))
+    {
+        JsonObj_new(corpus_p->json_string, &json_obj);
         JsonObj_destroy(&json_obj);
+        num_of_docs++;
+        elapsed_time = _bench_now() - start_time;
     }
-    PRINT_TEST_TITLE("test_json_array_1.json");
+    JsonGlobalStats heap_after;
+    JsonStats_global(&heap_after);
+    const size_t num_of_allocs = heap_after.num_of_allocs + heap_after.num_of_reallocs
+                               - heap_before.num_of_allocs - heap_before.num_of_reallocs;
+    const double allocs_per_doc = (double)num_of_allocs / (double)num_of_docs;
+    const size_t peak_rss_kb = _bench_peak_rss_kb();
+    const double doc_time    = elapsed_time / (double)num_of_docs;
+    const double mb_per_s    = (double)corpus_p->len / doc_time / 1e6;
+    const double docs_per_s  = 1.0 / doc_time;
+    const double ns_per_node = doc_time * 1e9 / (double)num_of_nodes;
+
+    printf(
+        "%-32s %10.2f %12lu %9.1f %12.1f %9.2f %9.1f %10lu\n",
+        corpus_p->name,
+        (double)corpus_p->len / 1e6,
+        num_of_nodes,
+        mb_per_s,
+        docs_per_s,
+        ns_per_node,
+        allocs_per_doc,
+        peak_rss_kb);
+    fprintf(
+        out_p,
+        "%s\n    {\"name\": \"%s\", \"bytes\": %lu, \"nodes\": %lu, \"docs\": %lu, "
+        "\"seconds\": %.6f, \"mb_per_s\": %.3f, \"docs_per_s\": %.3f, \"ns_per_node\": %.3f, "
+        "\"allocs_per_doc\": %.2f, \"peak_rss_kb\": %lu, \"parse_rss_kb\": %lu}",
+        is_first ? "" : ",",
+        corpus_p->name,
+        corpus_p->len,
+        num_of_nodes,
+        num_of_docs,
+        elapsed_time,
+        mb_per_s,
+        docs_per_s,
+        ns_per_node,
+        allocs_per_doc,
+        peak_rss_kb,
+        (peak_rss_kb > rss_kb) ? peak_rss_kb - rss_kb : 0);
+}
+
+// Run `corpus_p` and release it, so that the next corpus can reuse it.
+static void _bench_corpus_done(BenchCorpus* corpus_p, FILE* out_p, size_t* num_of_corpora_p)
+{
+    _bench_run_corpus(corpus_p, out_p, *num_of_corpora_p == 0);
+    (*num_of_corpora_p)++;
+    free(corpus_p->json_string);
+    *corpus_p = (BenchCorpus){0};
+}
+
+void bench_corpora(void)
+{
+    const char* out_path    = getenv("JSON_BENCH_OUT");
+    const char* commit      = getenv("JSON_BENCH_COMMIT");
+    const char* assets_dir  = getenv("JSON_BENCH_ASSETS");
+    const char* corpora_dir = getenv("JSON_BENCH_CORPORA");
+    const char* assets_mb   = getenv("JSON_BENCH_ASSETS_MB");
+    const size_t num_of_mb  = (assets_mb != NULL) ? strtoul(assets_mb, NULL, 10) : 0;
+    out_path                = (out_path != NULL) ? out_path : "bench.json";
+    assets_dir              = (assets_dir != NULL) ? assets_dir : "test/assets";
+    FILE* out_p             = fopen(out_path, "w");
+    if (out_p == NULL)
+    {
+        LOG_PERROR("Could not open the benchmark output");
+        return;
+    }
+    fprintf(
+        out_p,
+        "{\"commit\": \"%s\", \"min_seconds\": %.2f, \"corpora\": [",
+        (commit != NULL) ? commit : "unknown",
+        BENCH_CORPUS_SECONDS);
+    printf(
+        "%-32s %10s %12s %9s %12s %9s %9s %10s\n",
+        "corpus",
+        "MB",
+        "nodes",
+        "MB/s",
+        "docs/s",
+        "ns/node",
+        "allocs",
+        "peak kB");
+    size_t num_of_corpora = 0;
+    BenchCorpus corpus    = {0};
+
+    snprintf(corpus.name, sizeof(corpus.name), "numeric_array");
+    _bench_corpus_numbers(&corpus, 2000000);
+    _bench_corpus_done(&corpus, out_p, &num_of_corpora);
+
+    snprintf(corpus.name, sizeof(corpus.name), "string_logs");
+    _bench_corpus_logs(&corpus, 100000);
+    _bench_corpus_done(&corpus, out_p, &num_of_corpora);
+
+    snprintf(corpus.name, sizeof(corpus.name), "nested_configs");
+    _bench_corpus_nested(&corpus, 2000, 64);
+    _bench_corpus_done(&corpus, out_p, &num_of_corpora);
+
+    snprintf(corpus.name, sizeof(corpus.name), "wide_object");
+    corpus.json_string = _make_wide_object(500000, &corpus.len);
+    _bench_corpus_done(&corpus, out_p, &num_of_corpora);
+
+    const size_t assets_mb_len = (num_of_mb > 0) ? num_of_mb : BENCH_CORPUS_ASSETS_MB;
+    snprintf(corpus.name, sizeof(corpus.name), "assets_x%zuMB", assets_mb_len);
+    if (_bench_corpus_assets(&corpus, assets_dir, assets_mb_len * 1000000))
+    {
+        _bench_corpus_done(&corpus, out_p, &num_of_corpora);
+    }
+    else
+    {
+        LOG_WARNING("Assets not found in `%s`", assets_dir);
+    }
+    for (size_t i = 0; i < BENCH_NUM_OF_ASSETS; i++)
+    {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", assets_dir, bench_asset_names[i]);
+        corpus.json_string = _bench_read_file(path, &corpus.len);
+        if (corpus.json_string != NULL)
+        {
+            snprintf(corpus.name, sizeof(corpus.name), "asset/%s", bench_asset_names[i]);
+            _bench_corpus_done(&corpus, out_p, &num_of_corpora);
+        }
+    }
+
+    DIR* dir_p = (corpora_dir != NULL) ? opendir(corpora_dir) : NULL;
+    for (struct dirent* entry_p = (dir_p != NULL) ? readdir(dir_p) : NULL; entry_p != NULL;
+         entry_p                = readdir(dir_p))
+    {
+        const size_t name_len = strlen(entry_p->d_name);
+        if ((name_len < 5) || (strcmp(&entry_p->d_name[name_len - 5], ".json") != 0))
+        {
+            continue;
+        }
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", corpora_dir, entry_p->d_name);
+        corpus.json_string = _bench_read_file(path, &corpus.len);
+        if (corpus.json_string != NULL)
+        {
+            snprintf(corpus.name, sizeof(corpus.name), "file/%.58s", entry_p->d_name);
+            _bench_corpus_done(&corpus, out_p, &num_of_corpora);
+        }
+    }
+    if (dir_p != NULL)
+    {
+        closedir(dir_p);
+    }
+    fprintf(out_p, "\n]}\n");
+    fclose(out_p);
+    printf("Results written to %s\n", out_path);
+}
+
+#define BENCH_KEY_LOOKUPS 10000000
+
+// Lookups of long keys sharing a prefix, in an object too small for a key table.
+void bench_string_access(void)
+{
+    static const char* names[] = {
+        "host",
+        "port",
+        "timeout_ms",
+        "retries",
+        "user_agent",
+        "max_connections",
+        "tls",
+        "region",
+        "zone",
+        "log_level",
+        "owner",
+        "backoff_factor",
+    };
+    const size_t num_of_names = sizeof(names) / sizeof(names[0]);
+    char keys[sizeof(names) / sizeof(names[0])][64];
+    BenchCorpus corpus = {0};
+    _BenchCorpus_append(&corpus, "{");
+    for (size_t i = 0; i < num_of_names; i++)
+    {
+        snprintf(keys[i], sizeof(keys[i]), "service.configuration.%s", names[i]);
+        _BenchCorpus_append(&corpus, "%s\"%s\": %lu", (i > 0) ? ", " : "", keys[i], i);
+    }
+    _BenchCorpus_append(&corpus, "}");
+    JsonObj json_obj;
+    JsonObj_new(corpus.json_string, &json_obj);
+    json_uint_t sum         = 0;
+    const double start_time = _bench_now();
+    for (size_t i = 0; i < BENCH_KEY_LOOKUPS; i++)
+    {
+        json_uint_t value_llu = 0;
+        Json_get(&json_obj, keys[i % num_of_names], &value_llu);
+        sum += value_llu;
+    }
+    const double lookup_time = _bench_now() - start_time;
+    JsonObj_destroy(&json_obj);
+    free(corpus.json_string);
+    if (sum != (BENCH_KEY_LOOKUPS / num_of_names) * (num_of_names * (num_of_names - 1) / 2)
+                   + (BENCH_KEY_LOOKUPS % num_of_names) * (BENCH_KEY_LOOKUPS % num_of_names - 1) / 2)
+    {
+        LOG_ERROR("Wrong sum %llu", sum);
+    }
+    printf("Lookup of a 25-37 byte key among 12: %.1f ns\n", lookup_time * 1e9 / BENCH_KEY_LOOKUPS);
+}
+
+#define BENCH_WIDTH_KEYS 4096
+#define BENCH_WIDTH_TABLE_LOOKUPS (512 * BENCH_WIDTH_KEYS)
+#define BENCH_WIDTH_WALK_STEPS 200000000ULL
+
+// Time random lookups by key in objects of 8 to 100,000 members, walking the siblings and probing
+// the key table. The walk is timed on the same tree with the table unhooked from the first member.
+void bench_key_width(void)
+{
+    static const size_t widths[] = {8, 16, 64, 1024, 10000, 100000};
+    static char keys[BENCH_WIDTH_KEYS][32];
+    printf("%8s %12s %12s\n", "keys", "walk ns", "table ns");
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++)
     {
+        const size_t num_of_keys = widths[w];
+        BenchCorpus corpus       = {.name = "width"};
+        _BenchCorpus_append(&corpus, "{");
+        for (size_t i = 0; i < num_of_keys; i++)
+        {
+            _BenchCorpus_append(&corpus, "%s\"field_%lu\": %lu", (i > 0) ? ", " : "", i, i);
+        }
+        _BenchCorpus_append(&corpus, "}");
+        json_uint_t expected = 0;
+        uint64_t seed        = 88172645463325252ULL;
+        for (size_t i = 0; i < BENCH_WIDTH_KEYS; i++)
+        {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            snprintf(keys[i], sizeof(keys[i]), "field_%lu", seed % num_of_keys);
+            expected += seed % num_of_keys;
+        }
         JsonObj json_obj;
-        JsonItem* json_item;
-        json_uint_t value_llu;
-        const char* value_str;
-        double value_double;
-        bool value_bool;
-        JsonArray* json_array;
-        char* json_string = load_file_alloc("test/assets/test_json_array_1.json");
-        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Json object created");
-        Json_get(&json_obj, "array_key", &json_array);
-        ASSERT_EQ(json_array != NULL, true, "Array found as root element.");
-        Json_get(json_array, 0, &json_item);
-        ASSERT_EQ(json_item != NULL, true, "First array element is an item.");
-        Json_get(json_item, "object 1", &value_llu);
-        ASSERT_EQ(value_llu, 56, "Value LLU found");
-        Json_get(json_array, 1, &json_item);
-        ASSERT_EQ(json_item != NULL, true, "Second array element is an item.");
-        Json_get(json_item, "object 2", &value_double);
-        ASSERT_EQ(value_double, 404.5f, "Value DOUBLE found");
-        Json_get(json_array, 2, &json_item);
-        Json_get(json_item, "object 3", &value_str);
-        ASSERT_EQ(value_str, "SOME STRING", "Array element STRING found.");
-        Json_get(json_array, 3, &value_llu);
-        ASSERT_EQ(value_llu, 32, "Array element INT found.");
-        Json_get(json_array, 4, &value_bool);
-        ASSERT_EQ(value_bool, false, "Array element BOOL found.");
+        if (is_err(JsonObj_new(corpus.json_string, &json_obj)))
+        {
+            LOG_ERROR("Object of %lu keys rejected", num_of_keys);
+            free(corpus.json_string);
+            continue;
+        }
+        JsonItem* first_p             = json_obj.root.next_sibling;
+        JsonKeyTable* const table_p   = first_p->key_table_p;
+        double times[2]               = {0.0, 0.0};
+        const size_t num_of_lookups[] = {
+            (BENCH_WIDTH_WALK_STEPS / num_of_keys < BENCH_WIDTH_KEYS)
+                ? BENCH_WIDTH_KEYS
+                : BENCH_WIDTH_WALK_STEPS / num_of_keys / BENCH_WIDTH_KEYS * BENCH_WIDTH_KEYS,
+            BENCH_WIDTH_TABLE_LOOKUPS,
+        };
+        // 0: sibling walk, 1: key table, for objects that have one.
+        for (size_t mode = 0; mode < ((table_p != NULL) ? 2 : 1); mode++)
+        {
+            first_p->key_table_p    = (mode == 0) ? NULL : table_p;
+            json_uint_t sum         = 0;
+            const double start_time = _bench_now();
+            for (size_t i = 0; i < num_of_lookups[mode]; i++)
+            {
+                json_uint_t value_llu = 0;
+                Json_get(&json_obj, keys[i % BENCH_WIDTH_KEYS], &value_llu);
+                sum += value_llu;
+            }
+            times[mode] = (_bench_now() - start_time) / (double)num_of_lookups[mode];
+            if (sum != expected * (num_of_lookups[mode] / BENCH_WIDTH_KEYS))
+            {
+                LOG_ERROR("Wrong sum %llu for %lu keys", sum, num_of_keys);
+            }
+        }
+        first_p->key_table_p = table_p;
+        if (table_p != NULL)
+        {
+            printf("%8lu %12.0f %12.1f\n", num_of_keys, times[0] * 1e9, times[1] * 1e9);
+        }
+        else
+        {
+            printf("%8lu %12.0f %12s\n", num_of_keys, times[0] * 1e9, "-");
+        }
         JsonObj_destroy(&json_obj);
-        free(json_string);
+        free(corpus.json_string);
+    }
+}
+
+#define BENCH_DECODE_LEN (64 * 1024)
+#define BENCH_DECODE_BYTES (4ULL << 30)
+
+// Decode 64 KB strings of ASCII, of UTF-8 text and of ASCII with a few escapes per line, and
+// compare the throughput with that of memcpy on the same bytes.
+void bench_string_decoding(void)
+{
+    static const char* kinds[]     = {"ascii", "utf8", "escaped"};
+    static const char* fragments[] = {
+        "lorem ipsum dolor sit amet, consectetur adipiscing elit ",
+        "caf\xC3\xA9 na\xC3\xAFve \xE2\x82\xAC" "10 \xF0\x9F\x98\x80 \xCE\xB1\xCE\xB2\xCE\xB3 ",
+        "GET /api/v1/items?id=42 served in 12 ms by worker 7 for \\\"curl/8.0\\\"\\n",
+    };
+    char* raw_p        = malloc(BENCH_DECODE_LEN + 64);
+    char* buf_p        = malloc(BENCH_DECODE_LEN + 64);
+    volatile char sink = 0; // Keeps the copies
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++)
+    {
+        size_t len = 0;
+        while (len < BENCH_DECODE_LEN)
+        {
+            memcpy(&raw_p[len], fragments[k], strlen(fragments[k]));
+            len += strlen(fragments[k]);
+        }
+        const size_t num_of_runs = BENCH_DECODE_BYTES / len;
+        double start_time        = _bench_now();
+        for (size_t i = 0; i < num_of_runs; i++)
+        {
+            memcpy(buf_p, raw_p, len);
+            sink = buf_p[i % len];
+        }
+        const double copy_time = _bench_now() - start_time;
+        size_t decoded_len     = 0;
+        start_time             = _bench_now();
+        for (size_t i = 0; i < num_of_runs; i++)
+        {
+            memcpy(buf_p, raw_p, len);
+            sink = buf_p[i % len];
+            if (is_err(_decode_str(buf_p, len, &decoded_len)))
+            {
+                LOG_ERROR("Failed to decode the `%s` string", kinds[k]);
+                break;
+            }
+        }
+        const double decode_time = _bench_now() - start_time - copy_time;
+        printf(
+            "Decoding of %-7s strings: %5.1f GB/s (memcpy: %5.1f GB/s, %lu -> %lu bytes)\n",
+            kinds[k],
+            (double)(num_of_runs * len) / decode_time * 1e-9,
+            (double)(num_of_runs * len) / copy_time * 1e-9,
+            len,
+            decoded_len);
+    }
+    (void)sink;
+    free(raw_p);
+    free(buf_p);
+}
+
+#define BENCH_EVENTS_RECORDS 400000
+
+static bool _bench_count_event(void* count_p)
+{
+    (*(size_t*)count_p)++;
+    return true;
+}
+
+static bool _bench_count_str(const char* str_p, size_t len, void* count_p)
+{
+    (void)str_p;
+    (void)len;
+    (*(size_t*)count_p)++;
+    return true;
+}
+
+static bool _bench_count_int(json_int_t value, void* count_p)
+{
+    (void)value;
+    (*(size_t*)count_p)++;
+    return true;
+}
+
+static bool _bench_count_llu(json_uint_t value, void* count_p)
+{
+    (void)value;
+    (*(size_t*)count_p)++;
+    return true;
+}
+
+static bool _bench_count_double(json_decimal_t value, void* count_p)
+{
+    (void)value;
+    (*(size_t*)count_p)++;
+    return true;
+}
+
+static bool _bench_count_bool(json_bool_t value, void* count_p)
+{
+    (void)value;
+    (*(size_t*)count_p)++;
+    return true;
+}
+
+// Throughput and peak memory of Json_parse_events against JsonObj_new on the logs corpus, and of
+// Json_parse_events_file on the same document written to a temporary file.
+void bench_events(void)
+{
+    static const JsonHandler handler = {
+        .on_object_start = _bench_count_event,
+        .on_object_end   = _bench_count_event,
+        .on_array_start  = _bench_count_event,
+        .on_array_end    = _bench_count_event,
+        .on_key          = _bench_count_str,
+        .on_string       = _bench_count_str,
+        .on_int          = _bench_count_int,
+        .on_llu          = _bench_count_llu,
+        .on_double       = _bench_count_double,
+        .on_bool         = _bench_count_bool,
+    };
+    BenchCorpus corpus = {.name = "logs"};
+    _bench_corpus_logs(&corpus, BENCH_EVENTS_RECORDS);
+    const double mb = (double)corpus.len / (1024.0 * 1024.0);
+
+    size_t rss_kb = _bench_status_kb("VmRSS");
+    _bench_reset_peak_rss();
+    double start_time = _bench_now();
+    JsonObj json_obj;
+    if (is_err(JsonObj_new(corpus.json_string, &json_obj)))
+    {
+        LOG_ERROR("Corpus `%s` rejected", corpus.name);
+        free(corpus.json_string);
+        return;
     }
-    PRINT_TEST_TITLE("test_json_array_2.json");
+    JsonObj_destroy(&json_obj);
+    double elapsed = _bench_now() - start_time;
+    printf(
+        "JsonObj_new            : %7.1f MB/s, peak RSS +%lu kB\n",
+        mb / elapsed,
+        _bench_peak_rss_kb() - rss_kb);
+
+    size_t num_of_events = 0;
+    rss_kb               = _bench_status_kb("VmRSS");
+    _bench_reset_peak_rss();
+    start_time = _bench_now();
+    if (is_err(Json_parse_events(corpus.json_string, corpus.len, &handler, &num_of_events)))
     {
-        char* json_string = load_file_alloc("test/assets/test_json_array_2.json");
-        JsonItem* json_item;
-        JsonObj json_obj;
-        json_uint_t value_llu;
-        const char* value_str;
-        double value_double;
-        bool value_bool;
-        JsonArray* json_array;
-        JsonArray* json_array_2;
-        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Json object created");
-        Json_get(&json_obj, "array_key", &json_array);
-        ASSERT_EQ(json_array != NULL, true, "Array found as root element.");
-        Json_get(json_array, 0, &json_item);
-        ASSERT_EQ(json_item != NULL, true, "First array element is an item.");
-        Json_get(json_item, "inner array 1", &json_array_2);
-        Json_get(json_array_2, 0, &value_llu);
-        ASSERT_EQ(value_llu, 12314, "Value LLU found");
-        Json_get(json_array_2, 1, &value_double);
-        ASSERT_EQ(value_double, -32.4, "Value DOUBLE found");
-        Json_get(json_array_2, 2, &value_bool);
-        ASSERT_EQ(value_bool, true, "Value TRUE found");
-        Json_get(json_array, 1, &json_item);
-        ASSERT_EQ(json_item != NULL, true, "Second array element is an item.");
-        Json_get(json_item, "inner array 2", &json_array_2);
-        Json_get(json_array_2, 0, &value_double);
-        ASSERT_EQ(value_double, 1.4, "Value DOUBLE found");
-        Json_get(json_array_2, 1, &value_str);
-        ASSERT_EQ(value_str, "hello", "Value STRING found");
-        Json_get(json_array_2, 2, &value_bool);
-        ASSERT_EQ(value_bool, false, "Value FALSE found");
-        JsonObj_destroy(&json_obj);
-        free(json_string);
+        LOG_ERROR("Events of `%s` rejected", corpus.name);
     }
-    PRINT_TEST_TITLE("test_json_array_3.json");
+    elapsed = _bench_now() - start_time;
+    printf(
+        "Json_parse_events      : %7.1f MB/s, peak RSS +%lu kB, %lu events\n",
+        mb / elapsed,
+        _bench_peak_rss_kb() - rss_kb,
+        num_of_events);
+
+    char path[] = "/tmp/json_bench_events_XXXXXX";
+    const int fd = mkstemp(path);
+    if ((fd < 0) || (write(fd, corpus.json_string, corpus.len) != (ssize_t)corpus.len))
     {
-        JsonObj json_obj;
-        JsonItem* json_item;
-        const char* value_str;
-        json_uint_t value_llu;
-        JsonArray* json_array;
-        char* json_string = load_file_alloc("test/assets/test_json_array_3.json");
-        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Json object created");
-        ASSERT(Json_get(&json_obj, "Snapshot", &json_item) == ERR_ALL_GOOD, "Ok");
-        ASSERT(Json_get(json_item, "Value", &value_llu) == ERR_ALL_GOOD, "Ok");
-        ASSERT(Json_get(json_item, "Data", &json_array) == ERR_ALL_GOOD, "Ok");
-        ASSERT(Json_get(json_array, 0, &json_item) == ERR_ALL_GOOD, "Ok");
-        ASSERT(Json_get(json_item, "Time", &value_str) == ERR_ALL_GOOD, "Ok");
-        ASSERT_EQ(value_str, "2021-07-23T08:09:00.000000Z", "Time correct.");
-        JsonObj_destroy(&json_obj);
-        free(json_string);
+        LOG_PERROR("Failed to write `%s`", path);
     }
-    PRINT_TEST_TITLE("test_json_array_4.json");
+    else
     {
-        JsonObj json_obj;
-        json_uint_t value_llu;
-        JsonArray* json_array;
-        bool value_bool;
-        char* json_string = load_file_alloc("test/assets/test_json_array_4.json");
-        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Json object created");
-        ASSERT_OK(Json_get(&json_obj, "array_key1", &json_array), "Ok");
-        ASSERT_OK(Json_get(json_array, 0, &value_llu), "Ok");
-        ASSERT_EQ(value_llu, 32, "Ok");
-        ASSERT_OK(Json_get(json_array, 1, &value_bool), "Ok");
-        ASSERT_EQ(value_bool, false, "Ok");
-        ASSERT_OK(Json_get(&json_obj, "array_key2", &json_array), "Ok");
-        ASSERT_OK(Json_get(json_array, 0, &value_llu), "Ok");
-        ASSERT_EQ(value_llu, 33, "Ok");
-        ASSERT_OK(Json_get(json_array, 1, &value_bool), "Ok");
-        ASSERT_EQ(value_bool, true, "Ok");
-        ASSERT_OK(Json_get(&json_obj, "key", &value_llu), "Ok");
-        ASSERT_EQ(value_llu, 34, "Ok");
-        JsonObj_destroy(&json_obj);
-        free(json_string);
+        free(corpus.json_string);
+        corpus.json_string = NULL;
+        num_of_events      = 0;
+        rss_kb             = _bench_status_kb("VmRSS");
+        _bench_reset_peak_rss();
+        start_time = _bench_now();
+        if (is_err(Json_parse_events_file(path, &handler, &num_of_events)))
+        {
+            LOG_ERROR("Events of `%s` rejected", path);
+        }
+        elapsed = _bench_now() - start_time;
+        printf(
+            "Json_parse_events_file : %7.1f MB/s, peak RSS +%lu kB, %lu events\n",
+            mb / elapsed,
+            _bench_peak_rss_kb() - rss_kb,
+            num_of_events);
     }
-    PRINT_TEST_TITLE("Testing test/assets/test_json.json");
+    if (fd >= 0)
     {
-        JsonObj json_obj;
-        JsonItem* json_item;
-        const char* value_str;
-        json_uint_t value_llu;
-        double value_double;
-        bool value_bool;
-        JsonArray* json_array;
-        char* json_string = load_file_alloc("test/assets/test_json.json");
-        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Json object created");
-        free(json_string); // We can delete it.
-        Json_get(&json_obj, "text_key", &value_str);
-        ASSERT_EQ("text_value", value_str, "String*value found in first item");
+        close(fd);
+        unlink(path);
+    }
+    free(corpus.json_string);
+}
 
-        Json_get(&json_obj, "text_sibling", &value_str);
-        ASSERT_EQ("sibling_value", value_str, "String*value found in sibling");
+#define BENCH_NDJSON_LINES 1000000
+#define BENCH_NDJSON_OBJ_LINES 100000
+#define BENCH_NDJSON_RUNS 3
 
-        Json_get(&json_obj, "nested_1", &json_item);
-        ASSERT_EQ(json_item->key_p, "object_1.1", "Found nested object key");
+// Count the records of status 500 and above, as in the README.
+static bool _bench_count_5xx(const JsonRecord* record_p, void* count_p)
+{
+    json_uint_t status = 0;
+    if (is_ok(record_p->error) && is_ok(Json_get(record_p->item_p, "status", &status))
+        && (status >= 500))
+    {
+        (*(size_t*)count_p)++;
+    }
+    return true;
+}
 
-        Json_get(json_item, "object_1.1", &value_str);
-        ASSERT_EQ(value_str, "item_1.1", "Found nested object value");
-        Json_get(json_item, "object_1.2", &value_str);
-        ASSERT_EQ(value_str, "item_1.2", "Found nested sibling object value");
-        ASSERT(
-            Json_get(json_item, "object_32", &value_str) == ERR_JSON_MISSING_ENTRY,
-            "Object not found");
-        ASSERT(value_str == NULL, "Null returned.");
+// Parse the lines of `buf` with a JsonBatch handler (mode 0), keeping the JsonBatch records (mode
+// 1) or with JsonObj_new_insitu on a reset JsonObj (mode 2), count the records of status 500 and
+// above in `*num_of_5xx_p` and return the time taken.
+static double _bench_ndjson_run(char* buf, size_t len, size_t mode, size_t* num_of_5xx_p)
+{
+    JsonBatch batch;
+    JsonObj json_obj;
+    *num_of_5xx_p           = 0;
+    const double start_time = _bench_now();
+    if (mode == 0)
+    {
+        JsonBatch_new(buf, len, &batch, _bench_count_5xx, num_of_5xx_p);
+    }
+    else if (mode == 1)
+    {
+        JsonBatch_new(buf, len, &batch, NULL, NULL);
+    }
+    else
+    {
+        for (char* line_p = buf; line_p < buf + len;)
+        {
+            char* end_p        = memchr(line_p, '\n', (size_t)(buf + len - line_p));
+            json_uint_t status = 0;
+            if (is_ok(JsonObj_new_insitu(line_p, (size_t)(end_p - line_p), &json_obj))
+                && is_ok(Json_get(&json_obj, "status", &status)) && (status >= 500))
+            {
+                (*num_of_5xx_p)++;
+            }
+            JsonObj_reset(&json_obj);
+            line_p = end_p + 1;
+        }
+    }
+    const double elapsed = _bench_now() - start_time;
+    if (mode == 1)
+    {
+        for (size_t i = 0; i < batch.num_of_records; i++)
+        {
+            _bench_count_5xx(&batch.records[i], num_of_5xx_p);
+        }
+    }
+    if (mode < 2)
+    {
+        JsonBatch_destroy(&batch);
+    }
+    else
+    {
+        JsonObj_destroy(&json_obj);
+    }
+    return elapsed;
+}
 
-        Json_get(&json_obj, "nested_2", &json_item);
-        Json_get(json_item, "object_2.1", &value_str);
-        ASSERT_EQ(value_str, "item_2.1", "Found nested object value");
-        Json_get(json_item, "object_2.2", &json_item);
-        ASSERT_EQ(json_item->key_p, "item_2.2", "Found nested object key");
-        Json_get(json_item, "item_2.2", &value_str);
-        ASSERT_EQ(value_str, "value_2.2.1", "Found nested sibling object value");
+// Parse 1M log lines of about 90 bytes with JsonBatch_new, with a handler and keeping the records,
+// and line by line with JsonObj_new_insitu on a reset JsonObj and with one JsonObj_new per line.
+// One JsonObj per line holds its own arena, so that mode runs on the first 100,000 lines.
+void bench_ndjson(void)
+{
+    static const char* levels[]      = {"DEBUG", "INFO", "WARNING", "ERROR"};
+    static const unsigned statuses[] = {200, 200, 201, 204, 301, 404, 500, 503};
+    static const char* modes[]       = {
+        "JsonBatch_new, handler",
+        "JsonBatch_new, records kept",
+        "JsonObj_new_insitu, reset",
+    };
+    BenchCorpus corpus = {.name = "ndjson"};
+    size_t obj_len     = 0;
+    for (size_t i = 0; i < BENCH_NDJSON_LINES; i++)
+    {
+        _BenchCorpus_append(
+            &corpus,
+            "{\"ts\": %lu, \"level\": \"%s\", \"status\": %u, \"path\": \"/items/%lu\", "
+            "\"ms\": %lu}\n",
+            1760680000000 + 7 * i,
+            levels[i % 4],
+            statuses[(i * 7) % 8],
+            (i * 7919) % 100000,
+            i % 1000);
+        if (i + 1 == BENCH_NDJSON_OBJ_LINES)
+        {
+            obj_len = corpus.len;
+        }
+    }
+    char* buf = malloc(corpus.len);
+    printf(
+        "%lu lines of %.0f bytes on average\n",
+        (size_t)BENCH_NDJSON_LINES,
+        (double)corpus.len / BENCH_NDJSON_LINES);
+    for (size_t mode = 0; mode < sizeof(modes) / sizeof(modes[0]); mode++)
+    {
+        double best_time = 0.0;
+        for (size_t run = 0; run < BENCH_NDJSON_RUNS; run++)
+        {
+            size_t num_of_5xx = 0;
+            memcpy(buf, corpus.json_string, corpus.len);
+            const double elapsed = _bench_ndjson_run(buf, corpus.len, mode, &num_of_5xx);
+            best_time            = ((run == 0) || (elapsed < best_time)) ? elapsed : best_time;
+            if (num_of_5xx != BENCH_NDJSON_LINES / 4)
+            {
+                LOG_ERROR("Wrong count %lu for `%s`", num_of_5xx, modes[mode]);
+            }
+        }
+        printf("%-30s: %5.2f M records/s\n", modes[mode], BENCH_NDJSON_LINES / best_time / 1e6);
+    }
 
-        PRINT_TEST_TITLE("Test integer");
-        Json_get(&json_obj, "test_integer", &value_llu);
-        ASSERT_EQ(value_llu, 435234, "Integer found and read correctly");
+    // Lines ended by null bytes, each kept in its own JsonObj.
+    JsonObj* json_objs = malloc(BENCH_NDJSON_OBJ_LINES * sizeof(JsonObj));
+    memcpy(buf, corpus.json_string, obj_len);
+    for (size_t i = 0; i < obj_len; i++)
+    {
+        buf[i] = (buf[i] == '\n') ? '\0' : buf[i];
+    }
+    size_t num_of_objs      = 0;
+    const double start_time = _bench_now();
+    for (const char* line_p = buf; line_p < buf + obj_len; line_p += strlen(line_p) + 1)
+    {
+        if (is_err(JsonObj_new(line_p, &json_objs[num_of_objs])))
+        {
+            LOG_ERROR("Line %lu rejected", num_of_objs + 1);
+            break;
+        }
+        num_of_objs++;
+    }
+    const double elapsed = _bench_now() - start_time;
+    for (size_t i = 0; i < num_of_objs; i++)
+    {
+        JsonObj_destroy(&json_objs[i]);
+    }
+    printf(
+        "%-30s: %5.2f M records/s\n",
+        "JsonObj_new, one per line kept",
+        (double)num_of_objs / elapsed / 1e6);
+    free(json_objs);
+    free(buf);
+    free(corpus.json_string);
+}
 
-        PRINT_TEST_TITLE("Test double");
-        Json_get(&json_obj, "test_double", &value_double);
-        ASSERT_EQ(value_double, 435.234, "Float found and read correctly");
+#define BENCH_PROJECTION_RECORDS 100000
+#define BENCH_PROJECTION_RUNS 20
 
-        PRINT_TEST_TITLE("Test bool true");
-        Json_get(&json_obj, "test_bool_true", &value_bool);
-        ASSERT_EQ(value_bool, true, "Boolean found and read correctly");
+// Parse the logs corpus in full, then with projections keeping less and less of each record.
+void bench_projection(void)
+{
+    static const char* levels[]    = {"logs[*].level"};
+    static const char* some[]      = {"logs[*].level", "logs[*].ts", "logs[*].tags"};
+    static const char* first_one[] = {"logs[0]"};
+    const struct
+    {
+        const char* name;
+        const char* const* paths;
+        size_t num_of_paths;
+    } cases[] = {
+        {"everything", NULL, 0},
+        {"level, ts, tags", some, 3},
+        {"level", levels, 1},
+        {"first record", first_one, 1},
+    };
+    BenchCorpus corpus = {.name = "logs"};
+    _bench_corpus_logs(&corpus, BENCH_PROJECTION_RECORDS);
+    const double mb = (double)corpus.len / (1024.0 * 1024.0);
+    JsonObj json_obj;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        JsonProjection projection;
+        if ((cases[i].paths != NULL)
+            && is_err(JsonProjection_compile(cases[i].paths, cases[i].num_of_paths, &projection)))
+        {
+            LOG_ERROR("Projection `%s` rejected", cases[i].name);
+            continue;
+        }
+        const JsonProjection* projection_p = (cases[i].paths != NULL) ? &projection : NULL;
+        JsonStats stats                    = {0};
+        const double start_time            = _bench_now();
+        for (size_t run = 0; run < BENCH_PROJECTION_RUNS; run++)
+        {
+            if (is_err(JsonObj_new_projected(corpus.json_string, projection_p, &json_obj)))
+            {
+                LOG_ERROR("Corpus `%s` rejected", corpus.name);
+                break;
+            }
+            JsonObj_stats(&json_obj, &stats);
+            JsonObj_reset(&json_obj);
+        }
+        const double elapsed = _bench_now() - start_time;
+        printf(
+            "Projection %-16s: %7.1f MB/s, %8lu nodes, %8lu values dropped\n",
+            cases[i].name,
+            mb * BENCH_PROJECTION_RUNS / elapsed,
+            stats.num_of_nodes,
+            stats.num_of_dropped_values);
+        if (projection_p != NULL)
+        {
+            JsonProjection_destroy(&projection);
+        }
+    }
+    JsonObj_destroy(&json_obj);
+    free(corpus.json_string);
+}
 
-        PRINT_TEST_TITLE("Test bool false");
-        Json_get(&json_obj, "test_bool_false", &value_bool);
-        ASSERT_EQ(value_bool, false, "Boolean found and read correctly");
+#define BENCH_COLUMNS_ROWS 200000
+#define BENCH_COLUMNS_RUNS 20
 
-        Json_get(&json_obj, "test_array", &json_array);
-        Json_get(json_array, 0, &value_llu);
-        ASSERT_EQ(value_llu, 14352, "Array element of type INT read correctly");
-        Json_get(json_array, 1, &value_double);
-        ASSERT_EQ(value_double, 2.15, "Array element of type DOUBLE read correctly");
-        Json_get(json_array, 2, &value_str);
-        ASSERT_EQ(value_str, "string_element", "Array element of type C-string read correctly");
-        JsonObj_destroy(&json_obj);
+// Read 3 members of 6 from each element of an array of candles, with Json_get on each element and
+// with one Json_extract_columns.
+void bench_columns(void)
+{
+    BenchCorpus corpus = {.name = "candles"};
+    _BenchCorpus_append(&corpus, "{\"candles\": [");
+    for (size_t i = 0; i < BENCH_COLUMNS_ROWS; i++)
+    {
+        _BenchCorpus_append(
+            &corpus,
+            "%s{\"t\": %lu, \"open\": %lu.%02lu, \"high\": %lu.5, \"low\": %lu.25, "
+            "\"close\": %lu.%02lu, \"volume\": %lu}",
+            (i > 0) ? ", " : "",
+            1700000000 + 60 * i,
+            100 + i % 50,
+            i % 100,
+            101 + i % 50,
+            99 + i % 50,
+            100 + (i * 7) % 50,
+            (i * 13) % 100,
+            1000 + (i * 7919) % 100000);
     }
-    PRINT_TEST_TITLE("Invalid JSON string - empty")
+    _BenchCorpus_append(&corpus, "]}");
+    JsonObj json_obj;
+    JsonArray* array_p = NULL;
+    if (is_err(JsonObj_new(corpus.json_string, &json_obj))
+        || is_err(Json_get(&json_obj, "candles", &array_p)))
     {
-        JsonObj json_obj;
-        char* json_string = "";
-        ASSERT(JsonObj_new(json_string, &json_obj) == ERR_EMPTY_STRING, "Empty JSON fails to initialize.");
+        LOG_ERROR("Corpus `%s` rejected", corpus.name);
+        free(corpus.json_string);
+        return;
     }
-    PRINT_TEST_TITLE("Invalid JSON string - string not starting with '{'")
-    { // TODO: crate token analyzer and add TC's.
-        JsonObj json_obj;
-        char* json_string = "This is not a JSON file";
-        ASSERT(JsonObj_new(json_string, &json_obj) == ERR_JSON_INVALID, "Invalid JSON fails to initialize.");
+    json_uint_t* times       = malloc(BENCH_COLUMNS_ROWS * sizeof(json_uint_t));
+    json_decimal_t* closes   = malloc(BENCH_COLUMNS_ROWS * sizeof(json_decimal_t));
+    json_uint_t* volumes     = malloc(BENCH_COLUMNS_ROWS * sizeof(json_uint_t));
+    uint64_t* bitmaps        = malloc(3 * JSON_BITMAP_WORDS(BENCH_COLUMNS_ROWS) * sizeof(uint64_t));
+    const size_t num_of_rows = JsonArray_len(array_p);
+    double getters_sum       = 0.0;
+    double start_time        = _bench_now();
+    for (size_t run = 0; run < BENCH_COLUMNS_RUNS; run++)
+    {
+        for (size_t i = 0; i < num_of_rows; i++)
+        {
+            JsonItem* item_p = NULL;
+            Json_get(array_p, i, &item_p);
+            Json_get(item_p, "t", &times[i]);
+            Json_get(item_p, "close", &closes[i]);
+            Json_get(item_p, "volume", &volumes[i]);
+            getters_sum += closes[i];
+        }
     }
-    PRINT_TEST_TITLE("Fixed memory leak");
+    const double getters_time = _bench_now() - start_time;
+    JsonColumn columns[]      = {
+        {"t", VALUE_LLU, times, bitmaps, 0},
+        {"close", VALUE_DOUBLE, closes, &bitmaps[JSON_BITMAP_WORDS(BENCH_COLUMNS_ROWS)], 0},
+        {"volume", VALUE_LLU, volumes, &bitmaps[2 * JSON_BITMAP_WORDS(BENCH_COLUMNS_ROWS)], 0},
+    };
+    double columns_sum = 0.0;
+    start_time         = _bench_now();
+    for (size_t run = 0; run < BENCH_COLUMNS_RUNS; run++)
     {
-        JsonArray* json_array;
-        const char* value_str;
-        const char* json_char_p = "{\"request\":[\"Required parameter is missing\"]}";
-        JsonObj json_with_vector_obj;
-        ASSERT(is_ok(JsonObj_new(json_char_p, &json_with_vector_obj)), "Json object created");
-        Json_get(&json_with_vector_obj, "request", &json_array);
-        Json_get(json_array, 0, &value_str);
-        ASSERT_EQ(value_str, "Required parameter is missing", "");
-        JsonObj_destroy(&json_with_vector_obj);
+        Json_extract_columns(array_p, columns, 3);
+        for (size_t i = 0; i < num_of_rows; i++)
+        {
+            columns_sum += closes[i];
+        }
     }
-    PRINT_TEST_TITLE("Data conversion");
+    const double columns_time = _bench_now() - start_time;
+    if (columns_sum != getters_sum)
     {
-        JsonObj json_obj;
-        json_uint_t value_llu;
-        json_int_t value_int;
-        Error ret_res;
-        char* json_string = load_file_alloc("test/assets/test_json_numbers.json");
-        ASSERT_OK(JsonObj_new(json_string, &json_obj), "Json object created");
-        Json_get(&json_obj, "value_int", &value_llu);
-        ASSERT_EQ((json_uint_t)23, value_llu, "Conversion from INT to LLU successfull");
-        Json_get(&json_obj, "value_small_uint", &value_int);
-        ASSERT_EQ((json_int_t)43, value_int, "Conversion from LLU to INT successfull");
-        ret_res = Json_get(&json_obj, "value_negative_int", &value_llu);
-        ASSERT(ret_res == ERR_INVALID, "Conversion from negative INT to LLU failed");
-        ret_res = Json_get(&json_obj, "value_uint", &value_int);
-        ASSERT(ret_res == ERR_INVALID, "Conversion from large LLU to INT failed");
-        JsonObj_destroy(&json_obj);
-        free(json_string);
+        LOG_ERROR("Wrong sum %f instead of %f", columns_sum, getters_sum);
     }
-    /**/
+    printf(
+        "3 members of %lu elements: Json_get %.1f ns/element, Json_extract_columns %.1f "
+        "ns/element\n",
+        num_of_rows,
+        getters_time * 1e9 / (double)(BENCH_COLUMNS_RUNS * num_of_rows),
+        columns_time * 1e9 / (double)(BENCH_COLUMNS_RUNS * num_of_rows));
+    free(times);
+    free(closes);
+    free(volumes);
+    free(bitmaps);
+    JsonObj_destroy(&json_obj);
+    free(corpus.json_string);
 }
-#endif /* TEST */
+#endif /* BENCH */
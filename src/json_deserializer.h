@@ -41,45 +41,56 @@ void test_logger(void);
 
 #endif /* TEST */
 
-#define return_on_err(_expr)                            \
-    {                                                   \
-        Error _res = _expr;                             \
-        if (_res != ERR_ALL_GOOD)                       \
-        {                                               \
-            LOG_WARNING("Error propagated from here."); \
-            return _res;                                \
-        }                                               \
+// Errors are reported where they are raised, or recorded in a JsonError by the getters, so
+// propagating one does not log.
+#define return_on_err(_expr)      \
+    {                             \
+        Error _res = _expr;       \
+        if (_res != ERR_ALL_GOOD) \
+        {                         \
+            return _res;          \
+        }                         \
     }
 
 #if LOG_LEVEL > LEVEL_NO_LOGS
 #define DATE_TIME_STR_LEN 32
+#define LOG_MESSAGE_LEN 256 // Longer messages are truncated
+#define LOG_RING_LEN 1024   // Records per thread, a power of two
+
+// Log line waiting in the ring of the thread that logged it, see log_enqueue.
+typedef struct LogRecord
+{
+    struct timespec time;
+    FILE* file_p;
+    const char* type; // NULL for a separator
+    const char* filename;
+    int line;
+    char message[LOG_MESSAGE_LEN];
+} LogRecord;
+
+// Records of one thread. Only the thread moves `head` and only the writer thread moves `tail`, so
+// neither needs a lock.
+typedef struct LogRing
+{
+    _Alignas(64) _Atomic size_t head;
+    _Alignas(64) _Atomic size_t tail;
+    size_t drained;      // Records written by the writer thread, not yet flushed
+    atomic_bool in_use;  // Cleared when the thread exits, so that another thread takes the ring
+    struct LogRing* next_p;
+    LogRecord records[LOG_RING_LEN];
+} LogRing;
+
 void logger_init(const char*, const char*);
+void logger_flush(void);
+void log_enqueue(FILE*, const char*, const char*, int, const char*, ...)
+    __attribute__((format(printf, 5, 6)));
 
 void get_date_time(char* date_time_str);
 
-#define log_formatter(out_or_err, TYPE, fmt, ...)  \
-    char date_time_str[DATE_TIME_STR_LEN];         \
-    get_date_time(date_time_str);                  \
-    pthread_mutex_lock(&log_##out_or_err##_mutex); \
-    fprintf(                                       \
-        log_##out_or_err,                          \
-        "[%5s] <%d> %s %s:%d | " fmt "\n",         \
-        #TYPE,                                     \
-        getpid(),                                  \
-        date_time_str,                             \
-        __FILENAME__,                              \
-        __LINE__ __VA_OPT__(, ) __VA_ARGS__);      \
-    fflush(log_##out_or_err);                      \
-    pthread_mutex_unlock(&log_##out_or_err##_mutex);
-
-#define PRINT_SEPARATOR()                                                       \
-    {                                                                           \
-        char date_time_str[DATE_TIME_STR_LEN];                                  \
-        get_date_time(date_time_str);                                           \
-        pthread_mutex_lock(&log_out_mutex);                                     \
-        fprintf(log_out, "------- <%d> %s -------\n", getpid(), date_time_str); \
-        pthread_mutex_unlock(&log_out_mutex);                                   \
-    }
+#define log_formatter(out_or_err, TYPE, fmt, ...) \
+    log_enqueue(log_##out_or_err, #TYPE, __FILENAME__, __LINE__, fmt __VA_OPT__(, ) __VA_ARGS__);
+
+#define PRINT_SEPARATOR() log_enqueue(log_out, NULL, NULL, 0, "%s", "")
 
 #else /* LOG_LEVEL > LEVEL_NO_LOGS */
 #define get_date_time(something)
@@ -92,6 +103,7 @@ void get_date_time(char* date_time_str);
 #define LOG_PERROR(fmt, ...) {log_formatter(err, ERROR, fmt "`%s` | ", __VA_ARGS__ __VA_OPT__(, ) strerror(errno))}
 #else /* TEST */
 #define LOG_ERROR(...)
+#define LOG_PERROR(...)
 #endif /* TEST */
 
 #if LOG_LEVEL >= LEVEL_WARNING
@@ -235,9 +247,34 @@ typedef enum
     VALUE_INVALID,
 } ValueType;
 
+#define JSON_NO_OFFSET SIZE_MAX
+
+// Details of the last getter call that failed or converted its value, filled only when the
+// JsonError is attached to the document or passed to Json_get_err. The getters neither log nor
+// format anything, so that a missing optional member costs no more than its lookup.
+typedef struct JsonError
+{
+    Error code;          // ERR_ALL_GOOD when the value was found and converted
+    const char* note;    // Static description, e.g. "key not found" or "uint converted to int"
+    const char* key_p;   // Key requested, or key of the path step that failed; NULL for an index
+    size_t index;        // Index requested, when `key_p` is NULL
+    size_t offset;       // Offset in the JSON string of the value or its key, or JSON_NO_OFFSET
+    ValueType requested; // Type asked for by the caller
+    ValueType found;     // Type of the value found, VALUE_INVALID when there is none
+} JsonError;
+
+// A string of the document with its length in bytes, which saves the caller a call to strlen.
+// `ptr` is null-terminated as well.
+typedef struct JsonStr
+{
+    const char* ptr;
+    size_t len;
+} JsonStr;
+
 typedef struct JsonValue
 {
     ValueType value_type;
+    uint32_t value_len; // Length of value_char_p in bytes, for VALUE_STR only
     union
     {
         json_int_t value_int;            // leaf json_int_t
@@ -246,27 +283,368 @@ typedef struct JsonValue
         json_bool_t value_bool;          // leaf json_bool_t
         const char* value_char_p;        // leaf c-string
         struct JsonItem* value_child_p;  // another item
-        struct JsonArray* value_array_p; // the first item of an array
+        struct JsonArray* value_array_p; // table of the elements of an array
     };
 } JsonValue;
 
 typedef struct JsonItem
 {
     const char* key_p;
-    json_uint_t index; // For arrays only
+    union
+    {
+        json_uint_t index;                // For arrays only
+        struct JsonKeyTable* key_table_p; // First item of large objects only, NULL otherwise
+        struct JsonObj* obj_p;            // Root only, the document holding the item
+    };
     JsonValue value;
     struct JsonItem* parent;
     struct JsonItem* next_sibling;
+    uint32_t key_len; // Length of key_p in bytes
 } JsonItem;
 
+// Bump-pointer allocator holding every node of a JsonObj. Chunks grow geometrically and are
+// released all at once.
+typedef struct JsonArena
+{
+    struct JsonArenaChunk* first_chunk_p;
+    struct JsonArenaChunk* curr_chunk_p;
+} JsonArena;
+
+// Offsets of the structural characters of a JSON string, filled by the indexing stage.
+typedef struct JsonIndex
+{
+    uint32_t* positions;
+    size_t count;
+    size_t capacity;
+} JsonIndex;
+
+// Elements of the arrays being parsed, moved to their JsonArray when the array is closed.
+typedef struct JsonItemStack
+{
+    JsonItem** items;
+    size_t count;
+    size_t capacity;
+} JsonItemStack;
+
 typedef struct JsonObj
 {
     char* json_string;
+    size_t json_string_capacity; // 0 when json_string is borrowed from the caller or mapped
+    size_t json_string_mapped_len; // Length of the file mapped by JsonObj_from_file, 0 otherwise
+    JsonIndex index;
+    JsonItemStack element_stack;
+    JsonArena arena;
+    // Set by JsonObj_reset to let the next JsonObj_new recycle the buffers.
+    const struct JsonObj* recycle_p;
+    JsonError* error_p; // Filled by the getters of the document if not NULL, see JsonError
+    size_t parallel_scratch_bytes; // Worker buffers freed at the end of JsonObj_new_parallel
+    size_t num_of_dropped_values;  // Values left out by the projection of JsonObj_new_projected
+    size_t dropped_bytes;          // Bytes of the input they spanned
     JsonItem root;
 } JsonObj;
 
+// Memory held by a JsonObj and shape of its tree, filled by JsonObj_stats.
+typedef struct JsonStats
+{
+    size_t num_of_nodes;                 // Items of the tree, root excluded
+    size_t nodes_by_type[VALUE_INVALID]; // Items by ValueType, VALUE_UNDEFINED for empty objects
+    size_t max_depth;                    // 1 for the members of the top-level object
+    size_t string_bytes;          // JSON string copied or mapped by the document, 0 if borrowed
+    size_t node_bytes;            // Arena bytes taken by items, arrays and key tables
+    size_t arena_bytes;           // Arena bytes reserved, chunk headers included
+    size_t transient_bytes;       // Structural index and element stack, kept for the next parse
+    size_t peak_transient_bytes;  // Transient bytes plus the worker buffers of a parallel parse
+    size_t total_bytes;           // string_bytes + arena_bytes + transient_bytes
+    size_t num_of_dropped_values; // Members and elements left out by a projection
+    size_t dropped_bytes;         // Bytes of the input they spanned
+} JsonStats;
+
+#if defined(TEST) || defined(BENCH)
+#define JSON_STATS
+#endif /* TEST || BENCH */
+
+#ifdef JSON_STATS
+// Heap calls made by the library since the start of the process. Built with -DJSON_STATS only.
+typedef struct JsonGlobalStats
+{
+    size_t num_of_allocs;   // malloc, calloc and realloc of NULL
+    size_t num_of_reallocs; // realloc of a block
+    size_t num_of_frees;    // free of a block
+    size_t allocated_bytes; // Bytes requested by the allocations and reallocations
+} JsonGlobalStats;
+#endif /* JSON_STATS */
+
+// What the parser expects to find at the next non-whitespace position.
+typedef enum
+{
+    EXPECT_KEY,
+    EXPECT_VALUE,
+    EXPECT_COMMA_OR_CLOSE,
+    // Only needed when the input comes in chunks.
+    EXPECT_ROOT,
+    EXPECT_COLON,
+    EXPECT_END,
+} ParserState;
+
+typedef enum
+{
+    LEX_BETWEEN_TOKENS,
+    LEX_STRING,
+    LEX_SCALAR,
+} LexState;
+
+// Push parser building a JsonObj from chunks of input, see JsonParser_feed. Strings and scalars
+// split across chunks are carried over in `token`.
+typedef struct JsonParser
+{
+    JsonObj* json_obj_p;
+    struct JsonItem* container_p;
+    struct JsonItem* curr_item_p;
+    ParserState state;
+    LexState lex_state;
+    bool escaped;     // The previous character of the current string is an unescaped `\`
+    bool just_opened; // Nothing found yet in the current container
+    Error error;      // Sticky: set on failure, which destroys the JsonObj, or when finished
+    char* token;
+    size_t token_len;
+    size_t token_capacity;
+} JsonParser;
+
+// One record of a newline-delimited JSON buffer, see JsonBatch_new.
+typedef struct JsonRecord
+{
+    JsonItem* item_p; // First item of the record, to be passed to Json_get; NULL on error
+    size_t line;      // 1-based line of the record in the buffer
+    Error error;      // ERR_JSON_INVALID if the record could not be parsed
+} JsonRecord;
+
+// Called by JsonBatch_new for each record, valid or not. Returning false stops the batch.
+typedef bool (*JsonRecordHandler)(const JsonRecord*, void*);
+
+// Records of a newline-delimited JSON buffer, sharing one structural index and one arena.
+typedef struct JsonBatch
+{
+    JsonObj json_obj;    // Owns the index and the arena, borrows the buffer
+    JsonRecord* records; // Only filled when no handler is given
+    size_t num_of_records;
+    size_t num_of_errors;
+    size_t records_capacity;
+} JsonBatch;
+
+// Callbacks of Json_parse_events, any of which may be NULL. Strings and keys are decoded and
+// null-terminated, and only valid until the callback returns. Returning false stops the parse.
+typedef struct JsonHandler
+{
+    bool (*on_object_start)(void*);
+    bool (*on_object_end)(void*);
+    bool (*on_array_start)(void*);
+    bool (*on_array_end)(void*);
+    bool (*on_key)(const char*, size_t, void*);
+    bool (*on_string)(const char*, size_t, void*);
+    bool (*on_int)(json_int_t, void*);
+    bool (*on_llu)(json_uint_t, void*);
+    bool (*on_double)(json_decimal_t, void*);
+    bool (*on_bool)(json_bool_t, void*);
+} JsonHandler;
+
+// Document read on demand, see JsonDoc_new. Only the structural index is built: Json_get finds the
+// requested values in it and converts them, stepping over the others.
+typedef struct JsonDoc
+{
+    JsonObj json_obj; // Owns the index, borrows the buffer
+    size_t len;
+} JsonDoc;
+
+// Object of a JsonDoc, filled by Json_get.
+typedef struct JsonDocItem
+{
+    const JsonDoc* doc_p;
+    size_t pos; // Position of its `{` in the structural index
+} JsonDocItem;
+
+// Array of a JsonDoc, filled by Json_get. The last element reached is remembered, so that reading
+// the elements in order steps over each of them only once.
+typedef struct JsonDocArray
+{
+    const JsonDoc* doc_p;
+    size_t pos;          // Position of its `[` in the structural index
+    size_t cached_index; // Index and position of the last element reached, if `cached_pos` > 0
+    size_t cached_pos;
+} JsonDocArray;
+
+// Tag held by the top byte of a word of a JsonTape.
+typedef enum
+{
+    TAPE_OBJECT_START = '{',
+    TAPE_OBJECT_END   = '}',
+    TAPE_ARRAY_START  = '[',
+    TAPE_ARRAY_END    = ']',
+    TAPE_STR          = '"',
+    TAPE_INT          = 'l',
+    TAPE_LLU          = 'u',
+    TAPE_DOUBLE       = 'd',
+    TAPE_TRUE         = 't',
+    TAPE_FALSE        = 'f',
+} JsonTapeTag;
+
+// Document stored as one array of 64-bit words, see JsonTape_new. Below its tag, a word holds a
+// 24-bit field and a 32-bit field:
+// - the start word of an object or an array holds its number of members or elements (saturated)
+//   and the position of its end word, which holds the position of the start word;
+// - a key or a string holds its length (saturated) and its offset in the buffer;
+// - a number is a tag word followed by a word holding its 64 bits;
+// - `true` and `false` are a tag word.
+typedef struct JsonTape
+{
+    char* json_string; // Borrowed
+    uint64_t* words;
+    size_t num_of_words;
+    JsonError* error_p; // Filled by the getters of the tape if not NULL, see JsonError
+} JsonTape;
+
+// Object of a JsonTape, filled by Json_get.
+typedef struct JsonTapeItem
+{
+    const JsonTape* tape_p;
+    size_t pos; // Position of its start word
+} JsonTapeItem;
+
+// Array of a JsonTape, filled by Json_get. Like a JsonDocArray, it remembers the last element
+// reached.
+typedef struct JsonTapeArray
+{
+    const JsonTape* tape_p;
+    size_t pos;          // Position of its start word
+    size_t cached_index; // Index and position of the last element reached, if `cached_pos` > 0
+    size_t cached_pos;
+} JsonTapeArray;
+
+// Step of a compiled path: a key of an object, or an index in an array when `key_p` is NULL.
+typedef struct JsonPathStep
+{
+    const char* key_p;
+    size_t key_len;
+    uint64_t key_hash;
+    size_t index;
+} JsonPathStep;
+
+// Index of a step of a JsonProjection that stands for every element of an array, written `[*]`.
+#define JSON_PATH_ANY_INDEX SIZE_MAX
+
+// Path such as `a.b.c[3].d`, parsed once by JsonPath_compile and then evaluated by JsonPath_eval
+// on any number of documents. It is never modified after compilation, so threads can share it.
+typedef struct JsonPath
+{
+    JsonPathStep* steps; // Followed by the keys, in the same allocation
+    size_t num_of_steps;
+} JsonPath;
+
+// Node of the trie of a JsonProjection: a key of an object, or an index of an array when `key_p` is
+// NULL. Nodes are linked by their offset in `nodes`, 0 standing for none.
+typedef struct JsonProjectionNode
+{
+    const char* key_p;
+    size_t key_len;
+    size_t index; // JSON_PATH_ANY_INDEX for `[*]`
+    size_t first_child;
+    size_t next_sibling;
+    bool keep_all;    // A path ends here: the whole value is kept
+    bool has_keys;    // Some path goes on with a key: an object is filtered
+    bool has_indices; // Some path goes on with an index: an array is filtered
+} JsonProjectionNode;
+
+// Paths of the values that JsonObj_new_projected builds, see JsonProjection_compile.
+typedef struct JsonProjection
+{
+    JsonPath* paths; // Own the keys of the nodes
+    size_t num_of_paths;
+    JsonProjectionNode* nodes; // nodes[0] stands for the root object
+    size_t num_of_nodes;
+    size_t nodes_capacity;
+} JsonProjection;
+
+// Type of a member bound by JsonDoc_bind.
+typedef enum
+{
+    JSON_FIELD_INT,    // json_int_t
+    JSON_FIELD_UINT,   // json_uint_t
+    JSON_FIELD_DOUBLE, // json_decimal_t
+    JSON_FIELD_BOOL,   // json_bool_t
+    JSON_FIELD_STR,    // const char*, pointing into the buffer
+    JSON_FIELD_OBJECT, // struct described by its own schema
+} JsonFieldType;
+
+// Member of a struct bound to a key, see JSON_SCHEMA. An array is a C array of `capacity` elements,
+// the number of elements found being stored in the size_t member at `count_offset`.
+typedef struct JsonField
+{
+    const char* key;
+    size_t key_len;
+    JsonFieldType type; // Type of the elements of an array
+    size_t offset;
+    const struct JsonSchema* schema_p; // Objects and arrays of objects only
+    bool is_array;
+    size_t capacity;
+    size_t element_size;
+    size_t count_offset;
+} JsonField;
+
+typedef struct JsonSchema
+{
+    const JsonField* fields;
+    size_t num_of_fields;
+} JsonSchema;
+
+// Number of words of a bitmap of `num_of_rows` bits, see JsonColumn.
+#define JSON_BITMAP_WORDS(num_of_rows) (((num_of_rows) + 63) / 64)
+
+// Member extracted from every element of an array of objects by Json_extract_columns. Row `i`
+// holds the value of element `i`, of the C type of `value_type`, and bit `i % 64` of
+// `present_p[i / 64]` is set if the element has the member. A missing member, or one that does not
+// convert to `value_type`, leaves a zero value and a clear bit.
+typedef struct JsonColumn
+{
+    const char* key;
+    ValueType value_type;  // VALUE_DOUBLE, VALUE_INT, VALUE_LLU, VALUE_BOOL or VALUE_STR
+    void* values_p;        // JsonArray_len() values of json_decimal_t, ..., json_bool_t or JsonStr
+    uint64_t* present_p;   // JSON_BITMAP_WORDS(JsonArray_len()) words
+    size_t num_of_present; // Set to the number of bits set in `present_p`
+} JsonColumn;
+
 Error JsonObj_new(const char*, JsonObj*);
+Error JsonObj_new_projected(const char*, const JsonProjection*, JsonObj*);
+Error JsonObj_new_insitu(char*, size_t, JsonObj*);
+Error JsonObj_from_file(const char*, JsonObj*);
+Error JsonObj_new_parallel(char*, size_t, size_t, JsonObj*);
+void JsonObj_reset(JsonObj*);
 void JsonObj_destroy(JsonObj*);
+Error JsonObj_stats(const JsonObj*, JsonStats*);
+#ifdef JSON_STATS
+void JsonStats_global(JsonGlobalStats*);
+#endif /* JSON_STATS */
+size_t JsonArray_len(const JsonArray*);
+Error Json_extract_column(const JsonArray*, const char*, ValueType, void*, uint64_t*, size_t*);
+Error Json_extract_columns(const JsonArray*, JsonColumn*, size_t);
+Error JsonParser_new(JsonParser*, JsonObj*);
+Error JsonParser_feed(JsonParser*, const char*, size_t);
+Error JsonParser_finish(JsonParser*);
+Error JsonBatch_new(char*, size_t, JsonBatch*, JsonRecordHandler, void*);
+void JsonBatch_destroy(JsonBatch*);
+Error Json_parse_events(const char*, size_t, const JsonHandler*, void*);
+Error Json_parse_events_file(const char*, const JsonHandler*, void*);
+Error JsonDoc_new(char*, size_t, JsonDoc*);
+void JsonDoc_destroy(JsonDoc*);
+size_t JsonDocArray_len(JsonDocArray*);
+Error JsonPath_compile(const char*, JsonPath*);
+void JsonPath_destroy(JsonPath*);
+Error JsonProjection_compile(const char* const*, size_t, JsonProjection*);
+void JsonProjection_destroy(JsonProjection*);
+Error JsonDoc_bind(const JsonDoc*, const JsonSchema*, void*);
+Error JsonTape_new(char*, size_t, JsonTape*);
+void JsonTape_destroy(JsonTape*);
+size_t JsonTapeArray_len(JsonTapeArray*);
+void _JsonError_begin(JsonError*);
+Error _JsonError_end(Error);
 
 // Created to have a symmetry between GET_VALUE and GET_ARRAY_VALUE
 Error invalid_request(const JsonArray*, size_t, const JsonArray**);
@@ -275,6 +653,7 @@ Error invalid_request(const JsonArray*, size_t, const JsonArray**);
 #define OBJ_GET_VALUE_h(suffix, out_type)                                                          \
     Error obj_get_##suffix(const JsonObj*, const char*, out_type);
     OBJ_GET_VALUE_h(value_char_p, const char**)
+    OBJ_GET_VALUE_h(value_str, JsonStr*)
     OBJ_GET_VALUE_h(value_child_p, JsonItem**)
     OBJ_GET_VALUE_h(value_array_p, JsonArray**)
 
@@ -287,6 +666,7 @@ Error invalid_request(const JsonArray*, size_t, const JsonArray**);
 
 #define GET_VALUE_h(suffix, out_type) Error get_##suffix(const JsonItem*, const char*, out_type);
     GET_VALUE_h(value_char_p, const char**)
+    GET_VALUE_h(value_str, JsonStr*)
     GET_VALUE_h(value_child_p, JsonItem**)
     GET_VALUE_h(value_array_p, JsonArray**)
 
@@ -299,48 +679,327 @@ Error invalid_request(const JsonArray*, size_t, const JsonArray**);
 #define GET_ARRAY_VALUE_h(suffix, out_type)                                                        \
     Error get_array_##suffix(const JsonArray*, size_t, out_type);
     GET_ARRAY_VALUE_h(value_char_p, const char**)
+    GET_ARRAY_VALUE_h(value_str, JsonStr*)
     GET_ARRAY_VALUE_h(value_int, json_int_t*)
     GET_ARRAY_VALUE_h(value_llu, json_uint_t*)
     GET_ARRAY_VALUE_h(value_double, json_decimal_t*)
     GET_ARRAY_VALUE_h(value_bool, json_bool_t*)
     GET_ARRAY_VALUE_h(value_child_p, JsonItem**)
 
+#define DOC_GET_VALUE_h(suffix, out_type)                                                          \
+    Error doc_get_##suffix(const JsonDoc*, const char*, out_type);                                 \
+    Error doc_item_get_##suffix(const JsonDocItem*, const char*, out_type);                        \
+    Error doc_array_get_##suffix(JsonDocArray*, size_t, out_type);
+    DOC_GET_VALUE_h(value_char_p, const char**)
+    DOC_GET_VALUE_h(value_str, JsonStr*)
+    DOC_GET_VALUE_h(value_int, json_int_t*)
+    DOC_GET_VALUE_h(value_llu, json_uint_t*)
+    DOC_GET_VALUE_h(value_double, json_decimal_t*)
+    DOC_GET_VALUE_h(value_bool, json_bool_t*)
+    DOC_GET_VALUE_h(value_child_p, JsonDocItem*)
+    DOC_GET_VALUE_h(value_array_p, JsonDocArray*)
+
+#define PATH_GET_VALUE_h(suffix, out_type)                                                         \
+    Error path_obj_get_##suffix(const JsonObj*, const JsonPath*, out_type);                        \
+    Error path_get_##suffix(const JsonItem*, const JsonPath*, out_type);
+    PATH_GET_VALUE_h(value_char_p, const char**)
+    PATH_GET_VALUE_h(value_str, JsonStr*)
+    PATH_GET_VALUE_h(value_int, json_int_t*)
+    PATH_GET_VALUE_h(value_llu, json_uint_t*)
+    PATH_GET_VALUE_h(value_double, json_decimal_t*)
+    PATH_GET_VALUE_h(value_bool, json_bool_t*)
+    PATH_GET_VALUE_h(value_child_p, JsonItem**)
+    PATH_GET_VALUE_h(value_array_p, JsonArray**)
+
+#define DOC_PATH_GET_VALUE_h(suffix, out_type)                                                     \
+    Error path_doc_get_##suffix(const JsonDoc*, const JsonPath*, out_type);
+    DOC_PATH_GET_VALUE_h(value_char_p, const char**)
+    DOC_PATH_GET_VALUE_h(value_str, JsonStr*)
+    DOC_PATH_GET_VALUE_h(value_int, json_int_t*)
+    DOC_PATH_GET_VALUE_h(value_llu, json_uint_t*)
+    DOC_PATH_GET_VALUE_h(value_double, json_decimal_t*)
+    DOC_PATH_GET_VALUE_h(value_bool, json_bool_t*)
+    DOC_PATH_GET_VALUE_h(value_child_p, JsonDocItem*)
+    DOC_PATH_GET_VALUE_h(value_array_p, JsonDocArray*)
+
+#define TAPE_GET_VALUE_h(suffix, out_type)                                                         \
+    Error tape_get_##suffix(const JsonTape*, const char*, out_type);                               \
+    Error tape_item_get_##suffix(const JsonTapeItem*, const char*, out_type);                      \
+    Error tape_array_get_##suffix(JsonTapeArray*, size_t, out_type);                               \
+    Error path_tape_get_##suffix(const JsonTape*, const JsonPath*, out_type);
+    TAPE_GET_VALUE_h(value_char_p, const char**)
+    TAPE_GET_VALUE_h(value_str, JsonStr*)
+    TAPE_GET_VALUE_h(value_int, json_int_t*)
+    TAPE_GET_VALUE_h(value_llu, json_uint_t*)
+    TAPE_GET_VALUE_h(value_double, json_decimal_t*)
+    TAPE_GET_VALUE_h(value_bool, json_bool_t*)
+    TAPE_GET_VALUE_h(value_child_p, JsonTapeItem*)
+    TAPE_GET_VALUE_h(value_array_p, JsonTapeArray*)
+
 #define Json_get(json_stuff, needle, out_p)                    \
     _Generic ((json_stuff),                                    \
         JsonObj*: _Generic((out_p),                            \
             const char**    : obj_get_value_char_p,            \
+            JsonStr*        : obj_get_value_str,               \
             json_int_t*     : obj_get_value_int,               \
             json_uint_t*    : obj_get_value_llu,               \
             json_decimal_t* : obj_get_value_double,            \
             json_bool_t*    : obj_get_value_bool,              \
             JsonItem**      : obj_get_value_child_p,           \
-            JsonArray**     : obj_get_value_array_p            \
+            JsonArray**     : obj_get_value_array_p,           \
+            JsonDocItem*    : invalid_request,                 \
+            JsonDocArray*   : invalid_request,                 \
+            JsonTapeItem*   : invalid_request,                 \
+            JsonTapeArray*  : invalid_request                  \
             ),                                                 \
          JsonItem*: _Generic((out_p),                          \
             const char**    : get_value_char_p,                \
+            JsonStr*        : get_value_str,                   \
             json_int_t*     : get_value_int,                   \
             json_uint_t*    : get_value_llu,                   \
             json_decimal_t* : get_value_double,                \
             json_bool_t*    : get_value_bool,                  \
             JsonItem**      : get_value_child_p,               \
-            JsonArray**     : get_value_array_p                \
+            JsonArray**     : get_value_array_p,               \
+            JsonDocItem*    : invalid_request,                 \
+            JsonDocArray*   : invalid_request,                 \
+            JsonTapeItem*   : invalid_request,                 \
+            JsonTapeArray*  : invalid_request                  \
             ),                                                 \
         JsonArray*: _Generic((out_p),                          \
             const char**    : get_array_value_char_p,          \
+            JsonStr*        : get_array_value_str,             \
             json_int_t*     : get_array_value_int,             \
             json_uint_t*    : get_array_value_llu,             \
             json_decimal_t* : get_array_value_double,          \
             json_bool_t*    : get_array_value_bool,            \
             JsonItem**      : get_array_value_child_p,         \
-            JsonArray**     : invalid_request                  \
+            JsonArray**     : invalid_request,                 \
+            JsonDocItem*    : invalid_request,                 \
+            JsonDocArray*   : invalid_request,                 \
+            JsonTapeItem*   : invalid_request,                 \
+            JsonTapeArray*  : invalid_request                  \
+            ),                                                 \
+        JsonDoc*: _Generic((out_p),                            \
+            const char**    : doc_get_value_char_p,            \
+            JsonStr*        : doc_get_value_str,               \
+            json_int_t*     : doc_get_value_int,               \
+            json_uint_t*    : doc_get_value_llu,               \
+            json_decimal_t* : doc_get_value_double,            \
+            json_bool_t*    : doc_get_value_bool,              \
+            JsonDocItem*    : doc_get_value_child_p,           \
+            JsonDocArray*   : doc_get_value_array_p,           \
+            JsonItem**      : invalid_request,                 \
+            JsonArray**     : invalid_request,                 \
+            JsonTapeItem*   : invalid_request,                 \
+            JsonTapeArray*  : invalid_request                  \
+            ),                                                 \
+        JsonDocItem*: _Generic((out_p),                        \
+            const char**    : doc_item_get_value_char_p,       \
+            JsonStr*        : doc_item_get_value_str,          \
+            json_int_t*     : doc_item_get_value_int,          \
+            json_uint_t*    : doc_item_get_value_llu,          \
+            json_decimal_t* : doc_item_get_value_double,       \
+            json_bool_t*    : doc_item_get_value_bool,         \
+            JsonDocItem*    : doc_item_get_value_child_p,      \
+            JsonDocArray*   : doc_item_get_value_array_p,      \
+            JsonItem**      : invalid_request,                 \
+            JsonArray**     : invalid_request,                 \
+            JsonTapeItem*   : invalid_request,                 \
+            JsonTapeArray*  : invalid_request                  \
+            ),                                                 \
+        JsonDocArray*: _Generic((out_p),                       \
+            const char**    : doc_array_get_value_char_p,      \
+            JsonStr*        : doc_array_get_value_str,         \
+            json_int_t*     : doc_array_get_value_int,         \
+            json_uint_t*    : doc_array_get_value_llu,         \
+            json_decimal_t* : doc_array_get_value_double,      \
+            json_bool_t*    : doc_array_get_value_bool,        \
+            JsonDocItem*    : doc_array_get_value_child_p,     \
+            JsonDocArray*   : doc_array_get_value_array_p,     \
+            JsonItem**      : invalid_request,                 \
+            JsonArray**     : invalid_request,                 \
+            JsonTapeItem*   : invalid_request,                 \
+            JsonTapeArray*  : invalid_request                  \
+            ),                                                 \
+        JsonTape*: _Generic((out_p),                           \
+            const char**    : tape_get_value_char_p,           \
+            JsonStr*        : tape_get_value_str,              \
+            json_int_t*     : tape_get_value_int,              \
+            json_uint_t*    : tape_get_value_llu,              \
+            json_decimal_t* : tape_get_value_double,           \
+            json_bool_t*    : tape_get_value_bool,             \
+            JsonTapeItem*   : tape_get_value_child_p,          \
+            JsonTapeArray*  : tape_get_value_array_p,          \
+            JsonItem**      : invalid_request,                 \
+            JsonArray**     : invalid_request,                 \
+            JsonDocItem*    : invalid_request,                 \
+            JsonDocArray*   : invalid_request                  \
+            ),                                                 \
+        JsonTapeItem*: _Generic((out_p),                       \
+            const char**    : tape_item_get_value_char_p,      \
+            JsonStr*        : tape_item_get_value_str,         \
+            json_int_t*     : tape_item_get_value_int,         \
+            json_uint_t*    : tape_item_get_value_llu,         \
+            json_decimal_t* : tape_item_get_value_double,      \
+            json_bool_t*    : tape_item_get_value_bool,        \
+            JsonTapeItem*   : tape_item_get_value_child_p,     \
+            JsonTapeArray*  : tape_item_get_value_array_p,     \
+            JsonItem**      : invalid_request,                 \
+            JsonArray**     : invalid_request,                 \
+            JsonDocItem*    : invalid_request,                 \
+            JsonDocArray*   : invalid_request                  \
+            ),                                                 \
+        JsonTapeArray*: _Generic((out_p),                      \
+            const char**    : tape_array_get_value_char_p,     \
+            JsonStr*        : tape_array_get_value_str,        \
+            json_int_t*     : tape_array_get_value_int,        \
+            json_uint_t*    : tape_array_get_value_llu,        \
+            json_decimal_t* : tape_array_get_value_double,     \
+            json_bool_t*    : tape_array_get_value_bool,       \
+            JsonTapeItem*   : tape_array_get_value_child_p,    \
+            JsonTapeArray*  : tape_array_get_value_array_p,    \
+            JsonItem**      : invalid_request,                 \
+            JsonArray**     : invalid_request,                 \
+            JsonDocItem*    : invalid_request,                 \
+            JsonDocArray*   : invalid_request                  \
             )                                                  \
         )(json_stuff, needle, out_p)
+
+#define JsonPath_eval(json_stuff, path_p, out_p)               \
+    _Generic ((json_stuff),                                    \
+        JsonObj*: _Generic((out_p),                            \
+            const char**    : path_obj_get_value_char_p,       \
+            JsonStr*        : path_obj_get_value_str,          \
+            json_int_t*     : path_obj_get_value_int,          \
+            json_uint_t*    : path_obj_get_value_llu,          \
+            json_decimal_t* : path_obj_get_value_double,       \
+            json_bool_t*    : path_obj_get_value_bool,         \
+            JsonItem**      : path_obj_get_value_child_p,      \
+            JsonArray**     : path_obj_get_value_array_p,      \
+            JsonDocItem*    : invalid_request,                 \
+            JsonDocArray*   : invalid_request,                 \
+            JsonTapeItem*   : invalid_request,                 \
+            JsonTapeArray*  : invalid_request                  \
+            ),                                                 \
+        JsonItem*: _Generic((out_p),                           \
+            const char**    : path_get_value_char_p,           \
+            JsonStr*        : path_get_value_str,              \
+            json_int_t*     : path_get_value_int,              \
+            json_uint_t*    : path_get_value_llu,              \
+            json_decimal_t* : path_get_value_double,           \
+            json_bool_t*    : path_get_value_bool,             \
+            JsonItem**      : path_get_value_child_p,          \
+            JsonArray**     : path_get_value_array_p,          \
+            JsonDocItem*    : invalid_request,                 \
+            JsonDocArray*   : invalid_request,                 \
+            JsonTapeItem*   : invalid_request,                 \
+            JsonTapeArray*  : invalid_request                  \
+            ),                                                 \
+        JsonDoc*: _Generic((out_p),                            \
+            const char**    : path_doc_get_value_char_p,       \
+            JsonStr*        : path_doc_get_value_str,          \
+            json_int_t*     : path_doc_get_value_int,          \
+            json_uint_t*    : path_doc_get_value_llu,          \
+            json_decimal_t* : path_doc_get_value_double,       \
+            json_bool_t*    : path_doc_get_value_bool,         \
+            JsonDocItem*    : path_doc_get_value_child_p,      \
+            JsonDocArray*   : path_doc_get_value_array_p,      \
+            JsonItem**      : invalid_request,                 \
+            JsonArray**     : invalid_request,                 \
+            JsonTapeItem*   : invalid_request,                 \
+            JsonTapeArray*  : invalid_request                  \
+            ),                                                 \
+        JsonTape*: _Generic((out_p),                           \
+            const char**    : path_tape_get_value_char_p,      \
+            JsonStr*        : path_tape_get_value_str,         \
+            json_int_t*     : path_tape_get_value_int,         \
+            json_uint_t*    : path_tape_get_value_llu,         \
+            json_decimal_t* : path_tape_get_value_double,      \
+            json_bool_t*    : path_tape_get_value_bool,        \
+            JsonTapeItem*   : path_tape_get_value_child_p,     \
+            JsonTapeArray*  : path_tape_get_value_array_p,     \
+            JsonItem**      : invalid_request,                 \
+            JsonArray**     : invalid_request,                 \
+            JsonDocItem*    : invalid_request,                 \
+            JsonDocArray*   : invalid_request                  \
+            )                                                  \
+        )(json_stuff, path_p, out_p)
+
+// Json_get and JsonPath_eval filling `error_p` instead of the JsonError attached to the document.
+#define Json_get_err(json_stuff, needle, out_p, error_p) \
+    (_JsonError_begin(error_p), _JsonError_end(Json_get(json_stuff, needle, out_p)))
+#define JsonPath_eval_err(json_stuff, path_p, out_p, error_p) \
+    (_JsonError_begin(error_p), _JsonError_end(JsonPath_eval(json_stuff, path_p, out_p)))
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wextra-semi"
 ; // ensure clang-format works when turned on again
 #pragma clang diagnostic pop
+
+/*
+ * Descriptors of the members of a struct, for JsonDoc_bind. The members are listed once in an
+ * X-macro taking one generator per kind of member, e.g.
+ *
+ *     #define ORDER_FIELDS(FIELD, OBJECT, ARRAY, OBJECT_ARRAY)            \
+ *         FIELD(Order, id, "id")                                          \
+ *         OBJECT(Order, customer, "customer", &customer_schema)           \
+ *         ARRAY(Order, tags, "tags", num_of_tags)                         \
+ *         OBJECT_ARRAY(Order, lines, "lines", num_of_lines, &line_schema)
+ *     JSON_SCHEMA(order_schema, ORDER_FIELDS);
+ *
+ * The type of a scalar member, or of the elements of a scalar array, is deduced from the struct:
+ * it must be one of the json_*_t types or `const char*`.
+ */
+#define JSON_FIELD_TYPE_OF(member)                             \
+    _Generic((member),                                         \
+        json_int_t     : JSON_FIELD_INT,                       \
+        json_uint_t    : JSON_FIELD_UINT,                      \
+        json_decimal_t : JSON_FIELD_DOUBLE,                    \
+        json_bool_t    : JSON_FIELD_BOOL,                      \
+        const char*    : JSON_FIELD_STR                        \
+    )
+
+#define JSON_SCALAR_FIELD(struct_type, member, key)                                                \
+    {key, sizeof(key) - 1, JSON_FIELD_TYPE_OF(((struct_type*)0)->member),                          \
+     offsetof(struct_type, member), NULL, false, 0, 0, 0},
+
+#define JSON_OBJECT_FIELD(struct_type, member, key, schema_p)                                      \
+    {key, sizeof(key) - 1, JSON_FIELD_OBJECT, offsetof(struct_type, member), schema_p, false, 0,    \
+     0, 0},
+
+#define JSON_ARRAY_FIELD(struct_type, member, key, count_member)                                   \
+    {key, sizeof(key) - 1, JSON_FIELD_TYPE_OF(((struct_type*)0)->member[0]),                       \
+     offsetof(struct_type, member), NULL, true,                                                    \
+     sizeof(((struct_type*)0)->member) / sizeof(((struct_type*)0)->member[0]),                     \
+     sizeof(((struct_type*)0)->member[0]), offsetof(struct_type, count_member)},
+
+#define JSON_OBJECT_ARRAY_FIELD(struct_type, member, key, count_member, schema_p)                  \
+    {key, sizeof(key) - 1, JSON_FIELD_OBJECT, offsetof(struct_type, member), schema_p, true,       \
+     sizeof(((struct_type*)0)->member) / sizeof(((struct_type*)0)->member[0]),                     \
+     sizeof(((struct_type*)0)->member[0]), offsetof(struct_type, count_member)},
+
+#define JSON_SCHEMA(name, FIELDS)                                                                  \
+    static const JsonField name##_fields[] = {                                                     \
+        FIELDS(JSON_SCALAR_FIELD, JSON_OBJECT_FIELD, JSON_ARRAY_FIELD, JSON_OBJECT_ARRAY_FIELD)};  \
+    static const JsonSchema name = {name##_fields, sizeof(name##_fields) / sizeof(JsonField)}
 // clang-format on
 
 #ifdef TEST
 void test_json_deserializer(void);
 #endif
+#ifdef BENCH
+void bench_parallel_scaling(void);
+void bench_lazy_access(void);
+void bench_schema_binding(void);
+void bench_tape_scan(void);
+void bench_wide_documents(void);
+void bench_key_width(void);
+void bench_logging(void);
+void bench_corpora(void);
+void bench_string_access(void);
+void bench_string_decoding(void);
+void bench_events(void);
+void bench_ndjson(void);
+void bench_projection(void);
+void bench_columns(void);
+#endif
@@ -1,28 +1,81 @@
 #include <unistd.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stdarg.h>
+#include <stdatomic.h>
 #include <pthread.h>
+#include <sched.h> /* sched_yield */
 #include <errno.h>
+#include <limits.h> /* PATH_MAX */
+#include <dirent.h> /* opendir */
 #include <time.h>
 #include <sys/time.h> /* gettimeofday */
+#include <sys/mman.h> /* mmap */
+#include <sys/stat.h> /* fstat */
+#include <sys/resource.h> /* getrusage */
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif /* __x86_64__ */
 
 #include "json_deserializer.h"
 #include "json_deserializer.c"
 
-#ifndef TEST
+#if defined(TEST)
 int main()
 {
-    LOG_INFO("Nothing to run.\n");
+    test_json_deserializer();
+    test_logger();
     return 0;
 }
-#else  /* TEST defined */
+#elif defined(BENCH)
 int main()
 {
-    test_json_deserializer();
-    test_logger();
+    // JSON_BENCH_SUITE selects one suite by name; all of them run if it is not set.
+    const struct
+    {
+        const char* name;
+        void (*run)(void);
+    } suites[] = {
+        {"parallel", bench_parallel_scaling},
+        {"lazy", bench_lazy_access},
+        {"schema", bench_schema_binding},
+        {"tape", bench_tape_scan},
+        {"wide", bench_wide_documents},
+        {"width", bench_key_width},
+        {"logging", bench_logging},
+        {"corpora", bench_corpora},
+        {"strings", bench_string_access},
+        {"decoding", bench_string_decoding},
+        {"events", bench_events},
+        {"ndjson", bench_ndjson},
+        {"projection", bench_projection},
+        {"columns", bench_columns},
+    };
+    const char* suite_name = getenv("JSON_BENCH_SUITE");
+    bool found             = false;
+    for (size_t i = 0; i < sizeof(suites) / sizeof(suites[0]); i++)
+    {
+        if ((suite_name == NULL) || (strcmp(suite_name, suites[i].name) == 0))
+        {
+            suites[i].run();
+            found = true;
+        }
+    }
+    if (!found)
+    {
+        fprintf(stderr, "Unknown benchmark suite `%s`\n", suite_name);
+        return 1;
+    }
+    return 0;
+}
+#else  /* Neither TEST nor BENCH defined */
+int main()
+{
+    LOG_INFO("Nothing to run.\n");
     return 0;
 }
 #endif /* TEST */